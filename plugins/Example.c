@@ -0,0 +1,236 @@
+/*
+An example decoder plugin, to start a new one from (see src/LPD433Plugin.h).
+Build it with
+    gcc -shared -fPIC -Isrc -o build/plugins/Example.so plugins/Example.c
+and load it with `LPD433 -r 27 -P build/plugins`.
+
+It decodes (and encodes) a simple 12-bit protocol, like that of many cheap
+remotes: with T = 350µs, a '0' is a high pulse of 1T and a low pulse of 3T, a
+'1' a high pulse of 3T and a low pulse of 1T. The 12 bits (most significant
+first) are followed by a sync: a high pulse of 1T, and a low pulse of 31T.
+The upper 8 bits are the `id` of the remote, the lower 4 bits the `button`,
+e.g. `LPD433 -s 17 Example "[ id 42, button 3 ]" -P build/plugins`.
+*/
+#include <stdio.h>
+#include <string.h>
+#include "LPD433Plugin.h"
+
+#define ExamplePulseDuration 350
+#define ExampleBitCount 12
+#define ExampleSyncLowPulseCount 31
+#define ExampleTransmitRepeatCount 4
+
+// accepted deviation of a pulse from its nominal duration, in percent
+#define ExampleTolerance 40
+
+// the shortest low pulse that is accepted as the end of the sync
+#define ExampleSyncLowMinimum (ExampleSyncLowPulseCount * ExamplePulseDuration * (100 - ExampleTolerance) / 100)
+
+typedef struct ExampleDecoder
+{
+    LPD433PluginFrameFunction frameFunction;
+    void * host;
+
+    bool hasPreviousEdge;
+    uint32_t previousTimestamp;
+
+    // the frame that is being received
+    uint32_t startTimestamp;
+    uint32_t code;
+    uint32_t bitCount;
+    uint32_t highPulseCount; // of the high pulse of the bit or sync, 0 if none yet
+    uint32_t deviation;      // sum, in percent, over `pulseCount` pulses
+    uint32_t pulseCount;
+} ExampleDecoder;
+
+// Returns the duration of `duration` in T, 1 or 3, or 0 if it is neither.
+// Adds its deviation to that of the frame.
+static uint32_t ExampleMatchPulse(ExampleDecoder * decoder, uint32_t duration)
+{
+    for (uint32_t pulseCount = 1; pulseCount <= 3; pulseCount += 2)
+    {
+        uint32_t nominal = pulseCount * ExamplePulseDuration;
+        uint32_t difference = (duration > nominal) ? duration - nominal : nominal - duration;
+        if (difference * 100 <= nominal * ExampleTolerance)
+        {
+            decoder->deviation += difference * 100 / nominal;
+            decoder->pulseCount += 1;
+            return pulseCount;
+        }
+    }
+    return 0;
+}
+
+static void ExampleResetFrame(ExampleDecoder * decoder)
+{
+    decoder->code = 0;
+    decoder->bitCount = 0;
+    decoder->highPulseCount = 0;
+    decoder->deviation = 0;
+    decoder->pulseCount = 0;
+}
+
+// after lost edges, the previous edge can not be trusted either
+static void ExampleReset(void * context)
+{
+    ExampleDecoder * decoder = context;
+    decoder->hasPreviousEdge = false;
+    ExampleResetFrame(decoder);
+}
+
+static void * ExampleCreate(LPD433PluginFrameFunction frameFunction, void * host)
+{
+    ExampleDecoder * decoder = calloc(1, sizeof(ExampleDecoder));
+    if (NULL == decoder) { return NULL; }
+    decoder->frameFunction = frameFunction;
+    decoder->host = host;
+    ExampleResetFrame(decoder);
+    return decoder;
+}
+
+static void ExampleRelease(void * decoder)
+{
+    free(decoder);
+}
+
+static void ExampleFinishFrame(ExampleDecoder * decoder, uint32_t endTimestamp)
+{
+    LPD433PluginFrame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.code = decoder->code;
+    frame.bitCount = ExampleBitCount;
+    uint32_t averageDeviation = decoder->deviation / decoder->pulseCount;
+    frame.quality = (uint8_t) (averageDeviation >= 100 ? 0 : 100 - averageDeviation);
+    frame.startTimestamp = decoder->startTimestamp;
+    frame.endTimestamp = endTimestamp;
+    decoder->frameFunction(decoder->host, &frame);
+}
+
+// the high pulse of `duration` µs that started at `startTimestamp`
+static void ExampleDecodeHighPulse(ExampleDecoder * decoder, uint32_t startTimestamp, uint32_t duration)
+{
+    if (0 != decoder->highPulseCount) { ExampleResetFrame(decoder); }
+    if (0 == decoder->bitCount && 0 == decoder->pulseCount) { decoder->startTimestamp = startTimestamp; }
+
+    decoder->highPulseCount = ExampleMatchPulse(decoder, duration);
+    if (0 == decoder->highPulseCount) { ExampleResetFrame(decoder); }
+}
+
+// the low pulse of (at least, after a silence) `duration` µs that started at `startTimestamp`
+static void ExampleDecodeLowPulse(ExampleDecoder * decoder, uint32_t startTimestamp, uint32_t duration)
+{
+    if (0 == decoder->highPulseCount)
+    {
+        ExampleResetFrame(decoder);
+        return;
+    }
+
+    if (ExampleBitCount == decoder->bitCount)
+    {
+        // the sync: its low pulse may be cut short by the next frame
+        if (1 == decoder->highPulseCount && duration >= ExampleSyncLowMinimum)
+        { ExampleFinishFrame(decoder, startTimestamp); }
+        ExampleResetFrame(decoder);
+        return;
+    }
+
+    uint32_t lowPulseCount = ExampleMatchPulse(decoder, duration);
+    if (0 == lowPulseCount || lowPulseCount == decoder->highPulseCount)
+    {
+        ExampleResetFrame(decoder);
+        return;
+    }
+    decoder->code = (decoder->code << 1) | (3 == decoder->highPulseCount ? 1 : 0);
+    decoder->bitCount += 1;
+    decoder->highPulseCount = 0;
+}
+
+static void ExampleFeedEdges(void * context, const LPD433PluginEdge * edges, uint32_t count)
+{
+    ExampleDecoder * decoder = context;
+    for (uint32_t index = 0; index < count; index++)
+    {
+        const LPD433PluginEdge * edge = &edges[index];
+        if (decoder->hasPreviousEdge)
+        {
+            uint32_t duration = edge->timestamp - decoder->previousTimestamp;
+            // an edge ends the pulse of the other level, a silence a low pulse
+            if (1 == edge->level)
+            { ExampleDecodeLowPulse(decoder, decoder->previousTimestamp, duration); }
+            else if (0 == edge->level)
+            { ExampleDecodeHighPulse(decoder, decoder->previousTimestamp, duration); }
+            else
+            {
+                // a silence is reported every few ms: only one that is long
+                // enough ends the sync, and so the frame
+                if (duration >= ExampleSyncLowMinimum)
+                { ExampleDecodeLowPulse(decoder, decoder->previousTimestamp, duration); }
+                continue;
+            }
+        }
+        if (LPD433PluginLevelTimeout != edge->level)
+        {
+            decoder->hasPreviousEdge = true;
+            decoder->previousTimestamp = edge->timestamp;
+        }
+    }
+}
+
+static int ExampleFormat(const LPD433PluginFrame * frame, char * buffer, size_t size)
+{
+    return snprintf(buffer, size, "Example [id %u, button %u]",
+                    (unsigned) (frame->code >> 4), (unsigned) (frame->code & 0xF));
+}
+
+// Parses the value after `key` in `keyValues`, e.g. 3 for `button` in
+// `[ id 42, button 3 ]`. Returns false if there is none, or if it is > `max`.
+static bool ExampleParseValue(const char * keyValues, const char * key, uint32_t max, uint32_t * value)
+{
+    const char * position = strstr(keyValues, key);
+    if (NULL == position) { return false; }
+    char * end = NULL;
+    unsigned long parsed = strtoul(position + strlen(key), &end, 10);
+    if (end == position + strlen(key) || parsed > max) { return false; }
+    *value = (uint32_t) parsed;
+    return true;
+}
+
+static uint32_t ExampleEncode(const char * keyValues, uint32_t * durations, uint32_t capacity, uint32_t * repeatCount)
+{
+    uint32_t identifier = 0;
+    uint32_t button = 0;
+    if (!ExampleParseValue(keyValues, "id", 0xFF, &identifier) ||
+        !ExampleParseValue(keyValues, "button", 0xF, &button) ||
+        capacity < 2 * ExampleBitCount + 2)
+    { return 0; }
+
+    uint32_t code = (identifier << 4) | button;
+    uint32_t length = 0;
+    for (int32_t bit = ExampleBitCount - 1; bit >= 0; bit--)
+    {
+        bool one = (code >> bit) & 1;
+        durations[length++] = (one ? 3 : 1) * ExamplePulseDuration;
+        durations[length++] = (one ? 1 : 3) * ExamplePulseDuration;
+    }
+    durations[length++] = ExamplePulseDuration;
+    durations[length++] = ExampleSyncLowPulseCount * ExamplePulseDuration;
+    *repeatCount = ExampleTransmitRepeatCount;
+    return length;
+}
+
+static const LPD433Plugin ExamplePlugin =
+{
+    .ABIVersion = LPD433PluginABIVersion,
+    .name = "Example",
+    .create = ExampleCreate,
+    .release = ExampleRelease,
+    .reset = ExampleReset,
+    .feedEdges = ExampleFeedEdges,
+    .format = ExampleFormat,
+    .encode = ExampleEncode
+};
+
+const LPD433Plugin * LPD433PluginGet(void)
+{
+    return &ExamplePlugin;
+}
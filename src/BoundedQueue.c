@@ -0,0 +1,156 @@
+#include <stdio.h>
+#include <assert.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "BoundedQueue.h"
+
+// keeps the positions that producers and consumers update on separate cache
+// lines
+#define BoundedQueueCacheLineSize 64
+
+/*
+Each cell starts with a sequence number, followed by the element. A producer
+may fill a cell when its sequence equals the enqueue position, a consumer may
+empty it when its sequence is one more than the dequeue position. After
+emptying, the sequence is moved one lap (`capacity`) ahead.
+*/
+struct BoundedQueue
+{
+    uint32_t capacity;
+    uint32_t mask;
+    uint32_t elementSize;
+    uint32_t cellSize;
+    unsigned char * cells;
+
+    _Alignas(BoundedQueueCacheLineSize) _Atomic size_t enqueuePosition;
+    _Alignas(BoundedQueueCacheLineSize) _Atomic size_t dequeuePosition;
+};
+
+_Atomic size_t * BoundedQueueGetSequence(BoundedQueueRef queue, size_t position)
+{
+    return (_Atomic size_t *) (queue->cells + (position & queue->mask) * queue->cellSize);
+}
+
+unsigned char * BoundedQueueGetElement(BoundedQueueRef queue, size_t position)
+{
+    return queue->cells + (position & queue->mask) * queue->cellSize + sizeof(_Atomic size_t);
+}
+
+BoundedQueueRef BoundedQueueCreate(uint32_t capacity, uint32_t elementSize)
+{
+    assert(elementSize > 0);
+
+    uint32_t roundedCapacity = 2;
+    while (roundedCapacity < capacity && roundedCapacity < 0x80000000u) { roundedCapacity <<= 1; }
+
+    BoundedQueueRef newQueue = aligned_alloc(BoundedQueueCacheLineSize, sizeof(struct BoundedQueue));
+    if (NULL != newQueue)
+    {
+        newQueue->capacity = roundedCapacity;
+        newQueue->mask = roundedCapacity - 1;
+        newQueue->elementSize = elementSize;
+        // keep the sequence numbers aligned
+        newQueue->cellSize = (uint32_t) ((sizeof(_Atomic size_t) + elementSize + sizeof(size_t) - 1) / sizeof(size_t) * sizeof(size_t));
+        newQueue->cells = malloc((size_t) newQueue->cellSize * roundedCapacity);
+        if (NULL == newQueue->cells)
+        {
+            free(newQueue);
+            return NULL;
+        }
+        for (size_t position = 0; position < roundedCapacity; position++)
+        {
+            atomic_init(BoundedQueueGetSequence(newQueue, position), position);
+        }
+        atomic_init(&newQueue->enqueuePosition, 0);
+        atomic_init(&newQueue->dequeuePosition, 0);
+    }
+    return newQueue;
+}
+
+void BoundedQueueRelease(BoundedQueueRef queue)
+{
+    if (NULL == queue) { return; }
+    free(queue->cells);
+    free(queue);
+}
+
+bool BoundedQueueTryPush(BoundedQueueRef queue, const void * element)
+{
+    assert(NULL != queue);
+
+    size_t position = atomic_load_explicit(&queue->enqueuePosition, memory_order_relaxed);
+    while (true)
+    {
+        _Atomic size_t * sequence = BoundedQueueGetSequence(queue, position);
+        size_t cellSequence = atomic_load_explicit(sequence, memory_order_acquire);
+        intptr_t difference = (intptr_t) cellSequence - (intptr_t) position;
+        if (0 == difference)
+        {
+            // the cell is free: claim it, unless another producer did first
+            if (atomic_compare_exchange_weak_explicit(&queue->enqueuePosition, &position, position + 1,
+                                                      memory_order_relaxed, memory_order_relaxed))
+            {
+                memcpy(BoundedQueueGetElement(queue, position), element, queue->elementSize);
+                atomic_store_explicit(sequence, position + 1, memory_order_release);
+                return true;
+            }
+        }
+        else if (difference < 0)
+        {
+            // the cell still holds an element of the previous lap: full
+            return false;
+        }
+        else
+        {
+            position = atomic_load_explicit(&queue->enqueuePosition, memory_order_relaxed);
+        }
+    }
+}
+
+bool BoundedQueueTryPop(BoundedQueueRef queue, void * element)
+{
+    assert(NULL != queue);
+
+    size_t position = atomic_load_explicit(&queue->dequeuePosition, memory_order_relaxed);
+    while (true)
+    {
+        _Atomic size_t * sequence = BoundedQueueGetSequence(queue, position);
+        size_t cellSequence = atomic_load_explicit(sequence, memory_order_acquire);
+        intptr_t difference = (intptr_t) cellSequence - (intptr_t) (position + 1);
+        if (0 == difference)
+        {
+            if (atomic_compare_exchange_weak_explicit(&queue->dequeuePosition, &position, position + 1,
+                                                      memory_order_relaxed, memory_order_relaxed))
+            {
+                memcpy(element, BoundedQueueGetElement(queue, position), queue->elementSize);
+                atomic_store_explicit(sequence, position + queue->capacity, memory_order_release);
+                return true;
+            }
+        }
+        else if (difference < 0)
+        {
+            // the cell was not filled yet: empty
+            return false;
+        }
+        else
+        {
+            position = atomic_load_explicit(&queue->dequeuePosition, memory_order_relaxed);
+        }
+    }
+}
+
+uint32_t BoundedQueueGetCapacity(BoundedQueueRef queue)
+{
+    assert(NULL != queue);
+    return queue->capacity;
+}
+
+uint32_t BoundedQueueGetCount(BoundedQueueRef queue)
+{
+    assert(NULL != queue);
+    size_t enqueuePosition = atomic_load_explicit(&queue->enqueuePosition, memory_order_relaxed);
+    size_t dequeuePosition = atomic_load_explicit(&queue->dequeuePosition, memory_order_relaxed);
+    if (enqueuePosition <= dequeuePosition) { return 0; }
+    size_t count = enqueuePosition - dequeuePosition;
+    return (uint32_t) (count > queue->capacity ? queue->capacity : count);
+}
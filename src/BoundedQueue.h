@@ -0,0 +1,53 @@
+#ifndef BoundedQueue_h
+#define BoundedQueue_h
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+
+/*
+A BoundedQueue is a fixed-capacity first-in first-out queue of fixed-size
+elements, that any number of threads can push to and pop from at the same
+time without locks (a bounded multi-producer multi-consumer queue after Dmitry
+Vyukov). Pushing and popping never block and never allocate: when the queue is
+full, BoundedQueueTryPush() fails right away, when it is empty,
+BoundedQueueTryPop() does. This makes it safe to push from a thread that must
+not be held up, such as the PIGPIO callback thread.
+Elements are copied in and out with memcpy().
+*/
+
+typedef struct BoundedQueue *BoundedQueueRef;
+
+/*
+Creates a new queue for `capacity` elements of `elementSize` bytes, or NULL if
+a queue could not be created. `capacity` is rounded up to a power of two (at
+least 2). You are responsible for releasing this object using
+BoundedQueueRelease().
+*/
+BoundedQueueRef BoundedQueueCreate(uint32_t capacity, uint32_t elementSize);
+
+/*
+Releases a BoundedQueueRef. This function is safe to call when `queue` is
+NULL. No thread may use the queue anymore.
+*/
+void BoundedQueueRelease(BoundedQueueRef queue);
+
+/*
+Copies `element` into the queue. Returns false if the queue was full.
+*/
+bool BoundedQueueTryPush(BoundedQueueRef queue, const void * element);
+
+/*
+Copies the oldest element into `element`, and removes it from the queue.
+Returns false if the queue was empty.
+*/
+bool BoundedQueueTryPop(BoundedQueueRef queue, void * element);
+
+/*
+The capacity of the queue, and an estimate of the number of elements in it:
+other threads may push and pop while this is computed.
+*/
+uint32_t BoundedQueueGetCapacity(BoundedQueueRef queue);
+uint32_t BoundedQueueGetCount(BoundedQueueRef queue);
+
+#endif
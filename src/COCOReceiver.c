@@ -6,6 +6,7 @@
 #include <assert.h>
 #include "COCOReceiver.h"
 #include "PulseRecorder.h"
+#include "Tracepoints.h"
 
 #if COCODebugLogging
     #define DebugLog(format, ...) printf(format, ## __VA_ARGS__)
@@ -34,6 +35,12 @@ element  || start-sync | 26-bit address | 1-bit group | 1-bit on/off | 4-bit cha
 ‾‾‾‾‾‾‾‾‾||‾‾‾‾‾‾‾‾‾‾‾‾|‾‾‾‾‾‾‾‾‾‾‾‾‾‾‾‾|‾‾‾‾‾‾‾‾‾‾‾‾‾|‾‾‾‾‾‾‾‾‾‾‾‾‾‾|‾‾‾‾‾‾‾‾‾‾‾‾‾‾‾|‾‾‾‾‾‾‾‾‾‾‾||‾‾‾‾‾‾‾‾
 periods  ||       2    |       104      |     4       |       4      |       16      |    2      ||  132
 
+Dim messages have the dim pattern in place of the on/off bit, and a 4-bit dim
+level after the channel:
+element  || start-sync | 26-bit address | 1-bit group |   dim        | 4-bit channel | 4-bit dim level | stop-sync || TOTAL
+‾‾‾‾‾‾‾‾‾||‾‾‾‾‾‾‾‾‾‾‾‾|‾‾‾‾‾‾‾‾‾‾‾‾‾‾‾‾|‾‾‾‾‾‾‾‾‾‾‾‾‾|‾‾‾‾‾‾‾‾‾‾‾‾‾‾|‾‾‾‾‾‾‾‾‾‾‾‾‾‾‾|‾‾‾‾‾‾‾‾‾‾‾‾‾‾‾‾‾|‾‾‾‾‾‾‾‾‾‾‾||‾‾‾‾‾‾‾‾
+periods  ||       2    |       104      |     4       |       4      |       16      |        16       |    2      ||  148
+
 t = 260µs LOW
 T = 260µs HIGH
 
@@ -60,6 +67,12 @@ T     4t     T  t
 ‾‾|        |‾‾|
   |        |  |
   |________|  |__
+
+> dim
+T   t  T  t
+‾‾|  |‾‾|
+  |  |  |
+  |__|  |__
 */
 
 
@@ -67,6 +80,12 @@ T     4t     T  t
 // first T of the start-sync
 const uint32_t COCOMessagePulseCount = 131;
 
+// the same for a dim message, of 36 bits
+const uint32_t COCOMessageDimPulseCount = 147;
+
+// the bit of a dim message that has the dim pattern, in place of on/off
+const uint32_t COCODimBitIndex = 27;
+
 // the number of high or low pulses that encode a zero or a one
 const uint32_t COCOPulsesPerBit = 4;
 
@@ -82,6 +101,15 @@ const uint32_t COCOStartSyncLowPulsesCount = 10;
 // the length of a long end sync pulse, expressed in number of singlepulseDuration
 const uint32_t COCOEndSyncLowPulsesCount = 40;
 
+// whether a pulse was high (carrier) or low (no carrier). Durations fed 
+// without a level are `unknown`, and are never checked.
+typedef enum COCOPulseLevel
+{
+    COCOPulseLevelUnknown = -1,
+    COCOPulseLevelLow = 0,
+    COCOPulseLevelHigh = 1
+} COCOPulseLevel;
+
 struct COCOReceiver
 {
     // publicly queryable properties
@@ -91,11 +119,12 @@ struct COCOReceiver
     uint32_t positiveTolerance; // percentage, e.g. 40 means 40%
     uint32_t negativeTolerance; // percentage, e.g. 40 means 40%
     uint32_t singlePulseDuration; // µicro seconds
-
+    bool inverted;
 
     // for internal use
     //
     COCOMessageDetected callback;
+    void * context;
     uint32_t repeats;
     uint32_t lastTimestamp;
     uint32_t *durations;
@@ -105,6 +134,7 @@ struct COCOReceiver
     uint32_t groupMask;
     uint32_t addressMask;
     uint32_t previousMessageCode;
+    int8_t previousDimLevel;
     uint32_t startTime;
     uint32_t timestampPreviousHit;
 
@@ -115,12 +145,22 @@ struct COCOReceiver
     uint32_t endSyncLowMinDuration;
     uint32_t endSyncLowMaxDuration;
 
+    // only used when levels are fed: the level after the last edge (-1 before
+    // the first edge), and whether the stored durations started with a 
+    // start-sync and all had the level expected at their index
+    int32_t lastLevel;
+    bool synchronised;
+    _Atomic uint32_t polarityErrorCount;
+
+    struct ReceiverCounters counters;
+
     PulseRecorderRef pulseRecorder;
 };
 
 struct COCOMessage
 {
     uint32_t timestamp; // timestamp of the end of the long part of the start-sync 
+    uint32_t endTimestamp; // timestamp of the end of the end-sync
 
     // all 32 bits encoding the message (i.e. address, group, onOff and channel)
     uint32_t fullMessageCode;
@@ -130,6 +170,9 @@ struct COCOMessage
     bool group;
     bool onOff;
     uint16_t channel;
+    int8_t dimLevel; // or COCOMessageNoDimLevel
+
+    uint8_t quality; // 0 - 100
 };
 
 uint32_t COCOMessageGetAddress(COCOMessageRef message)
@@ -144,6 +187,33 @@ bool COCOMessageGetOnOff(COCOMessageRef message)
 uint16_t COCOMessageGetChannel(COCOMessageRef message)
 { assert(NULL != message); return message->channel; }
 
+int8_t COCOMessageGetDimLevel(COCOMessageRef message)
+{ assert(NULL != message); return message->dimLevel; }
+
+uint8_t COCOMessageGetQuality(COCOMessageRef message)
+{ assert(NULL != message); return message->quality; }
+
+uint32_t COCOMessageGetStartTimestamp(COCOMessageRef message)
+{ assert(NULL != message); return message->timestamp; }
+
+uint32_t COCOMessageGetEndTimestamp(COCOMessageRef message)
+{ assert(NULL != message); return message->endTimestamp; }
+
+uint32_t COCOMessageGetCode(COCOMessageRef message)
+{
+    assert(NULL != message);
+
+    // 26-bit address | 1-bit group | 1-bit on/off | 4-bit channel
+    uint32_t code = message->address;
+    code <<= 1;
+    code |= message->group ? 1 : 0;
+    code <<= 1;
+    code |= message->onOff ? 1 : 0;
+    code <<= 4;
+    code |= message->channel & 0b00001111;
+    return code;
+}
+
 
 
 void printBinary(uint32_t value, int size)
@@ -173,14 +243,42 @@ void binaryRepresentation(uint32_t value, int size, char *buffer)
     buffer[size] = '\0';
 }
 
+// the deviation of `duration` from `nominalDuration`, in percent
+uint32_t COCOPulseDeviation(uint32_t duration, uint32_t nominalDuration)
+{
+    uint32_t difference = duration > nominalDuration ? duration - nominalDuration : nominalDuration - duration;
+    return difference * 100 / nominalDuration;
+}
+
+// counts and traces a frame that was rejected
+void COCOReceiverReject(COCOReceiverRef receiver, ReceiverRejectReason reason, uint32_t bitIndex)
+{
+    ReceiverCountersCountReject(&receiver->counters, reason, bitIndex);
+    LPD433Trace3(coco_frame_reject, receiver, reason, bitIndex);
+}
+
+// the bit that the duration at `durationsIndex` is part of; index 0 is the
+// start-sync
+uint32_t COCOBitIndex(uint32_t durationsIndex)
+{
+    return (0 == durationsIndex) ? 0 : (durationsIndex - 1) / COCOPulsesPerBit;
+}
+
 bool analyzeDurations(COCOReceiverRef receiver, uint32_t timestamp, struct COCOMessage * message)
 {
     assert(NULL != receiver);
 
     // this can only be a valid COCO message if there are 
-    // COCOMessagePulseCount pulses
-    if (receiver->durationsIndex < COCOMessagePulseCount - 1)
-    { return false; }
+    // COCOMessagePulseCount pulses, or COCOMessageDimPulseCount for a dim
+    // message: both are decoded from the same durations
+    uint32_t endSyncIndex = receiver->durationsIndex;
+    if (endSyncIndex != COCOMessagePulseCount - 1 && endSyncIndex != COCOMessageDimPulseCount - 1)
+    {
+        COCOReceiverReject(receiver, ReceiverRejectReasonPulseCount, COCOBitIndex(receiver->durationsIndex));
+        return false;
+    }
+    bool isDimMessage = (COCOMessageDimPulseCount - 1 == endSyncIndex);
+    ReceiverCountersIncrement(receiver->counters.frameCount);
 
     uint32_t singlePulseDuration = (receiver->durations[0] + receiver->durations[receiver->durationsIndex]) / 
                         (COCOStartSyncLowPulsesCount + COCOEndSyncLowPulsesCount);
@@ -188,10 +286,14 @@ bool analyzeDurations(COCOReceiverRef receiver, uint32_t timestamp, struct COCOM
     uint32_t minDuration = 0xffffffff;
     uint32_t maxDuration = 0;
 
-    uint32_t code = 0;
+    uint32_t code = 0; // the first 32 bits
+    uint32_t dimLevel = 0;
     uint32_t codeLength = 0;
     uint32_t bitValues[COCOPulsesPerBit];
     uint32_t bitIndex = 0;
+
+    // sum of the deviations from the nominal pulse durations, in percent
+    uint32_t deviation = 0;
     for (uint32_t index = 0; index <= receiver->durationsIndex; index++)
     {
         // first duration that is stored is always the start sync
@@ -203,7 +305,7 @@ bool analyzeDurations(COCOReceiverRef receiver, uint32_t timestamp, struct COCOM
 
         // this index marks the end, as does the value, so this is actuall
         // redundant. This could be done with either the index or the value
-        if (index == (COCOMessagePulseCount - 1) &&
+        if (index == endSyncIndex &&
             receiver->durations[index] > receiver->endSyncLowMinDuration &&
             receiver->durations[index] < receiver->endSyncLowMaxDuration)
         {
@@ -229,15 +331,41 @@ bool analyzeDurations(COCOReceiverRef receiver, uint32_t timestamp, struct COCOM
                 bitValues[2],
                 bitValues[3]);
 
-            if (bitValues[0] < receiver->singlePulseMaxDuration && bitValues[0] > receiver->singlePulseMinDuration &&
+            uint32_t bit;
+            if (isDimMessage && COCODimBitIndex == codeLength)
+            {
+                if (bitValues[0] < receiver->singlePulseMaxDuration && bitValues[0] > receiver->singlePulseMinDuration &&
+                    bitValues[1] < receiver->singlePulseMaxDuration && bitValues[1] > receiver->singlePulseMinDuration &&
+                    bitValues[2] < receiver->singlePulseMaxDuration && bitValues[2] > receiver->singlePulseMinDuration &&
+                    bitValues[3] < receiver->singlePulseMaxDuration && bitValues[3] > receiver->singlePulseMinDuration
+                    )
+                {
+                    // dim: the on/off bit is 0
+                    bit = 0;
+                    deviation += COCOPulseDeviation(bitValues[0], receiver->singlePulseDuration) +
+                                 COCOPulseDeviation(bitValues[1], receiver->singlePulseDuration) +
+                                 COCOPulseDeviation(bitValues[2], receiver->singlePulseDuration) +
+                                 COCOPulseDeviation(bitValues[3], receiver->singlePulseDuration);
+                }
+                else
+                {
+                    DebugLog("\nNot the dim pattern.\n");
+                    COCOReceiverReject(receiver, ReceiverRejectReasonBitEncoding, (index / COCOPulsesPerBit) - 1);
+                    return false;
+                }
+            }
+            else if (bitValues[0] < receiver->singlePulseMaxDuration && bitValues[0] > receiver->singlePulseMinDuration &&
                 bitValues[1] < receiver->singlePulseMaxDuration && bitValues[1] > receiver->singlePulseMinDuration &&
                 bitValues[2] < receiver->singlePulseMaxDuration && bitValues[2] > receiver->singlePulseMinDuration &&
                 bitValues[3] < (COCOPulsesLong * receiver->singlePulseMaxDuration) && (bitValues[3] >  COCOPulsesLong * receiver->singlePulseMinDuration)
                 )
             {
                 // '0'
-                code <<= 1;
-                codeLength += 1;
+                bit = 0;
+                deviation += COCOPulseDeviation(bitValues[0], receiver->singlePulseDuration) +
+                             COCOPulseDeviation(bitValues[1], receiver->singlePulseDuration) +
+                             COCOPulseDeviation(bitValues[2], receiver->singlePulseDuration) +
+                             COCOPulseDeviation(bitValues[3], COCOPulsesLong * receiver->singlePulseDuration);
             }
             else if (bitValues[0] < receiver->singlePulseMaxDuration && bitValues[0] > receiver->singlePulseMinDuration &&
                      bitValues[1] < (COCOPulsesLong * receiver->singlePulseMaxDuration) && (bitValues[1] >  COCOPulsesLong * receiver->singlePulseMinDuration) &&
@@ -246,18 +374,25 @@ bool analyzeDurations(COCOReceiverRef receiver, uint32_t timestamp, struct COCOM
                      )
             {
                 // '1'
-                code <<= 1;
-                code |= 1;
-
-                codeLength += 1;
+                bit = 1;
+                deviation += COCOPulseDeviation(bitValues[0], receiver->singlePulseDuration) +
+                             COCOPulseDeviation(bitValues[1], COCOPulsesLong * receiver->singlePulseDuration) +
+                             COCOPulseDeviation(bitValues[2], receiver->singlePulseDuration) +
+                             COCOPulseDeviation(bitValues[3], receiver->singlePulseDuration);
             }
             else
             {
                 DebugLog("\nNot a valid bit-encoding.\n");
+                COCOReceiverReject(receiver, ReceiverRejectReasonBitEncoding, (index / COCOPulsesPerBit) - 1);
                 return false;
             }
 
-            DebugLog("\t%5llu\n", code & 1);
+            // the bits after the channel are the dim level
+            if (codeLength < 32) { code = (code << 1) | bit; }
+            else { dimLevel = (dimLevel << 1) | bit; }
+            codeLength += 1;
+
+            DebugLog("\t%5lu\n", bit);
         }
     }
 
@@ -270,8 +405,9 @@ bool analyzeDurations(COCOReceiverRef receiver, uint32_t timestamp, struct COCOM
 
     if (NULL != receiver->pulseRecorder)
     {   
-    	char * binary = malloc(sizeof(char) * (codeLength + 1)); // + 1 for terminating NULL
-    	binaryRepresentation(code, codeLength, binary);
+    	uint32_t codeBitCount = (codeLength > 32) ? 32 : codeLength;
+    	char * binary = malloc(sizeof(char) * (codeBitCount + 1)); // + 1 for terminating NULL
+    	binaryRepresentation(code, codeBitCount, binary);
         char* description;
         int bytesPrinted = asprintf(&description, "\ncode: %s\nlength: %lu\nestimated pulse T: %lu\nmin pulse T: %lu\nmax pulse T: %lu\n", binary, codeLength, singlePulseDuration, minDuration, maxDuration);
         free(binary);
@@ -287,11 +423,16 @@ bool analyzeDurations(COCOReceiverRef receiver, uint32_t timestamp, struct COCOM
     if (NULL != message)
     {
         message->timestamp = timestamp;
+        message->endTimestamp = timestamp;
         message->fullMessageCode = code;
         message->address = (code & receiver->addressMask) >> 6;
         message->group = (code & receiver->groupMask) == receiver->groupMask;
         message->onOff = (code & receiver->onOffMask) == receiver->onOffMask;
         message->channel = (uint16_t) (code & receiver->channelMask);
+        message->dimLevel = isDimMessage ? (int8_t) dimLevel : COCOMessageNoDimLevel;
+
+        uint32_t averageDeviation = (0 == codeLength) ? 100 : deviation / (codeLength * COCOPulsesPerBit);
+        message->quality = (uint8_t) (averageDeviation >= 100 ? 0 : 100 - averageDeviation);
     }
 
     return true;
@@ -326,25 +467,74 @@ COCOMessageRef COCOMessageCreate()
         message->group = false;  
         message->onOff = false;
         message->channel = 0;
+        message->dimLevel = COCOMessageNoDimLevel;
+        message->quality = 100;
+        message->timestamp = 0;
+        message->endTimestamp = 0;
     }
     return message;
 }
 
-// Actual 'meat' of a COCOReceiver
-void COCOReceiverFeedGPIOValueChangeTime(COCOReceiverRef receiver, uint32_t timestamp)
+COCOMessageRef COCOMessageCreateWithCode(uint32_t code, uint8_t quality, uint32_t startTimestamp, uint32_t endTimestamp)
+{
+    COCOMessageRef message = COCOMessageCreate();
+    if (NULL != message)
+    {
+        // 26-bit address | 1-bit group | 1-bit on/off | 4-bit channel
+        message->fullMessageCode = code;
+        message->address = code >> 6;
+        message->group = (code >> 5) & 1;
+        message->onOff = (code >> 4) & 1;
+        message->channel = (uint16_t) (code & 0b00001111);
+        message->quality = quality;
+        message->timestamp = startTimestamp;
+        message->endTimestamp = endTimestamp;
+    }
+    return message;
+}
+
+// Actual 'meat' of a COCOReceiver: the pulse that ended at `timestamp`
+void COCOReceiverFeedPulse(COCOReceiverRef receiver, uint32_t timestamp, COCOPulseLevel level)
 {
     assert(NULL != receiver);
 
     uint32_t duration = timestamp - receiver->lastTimestamp;
-    
-    if (duration > receiver->startSyncLowMinDuration && duration < receiver->startSyncLowMaxDuration)
+    receiver->lastTimestamp = timestamp;
+
+    // both syncs are low: a high pulse of the same length is not one
+    bool maybeLow = (COCOPulseLevelHigh != level);
+    if (maybeLow && duration > receiver->startSyncLowMinDuration && duration < receiver->startSyncLowMaxDuration)
     {
         // start-sync received, start a new sequence
         receiver->startTime = timestamp;
         receiver->durationsIndex = 0;
+        receiver->synchronised = true;
+        ReceiverCountersIncrement(receiver->counters.startSyncCount);
+        LPD433Trace3(coco_start_sync, receiver, timestamp, duration);
+    }
+
+    if (COCOPulseLevelUnknown != level)
+    {
+        // the start-sync is at index 0, after which high and low pulses 
+        // alternate. A pulse of the wrong level means an edge was missed (or 
+        // noise added one): the rest of this message can not line up anymore,
+        // so stop collecting until the next start-sync.
+        COCOPulseLevel expectedLevel = (0 == receiver->durationsIndex % 2) ? COCOPulseLevelLow : COCOPulseLevelHigh;
+        if (receiver->synchronised && level != expectedLevel)
+        {
+            receiver->synchronised = false;
+            ReceiverCountersIncrement(receiver->polarityErrorCount);
+            COCOReceiverReject(receiver, ReceiverRejectReasonPolarity, COCOBitIndex(receiver->durationsIndex));
+        }
+        if (!receiver->synchronised)
+        {
+            receiver->durationsIndex = 0;
+            return;
+        }
     }
 
-    if (duration > receiver->endSyncLowMinDuration &&
+    if (maybeLow && 
+        duration > receiver->endSyncLowMinDuration &&
         duration < receiver->endSyncLowMaxDuration)
     {
         // initialize an empty COCOMessage struct, and hae the analyzeDurations()
@@ -357,14 +547,22 @@ void COCOReceiverFeedGPIOValueChangeTime(COCOReceiverRef receiver, uint32_t time
         bool messageCallback = false;
 
         // end-sync received, analyze what was received
+        ReceiverCountersIncrement(receiver->counters.endSyncCount);
         receiver->durations[receiver->durationsIndex] = duration;
         if (analyzeDurations(receiver, receiver->startTime, message))
         {
+            message->endTimestamp = timestamp;
+            ReceiverCountersIncrement(receiver->counters.acceptedCount);
+            LPD433Trace3(coco_frame_accept, receiver, message->fullMessageCode, message->quality);
+
             // if this message was the same one as before,
             // repeats goes +1
-            if (message->fullMessageCode == receiver->previousMessageCode)
+            if (message->fullMessageCode == receiver->previousMessageCode &&
+                message->dimLevel == receiver->previousDimLevel)
             {
                 receiver->repeats += 1;
+                ReceiverCountersIncrement(receiver->counters.repeatCount);
+                LPD433Trace3(coco_repeat, receiver, message->fullMessageCode, receiver->repeats);
 
                 // COCO senders send their message several times
                 // if a certain number of repeats is detected, count this as
@@ -392,20 +590,34 @@ void COCOReceiverFeedGPIOValueChangeTime(COCOReceiverRef receiver, uint32_t time
                         if (NULL != receiver->callback)
                         {
                             messageCallback = true;
+                            ReceiverCountersIncrement(receiver->counters.callbackCount);
+                            // the callback owns the message, it may be gone after the call
+                            uint32_t code = message->fullMessageCode;
+                            LPD433Trace2(coco_callback_entry, receiver, code);
                             receiver->callback(receiver, message);
+                            LPD433Trace2(coco_callback_exit, receiver, code);
                         }
                     }
+                    else
+                    {
+                        ReceiverCountersIncrement(receiver->counters.suppressedCount);
+                        LPD433Trace3(coco_refractory, receiver, message->fullMessageCode, message->timestamp - receiver->timestampPreviousHit);
+                    }
                 }
             }
             else 
             {
+                // a repeat already matches the previous message, and after a
+                // hit `message` belongs to the callback
                 receiver->repeats = 0;
+                receiver->previousMessageCode = message->fullMessageCode;
+                receiver->previousDimLevel = message->dimLevel;
             }
-            receiver->previousMessageCode = message->fullMessageCode;
         }
         else 
         {
             receiver->previousMessageCode = 0;
+            receiver->previousDimLevel = COCOMessageNoDimLevel;
         }
 
         // callback was not called, free the message ourselves
@@ -415,12 +627,55 @@ void COCOReceiverFeedGPIOValueChangeTime(COCOReceiverRef receiver, uint32_t time
     receiver->durations[receiver->durationsIndex] = duration;
     receiver->durationsIndex += 1;
 
-    // COCO protocol only has 132 durations, and this program does not
-    // store the first T of the sync bit, so only 131 needed
-    if (receiver->durationsIndex == COCOMessagePulseCount)
-    { receiver->durationsIndex = 0; }
-    
-    receiver->lastTimestamp = timestamp;
+    // COCO protocol only has 132 durations (148 for a dim message), and this
+    // program does not store the first T of the sync bit, so only 131 (147)
+    // needed
+    if (receiver->durationsIndex == COCOMessageDimPulseCount)
+    {
+        receiver->durationsIndex = 0;
+        // with levels, only a start-sync starts the next message
+        receiver->synchronised = false;
+    }
+}
+
+void COCOReceiverFeedGPIOValueChangeTime(COCOReceiverRef receiver, uint32_t timestamp)
+{
+    assert(NULL != receiver);
+    ReceiverCountersIncrement(receiver->counters.edgeCount);
+    COCOReceiverFeedPulse(receiver, timestamp, COCOPulseLevelUnknown);
+}
+
+void COCOReceiverFeedGPIOLevelChange(COCOReceiverRef receiver, uint32_t timestamp, uint32_t level)
+{
+    assert(NULL != receiver);
+    ReceiverCountersIncrement(receiver->counters.edgeCount);
+
+    int32_t newLevel = ((0 != level) != receiver->inverted) ? 1 : 0;
+    if (newLevel == receiver->lastLevel)
+    {
+        // no change: an edge in between was missed, so the level (and 
+        // length) of the pulse that ended is unknown
+        receiver->lastTimestamp = timestamp;
+        if (receiver->synchronised)
+        {
+            ReceiverCountersIncrement(receiver->polarityErrorCount);
+            COCOReceiverReject(receiver, ReceiverRejectReasonPolarity, COCOBitIndex(receiver->durationsIndex));
+        }
+        receiver->synchronised = false;
+        receiver->durationsIndex = 0;
+        return;
+    }
+    // the pulse that ended had the other level; before the first edge it is
+    // unknown
+    COCOPulseLevel pulseLevel = (receiver->lastLevel < 0) ? COCOPulseLevelUnknown : 
+                                (1 == receiver->lastLevel) ? COCOPulseLevelHigh : COCOPulseLevelLow;
+    receiver->lastLevel = newLevel;
+    if (COCOPulseLevelUnknown == pulseLevel)
+    {
+        receiver->lastTimestamp = timestamp;
+        return;
+    }
+    COCOReceiverFeedPulse(receiver, timestamp, pulseLevel);
 }
 
 void updateDurationsForReceiver(COCOReceiverRef receiver)
@@ -444,7 +699,7 @@ COCOReceiverRef COCOReceiverCreate()
     {
         // set defaults
         // newReceiver->durations is freed in COCOReceiverRelease()
-        newReceiver->durations = malloc(sizeof(uint32_t) * COCOMessagePulseCount);
+        newReceiver->durations = malloc(sizeof(uint32_t) * COCOMessageDimPulseCount);
         newReceiver->repeatCount = 1;
         newReceiver->refractoryPeriod = 0;
 
@@ -454,9 +709,14 @@ COCOReceiverRef COCOReceiverCreate()
 
         updateDurationsForReceiver(newReceiver);
 
+        newReceiver->inverted = false;
         newReceiver->repeats = 0;
         newReceiver->lastTimestamp = 0;
         newReceiver->durationsIndex = 0;
+        newReceiver->lastLevel = -1;
+        newReceiver->synchronised = false;
+        atomic_init(&newReceiver->polarityErrorCount, 0);
+        ReceiverCountersReset(&newReceiver->counters);
 
         // 26-bit address | 1-bit group | 1-bit on/off | 4-bit channel
         newReceiver->channelMask = 0b00001111;
@@ -465,15 +725,37 @@ COCOReceiverRef COCOReceiverCreate()
         newReceiver->addressMask = 0b11111111111111111111111111000000;
 
         newReceiver->previousMessageCode = 0;
+        newReceiver->previousDimLevel = COCOMessageNoDimLevel;
         newReceiver->startTime = 0;
         newReceiver->timestampPreviousHit = 0;
 
         newReceiver->pulseRecorder = NULL;
+        newReceiver->callback = NULL;
+        newReceiver->context = NULL;
     }
     return newReceiver;
 }
 
 
+void COCOReceiverFeedTimeout(COCOReceiverRef receiver, uint32_t timestamp)
+{
+    assert(NULL != receiver);
+
+    // only a message of which everything but the end-sync was received can
+    // be finalised, once the silence is at least as long as an end-sync
+    uint32_t silence = timestamp - receiver->lastTimestamp;
+    uint32_t endSyncDuration = COCOEndSyncLowPulsesCount * receiver->singlePulseDuration;
+    if (silence < endSyncDuration ||
+        (receiver->durationsIndex != COCOMessagePulseCount - 1 && receiver->durationsIndex != COCOMessageDimPulseCount - 1))
+    { return; }
+
+    // the end-sync started at the last edge: end it at its nominal length, as
+    // if the edge was there. The real next edge is then measured from here.
+    // The level does not change, it is still low.
+    COCOReceiverFeedPulse(receiver, receiver->lastTimestamp + endSyncDuration, 
+                          (receiver->lastLevel < 0) ? COCOPulseLevelUnknown : COCOPulseLevelLow);
+}
+
 void COCOMessageRelease(COCOMessageRef message)
 {
     if (NULL != message) { free(message); }
@@ -501,6 +783,16 @@ void COCOReceiverSetCallback(COCOReceiverRef receiver, COCOMessageDetected callb
     assert(NULL != receiver);
     receiver->callback = callback;
 }
+void COCOReceiverSetContext(COCOReceiverRef receiver, void * context)
+{
+    assert(NULL != receiver);
+    receiver->context = context;
+}
+void * COCOReceiverGetContext(COCOReceiverRef receiver)
+{
+    assert(NULL != receiver);
+    return receiver->context;
+}
 void COCOReceiverSetRepeatCount(COCOReceiverRef receiver, uint32_t repeatCount)
 {
     assert(NULL != receiver);
@@ -516,7 +808,7 @@ void COCOReceiverSetPositiveTolerance(COCOReceiverRef receiver, uint32_t toleran
     assert(NULL != receiver);
     assert(tolerance > 0 && tolerance <= 100);
 
-    uint32_t newValue = newValue > 100 ? 100 : newValue;
+    uint32_t newValue = tolerance > 100 ? 100 : tolerance;
     receiver->positiveTolerance = newValue;
     updateDurationsForReceiver(receiver);
 }
@@ -525,7 +817,7 @@ void COCOReceiverSetNegativeTolerance(COCOReceiverRef receiver, uint32_t toleran
     assert(NULL != receiver);
     assert(tolerance > 0 && tolerance <= 100);
 
-    uint32_t newValue = newValue > 100 ? 100 : newValue;
+    uint32_t newValue = tolerance > 100 ? 100 : tolerance;
     receiver->negativeTolerance = newValue;
     updateDurationsForReceiver(receiver);
 }
@@ -556,6 +848,32 @@ uint32_t COCOReceiverGetNegativeTolerance(COCOReceiverRef receiver)
     assert(NULL != receiver);
     return receiver->negativeTolerance;
 }
+void COCOReceiverSetInverted(COCOReceiverRef receiver, bool inverted)
+{
+    assert(NULL != receiver);
+    receiver->inverted = inverted;
+    receiver->lastLevel = -1;
+    receiver->synchronised = false;
+}
+
+bool COCOReceiverGetInverted(COCOReceiverRef receiver)
+{
+    assert(NULL != receiver);
+    return receiver->inverted;
+}
+
+uint32_t COCOReceiverGetPolarityErrorCount(COCOReceiverRef receiver)
+{
+    assert(NULL != receiver);
+    return atomic_load_explicit(&receiver->polarityErrorCount, memory_order_relaxed);
+}
+
+void COCOReceiverGetStatistics(COCOReceiverRef receiver, ReceiverStatistics * statistics)
+{
+    assert(NULL != receiver);
+    ReceiverCountersGetStatistics(&receiver->counters, statistics);
+}
+
 uint32_t COCOReceiverGetSinglePulseDuration(COCOReceiverRef receiver)
 {
     assert(NULL != receiver);
@@ -584,6 +902,12 @@ void COCOMessageSetChannel(COCOMessageRef message, uint16_t channel)
     assert(NULL != message);
     message->channel = channel;
 }
+void COCOMessageSetDimLevel(COCOMessageRef message, int8_t dimLevel)
+{
+    assert(NULL != message);
+    assert(COCOMessageNoDimLevel == dimLevel || (dimLevel >= 0 && dimLevel <= 15));
+    message->dimLevel = dimLevel;
+}
 
 
 
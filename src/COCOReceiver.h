@@ -1,6 +1,7 @@
 #include <stdlib.h>
 #include <inttypes.h>
 #include <stdbool.h>
+#include "ReceiverStatistics.h"
 
 // set this to non-zero to enable extensive printout of received signals
 #define COCODebugLogging 0
@@ -19,6 +20,40 @@ bool COCOMessageGetGroup(COCOMessageRef message);
 bool COCOMessageGetOnOff(COCOMessageRef message);
 uint16_t COCOMessageGetChannel(COCOMessageRef message);
 
+/*
+Returns the 32 bits as they are sent over the air: 26-bit address | 1-bit group |
+1-bit on/off | 4-bit channel. Two messages with the same code (and dim level)
+are the same message. The on/off bit of a dim message is 0.
+*/
+uint32_t COCOMessageGetCode(COCOMessageRef message);
+
+// the dim level of a message that switches on or off
+#define COCOMessageNoDimLevel -1
+
+/*
+Dimmers also receive (and remotes of dimmers send) 36-bit messages that set a
+dim level: they have a third pattern in place of the on/off bit, and 4 bits of
+dim level after the channel. Returns the dim level (0 - 15) of such a message,
+or COCOMessageNoDimLevel. COCOMessageGetOnOff() is false for a dim message.
+*/
+int8_t COCOMessageGetDimLevel(COCOMessageRef message);
+
+/*
+An estimate of how well the received pulses matched the protocol, from 0 (at 
+the edge of the tolerances) to 100 (perfect timing). Use this to pick the best
+of several copies of the same message, e.g. received through different receivers.
+*/
+uint8_t COCOMessageGetQuality(COCOMessageRef message);
+
+/*
+The timestamps (in the time base of the timestamps fed to the receiver) of the
+end of the start-sync, and of the end of the end-sync, i.e. of the first and
+the last edge of a received message. The time from the first edge to the
+moment the message is handled is how long it took to receive it.
+*/
+uint32_t COCOMessageGetStartTimestamp(COCOMessageRef message);
+uint32_t COCOMessageGetEndTimestamp(COCOMessageRef message);
+
 /*
 Releases a COCOMessageRef. The advantage of using this function over
 free(), is that this function is save when `receiver` is NULL.
@@ -46,6 +81,13 @@ If your callback is never called, try tweaking some of the parameters.
 */
 void COCOReceiverSetCallback(COCOReceiverRef receiver, COCOMessageDetected callback);
 
+/*
+Defaults to NULL. A pointer that is not used by the receiver, so that your
+callback can tell receivers apart (e.g. when listening on several GPIOs).
+*/
+void COCOReceiverSetContext(COCOReceiverRef receiver, void * context);
+void * COCOReceiverGetContext(COCOReceiverRef receiver);
+
 /*
 Every time the GPIO that you are monitoring changes state, call this function 
 the timestammp of that change. 
@@ -55,6 +97,30 @@ set with `gpioSetAlertFunc`.
 */
 void COCOReceiverFeedGPIOValueChangeTime(COCOReceiverRef receiver, uint32_t timestamp);
 
+/*
+Like COCOReceiverFeedGPIOValueChangeTime(), but with the `level` (0 or 1) of
+the GPIO after the change, as PIGPIO passes it to an alert function. Prefer
+this function when the level is known: the start- and end-sync are then only
+accepted when they are low, and every pulse of a message is checked to be high
+or low as the protocol requires. When an edge was missed (the level did not
+change, or a pulse has the wrong level), the message that is being received is
+dropped at once, and the receiver waits for the next start-sync, instead of
+collecting and analysing the misaligned pulses that follow.
+Do not mix this function and COCOReceiverFeedGPIOValueChangeTime() on one
+receiver.
+*/
+void COCOReceiverFeedGPIOLevelChange(COCOReceiverRef receiver, uint32_t timestamp, uint32_t level);
+
+/*
+Call this when the GPIO did not change state since the last call to 
+COCOReceiverFeedGPIOValueChangeTime() until `timestamp`, e.g. from the timeout
+of a PIGPIO ISR or watchdog. A message ends with a long low end-sync, which is
+otherwise only measured when the next edge arrives: if the silence is already
+as long as an end-sync, the message is analysed right away.
+Calling this function more than once during the same silence is harmless.
+*/
+void COCOReceiverFeedTimeout(COCOReceiverRef receiver, uint32_t timestamp);
+
 /*
 This value defaults to 1: any identical message coming in this number of repeated times
 will trigger COCOReceiver to call your callback/
@@ -120,6 +186,27 @@ Second and 4th value would need a positive tolerance to be considered valid.
 */
 void COCOReceiverSetNegativeTolerance(COCOReceiverRef receiver, uint32_t tolerance);
 
+/*
+Defaults to false. Set this to true for a receiver module whose output is low
+while it receives a carrier, and high otherwise. Only used by
+COCOReceiverFeedGPIOLevelChange().
+*/
+void COCOReceiverSetInverted(COCOReceiverRef receiver, bool inverted);
+bool COCOReceiverGetInverted(COCOReceiverRef receiver);
+
+/*
+The number of times COCOReceiverFeedGPIOLevelChange() dropped a message that
+was being received, because an edge was missed. Safe to call from any thread.
+*/
+uint32_t COCOReceiverGetPolarityErrorCount(COCOReceiverRef receiver);
+
+/*
+Copies the counters of what this receiver did with the edges it was fed (see
+ReceiverStatistics.h) into `statistics`. Safe to call from any thread, at any
+time.
+*/
+void COCOReceiverGetStatistics(COCOReceiverRef receiver, ReceiverStatistics * statistics);
+
 // Querying the reeiver.
 uint32_t COCOReceiverGetRepeatCount(COCOReceiverRef receiver);
 uint32_t COCOReceiverGetRefractoryPeriod(COCOReceiverRef receiver);
@@ -135,12 +222,22 @@ void COCOMessageSetGroup(COCOMessageRef message, bool group);
 void COCOMessageSetOnOff(COCOMessageRef message, bool onOff);
 void COCOMessageSetChannel(COCOMessageRef message, uint16_t channel);
 
+// 0 - 15, or COCOMessageNoDimLevel (the default) to send an on/off message
+void COCOMessageSetDimLevel(COCOMessageRef message, int8_t dimLevel);
+
 /*
 Creates a new COCOMessageRef, or NULL if a receiver could not be created. You are 
 responsible for releasing this object using COCOMessageRelease().
 */
 COCOMessageRef COCOMessageCreate();
 
+/*
+Creates a COCOMessageRef from the 32 bits of a message (see COCOMessageGetCode()),
+for messages that were decoded by something else than a COCOReceiver, e.g. a
+ProtocolEngine. You are responsible for releasing it using COCOMessageRelease().
+*/
+COCOMessageRef COCOMessageCreateWithCode(uint32_t code, uint8_t quality, uint32_t startTimestamp, uint32_t endTimestamp);
+
 
 
 void COCOReceiverSetRecordReceivedTransmissions(COCOReceiverRef receiver, bool shouldRecord);
\ No newline at end of file
@@ -0,0 +1,261 @@
+#include <stdio.h>
+#include <assert.h>
+#include "COCOScenePlanner.h"
+
+// the COCO protocol has 4 bits for the channel
+#define COCOScenePlannerChannelCount 16
+
+struct COCOSceneAddress
+{
+    uint32_t address;
+    uint16_t channelsInUse;  // bit n is channel n
+    uint16_t channelsInScene;
+    uint16_t channelsOn;     // subset of channelsInScene
+    uint16_t channelsDimmed; // subset of channelsInScene, not of channelsOn
+    int8_t dimLevels[COCOScenePlannerChannelCount];
+};
+
+struct COCOScenePlanner
+{
+    struct COCOSceneAddress *addresses;
+    uint32_t addressesCount;
+    uint32_t addressesCapacity;
+
+    COCOMessageRef *messages;
+    uint32_t messagesCount;
+    uint32_t messagesCapacity;
+};
+
+COCOScenePlannerRef COCOScenePlannerCreate()
+{
+    COCOScenePlannerRef newPlanner = malloc(sizeof(struct COCOScenePlanner));
+    if (NULL != newPlanner)
+    {
+        newPlanner->addresses = NULL;
+        newPlanner->addressesCount = 0;
+        newPlanner->addressesCapacity = 0;
+        newPlanner->messages = NULL;
+        newPlanner->messagesCount = 0;
+        newPlanner->messagesCapacity = 0;
+    }
+    return newPlanner;
+}
+
+void COCOScenePlannerReleaseMessages(COCOScenePlannerRef planner)
+{
+    for (uint32_t index = 0; index < planner->messagesCount; index++)
+    {
+        COCOMessageRelease(planner->messages[index]);
+    }
+    planner->messagesCount = 0;
+}
+
+void COCOScenePlannerRelease(COCOScenePlannerRef planner)
+{
+    if (NULL != planner)
+    {
+        COCOScenePlannerReleaseMessages(planner);
+        free(planner->messages);
+        free(planner->addresses);
+        free(planner);
+    }
+}
+
+// returns NULL if there is no memory for a new address
+struct COCOSceneAddress * COCOScenePlannerGetAddress(COCOScenePlannerRef planner, uint32_t address)
+{
+    for (uint32_t index = 0; index < planner->addressesCount; index++)
+    {
+        if (planner->addresses[index].address == address)
+        { return &planner->addresses[index]; }
+    }
+
+    if (planner->addressesCount == planner->addressesCapacity)
+    {
+        uint32_t newCapacity = (0 == planner->addressesCapacity) ? 8 : planner->addressesCapacity * 2;
+        struct COCOSceneAddress * newAddresses = realloc(planner->addresses, sizeof(struct COCOSceneAddress) * newCapacity);
+        if (NULL == newAddresses)
+        {
+            printf("COCOScenePlanner: could not allocate memory for address %u\n", address);
+            return NULL;
+        }
+        planner->addresses = newAddresses;
+        planner->addressesCapacity = newCapacity;
+    }
+
+    struct COCOSceneAddress * sceneAddress = &planner->addresses[planner->addressesCount];
+    planner->addressesCount += 1;
+    sceneAddress->address = address;
+    sceneAddress->channelsInUse = 0xFFFF;
+    sceneAddress->channelsInScene = 0;
+    sceneAddress->channelsOn = 0;
+    sceneAddress->channelsDimmed = 0;
+    return sceneAddress;
+}
+
+void COCOScenePlannerSetState(COCOScenePlannerRef planner, uint32_t address, uint16_t channel, bool onOff)
+{
+    assert(NULL != planner);
+    assert(channel < COCOScenePlannerChannelCount);
+
+    struct COCOSceneAddress * sceneAddress = COCOScenePlannerGetAddress(planner, address);
+    if (NULL == sceneAddress) { return; }
+
+    uint16_t channelBit = (uint16_t) (1 << (channel % COCOScenePlannerChannelCount));
+    sceneAddress->channelsInScene |= channelBit;
+    sceneAddress->channelsDimmed &= (uint16_t) ~channelBit;
+    if (onOff)
+    { sceneAddress->channelsOn |= channelBit; }
+    else
+    { sceneAddress->channelsOn &= (uint16_t) ~channelBit; }
+}
+
+void COCOScenePlannerSetDimLevel(COCOScenePlannerRef planner, uint32_t address, uint16_t channel, int8_t dimLevel)
+{
+    assert(NULL != planner);
+    assert(channel < COCOScenePlannerChannelCount);
+    assert(dimLevel >= 0 && dimLevel <= 15);
+
+    struct COCOSceneAddress * sceneAddress = COCOScenePlannerGetAddress(planner, address);
+    if (NULL == sceneAddress) { return; }
+
+    uint16_t channelBit = (uint16_t) (1 << (channel % COCOScenePlannerChannelCount));
+    sceneAddress->channelsInScene |= channelBit;
+    sceneAddress->channelsOn &= (uint16_t) ~channelBit;
+    sceneAddress->channelsDimmed |= channelBit;
+    sceneAddress->dimLevels[channel % COCOScenePlannerChannelCount] = dimLevel;
+}
+
+void COCOScenePlannerSetChannelsInUse(COCOScenePlannerRef planner, uint32_t address, uint16_t channelMask)
+{
+    assert(NULL != planner);
+
+    struct COCOSceneAddress * sceneAddress = COCOScenePlannerGetAddress(planner, address);
+    if (NULL == sceneAddress) { return; }
+    sceneAddress->channelsInUse = channelMask;
+}
+
+void COCOScenePlannerClear(COCOScenePlannerRef planner)
+{
+    assert(NULL != planner);
+
+    COCOScenePlannerReleaseMessages(planner);
+    for (uint32_t index = 0; index < planner->addressesCount; index++)
+    {
+        planner->addresses[index].channelsInScene = 0;
+        planner->addresses[index].channelsOn = 0;
+        planner->addresses[index].channelsDimmed = 0;
+    }
+}
+
+bool COCOScenePlannerAddMessage(COCOScenePlannerRef planner, uint32_t address, bool group, bool onOff, uint16_t channel, int8_t dimLevel)
+{
+    if (planner->messagesCount == planner->messagesCapacity)
+    {
+        uint32_t newCapacity = (0 == planner->messagesCapacity) ? 16 : planner->messagesCapacity * 2;
+        COCOMessageRef * newMessages = realloc(planner->messages, sizeof(COCOMessageRef) * newCapacity);
+        if (NULL == newMessages) { return false; }
+        planner->messages = newMessages;
+        planner->messagesCapacity = newCapacity;
+    }
+
+    COCOMessageRef message = COCOMessageCreate();
+    if (NULL == message) { return false; }
+    COCOMessageSetAddress(message, address);
+    COCOMessageSetGroup(message, group);
+    COCOMessageSetOnOff(message, onOff);
+    COCOMessageSetChannel(message, channel);
+    COCOMessageSetDimLevel(message, dimLevel);
+
+    planner->messages[planner->messagesCount] = message;
+    planner->messagesCount += 1;
+    return true;
+}
+
+// adds an individual message for every channel in `channels`
+bool COCOScenePlannerAddChannelMessages(COCOScenePlannerRef planner, uint32_t address, uint16_t channels, bool onOff)
+{
+    for (uint16_t channel = 0; channel < COCOScenePlannerChannelCount; channel++)
+    {
+        if ((channels >> channel) & 1)
+        {
+            if (!COCOScenePlannerAddMessage(planner, address, false, onOff, channel, COCOMessageNoDimLevel))
+            { return false; }
+        }
+    }
+    return true;
+}
+
+uint32_t COCOScenePlannerPlan(COCOScenePlannerRef planner)
+{
+    assert(NULL != planner);
+
+    COCOScenePlannerReleaseMessages(planner);
+
+    bool planned = true;
+    for (uint32_t index = 0; index < planner->addressesCount && planned; index++)
+    {
+        struct COCOSceneAddress * sceneAddress = &planner->addresses[index];
+        // a dimmed channel gets its dim message last, whatever state a group
+        // message left it in
+        uint16_t channelsOnOff = sceneAddress->channelsInScene & (uint16_t) ~sceneAddress->channelsDimmed;
+        uint16_t channelsOn = sceneAddress->channelsOn;
+        uint16_t channelsOff = channelsOnOff & (uint16_t) ~sceneAddress->channelsOn;
+
+        // Only the last group message matters: it sets the state all later
+        // individual messages start from. So the shortest sequence is either
+        // one individual message per channel, or one group message followed
+        // by the channels that need the opposite state.
+        uint32_t individualCount = __builtin_popcount(channelsOnOff);
+        uint32_t groupOnCount = 1 + __builtin_popcount(channelsOff);
+        uint32_t groupOffCount = 1 + __builtin_popcount(channelsOn);
+
+        // a group message would change channels that are not in the scene
+        bool groupAllowed = (0 == (sceneAddress->channelsInUse & (uint16_t) ~sceneAddress->channelsInScene));
+
+        if (groupAllowed && groupOnCount < individualCount && groupOnCount <= groupOffCount)
+        {
+            planned = COCOScenePlannerAddMessage(planner, sceneAddress->address, true, true, 0, COCOMessageNoDimLevel) &&
+                      COCOScenePlannerAddChannelMessages(planner, sceneAddress->address, channelsOff, false);
+        }
+        else if (groupAllowed && groupOffCount < individualCount)
+        {
+            planned = COCOScenePlannerAddMessage(planner, sceneAddress->address, true, false, 0, COCOMessageNoDimLevel) &&
+                      COCOScenePlannerAddChannelMessages(planner, sceneAddress->address, channelsOn, true);
+        }
+        else
+        {
+            planned = COCOScenePlannerAddChannelMessages(planner, sceneAddress->address, channelsOn, true) &&
+                      COCOScenePlannerAddChannelMessages(planner, sceneAddress->address, channelsOff, false);
+        }
+
+        for (uint16_t channel = 0; channel < COCOScenePlannerChannelCount && planned; channel++)
+        {
+            if ((sceneAddress->channelsDimmed >> channel) & 1)
+            {
+                planned = COCOScenePlannerAddMessage(planner, sceneAddress->address, false, false, channel,
+                                                     sceneAddress->dimLevels[channel]);
+            }
+        }
+    }
+
+    if (!planned)
+    {
+        printf("COCOScenePlannerPlan(): could not allocate memory for the planned messages\n");
+        COCOScenePlannerReleaseMessages(planner);
+    }
+    return planner->messagesCount;
+}
+
+uint32_t COCOScenePlannerGetMessageCount(COCOScenePlannerRef planner)
+{
+    assert(NULL != planner);
+    return planner->messagesCount;
+}
+
+COCOMessageRef COCOScenePlannerGetMessageAtIndex(COCOScenePlannerRef planner, uint32_t index)
+{
+    assert(NULL != planner);
+    assert(index < planner->messagesCount);
+    return planner->messages[index];
+}
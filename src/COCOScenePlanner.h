@@ -0,0 +1,83 @@
+#ifndef COCOScenePlanner_h
+#define COCOScenePlanner_h
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include "COCOReceiver.h"
+
+/*
+A COCOScenePlanner computes the shortest sequence of COCO messages that brings
+a number of COCO receivers into a desired on/off state (a 'scene').
+A COCO message with the group bit set switches every channel of an address at
+once. So when most channels of an address should be on, one group 'on' message
+followed by an individual 'off' message for each remaining channel is shorter
+than an individual message per channel. For 16 channels, 16 messages can
+shrink to as little as 1.
+
+Usage:
+    COCOScenePlannerSetState() for every (address, channel) in the scene
+    COCOScenePlannerPlan()
+    OOKSenderSendCOCOScene(), or send the messages returned by
+    COCOScenePlannerGetMessageAtIndex() yourself, in order.
+*/
+
+typedef struct COCOScenePlanner *COCOScenePlannerRef;
+
+/*
+Creates a new COCOScenePlanner, or NULL if a planner could not be created. You
+are responsible for releasing this object using COCOScenePlannerRelease().
+*/
+COCOScenePlannerRef COCOScenePlannerCreate();
+
+/*
+Releases a COCOScenePlannerRef, including all messages it planned.
+This function is safe to call when `planner` is NULL.
+*/
+void COCOScenePlannerRelease(COCOScenePlannerRef planner);
+
+/*
+Sets the desired state of one channel (0 - 15) of the receivers paired with
+`address`. Setting the state of the same address and channel again replaces
+the previous state.
+*/
+void COCOScenePlannerSetState(COCOScenePlannerRef planner, uint32_t address, uint16_t channel, bool onOff);
+
+/*
+Sets the desired state of one channel of a dimmer to a dim level (0 - 15),
+instead of on or off: the channel gets a dim message (see
+COCOMessageGetDimLevel()) after the on/off messages of its address. Setting
+the state of the channel with COCOScenePlannerSetState() replaces it.
+*/
+void COCOScenePlannerSetDimLevel(COCOScenePlannerRef planner, uint32_t address, uint16_t channel, int8_t dimLevel);
+
+/*
+Defaults to 0xFFFF: all 16 channels.
+A group message also switches channels that are not part of the scene, so the
+planner only uses a group message for `address` if every channel that is in
+use has a desired state. Pass the channels that actually have a receiver
+paired with them as a bitmask (bit n is channel n), so that the remaining
+channels do not prevent group messages.
+*/
+void COCOScenePlannerSetChannelsInUse(COCOScenePlannerRef planner, uint32_t address, uint16_t channelMask);
+
+/*
+Removes all desired states and planned messages. The channels in use are kept.
+*/
+void COCOScenePlannerClear(COCOScenePlannerRef planner);
+
+/*
+Computes the messages to send, and returns their number.
+*/
+uint32_t COCOScenePlannerPlan(COCOScenePlannerRef planner);
+
+/*
+The messages computed by the last call to COCOScenePlannerPlan(). The messages
+need to be sent in order, as a group message is followed by the individual
+messages that correct it. The returned message is owned by the planner: do
+not release it, and do not use it after the next call to COCOScenePlannerPlan().
+*/
+uint32_t COCOScenePlannerGetMessageCount(COCOScenePlannerRef planner);
+COCOMessageRef COCOScenePlannerGetMessageAtIndex(COCOScenePlannerRef planner, uint32_t index);
+
+#endif
@@ -0,0 +1,502 @@
+#include <stdio.h>
+#include <assert.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h> // usleep()
+#include <pthread.h>
+#include <stdatomic.h>
+#include "CharacterDeviceGPIOBackend.h"
+
+#if defined(__linux__) && __has_include(<linux/gpio.h>)
+    #include <linux/gpio.h>
+#endif
+
+#ifdef GPIO_V2_GET_LINE_IOCTL
+
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+#define CharacterDeviceGPIOCount 64
+#define CharacterDeviceTimerCount 10
+
+// the number of edges read at once
+#define CharacterDeviceEventBatchLength 64
+
+// the number of edges the kernel queues per line before it drops edges
+#define CharacterDeviceEventBufferSize 1024
+
+// what an epoll event is for: the upper 32 bits of its data
+typedef enum CharacterDeviceSource
+{
+    CharacterDeviceSourceStop = 0,
+    CharacterDeviceSourceLine = 1,
+    CharacterDeviceSourceTimer = 2
+} CharacterDeviceSource;
+
+struct CharacterDeviceLine
+{
+    int fileDescriptor; // the line request, -1 when not requested
+    bool isOutput;
+    GPIOBackendEdgeFunction edgeFunction;
+    void * userdata;
+    uint32_t lastSequenceNumber;
+};
+
+struct CharacterDeviceTimer
+{
+    int fileDescriptor; // timerfd, -1 when not in use
+    GPIOBackendTimerFunction function;
+    void * userdata;
+};
+
+struct CharacterDeviceGPIOBackend
+{
+    struct GPIOBackend backend; // must be first: the GPIOBackendRef points here
+
+    char * chipPath;
+    int chipFileDescriptor;
+    int epollFileDescriptor;
+    int stopFileDescriptor; // eventfd that wakes up the thread to stop it
+    pthread_t thread;
+    bool running;
+
+    // held while edges or timers are dispatched, and while lines and timers
+    // are changed
+    pthread_mutex_t lock;
+    struct CharacterDeviceLine lines[CharacterDeviceGPIOCount];
+    struct CharacterDeviceTimer timers[CharacterDeviceTimerCount];
+
+    // written from the thread that reads the edges, read from any thread
+    _Atomic uint64_t eventCount;
+    _Atomic uint64_t readCount;
+    _Atomic uint64_t lostEventCount;
+};
+
+struct CharacterDeviceGPIOBackend * CharacterDeviceGPIOBackendGetState(GPIOBackendRef backend)
+{
+    assert(NULL != backend);
+    return backend->state;
+}
+
+uint64_t CharacterDeviceGPIOBackendTime(GPIOBackendRef backend)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000 + (uint64_t) now.tv_nsec / 1000;
+}
+
+uint32_t CharacterDeviceGPIOBackendTick(GPIOBackendRef backend)
+{
+    // the same clock as the kernel's edge timestamps
+    return (uint32_t) CharacterDeviceGPIOBackendTime(backend);
+}
+
+void CharacterDeviceGPIOBackendWaitUntil(GPIOBackendRef backend, uint64_t time)
+{
+    // busywait is more accurate than some form of sleep()
+    while (CharacterDeviceGPIOBackendTime(backend) < time) { ; }
+}
+
+void CharacterDeviceGPIOBackendSleep(GPIOBackendRef backend, uint32_t duration)
+{
+    usleep(duration);
+}
+
+bool CharacterDeviceGPIOBackendWatch(struct CharacterDeviceGPIOBackend * device, int fileDescriptor, CharacterDeviceSource source, uint32_t index)
+{
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.u64 = ((uint64_t) source << 32) | index;
+    return 0 == epoll_ctl(device->epollFileDescriptor, EPOLL_CTL_ADD, fileDescriptor, &event);
+}
+
+// the chip for messages, which is not set when only the clock and timers are used
+const char * CharacterDeviceGPIOBackendChipName(struct CharacterDeviceGPIOBackend * device)
+{
+    return (NULL != device->chipPath) ? device->chipPath : "(none)";
+}
+
+// returns the file descriptor of the line request, or -1
+int CharacterDeviceGPIOBackendRequestLine(struct CharacterDeviceGPIOBackend * device, uint32_t gpio, uint64_t flags)
+{
+    if (device->chipFileDescriptor < 0)
+    {
+        printf("CharacterDeviceGPIOBackend: no chip, line %u can not be requested.\n", gpio);
+        return -1;
+    }
+
+    struct gpio_v2_line_request request;
+    memset(&request, 0, sizeof(request));
+    request.offsets[0] = gpio;
+    request.num_lines = 1;
+    strncpy(request.consumer, "LPD433", sizeof(request.consumer) - 1);
+    request.config.flags = flags;
+    if (flags & (GPIO_V2_LINE_FLAG_EDGE_RISING | GPIO_V2_LINE_FLAG_EDGE_FALLING))
+    { request.event_buffer_size = CharacterDeviceEventBufferSize; }
+
+    if (ioctl(device->chipFileDescriptor, GPIO_V2_GET_LINE_IOCTL, &request) < 0)
+    {
+        printf("CharacterDeviceGPIOBackend: could not request line %u of `%s`: %s\n", gpio, CharacterDeviceGPIOBackendChipName(device), strerror(errno));
+        return -1;
+    }
+    return request.fd;
+}
+
+void CharacterDeviceGPIOBackendReleaseLine(struct CharacterDeviceGPIOBackend * device, struct CharacterDeviceLine * line)
+{
+    if (line->fileDescriptor >= 0)
+    {
+        epoll_ctl(device->epollFileDescriptor, EPOLL_CTL_DEL, line->fileDescriptor, NULL);
+        close(line->fileDescriptor);
+        line->fileDescriptor = -1;
+    }
+    line->edgeFunction = NULL;
+    line->isOutput = false;
+}
+
+void CharacterDeviceGPIOBackendReleaseTimer(struct CharacterDeviceGPIOBackend * device, struct CharacterDeviceTimer * timer)
+{
+    if (timer->fileDescriptor >= 0)
+    {
+        epoll_ctl(device->epollFileDescriptor, EPOLL_CTL_DEL, timer->fileDescriptor, NULL);
+        close(timer->fileDescriptor);
+        timer->fileDescriptor = -1;
+    }
+    timer->function = NULL;
+}
+
+void CharacterDeviceGPIOBackendReadEdges(struct CharacterDeviceGPIOBackend * device, uint32_t gpio)
+{
+    struct CharacterDeviceLine * line = &device->lines[gpio];
+    if (line->fileDescriptor < 0 || NULL == line->edgeFunction) { return; }
+
+    struct gpio_v2_line_event events[CharacterDeviceEventBatchLength];
+    ssize_t length = read(line->fileDescriptor, events, sizeof(events));
+    if (length < (ssize_t) sizeof(struct gpio_v2_line_event)) { return; }
+
+    uint32_t count = (uint32_t) (length / sizeof(struct gpio_v2_line_event));
+    atomic_fetch_add_explicit(&device->readCount, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&device->eventCount, count, memory_order_relaxed);
+    for (uint32_t index = 0; index < count; index++)
+    {
+        struct gpio_v2_line_event * event = &events[index];
+
+        // the kernel numbers the edges of each line, a gap means it dropped some
+        if (0 != line->lastSequenceNumber && event->line_seqno != line->lastSequenceNumber + 1)
+        { atomic_fetch_add_explicit(&device->lostEventCount, event->line_seqno - line->lastSequenceNumber - 1, memory_order_relaxed); }
+        line->lastSequenceNumber = event->line_seqno;
+
+        int level = (GPIO_V2_LINE_EVENT_RISING_EDGE == event->id) ? 1 : 0;
+        line->edgeFunction((int) gpio, level, (uint32_t) (event->timestamp_ns / 1000), line->userdata);
+    }
+}
+
+void * CharacterDeviceGPIOBackendRun(void * argument)
+{
+    struct CharacterDeviceGPIOBackend * device = argument;
+
+    struct epoll_event events[16];
+    bool running = true;
+    while (running)
+    {
+        int count = epoll_wait(device->epollFileDescriptor, events, 16, -1);
+        if (count < 0)
+        {
+            if (EINTR == errno) { continue; }
+            printf("CharacterDeviceGPIOBackend: epoll_wait failed: %s\n", strerror(errno));
+            break;
+        }
+
+        for (int index = 0; index < count; index++)
+        {
+            CharacterDeviceSource source = (CharacterDeviceSource) (events[index].data.u64 >> 32);
+            uint32_t sourceIndex = (uint32_t) events[index].data.u64;
+            if (CharacterDeviceSourceStop == source)
+            {
+                running = false;
+                continue;
+            }
+
+            pthread_mutex_lock(&device->lock);
+            if (CharacterDeviceSourceLine == source)
+            {
+                CharacterDeviceGPIOBackendReadEdges(device, sourceIndex);
+            }
+            else
+            {
+                struct CharacterDeviceTimer * timer = &device->timers[sourceIndex];
+                uint64_t expirationCount;
+                if (timer->fileDescriptor >= 0 &&
+                    read(timer->fileDescriptor, &expirationCount, sizeof(expirationCount)) == sizeof(expirationCount) &&
+                    NULL != timer->function)
+                { timer->function(timer->userdata); }
+            }
+            pthread_mutex_unlock(&device->lock);
+        }
+    }
+    return NULL;
+}
+
+void CharacterDeviceGPIOBackendCloseFileDescriptors(struct CharacterDeviceGPIOBackend * device)
+{
+    if (device->stopFileDescriptor >= 0) { close(device->stopFileDescriptor); }
+    if (device->epollFileDescriptor >= 0) { close(device->epollFileDescriptor); }
+    if (device->chipFileDescriptor >= 0) { close(device->chipFileDescriptor); }
+    device->stopFileDescriptor = -1;
+    device->epollFileDescriptor = -1;
+    device->chipFileDescriptor = -1;
+}
+
+int CharacterDeviceGPIOBackendInitialise(GPIOBackendRef backend)
+{
+    struct CharacterDeviceGPIOBackend * device = CharacterDeviceGPIOBackendGetState(backend);
+    if (device->running) { return 0; }
+
+    // without a chip, only the clock and the timers are available
+    if (NULL != device->chipPath) { device->chipFileDescriptor = open(device->chipPath, O_RDWR | O_CLOEXEC); }
+    device->epollFileDescriptor = epoll_create1(EPOLL_CLOEXEC);
+    device->stopFileDescriptor = eventfd(0, EFD_CLOEXEC);
+    if ((NULL != device->chipPath && device->chipFileDescriptor < 0) || device->epollFileDescriptor < 0 || device->stopFileDescriptor < 0 ||
+        !CharacterDeviceGPIOBackendWatch(device, device->stopFileDescriptor, CharacterDeviceSourceStop, 0))
+    {
+        printf("CharacterDeviceGPIOBackend: could not open `%s`: %s\n", CharacterDeviceGPIOBackendChipName(device), strerror(errno));
+        CharacterDeviceGPIOBackendCloseFileDescriptors(device);
+        return -1;
+    }
+
+    if (0 != pthread_create(&device->thread, NULL, &CharacterDeviceGPIOBackendRun, device))
+    {
+        printf("CharacterDeviceGPIOBackend: could not start the event thread.\n");
+        CharacterDeviceGPIOBackendCloseFileDescriptors(device);
+        return -1;
+    }
+    device->running = true;
+    return 0;
+}
+
+void CharacterDeviceGPIOBackendTerminate(GPIOBackendRef backend)
+{
+    struct CharacterDeviceGPIOBackend * device = CharacterDeviceGPIOBackendGetState(backend);
+    if (!device->running) { return; }
+
+    uint64_t one = 1;
+    ssize_t written = write(device->stopFileDescriptor, &one, sizeof(one));
+    (void) written;
+    pthread_join(device->thread, NULL);
+    device->running = false;
+
+    for (uint32_t index = 0; index < CharacterDeviceGPIOCount; index++)
+    {
+        CharacterDeviceGPIOBackendReleaseLine(device, &device->lines[index]);
+    }
+    for (uint32_t index = 0; index < CharacterDeviceTimerCount; index++)
+    {
+        CharacterDeviceGPIOBackendReleaseTimer(device, &device->timers[index]);
+    }
+    CharacterDeviceGPIOBackendCloseFileDescriptors(device);
+}
+
+void CharacterDeviceGPIOBackendRelease(GPIOBackendRef backend)
+{
+    struct CharacterDeviceGPIOBackend * device = CharacterDeviceGPIOBackendGetState(backend);
+    CharacterDeviceGPIOBackendTerminate(backend);
+    pthread_mutex_destroy(&device->lock);
+    free(device->chipPath);
+    free(device);
+}
+
+int CharacterDeviceGPIOBackendSetOutput(GPIOBackendRef backend, uint32_t gpio)
+{
+    struct CharacterDeviceGPIOBackend * device = CharacterDeviceGPIOBackendGetState(backend);
+    if (gpio >= CharacterDeviceGPIOCount || !device->running) { return -1; }
+
+    int result = 0;
+    pthread_mutex_lock(&device->lock);
+    struct CharacterDeviceLine * line = &device->lines[gpio];
+    if (!line->isOutput)
+    {
+        CharacterDeviceGPIOBackendReleaseLine(device, line);
+        line->fileDescriptor = CharacterDeviceGPIOBackendRequestLine(device, gpio, GPIO_V2_LINE_FLAG_OUTPUT);
+        line->isOutput = (line->fileDescriptor >= 0);
+        result = line->isOutput ? 0 : -1;
+    }
+    pthread_mutex_unlock(&device->lock);
+    return result;
+}
+
+int CharacterDeviceGPIOBackendWrite(GPIOBackendRef backend, uint32_t gpio, uint32_t level)
+{
+    struct CharacterDeviceGPIOBackend * device = CharacterDeviceGPIOBackendGetState(backend);
+    if (gpio >= CharacterDeviceGPIOCount) { return -1; }
+
+    // not locked: the sender writes while edges are dispatched, and a line
+    // only stops being an output when the caller changes it
+    struct CharacterDeviceLine * line = &device->lines[gpio];
+    if (!line->isOutput) { return -1; }
+
+    struct gpio_v2_line_values values;
+    values.mask = 1;
+    values.bits = (0 != level) ? 1 : 0;
+    return ioctl(line->fileDescriptor, GPIO_V2_LINE_SET_VALUES_IOCTL, &values) < 0 ? -1 : 0;
+}
+
+int CharacterDeviceGPIOBackendSetEdgeFunction(GPIOBackendRef backend, uint32_t gpio, GPIOBackendEdgeFunction function, void * userdata)
+{
+    struct CharacterDeviceGPIOBackend * device = CharacterDeviceGPIOBackendGetState(backend);
+    if (gpio >= CharacterDeviceGPIOCount || !device->running) { return -1; }
+
+    int result = 0;
+    pthread_mutex_lock(&device->lock);
+    struct CharacterDeviceLine * line = &device->lines[gpio];
+    if (NULL == function)
+    {
+        CharacterDeviceGPIOBackendReleaseLine(device, line);
+    }
+    else
+    {
+        if (line->fileDescriptor < 0 || line->isOutput)
+        {
+            CharacterDeviceGPIOBackendReleaseLine(device, line);
+            line->fileDescriptor = CharacterDeviceGPIOBackendRequestLine(device, gpio,
+                GPIO_V2_LINE_FLAG_INPUT | GPIO_V2_LINE_FLAG_EDGE_RISING | GPIO_V2_LINE_FLAG_EDGE_FALLING);
+            line->lastSequenceNumber = 0;
+            if (line->fileDescriptor >= 0 &&
+                !CharacterDeviceGPIOBackendWatch(device, line->fileDescriptor, CharacterDeviceSourceLine, gpio))
+            {
+                close(line->fileDescriptor);
+                line->fileDescriptor = -1;
+            }
+        }
+        if (line->fileDescriptor >= 0)
+        {
+            line->edgeFunction = function;
+            line->userdata = userdata;
+        }
+        else { result = -1; }
+    }
+    pthread_mutex_unlock(&device->lock);
+    return result;
+}
+
+int CharacterDeviceGPIOBackendSetTimerFunction(GPIOBackendRef backend, uint32_t timer, uint32_t millis, GPIOBackendTimerFunction function, void * userdata)
+{
+    struct CharacterDeviceGPIOBackend * device = CharacterDeviceGPIOBackendGetState(backend);
+    if (timer >= CharacterDeviceTimerCount || !device->running || (NULL != function && 0 == millis)) { return -1; }
+
+    int result = 0;
+    pthread_mutex_lock(&device->lock);
+    struct CharacterDeviceTimer * deviceTimer = &device->timers[timer];
+    if (NULL == function)
+    {
+        CharacterDeviceGPIOBackendReleaseTimer(device, deviceTimer);
+    }
+    else
+    {
+        if (deviceTimer->fileDescriptor < 0)
+        {
+            deviceTimer->fileDescriptor = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+            if (deviceTimer->fileDescriptor >= 0 &&
+                !CharacterDeviceGPIOBackendWatch(device, deviceTimer->fileDescriptor, CharacterDeviceSourceTimer, timer))
+            {
+                close(deviceTimer->fileDescriptor);
+                deviceTimer->fileDescriptor = -1;
+            }
+        }
+
+        struct itimerspec interval;
+        interval.it_interval.tv_sec = millis / 1000;
+        interval.it_interval.tv_nsec = (long) (millis % 1000) * 1000000;
+        interval.it_value = interval.it_interval;
+        if (deviceTimer->fileDescriptor >= 0 && 0 == timerfd_settime(deviceTimer->fileDescriptor, 0, &interval, NULL))
+        {
+            deviceTimer->function = function;
+            deviceTimer->userdata = userdata;
+        }
+        else
+        {
+            printf("CharacterDeviceGPIOBackend: could not start timer %u: %s\n", timer, strerror(errno));
+            CharacterDeviceGPIOBackendReleaseTimer(device, deviceTimer);
+            result = -1;
+        }
+    }
+    pthread_mutex_unlock(&device->lock);
+    return result;
+}
+
+GPIOBackendRef CharacterDeviceGPIOBackendCreate(const char * chipPath)
+{
+    struct CharacterDeviceGPIOBackend * device = malloc(sizeof(struct CharacterDeviceGPIOBackend));
+    if (NULL == device) { return NULL; }
+
+    device->backend.name = "cdev";
+    device->backend.state = device;
+    device->backend.initialise = CharacterDeviceGPIOBackendInitialise;
+    device->backend.terminate = CharacterDeviceGPIOBackendTerminate;
+    device->backend.release = CharacterDeviceGPIOBackendRelease;
+    device->backend.setOutput = CharacterDeviceGPIOBackendSetOutput;
+    device->backend.write = CharacterDeviceGPIOBackendWrite;
+    device->backend.setEdgeFunction = CharacterDeviceGPIOBackendSetEdgeFunction;
+    device->backend.setTimerFunction = CharacterDeviceGPIOBackendSetTimerFunction;
+    device->backend.tick = CharacterDeviceGPIOBackendTick;
+    device->backend.time = CharacterDeviceGPIOBackendTime;
+    device->backend.waitUntil = CharacterDeviceGPIOBackendWaitUntil;
+    device->backend.sleep = CharacterDeviceGPIOBackendSleep;
+
+    device->chipPath = (NULL != chipPath) ? strdup(chipPath) : NULL;
+    device->chipFileDescriptor = -1;
+    device->epollFileDescriptor = -1;
+    device->stopFileDescriptor = -1;
+    device->running = false;
+    pthread_mutex_init(&device->lock, NULL);
+    for (uint32_t index = 0; index < CharacterDeviceGPIOCount; index++)
+    {
+        device->lines[index].fileDescriptor = -1;
+        device->lines[index].isOutput = false;
+        device->lines[index].edgeFunction = NULL;
+        device->lines[index].userdata = NULL;
+        device->lines[index].lastSequenceNumber = 0;
+    }
+    for (uint32_t index = 0; index < CharacterDeviceTimerCount; index++)
+    {
+        device->timers[index].fileDescriptor = -1;
+        device->timers[index].function = NULL;
+        device->timers[index].userdata = NULL;
+    }
+    atomic_init(&device->eventCount, 0);
+    atomic_init(&device->readCount, 0);
+    atomic_init(&device->lostEventCount, 0);
+    return &device->backend;
+}
+
+uint64_t CharacterDeviceGPIOBackendGetEventCount(GPIOBackendRef backend)
+{
+    return atomic_load_explicit(&CharacterDeviceGPIOBackendGetState(backend)->eventCount, memory_order_relaxed);
+}
+
+uint64_t CharacterDeviceGPIOBackendGetReadCount(GPIOBackendRef backend)
+{
+    return atomic_load_explicit(&CharacterDeviceGPIOBackendGetState(backend)->readCount, memory_order_relaxed);
+}
+
+uint64_t CharacterDeviceGPIOBackendGetLostEventCount(GPIOBackendRef backend)
+{
+    return atomic_load_explicit(&CharacterDeviceGPIOBackendGetState(backend)->lostEventCount, memory_order_relaxed);
+}
+
+#else
+
+GPIOBackendRef CharacterDeviceGPIOBackendCreate(const char * chipPath)
+{
+    printf("CharacterDeviceGPIOBackend: the GPIO character device (uAPI v2) is not available on this system.\n");
+    return NULL;
+}
+
+uint64_t CharacterDeviceGPIOBackendGetEventCount(GPIOBackendRef backend) { return 0; }
+uint64_t CharacterDeviceGPIOBackendGetReadCount(GPIOBackendRef backend) { return 0; }
+uint64_t CharacterDeviceGPIOBackendGetLostEventCount(GPIOBackendRef backend) { return 0; }
+
+#endif
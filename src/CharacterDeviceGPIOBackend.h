@@ -0,0 +1,44 @@
+#ifndef CharacterDeviceGPIOBackend_h
+#define CharacterDeviceGPIOBackend_h
+
+#include "GPIOBackend.h"
+
+/*
+A GPIOBackend on the Linux GPIO character device (`/dev/gpiochipN`, uAPI v2),
+so without PIGPIO. Instead of sampling the pins, the kernel timestamps each
+edge in its interrupt handler and queues it. One thread waits (epoll) on all
+requested lines and timers at once, and reads up to 64 queued edges per
+read(), so a silent band costs no CPU at all, and a busy one costs one system
+call per batch of edges instead of one per edge.
+GPIO numbers are line offsets of the chip; on a Raspberry Pi these equal the
+PIGPIO (Broadcom) numbers on `/dev/gpiochip0`.
+Edge timestamps are CLOCK_MONOTONIC in microseconds, as is
+GPIOBackendGetTick(). Edge and timer functions are called on the backend's
+thread, and must not call GPIOBackendSetEdgeFunction() or
+GPIOBackendSetTimerFunction() themselves.
+This backend can be tried without hardware using the kernel's gpio-sim module,
+which creates a chip whose line levels can be set through configfs/sysfs.
+*/
+
+/*
+Creates a backend for the chip at `chipPath` (e.g. "/dev/gpiochip0"), or NULL
+if it could not be created. The chip is opened by GPIOBackendInitialise().
+Pass NULL for a backend without GPIOs, that only offers its clock and timers,
+e.g. when another process owns the GPIOs.
+You are responsible for releasing it using GPIOBackendRelease().
+*/
+GPIOBackendRef CharacterDeviceGPIOBackendCreate(const char * chipPath);
+
+/*
+Statistics on the edges read:
+- events: the number of edges read from the kernel
+- reads: the number of read() calls that returned edges; events / reads is the
+  average batch size
+- lost: the number of edges the kernel dropped because its queue was full
+Safe to call from any thread.
+*/
+uint64_t CharacterDeviceGPIOBackendGetEventCount(GPIOBackendRef backend);
+uint64_t CharacterDeviceGPIOBackendGetReadCount(GPIOBackendRef backend);
+uint64_t CharacterDeviceGPIOBackendGetLostEventCount(GPIOBackendRef backend);
+
+#endif
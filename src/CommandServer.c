@@ -0,0 +1,305 @@
+#ifndef _GNU_SOURCE
+    #define _GNU_SOURCE 1 // to be able to use accept4()
+#endif
+
+#include <stdio.h>
+#include <assert.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "CommandServer.h"
+
+#define CommandServerMaxClientCount 16
+
+// the longest accepted command, including the terminating newline
+#define CommandServerMaxLineLength 512
+
+struct CommandServerClient
+{
+    int fileDescriptor; // -1 when this slot is not in use
+    bool subscribed;
+    char buffer[CommandServerMaxLineLength];
+    uint32_t bufferLength;
+};
+
+struct CommandServer
+{
+    CommandServerCommandReceived callback;
+
+    // for internal use
+    //
+    char * socketPath;
+    int listenFileDescriptor;
+    int stopPipe[2]; // written to by CommandServerStop() to wake up poll()
+    struct CommandServerClient clients[CommandServerMaxClientCount];
+    uint32_t droppedCount;
+
+    // protects `clients` against CommandServerBroadcast() from other threads
+    pthread_mutex_t lock;
+};
+
+CommandServerRef CommandServerCreate(const char * socketPath)
+{
+    struct sockaddr_un socketAddress;
+    if (strlen(socketPath) >= sizeof(socketAddress.sun_path))
+    {
+        printf("CommandServerCreate(): socket path too long: `%s`\n", socketPath);
+        return NULL;
+    }
+
+    CommandServerRef newServer = malloc(sizeof(struct CommandServer));
+    if (NULL == newServer) { return NULL; }
+
+    newServer->callback = NULL;
+    newServer->droppedCount = 0;
+    newServer->socketPath = strdup(socketPath);
+    for (uint32_t index = 0; index < CommandServerMaxClientCount; index++)
+    {
+        newServer->clients[index].fileDescriptor = -1;
+    }
+    pthread_mutex_init(&newServer->lock, NULL);
+
+    newServer->listenFileDescriptor = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (newServer->listenFileDescriptor < 0 || 0 != pipe(newServer->stopPipe))
+    {
+        printf("CommandServerCreate(): could not create socket: %s\n", strerror(errno));
+        if (newServer->listenFileDescriptor >= 0) { close(newServer->listenFileDescriptor); }
+        pthread_mutex_destroy(&newServer->lock);
+        free(newServer->socketPath);
+        free(newServer);
+        return NULL;
+    }
+
+    memset(&socketAddress, 0, sizeof(socketAddress));
+    socketAddress.sun_family = AF_UNIX;
+    strcpy(socketAddress.sun_path, socketPath);
+    unlink(socketPath);
+
+    if (0 != bind(newServer->listenFileDescriptor, (struct sockaddr *) &socketAddress, sizeof(socketAddress)) ||
+        0 != listen(newServer->listenFileDescriptor, CommandServerMaxClientCount))
+    {
+        printf("CommandServerCreate(): could not listen on `%s`: %s\n", socketPath, strerror(errno));
+        newServer->socketPath[0] = '\0'; // nothing to unlink
+        CommandServerRelease(newServer);
+        return NULL;
+    }
+
+    return newServer;
+}
+
+void CommandServerCloseClient(CommandServerRef server, CommandServerClientRef client)
+{
+    pthread_mutex_lock(&server->lock);
+    close(client->fileDescriptor);
+    client->fileDescriptor = -1;
+    pthread_mutex_unlock(&server->lock);
+}
+
+void CommandServerRelease(CommandServerRef server)
+{
+    if (NULL != server)
+    {
+        for (uint32_t index = 0; index < CommandServerMaxClientCount; index++)
+        {
+            if (server->clients[index].fileDescriptor >= 0)
+            { CommandServerCloseClient(server, &server->clients[index]); }
+        }
+        close(server->listenFileDescriptor);
+        close(server->stopPipe[0]);
+        close(server->stopPipe[1]);
+        if ('\0' != server->socketPath[0]) { unlink(server->socketPath); }
+        free(server->socketPath);
+        pthread_mutex_destroy(&server->lock);
+        free(server);
+    }
+}
+
+void CommandServerSetCallback(CommandServerRef server, CommandServerCommandReceived callback)
+{
+    assert(NULL != server);
+    server->callback = callback;
+}
+
+void CommandServerStop(CommandServerRef server)
+{
+    assert(NULL != server);
+    char byte = 0;
+    // write() is async-signal-safe; the result is irrelevant: if the pipe is
+    // full, a stop is already pending
+    ssize_t written = write(server->stopPipe[1], &byte, 1);
+    (void) written;
+}
+
+void CommandServerAcceptClient(CommandServerRef server)
+{
+    int fileDescriptor = accept4(server->listenFileDescriptor, NULL, NULL, SOCK_CLOEXEC);
+    if (fileDescriptor < 0) { return; }
+
+    pthread_mutex_lock(&server->lock);
+    CommandServerClientRef client = NULL;
+    for (uint32_t index = 0; index < CommandServerMaxClientCount && NULL == client; index++)
+    {
+        if (server->clients[index].fileDescriptor < 0)
+        { client = &server->clients[index]; }
+    }
+    if (NULL != client)
+    {
+        client->fileDescriptor = fileDescriptor;
+        client->subscribed = false;
+        client->bufferLength = 0;
+    }
+    pthread_mutex_unlock(&server->lock);
+
+    if (NULL == client)
+    {
+        const char * reply = "ERR too many clients\n";
+        send(fileDescriptor, reply, strlen(reply), MSG_DONTWAIT | MSG_NOSIGNAL);
+        close(fileDescriptor);
+    }
+}
+
+void CommandServerReadClient(CommandServerRef server, CommandServerClientRef client)
+{
+    ssize_t length = read(client->fileDescriptor,
+                          client->buffer + client->bufferLength,
+                          CommandServerMaxLineLength - client->bufferLength);
+    if (length <= 0)
+    {
+        CommandServerCloseClient(server, client);
+        return;
+    }
+    client->bufferLength += (uint32_t) length;
+
+    // handle every complete line in the buffer
+    char * lineStart = client->buffer;
+    char * lineEnd;
+    while (client->fileDescriptor >= 0 &&
+           NULL != (lineEnd = memchr(lineStart, '\n', client->bufferLength - (lineStart - client->buffer))))
+    {
+        *lineEnd = '\0';
+        if (lineEnd > lineStart && '\r' == lineEnd[-1]) { lineEnd[-1] = '\0'; }
+        if (NULL != server->callback) { server->callback(server, client, lineStart); }
+        lineStart = lineEnd + 1;
+    }
+    if (client->fileDescriptor < 0) { return; }
+
+    uint32_t remainingLength = client->bufferLength - (uint32_t) (lineStart - client->buffer);
+    memmove(client->buffer, lineStart, remainingLength);
+    client->bufferLength = remainingLength;
+
+    if (client->bufferLength == CommandServerMaxLineLength)
+    {
+        CommandServerReply(client, "ERR line too long");
+        client->bufferLength = 0;
+    }
+}
+
+void CommandServerRun(CommandServerRef server)
+{
+    assert(NULL != server);
+
+    struct pollfd pollFileDescriptors[CommandServerMaxClientCount + 2];
+    CommandServerClientRef polledClients[CommandServerMaxClientCount];
+    bool running = true;
+    while (running)
+    {
+        pollFileDescriptors[0].fd = server->stopPipe[0];
+        pollFileDescriptors[0].events = POLLIN;
+        pollFileDescriptors[1].fd = server->listenFileDescriptor;
+        pollFileDescriptors[1].events = POLLIN;
+        uint32_t count = 2;
+        for (uint32_t index = 0; index < CommandServerMaxClientCount; index++)
+        {
+            if (server->clients[index].fileDescriptor >= 0)
+            {
+                polledClients[count - 2] = &server->clients[index];
+                pollFileDescriptors[count].fd = server->clients[index].fileDescriptor;
+                pollFileDescriptors[count].events = POLLIN;
+                count += 1;
+            }
+        }
+
+        if (poll(pollFileDescriptors, count, -1) < 0)
+        {
+            if (EINTR == errno) { continue; }
+            printf("CommandServerRun(): poll failed: %s\n", strerror(errno));
+            break;
+        }
+
+        if (pollFileDescriptors[0].revents & POLLIN)
+        {
+            char byte;
+            ssize_t length = read(server->stopPipe[0], &byte, 1);
+            (void) length;
+            running = false;
+            continue;
+        }
+        for (uint32_t index = 2; index < count; index++)
+        {
+            if (pollFileDescriptors[index].revents & (POLLIN | POLLHUP | POLLERR))
+            { CommandServerReadClient(server, polledClients[index - 2]); }
+        }
+        if (pollFileDescriptors[1].revents & POLLIN)
+        { CommandServerAcceptClient(server); }
+    }
+}
+
+// writes the whole line, or nothing at all when the socket buffer is full
+bool CommandServerSendLine(int fileDescriptor, const char * format, va_list arguments)
+{
+    char line[CommandServerMaxLineLength];
+    int length = vsnprintf(line, sizeof(line) - 1, format, arguments);
+    if (length < 0) { return false; }
+    if (length > (int) sizeof(line) - 2) { length = sizeof(line) - 2; }
+    line[length] = '\n';
+    length += 1;
+
+    return send(fileDescriptor, line, length, MSG_DONTWAIT | MSG_NOSIGNAL) == length;
+}
+
+void CommandServerReply(CommandServerClientRef client, const char * format, ...)
+{
+    assert(NULL != client);
+    va_list arguments;
+    va_start(arguments, format);
+    CommandServerSendLine(client->fileDescriptor, format, arguments);
+    va_end(arguments);
+}
+
+void CommandServerClientSetSubscribed(CommandServerClientRef client, bool subscribed)
+{
+    assert(NULL != client);
+    client->subscribed = subscribed;
+}
+
+void CommandServerBroadcast(CommandServerRef server, const char * format, ...)
+{
+    assert(NULL != server);
+
+    pthread_mutex_lock(&server->lock);
+    for (uint32_t index = 0; index < CommandServerMaxClientCount; index++)
+    {
+        CommandServerClientRef client = &server->clients[index];
+        if (client->fileDescriptor >= 0 && client->subscribed)
+        {
+            va_list arguments;
+            va_start(arguments, format);
+            if (!CommandServerSendLine(client->fileDescriptor, format, arguments))
+            { server->droppedCount += 1; }
+            va_end(arguments);
+        }
+    }
+    pthread_mutex_unlock(&server->lock);
+}
+
+uint32_t CommandServerGetDroppedCount(CommandServerRef server)
+{
+    assert(NULL != server);
+    return server->droppedCount;
+}
@@ -0,0 +1,75 @@
+#ifndef CommandServer_h
+#define CommandServer_h
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+
+/*
+A CommandServer listens on a Unix domain socket for clients that send commands,
+one per line (terminated by '\n'). Each line is handed to your callback, which
+answers the client using CommandServerReply(). Clients can subscribe to
+receive the lines passed to CommandServerBroadcast().
+Try it with: `socat - UNIX-CONNECT:/tmp/LPD433.socket`
+*/
+
+typedef struct CommandServer *CommandServerRef;
+typedef struct CommandServerClient *CommandServerClientRef;
+
+/*
+Called on the thread that runs CommandServerRun(), once for every line received
+from a client. `line` does not contain the terminating newline, and may be
+modified by the callback.
+*/
+typedef void (*CommandServerCommandReceived)(CommandServerRef, CommandServerClientRef, char * line);
+
+/*
+Creates a new CommandServer listening on `socketPath`, or NULL if the socket
+could not be created. An existing file at `socketPath` is removed first.
+You are responsible for releasing this object using CommandServerRelease().
+*/
+CommandServerRef CommandServerCreate(const char * socketPath);
+
+/*
+Closes all connections, removes the socket file and frees the server.
+This function is safe to call when `server` is NULL.
+*/
+void CommandServerRelease(CommandServerRef server);
+
+void CommandServerSetCallback(CommandServerRef server, CommandServerCommandReceived callback);
+
+/*
+Accepts clients and reads their commands until CommandServerStop() is called.
+Commands are handled one at a time, in the order in which they arrive.
+*/
+void CommandServerRun(CommandServerRef server);
+
+/*
+Makes CommandServerRun() return. Safe to call from any thread, and from a
+signal handler.
+*/
+void CommandServerStop(CommandServerRef server);
+
+/*
+Sends a line to `client`; a '\n' is appended. Only call this from your
+CommandServerCommandReceived callback.
+*/
+void CommandServerReply(CommandServerClientRef client, const char * format, ...);
+
+/*
+Once subscribed, a client receives every line passed to CommandServerBroadcast().
+*/
+void CommandServerClientSetSubscribed(CommandServerClientRef client, bool subscribed);
+
+/*
+Sends a line to all subscribed clients; a '\n' is appended. This function never
+blocks on a slow client: if a client's socket buffer is full, the line is
+dropped for that client. Safe to call from any thread (e.g. from a receiver's
+callback on the PIGPIO thread).
+*/
+void CommandServerBroadcast(CommandServerRef server, const char * format, ...);
+
+// the number of broadcasted lines that could not be delivered to a client
+uint32_t CommandServerGetDroppedCount(CommandServerRef server);
+
+#endif
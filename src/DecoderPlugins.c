@@ -0,0 +1,334 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <stdatomic.h>
+#include <dlfcn.h>
+#include <dirent.h>
+#include <time.h>
+#include "DecoderPlugins.h"
+
+// the maximum number of edges that are collected before they are decoded
+#define PluginDecoderSetBatchLength 64
+
+// a pulse this long (µs) is longer than a bit of the usual protocols: it is a
+// sync or ends a frame, so the collected edges are decoded right away
+#define PluginDecoderSetFlushGap 2000
+
+struct PluginLibrary
+{
+    uint32_t pluginCount;
+    const LPD433Plugin * plugins[PluginLibraryMaxPluginCount];
+    void * handles[PluginLibraryMaxPluginCount];
+};
+
+struct PluginDecoder
+{
+    const LPD433Plugin * plugin;
+    void * decoder; // NULL if the plugin could not create one
+    PluginDecoderSetRef set;
+    uint32_t index;
+    _Atomic uint64_t CPUTime; // ns
+    _Atomic uint64_t frameCount;
+};
+
+struct PluginDecoderSet
+{
+    PluginFrameDetected callback;
+    void * context;
+    bool inverted;
+
+    uint32_t decoderCount;
+    struct PluginDecoder decoders[PluginLibraryMaxPluginCount];
+
+    LPD433PluginEdge edges[PluginDecoderSetBatchLength];
+    uint32_t collectedEdgeCount;
+    uint32_t lastTimestamp;
+    _Atomic uint64_t edgeCount;
+};
+
+PluginLibraryRef PluginLibraryCreate()
+{
+    PluginLibraryRef newLibrary = malloc(sizeof(struct PluginLibrary));
+    if (NULL != newLibrary)
+    {
+        newLibrary->pluginCount = 0;
+    }
+    return newLibrary;
+}
+
+void PluginLibraryRelease(PluginLibraryRef library)
+{
+    if (NULL == library) { return; }
+    for (uint32_t index = 0; index < library->pluginCount; index++)
+    {
+        dlclose(library->handles[index]);
+    }
+    free(library);
+}
+
+bool PluginLibraryLoad(PluginLibraryRef library, const char * path)
+{
+    assert(NULL != library);
+    assert(NULL != path);
+
+    if (library->pluginCount == PluginLibraryMaxPluginCount)
+    {
+        printf("Plugin %s: not loaded, there are already %u plugins.\n", path, PluginLibraryMaxPluginCount);
+        return false;
+    }
+
+    void * handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (NULL == handle)
+    {
+        printf("Plugin %s: %s\n", path, dlerror());
+        return false;
+    }
+
+    LPD433PluginGetFunction getPlugin = (LPD433PluginGetFunction) dlsym(handle, LPD433PluginEntryPoint);
+    const LPD433Plugin * plugin = (NULL == getPlugin) ? NULL : getPlugin();
+    const char * error = NULL;
+    if (NULL == plugin)
+    { error = "no " LPD433PluginEntryPoint "(), or it returned NULL"; }
+    else if (LPD433PluginABIVersion != plugin->ABIVersion)
+    { error = "built for another version of LPD433Plugin.h"; }
+    else if (NULL == plugin->name || NULL == plugin->create || NULL == plugin->release ||
+             NULL == plugin->reset || NULL == plugin->feedEdges || NULL == plugin->format)
+    { error = "a name or a required function is missing"; }
+    else if (PluginLibraryFindPlugin(library, plugin->name) >= 0)
+    { error = "a plugin of that name is already loaded"; }
+
+    if (NULL != error)
+    {
+        printf("Plugin %s: %s.\n", path, error);
+        dlclose(handle);
+        return false;
+    }
+
+    library->plugins[library->pluginCount] = plugin;
+    library->handles[library->pluginCount] = handle;
+    library->pluginCount += 1;
+    return true;
+}
+
+// scandir() filter: shared libraries
+int PluginLibraryIsSharedLibrary(const struct dirent * entry)
+{
+    size_t length = strlen(entry->d_name);
+    return length > 3 && !strcmp(entry->d_name + length - 3, ".so");
+}
+
+int32_t PluginLibraryLoadDirectory(PluginLibraryRef library, const char * directory)
+{
+    assert(NULL != library);
+    assert(NULL != directory);
+
+    struct dirent ** entries = NULL;
+    int entryCount = scandir(directory, &entries, PluginLibraryIsSharedLibrary, alphasort);
+    if (entryCount < 0)
+    {
+        printf("Could not read the plugin directory %s.\n", directory);
+        return -1;
+    }
+
+    int32_t loadedCount = 0;
+    for (int index = 0; index < entryCount; index++)
+    {
+        char path[4096];
+        snprintf(path, sizeof(path), "%s/%s", directory, entries[index]->d_name);
+        if (PluginLibraryLoad(library, path)) { loadedCount += 1; }
+        free(entries[index]);
+    }
+    free(entries);
+    return loadedCount;
+}
+
+uint32_t PluginLibraryGetPluginCount(PluginLibraryRef library)
+{
+    assert(NULL != library);
+    return library->pluginCount;
+}
+
+const LPD433Plugin * PluginLibraryGetPlugin(PluginLibraryRef library, uint32_t pluginIndex)
+{
+    assert(NULL != library);
+    assert(pluginIndex < library->pluginCount);
+    return library->plugins[pluginIndex];
+}
+
+int32_t PluginLibraryFindPlugin(PluginLibraryRef library, const char * name)
+{
+    assert(NULL != library);
+    assert(NULL != name);
+    for (uint32_t index = 0; index < library->pluginCount; index++)
+    {
+        if (!strcmp(library->plugins[index]->name, name)) { return (int32_t) index; }
+    }
+    return -1;
+}
+
+// LPD433PluginFrameFunction: `host` is the PluginDecoder that decoded the frame
+void PluginDecoderFrameDetected(void * host, const LPD433PluginFrame * frame)
+{
+    struct PluginDecoder * decoder = host;
+    atomic_fetch_add_explicit(&decoder->frameCount, 1, memory_order_relaxed);
+    if (NULL != decoder->set->callback)
+    { decoder->set->callback(decoder->set, decoder->index, frame); }
+}
+
+PluginDecoderSetRef PluginDecoderSetCreate(PluginLibraryRef library)
+{
+    assert(NULL != library);
+
+    PluginDecoderSetRef newSet = malloc(sizeof(struct PluginDecoderSet));
+    if (NULL != newSet)
+    {
+        newSet->callback = NULL;
+        newSet->context = NULL;
+        newSet->inverted = false;
+        newSet->collectedEdgeCount = 0;
+        newSet->lastTimestamp = 0;
+        atomic_init(&newSet->edgeCount, 0);
+
+        newSet->decoderCount = library->pluginCount;
+        for (uint32_t index = 0; index < library->pluginCount; index++)
+        {
+            struct PluginDecoder * decoder = &newSet->decoders[index];
+            decoder->plugin = library->plugins[index];
+            decoder->set = newSet;
+            decoder->index = index;
+            atomic_init(&decoder->CPUTime, 0);
+            atomic_init(&decoder->frameCount, 0);
+            decoder->decoder = decoder->plugin->create(&PluginDecoderFrameDetected, decoder);
+            if (NULL == decoder->decoder)
+            { printf("Plugin %s: could not create a decoder.\n", decoder->plugin->name); }
+        }
+    }
+    return newSet;
+}
+
+void PluginDecoderSetRelease(PluginDecoderSetRef set)
+{
+    if (NULL == set) { return; }
+    for (uint32_t index = 0; index < set->decoderCount; index++)
+    {
+        if (NULL != set->decoders[index].decoder)
+        { set->decoders[index].plugin->release(set->decoders[index].decoder); }
+    }
+    free(set);
+}
+
+bool PluginDecoderSetHasDecoder(PluginDecoderSetRef set, uint32_t pluginIndex)
+{
+    assert(NULL != set);
+    assert(pluginIndex < set->decoderCount);
+    return NULL != set->decoders[pluginIndex].decoder;
+}
+
+void PluginDecoderSetSetCallback(PluginDecoderSetRef set, PluginFrameDetected callback)
+{
+    assert(NULL != set);
+    set->callback = callback;
+}
+
+void PluginDecoderSetSetContext(PluginDecoderSetRef set, void * context)
+{
+    assert(NULL != set);
+    set->context = context;
+}
+
+void * PluginDecoderSetGetContext(PluginDecoderSetRef set)
+{
+    assert(NULL != set);
+    return set->context;
+}
+
+void PluginDecoderSetSetInverted(PluginDecoderSetRef set, bool inverted)
+{
+    assert(NULL != set);
+    set->inverted = inverted;
+}
+
+uint64_t PluginDecoderSetThreadCPUTime()
+{
+    struct timespec time;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return (uint64_t) time.tv_sec * 1000000000 + (uint64_t) time.tv_nsec;
+}
+
+// passes the collected edges to each decoder, and accounts its CPU time
+void PluginDecoderSetFlush(PluginDecoderSetRef set)
+{
+    if (0 == set->collectedEdgeCount) { return; }
+
+    uint64_t startTime = PluginDecoderSetThreadCPUTime();
+    for (uint32_t index = 0; index < set->decoderCount; index++)
+    {
+        struct PluginDecoder * decoder = &set->decoders[index];
+        if (NULL == decoder->decoder) { continue; }
+        decoder->plugin->feedEdges(decoder->decoder, set->edges, set->collectedEdgeCount);
+
+        uint64_t endTime = PluginDecoderSetThreadCPUTime();
+        atomic_fetch_add_explicit(&decoder->CPUTime, endTime - startTime, memory_order_relaxed);
+        startTime = endTime;
+    }
+    set->collectedEdgeCount = 0;
+}
+
+void PluginDecoderSetFeedGPIOLevelChange(PluginDecoderSetRef set, uint32_t timestamp, uint32_t level)
+{
+    assert(NULL != set);
+    atomic_fetch_add_explicit(&set->edgeCount, 1, memory_order_relaxed);
+
+    LPD433PluginEdge * edge = &set->edges[set->collectedEdgeCount];
+    edge->timestamp = timestamp;
+    edge->level = (level ^ (set->inverted ? 1 : 0)) & 1;
+    set->collectedEdgeCount += 1;
+
+    uint32_t duration = timestamp - set->lastTimestamp;
+    set->lastTimestamp = timestamp;
+    if (PluginDecoderSetBatchLength == set->collectedEdgeCount || duration > PluginDecoderSetFlushGap)
+    { PluginDecoderSetFlush(set); }
+}
+
+void PluginDecoderSetFeedTimeout(PluginDecoderSetRef set, uint32_t timestamp)
+{
+    assert(NULL != set);
+    if (PluginDecoderSetBatchLength == set->collectedEdgeCount) { PluginDecoderSetFlush(set); }
+
+    LPD433PluginEdge * edge = &set->edges[set->collectedEdgeCount];
+    edge->timestamp = timestamp;
+    edge->level = LPD433PluginLevelTimeout;
+    set->collectedEdgeCount += 1;
+    PluginDecoderSetFlush(set);
+}
+
+void PluginDecoderSetReset(PluginDecoderSetRef set)
+{
+    assert(NULL != set);
+    set->collectedEdgeCount = 0;
+    for (uint32_t index = 0; index < set->decoderCount; index++)
+    {
+        if (NULL != set->decoders[index].decoder)
+        { set->decoders[index].plugin->reset(set->decoders[index].decoder); }
+    }
+}
+
+uint64_t PluginDecoderSetGetCPUTime(PluginDecoderSetRef set, uint32_t pluginIndex)
+{
+    assert(NULL != set);
+    assert(pluginIndex < set->decoderCount);
+    return atomic_load_explicit(&set->decoders[pluginIndex].CPUTime, memory_order_relaxed) / 1000;
+}
+
+uint64_t PluginDecoderSetGetEdgeCount(PluginDecoderSetRef set)
+{
+    assert(NULL != set);
+    return atomic_load_explicit(&set->edgeCount, memory_order_relaxed);
+}
+
+uint64_t PluginDecoderSetGetFrameCount(PluginDecoderSetRef set, uint32_t pluginIndex)
+{
+    assert(NULL != set);
+    assert(pluginIndex < set->decoderCount);
+    return atomic_load_explicit(&set->decoders[pluginIndex].frameCount, memory_order_relaxed);
+}
@@ -0,0 +1,120 @@
+#ifndef DecoderPlugins_h
+#define DecoderPlugins_h
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include "LPD433Plugin.h"
+
+/*
+Decoder plugins (see LPD433Plugin.h) are loaded into a PluginLibrary, once.
+Each receive PIN then gets a PluginDecoderSet: a decoder of every plugin in
+the library, fed the edges of that PIN next to the built-in receivers.
+*/
+
+// the maximum number of plugins in a library
+#define PluginLibraryMaxPluginCount 16
+
+typedef struct PluginLibrary *PluginLibraryRef;
+typedef struct PluginDecoderSet *PluginDecoderSetRef;
+
+/*
+Creates a new, empty PluginLibrary, or NULL if one could not be created. You
+are responsible for releasing this object using PluginLibraryRelease(), after
+all PluginDecoderSets that use it.
+*/
+PluginLibraryRef PluginLibraryCreate();
+
+/*
+Releases a PluginLibraryRef, and closes the shared libraries of its plugins.
+This function is safe to call when `library` is NULL.
+*/
+void PluginLibraryRelease(PluginLibraryRef library);
+
+/*
+Loads the plugin in the shared library at `path`. Returns false, after
+printing why, if it is not a plugin for this version of LPD433, or if the
+library already holds a plugin of that name or is full.
+*/
+bool PluginLibraryLoad(PluginLibraryRef library, const char * path);
+
+/*
+Loads every `*.so` in `directory`, in alphabetical order. Returns the number
+of plugins that were loaded, or -1 if the directory could not be read.
+*/
+int32_t PluginLibraryLoadDirectory(PluginLibraryRef library, const char * directory);
+
+uint32_t PluginLibraryGetPluginCount(PluginLibraryRef library);
+const LPD433Plugin * PluginLibraryGetPlugin(PluginLibraryRef library, uint32_t pluginIndex);
+
+/*
+Returns the index of the plugin called `name`, or -1.
+*/
+int32_t PluginLibraryFindPlugin(PluginLibraryRef library, const char * name);
+
+// `frame` is only valid during the call
+typedef void (*PluginFrameDetected)(PluginDecoderSetRef set, uint32_t pluginIndex, const LPD433PluginFrame * frame);
+
+/*
+Creates a decoder of each plugin in `library`, or returns NULL if the set
+could not be created. Plugins that fail to create a decoder are left out (see
+PluginDecoderSetHasDecoder()). You are responsible for releasing this object
+using PluginDecoderSetRelease().
+*/
+PluginDecoderSetRef PluginDecoderSetCreate(PluginLibraryRef library);
+
+/*
+Releases a PluginDecoderSetRef and its decoders. This function is safe to
+call when `set` is NULL.
+*/
+void PluginDecoderSetRelease(PluginDecoderSetRef set);
+
+bool PluginDecoderSetHasDecoder(PluginDecoderSetRef set, uint32_t pluginIndex);
+
+void PluginDecoderSetSetCallback(PluginDecoderSetRef set, PluginFrameDetected callback);
+
+/*
+Defaults to NULL. A pointer that is not used by the set, so that your
+callback can tell sets apart (e.g. when listening on several GPIOs).
+*/
+void PluginDecoderSetSetContext(PluginDecoderSetRef set, void * context);
+void * PluginDecoderSetGetContext(PluginDecoderSetRef set);
+
+/*
+Defaults to false. Set this to true for a receiver module whose output is low
+while it receives a carrier, and high otherwise: the plugins are always given
+the level of the carrier.
+*/
+void PluginDecoderSetSetInverted(PluginDecoderSetRef set, bool inverted);
+
+/*
+Every time the GPIO changes state, call this function with the timestamp of
+the change (µs) and the `level` (0 or 1) after it. The edges are collected,
+and passed to the decoders in one call per decoder: when enough edges were
+collected, and after every gap between two edges that is longer than a bit
+of the usual protocols (a sync, or the end of a frame), so that frames are
+still reported as soon as they end.
+*/
+void PluginDecoderSetFeedGPIOLevelChange(PluginDecoderSetRef set, uint32_t timestamp, uint32_t level);
+
+/*
+Call this when the GPIO did not change state since the last edge until
+`timestamp`: the collected edges and the silence are passed to the decoders.
+*/
+void PluginDecoderSetFeedTimeout(PluginDecoderSetRef set, uint32_t timestamp);
+
+/*
+Resets the decoders, and drops the collected edges.
+*/
+void PluginDecoderSetReset(PluginDecoderSetRef set);
+
+/*
+The CPU time that the decoder of a plugin spent decoding, in microseconds,
+and the number of edges and frames it was fed and reported. Safe to call from
+any thread, at any time.
+*/
+uint64_t PluginDecoderSetGetCPUTime(PluginDecoderSetRef set, uint32_t pluginIndex);
+uint64_t PluginDecoderSetGetEdgeCount(PluginDecoderSetRef set);
+uint64_t PluginDecoderSetGetFrameCount(PluginDecoderSetRef set, uint32_t pluginIndex);
+
+#endif
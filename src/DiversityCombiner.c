@@ -0,0 +1,274 @@
+#include <stdio.h>
+#include <assert.h>
+#include <pthread.h>
+#include "DiversityCombiner.h"
+
+#define DiversityCombinerMaxSourceCount 32
+
+// the number of distinct messages that can be combined at the same time.
+// When all are in use, the oldest one is passed on early.
+#define DiversityCombinerPendingCount 32
+
+struct DiversityCombinerPending
+{
+    bool inUse;
+    uint32_t protocol;
+    uint64_t code;
+    uint32_t firstTimestamp;
+    uint32_t sourcesMask; // bit n is set when source n submitted a copy
+
+    // the best copy so far
+    void * message;
+    DiversityCombinerMessageReleaser releaser;
+    uint8_t quality;
+    uint32_t source;
+};
+
+struct DiversityCombinerSourceStatistics
+{
+    uint32_t submittedCount;
+    uint32_t selectedCount;
+    uint32_t duplicateCount;
+};
+
+struct DiversityCombiner
+{
+    DiversityCombinerMessageCombined callback;
+    uint32_t sourceCount;
+    uint32_t window; // µicro seconds
+
+    // for internal use
+    //
+    struct DiversityCombinerPending pending[DiversityCombinerPendingCount];
+    struct DiversityCombinerSourceStatistics statistics[DiversityCombinerMaxSourceCount];
+    pthread_mutex_t lock;
+};
+
+DiversityCombinerRef DiversityCombinerCreate(uint32_t sourceCount)
+{
+    assert(sourceCount > 0 && sourceCount <= DiversityCombinerMaxSourceCount);
+
+    DiversityCombinerRef newCombiner = malloc(sizeof(struct DiversityCombiner));
+    if (NULL != newCombiner)
+    {
+        newCombiner->callback = NULL;
+        newCombiner->sourceCount = sourceCount;
+        newCombiner->window = 50000;
+        for (uint32_t index = 0; index < DiversityCombinerPendingCount; index++)
+        {
+            newCombiner->pending[index].inUse = false;
+        }
+        for (uint32_t index = 0; index < DiversityCombinerMaxSourceCount; index++)
+        {
+            newCombiner->statistics[index].submittedCount = 0;
+            newCombiner->statistics[index].selectedCount = 0;
+            newCombiner->statistics[index].duplicateCount = 0;
+        }
+        pthread_mutex_init(&newCombiner->lock, NULL);
+    }
+    return newCombiner;
+}
+
+void DiversityCombinerRelease(DiversityCombinerRef combiner)
+{
+    if (NULL != combiner)
+    {
+        for (uint32_t index = 0; index < DiversityCombinerPendingCount; index++)
+        {
+            struct DiversityCombinerPending * pending = &combiner->pending[index];
+            if (pending->inUse && NULL != pending->releaser)
+            { pending->releaser(pending->message); }
+        }
+        pthread_mutex_destroy(&combiner->lock);
+        free(combiner);
+    }
+}
+
+void DiversityCombinerSetCallback(DiversityCombinerRef combiner, DiversityCombinerMessageCombined callback)
+{
+    assert(NULL != combiner);
+    combiner->callback = callback;
+}
+
+void DiversityCombinerSetWindow(DiversityCombinerRef combiner, uint32_t window)
+{
+    assert(NULL != combiner);
+    combiner->window = window;
+}
+
+uint32_t DiversityCombinerGetWindow(DiversityCombinerRef combiner)
+{
+    assert(NULL != combiner);
+    return combiner->window;
+}
+
+/*
+Takes a pending message out of the list, and counts it as selected. The
+caller must pass the copy to the callback (after releasing the lock).
+*/
+struct DiversityCombinerPending DiversityCombinerTakePending(DiversityCombinerRef combiner, struct DiversityCombinerPending * pending)
+{
+    struct DiversityCombinerPending taken = *pending;
+    pending->inUse = false;
+    combiner->statistics[taken.source].selectedCount += 1;
+    return taken;
+}
+
+void DiversityCombinerPassOn(DiversityCombinerRef combiner, struct DiversityCombinerPending * taken)
+{
+    if (NULL != combiner->callback)
+    { combiner->callback(combiner, taken->protocol, taken->message, taken->source); }
+    else if (NULL != taken->releaser)
+    { taken->releaser(taken->message); }
+}
+
+void DiversityCombinerSubmit(DiversityCombinerRef combiner,
+                             uint32_t protocol,
+                             uint64_t code,
+                             uint32_t timestamp,
+                             uint8_t quality,
+                             uint32_t source,
+                             void * message,
+                             DiversityCombinerMessageReleaser releaser)
+{
+    assert(NULL != combiner);
+    assert(source < combiner->sourceCount);
+
+    struct DiversityCombinerPending taken;
+    bool passOn = false;
+
+    pthread_mutex_lock(&combiner->lock);
+    combiner->statistics[source].submittedCount += 1;
+
+    // find a copy of this message that is still within its window, and the
+    // oldest pending message in case there is no room for a new one
+    struct DiversityCombinerPending * copy = NULL;
+    struct DiversityCombinerPending * unused = NULL;
+    struct DiversityCombinerPending * oldest = NULL;
+    for (uint32_t index = 0; index < DiversityCombinerPendingCount; index++)
+    {
+        struct DiversityCombinerPending * pending = &combiner->pending[index];
+        if (!pending->inUse)
+        {
+            if (NULL == unused) { unused = pending; }
+            continue;
+        }
+        // copies from different sources can be submitted slightly out of order
+        int32_t age = (int32_t) (timestamp - pending->firstTimestamp);
+        if (age < 0) { age = -age; }
+        if (pending->protocol == protocol && pending->code == code && age <= (int32_t) combiner->window)
+        { copy = pending; }
+        if (NULL == oldest || (int32_t) (pending->firstTimestamp - oldest->firstTimestamp) < 0)
+        { oldest = pending; }
+    }
+
+    if (NULL != copy)
+    {
+        // keep the best copy, the other one is a duplicate
+        if (quality > copy->quality)
+        {
+            combiner->statistics[copy->source].duplicateCount += 1;
+            if (NULL != copy->releaser) { copy->releaser(copy->message); }
+            copy->message = message;
+            copy->releaser = releaser;
+            copy->quality = quality;
+            copy->source = source;
+        }
+        else
+        {
+            combiner->statistics[source].duplicateCount += 1;
+            if (NULL != releaser) { releaser(message); }
+        }
+        copy->sourcesMask |= (1u << source);
+    }
+    else
+    {
+        if (NULL == unused)
+        {
+            // no room: pass on the oldest message early
+            taken = DiversityCombinerTakePending(combiner, oldest);
+            passOn = true;
+            unused = oldest;
+        }
+        copy = unused;
+        copy->inUse = true;
+        copy->protocol = protocol;
+        copy->code = code;
+        copy->firstTimestamp = timestamp;
+        copy->sourcesMask = (1u << source);
+        copy->message = message;
+        copy->releaser = releaser;
+        copy->quality = quality;
+        copy->source = source;
+    }
+
+    // once every source delivered a copy, there is nothing left to wait for
+    struct DiversityCombinerPending complete;
+    bool passOnComplete = false;
+    if ((uint32_t) __builtin_popcount(copy->sourcesMask) == combiner->sourceCount)
+    {
+        complete = DiversityCombinerTakePending(combiner, copy);
+        passOnComplete = true;
+    }
+    pthread_mutex_unlock(&combiner->lock);
+
+    // the callback is called without holding the lock, so that it may take
+    // its time, or even submit messages itself
+    if (passOn) { DiversityCombinerPassOn(combiner, &taken); }
+    if (passOnComplete) { DiversityCombinerPassOn(combiner, &complete); }
+}
+
+void DiversityCombinerFlush(DiversityCombinerRef combiner, uint32_t timestamp)
+{
+    assert(NULL != combiner);
+
+    struct DiversityCombinerPending taken[DiversityCombinerPendingCount];
+    uint32_t takenCount = 0;
+
+    pthread_mutex_lock(&combiner->lock);
+    for (uint32_t index = 0; index < DiversityCombinerPendingCount; index++)
+    {
+        struct DiversityCombinerPending * pending = &combiner->pending[index];
+        if (pending->inUse && (int32_t) (timestamp - pending->firstTimestamp) > (int32_t) combiner->window)
+        {
+            taken[takenCount] = DiversityCombinerTakePending(combiner, pending);
+            takenCount += 1;
+        }
+    }
+    pthread_mutex_unlock(&combiner->lock);
+
+    // pass them on in the order in which they were first received
+    for (uint32_t count = 0; count < takenCount; count++)
+    {
+        uint32_t oldestIndex = count;
+        for (uint32_t index = count + 1; index < takenCount; index++)
+        {
+            if ((int32_t) (taken[index].firstTimestamp - taken[oldestIndex].firstTimestamp) < 0)
+            { oldestIndex = index; }
+        }
+        struct DiversityCombinerPending oldest = taken[oldestIndex];
+        taken[oldestIndex] = taken[count];
+        DiversityCombinerPassOn(combiner, &oldest);
+    }
+}
+
+uint32_t DiversityCombinerGetSubmittedCount(DiversityCombinerRef combiner, uint32_t source)
+{
+    assert(NULL != combiner);
+    assert(source < combiner->sourceCount);
+    return combiner->statistics[source].submittedCount;
+}
+
+uint32_t DiversityCombinerGetSelectedCount(DiversityCombinerRef combiner, uint32_t source)
+{
+    assert(NULL != combiner);
+    assert(source < combiner->sourceCount);
+    return combiner->statistics[source].selectedCount;
+}
+
+uint32_t DiversityCombinerGetDuplicateCount(DiversityCombinerRef combiner, uint32_t source)
+{
+    assert(NULL != combiner);
+    assert(source < combiner->sourceCount);
+    return combiner->statistics[source].duplicateCount;
+}
@@ -0,0 +1,89 @@
+#ifndef DiversityCombiner_h
+#define DiversityCombiner_h
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+
+/*
+A DiversityCombiner merges the messages detected by several receivers (e.g.
+several 433MHz receiver modules on different GPIOs, placed around a room) into
+one stream. A transmission that is picked up by more than one receiver is only
+passed on once: all copies with the same protocol and code that arrive within
+the window of the first copy are combined, and the copy with the best quality
+is passed to your callback.
+A combined message is passed on as soon as every source delivered its copy, or
+otherwise when DiversityCombinerFlush() is called after the window passed.
+All timestamps are expressed in microseconds (e.g. the PIGPIO `tick`).
+All functions are thread-safe.
+*/
+
+typedef struct DiversityCombiner *DiversityCombinerRef;
+
+// releases a message that was submitted, but not passed on
+typedef void (*DiversityCombinerMessageReleaser)(void * message);
+
+/*
+Called with the best copy of each transmission. `source` is the source that
+submitted this copy. Ownership of `message` is handed over to the callback.
+*/
+typedef void (*DiversityCombinerMessageCombined)(DiversityCombinerRef, uint32_t protocol, void * message, uint32_t source);
+
+/*
+Creates a new DiversityCombiner for messages from `sourceCount` (1 - 32)
+sources, or NULL if a combiner could not be created. You are responsible for
+releasing this object using DiversityCombinerRelease().
+*/
+DiversityCombinerRef DiversityCombinerCreate(uint32_t sourceCount);
+
+/*
+Releases a DiversityCombinerRef, and any message it holds that was not passed
+on yet. This function is safe to call when `combiner` is NULL.
+*/
+void DiversityCombinerRelease(DiversityCombinerRef combiner);
+
+void DiversityCombinerSetCallback(DiversityCombinerRef combiner, DiversityCombinerMessageCombined callback);
+
+/*
+Defaults to 50000, expressed in microseconds.
+The time after the first copy of a message in which other copies of the same
+message are considered duplicates.
+*/
+void DiversityCombinerSetWindow(DiversityCombinerRef combiner, uint32_t window);
+uint32_t DiversityCombinerGetWindow(DiversityCombinerRef combiner);
+
+/*
+Submits a message detected by `source` (0 - sourceCount - 1). `protocol` and
+`code` together identify the message (e.g. 1 and COCOMessageGetCode(), with
+the dim level above its 32 bits).
+`quality` is used to pick the best copy. The combiner takes ownership of
+`message`: it is either passed to the callback, or released using `releaser`.
+With only one source, the message is passed on immediately.
+*/
+void DiversityCombinerSubmit(DiversityCombinerRef combiner,
+                             uint32_t protocol,
+                             uint64_t code,
+                             uint32_t timestamp,
+                             uint8_t quality,
+                             uint32_t source,
+                             void * message,
+                             DiversityCombinerMessageReleaser releaser);
+
+/*
+Passes on all messages of which the window passed at `timestamp`.
+Call this periodically, e.g. every 10ms.
+*/
+void DiversityCombinerFlush(DiversityCombinerRef combiner, uint32_t timestamp);
+
+/*
+Per-source statistics:
+- submitted: the number of messages the source submitted
+- selected: the number of times a copy from this source was passed on
+- duplicates: the number of copies from this source that were dropped
+  because another copy was passed on
+*/
+uint32_t DiversityCombinerGetSubmittedCount(DiversityCombinerRef combiner, uint32_t source);
+uint32_t DiversityCombinerGetSelectedCount(DiversityCombinerRef combiner, uint32_t source);
+uint32_t DiversityCombinerGetDuplicateCount(DiversityCombinerRef combiner, uint32_t source);
+
+#endif
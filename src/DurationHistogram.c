@@ -0,0 +1,298 @@
+#include <assert.h>
+#include <stdatomic.h>
+#include "DurationHistogram.h"
+
+// 32 bins per power of two: a bin is 1/32 of the power of two wide, 3% of the
+// first bin's lower bound and 1.6% of the last one's
+#define DurationHistogramSubBinBits 5
+#define DurationHistogramSubBinCount (1u << DurationHistogramSubBinBits)
+
+// the binned durations: 2^5 = 32µs up to 2^17 = 131ms
+#define DurationHistogramMinExponent DurationHistogramSubBinBits
+#define DurationHistogramMaxExponent 17
+#define DurationHistogramBinCount ((DurationHistogramMaxExponent - DurationHistogramMinExponent) * DurationHistogramSubBinCount)
+
+// a peak is a run of bins that each hold more than 1 / DurationHistogramNoiseDivisor
+// of all durations
+#define DurationHistogramNoiseDivisor 500
+
+// the margin added to the deviations of the peaks, in percent
+#define DurationHistogramToleranceMargin 5
+
+struct DurationHistogram
+{
+    _Atomic uint32_t bins[2][DurationHistogramBinCount];
+    _Atomic uint64_t shortCounts[2]; // below the first bin
+    _Atomic uint64_t longCounts[2];  // beyond the last bin
+
+    // for internal use
+    //
+    uint32_t lastTimestamp;
+    int32_t lastLevel; // -1 before the first edge
+};
+
+// the bin of `duration`, or -1 if it is too short, DurationHistogramBinCount if too long
+int32_t DurationHistogramBinIndex(uint32_t duration)
+{
+    if (duration < (1u << DurationHistogramMinExponent)) { return -1; }
+    if (duration >= (1u << DurationHistogramMaxExponent)) { return DurationHistogramBinCount; }
+
+    uint32_t exponent = 31 - (uint32_t) __builtin_clz(duration);
+    uint32_t shift = exponent - DurationHistogramSubBinBits;
+    uint32_t subBin = (duration >> shift) & (DurationHistogramSubBinCount - 1);
+    return (int32_t) (((exponent - DurationHistogramMinExponent) << DurationHistogramSubBinBits) + subBin);
+}
+
+// the first duration that is counted in the bin at `index`
+uint32_t DurationHistogramBinStart(uint32_t index)
+{
+    uint32_t exponent = (index >> DurationHistogramSubBinBits) + DurationHistogramMinExponent;
+    uint32_t shift = exponent - DurationHistogramSubBinBits;
+    return (DurationHistogramSubBinCount + (index & (DurationHistogramSubBinCount - 1))) << shift;
+}
+
+uint32_t DurationHistogramBinWidth(uint32_t index)
+{
+    uint32_t exponent = (index >> DurationHistogramSubBinBits) + DurationHistogramMinExponent;
+    return 1u << (exponent - DurationHistogramSubBinBits);
+}
+
+DurationHistogramRef DurationHistogramCreate()
+{
+    DurationHistogramRef newHistogram = malloc(sizeof(struct DurationHistogram));
+    if (NULL != newHistogram)
+    {
+        for (uint32_t level = 0; level < 2; level++)
+        {
+            for (uint32_t index = 0; index < DurationHistogramBinCount; index++)
+            {
+                atomic_init(&newHistogram->bins[level][index], 0);
+            }
+            atomic_init(&newHistogram->shortCounts[level], 0);
+            atomic_init(&newHistogram->longCounts[level], 0);
+        }
+        newHistogram->lastTimestamp = 0;
+        newHistogram->lastLevel = -1;
+    }
+    return newHistogram;
+}
+
+void DurationHistogramRelease(DurationHistogramRef histogram)
+{
+    free(histogram);
+}
+
+void DurationHistogramAddDuration(DurationHistogramRef histogram, DurationHistogramLevel level, uint32_t duration)
+{
+    assert(NULL != histogram);
+    assert(DurationHistogramLevelLow == level || DurationHistogramLevelHigh == level);
+
+    int32_t index = DurationHistogramBinIndex(duration);
+    if (index < 0)
+    { atomic_fetch_add_explicit(&histogram->shortCounts[level], 1, memory_order_relaxed); }
+    else if (index >= (int32_t) DurationHistogramBinCount)
+    { atomic_fetch_add_explicit(&histogram->longCounts[level], 1, memory_order_relaxed); }
+    else
+    { atomic_fetch_add_explicit(&histogram->bins[level][index], 1, memory_order_relaxed); }
+}
+
+void DurationHistogramFeedEdge(DurationHistogramRef histogram, uint32_t timestamp, uint32_t level)
+{
+    assert(NULL != histogram);
+
+    int32_t newLevel = (0 != level) ? 1 : 0;
+    if (histogram->lastLevel >= 0 && newLevel != histogram->lastLevel)
+    {
+        DurationHistogramAddDuration(histogram, (DurationHistogramLevel) histogram->lastLevel, timestamp - histogram->lastTimestamp);
+    }
+    histogram->lastLevel = newLevel;
+    histogram->lastTimestamp = timestamp;
+}
+
+// the count of the bin at `index` of `level`, Both adds low and high
+uint64_t DurationHistogramGetBin(DurationHistogramRef histogram, DurationHistogramLevel level, uint32_t index)
+{
+    if (DurationHistogramLevelBoth == level)
+    {
+        return (uint64_t) atomic_load_explicit(&histogram->bins[0][index], memory_order_relaxed) +
+               (uint64_t) atomic_load_explicit(&histogram->bins[1][index], memory_order_relaxed);
+    }
+    return atomic_load_explicit(&histogram->bins[level][index], memory_order_relaxed);
+}
+
+uint64_t DurationHistogramGetCount(DurationHistogramRef histogram, DurationHistogramLevel level)
+{
+    assert(NULL != histogram);
+    if (DurationHistogramLevelBoth == level)
+    {
+        return DurationHistogramGetCount(histogram, DurationHistogramLevelLow) +
+               DurationHistogramGetCount(histogram, DurationHistogramLevelHigh);
+    }
+
+    uint64_t count = atomic_load_explicit(&histogram->shortCounts[level], memory_order_relaxed) +
+                     atomic_load_explicit(&histogram->longCounts[level], memory_order_relaxed);
+    for (uint32_t index = 0; index < DurationHistogramBinCount; index++)
+    {
+        count += atomic_load_explicit(&histogram->bins[level][index], memory_order_relaxed);
+    }
+    return count;
+}
+
+void DurationHistogramReset(DurationHistogramRef histogram)
+{
+    assert(NULL != histogram);
+    for (uint32_t level = 0; level < 2; level++)
+    {
+        for (uint32_t index = 0; index < DurationHistogramBinCount; index++)
+        {
+            atomic_store_explicit(&histogram->bins[level][index], 0, memory_order_relaxed);
+        }
+        atomic_store_explicit(&histogram->shortCounts[level], 0, memory_order_relaxed);
+        atomic_store_explicit(&histogram->longCounts[level], 0, memory_order_relaxed);
+    }
+}
+
+uint32_t DurationHistogramGetPeaks(DurationHistogramRef histogram, DurationHistogramLevel level,
+                                   DurationHistogramPeak * peaks, uint32_t maxPeakCount)
+{
+    assert(NULL != histogram);
+    assert(NULL != peaks || 0 == maxPeakCount);
+
+    // one snapshot, so that the threshold and the peaks agree
+    uint64_t counts[DurationHistogramBinCount];
+    uint64_t total = 0;
+    for (uint32_t index = 0; index < DurationHistogramBinCount; index++)
+    {
+        counts[index] = DurationHistogramGetBin(histogram, level, index);
+        total += counts[index];
+    }
+    uint64_t threshold = total / DurationHistogramNoiseDivisor;
+    if (threshold < 2) { threshold = 2; }
+
+    uint32_t peakCount = 0;
+    uint32_t index = 0;
+    while (index < DurationHistogramBinCount && peakCount < maxPeakCount)
+    {
+        if (counts[index] < threshold) { index += 1; continue; }
+
+        // a run of significant bins
+        uint32_t firstIndex = index;
+        uint64_t count = 0;
+        uint64_t weightedSum = 0; // of the bin centres
+        for (; index < DurationHistogramBinCount && counts[index] >= threshold; index++)
+        {
+            count += counts[index];
+            weightedSum += counts[index] * (DurationHistogramBinStart(index) + DurationHistogramBinWidth(index) / 2);
+        }
+
+        DurationHistogramPeak * peak = &peaks[peakCount];
+        peak->duration = (uint32_t) (weightedSum / count);
+        peak->minDuration = DurationHistogramBinStart(firstIndex);
+        peak->maxDuration = DurationHistogramBinStart(index - 1) + DurationHistogramBinWidth(index - 1) - 1;
+        peak->count = count;
+        peakCount += 1;
+    }
+    return peakCount;
+}
+
+bool DurationHistogramSuggestTolerances(DurationHistogramRef histogram, uint32_t nominalPulseDuration,
+                                        const uint32_t * multiples, uint32_t multipleCount,
+                                        DurationHistogramSuggestion * suggestion)
+{
+    assert(NULL != histogram);
+    assert(NULL != suggestion);
+    assert(nominalPulseDuration > 0);
+
+    // the receivers apply the same tolerances to pulses and gaps
+    DurationHistogramPeak peaks[DurationHistogramMaxPeakCount];
+    uint32_t peakCount = DurationHistogramGetPeaks(histogram, DurationHistogramLevelBoth, peaks, DurationHistogramMaxPeakCount);
+
+    // the single pulse duration: the most frequent duration near the nominal one
+    DurationHistogramPeak * singlePulsePeak = NULL;
+    for (uint32_t index = 0; index < peakCount; index++)
+    {
+        uint32_t duration = peaks[index].duration;
+        if (duration * 100 >= nominalPulseDuration * 60 && duration * 100 <= nominalPulseDuration * 140 &&
+            (NULL == singlePulsePeak || peaks[index].count > singlePulsePeak->count))
+        { singlePulsePeak = &peaks[index]; }
+    }
+    if (NULL == singlePulsePeak) { return false; }
+
+    uint32_t singlePulseDuration = singlePulsePeak->duration;
+    uint32_t positiveDeviation = 0;
+    uint32_t negativeDeviation = 0;
+    uint32_t matchedPeakCount = 0;
+    for (uint32_t multipleIndex = 0; multipleIndex < multipleCount; multipleIndex++)
+    {
+        uint32_t nominal = multiples[multipleIndex] * singlePulseDuration;
+
+        // the largest peak within 20% of this multiple
+        DurationHistogramPeak * match = NULL;
+        for (uint32_t index = 0; index < peakCount; index++)
+        {
+            uint32_t duration = peaks[index].duration;
+            if ((uint64_t) duration * 100 >= (uint64_t) nominal * 80 && (uint64_t) duration * 100 <= (uint64_t) nominal * 120 &&
+                (NULL == match || peaks[index].count > match->count))
+            { match = &peaks[index]; }
+        }
+        if (NULL == match) { continue; }
+
+        matchedPeakCount += 1;
+        if (match->maxDuration > nominal)
+        {
+            uint32_t deviation = (uint32_t) (((uint64_t) (match->maxDuration - nominal) * 100 + nominal - 1) / nominal);
+            if (deviation > positiveDeviation) { positiveDeviation = deviation; }
+        }
+        if (match->minDuration < nominal)
+        {
+            uint32_t deviation = (uint32_t) (((uint64_t) (nominal - match->minDuration) * 100 + nominal - 1) / nominal);
+            if (deviation > negativeDeviation) { negativeDeviation = deviation; }
+        }
+    }
+
+    suggestion->singlePulseDuration = singlePulseDuration;
+    suggestion->positiveTolerance = positiveDeviation + DurationHistogramToleranceMargin;
+    suggestion->negativeTolerance = negativeDeviation + DurationHistogramToleranceMargin;
+    if (suggestion->negativeTolerance > 99) { suggestion->negativeTolerance = 99; }
+    suggestion->matchedPeakCount = matchedPeakCount;
+    return true;
+}
+
+void DurationHistogramPrintPeaks(DurationHistogramRef histogram, FILE * output, DurationHistogramLevel level, const char * name)
+{
+    DurationHistogramPeak peaks[DurationHistogramMaxPeakCount];
+    uint32_t peakCount = DurationHistogramGetPeaks(histogram, level, peaks, DurationHistogramMaxPeakCount);
+    fprintf(output, "%s peaks:", name);
+    if (0 == peakCount) { fprintf(output, " none"); }
+    for (uint32_t index = 0; index < peakCount; index++)
+    {
+        fprintf(output, " %uµs (%u - %u, %llu)", peaks[index].duration, peaks[index].minDuration,
+                peaks[index].maxDuration, (unsigned long long) peaks[index].count);
+    }
+    fprintf(output, "\n");
+}
+
+void DurationHistogramPrint(DurationHistogramRef histogram, FILE * output)
+{
+    assert(NULL != histogram);
+    assert(NULL != output);
+
+    fprintf(output, "  duration (µs)\t     low\t    high\n");
+    fprintf(output, "  < %10u\t%8llu\t%8llu\n", 1u << DurationHistogramMinExponent,
+            (unsigned long long) atomic_load_explicit(&histogram->shortCounts[0], memory_order_relaxed),
+            (unsigned long long) atomic_load_explicit(&histogram->shortCounts[1], memory_order_relaxed));
+    for (uint32_t index = 0; index < DurationHistogramBinCount; index++)
+    {
+        uint32_t low = atomic_load_explicit(&histogram->bins[0][index], memory_order_relaxed);
+        uint32_t high = atomic_load_explicit(&histogram->bins[1][index], memory_order_relaxed);
+        if (0 == low && 0 == high) { continue; }
+        fprintf(output, "  %6u - %6u\t%8u\t%8u\n", DurationHistogramBinStart(index),
+                DurationHistogramBinStart(index) + DurationHistogramBinWidth(index) - 1, low, high);
+    }
+    fprintf(output, "  >=%10u\t%8llu\t%8llu\n", 1u << DurationHistogramMaxExponent,
+            (unsigned long long) atomic_load_explicit(&histogram->longCounts[0], memory_order_relaxed),
+            (unsigned long long) atomic_load_explicit(&histogram->longCounts[1], memory_order_relaxed));
+
+    DurationHistogramPrintPeaks(histogram, output, DurationHistogramLevelLow, "low");
+    DurationHistogramPrintPeaks(histogram, output, DurationHistogramLevelHigh, "high");
+}
@@ -0,0 +1,111 @@
+#ifndef DurationHistogram_h
+#define DurationHistogram_h
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+/*
+A DurationHistogram counts the durations of all pulses (high) and gaps (low)
+of one GPIO, to see what the transmitters around a receiver actually send:
+the clusters ("peaks") of durations around T, 3T, 4T, 10T, 31T and 40T show
+the real single pulse duration of a remote, and how much its pulses vary,
+from which it suggests the single pulse duration and tolerances to configure
+the receivers with (see COCOReceiverSetSinglePulseDuration() and friends).
+Durations are counted in logarithmic bins, 32 per power of two (each bin is
+about 1.6 - 3% wide), from 32µs to 131ms; shorter and longer durations are
+counted, but not binned. The memory is fixed, feeding an edge takes constant
+time, so the histogram can always be fed.
+Feed it from one thread. Query it from any thread: the counts are read one by
+one, so they may be a few edges apart.
+*/
+
+typedef struct DurationHistogram *DurationHistogramRef;
+
+// which durations to look at
+typedef enum DurationHistogramLevel
+{
+    DurationHistogramLevelLow = 0,  // the gaps, i.e. the time without carrier
+    DurationHistogramLevelHigh = 1, // the pulses of carrier
+    DurationHistogramLevelBoth = 2
+} DurationHistogramLevel;
+
+// a cluster of durations
+typedef struct DurationHistogramPeak
+{
+    uint32_t duration;    // µs, the mean of the durations in the cluster
+    uint32_t minDuration; // µs, the start of the first bin of the cluster
+    uint32_t maxDuration; // µs, the end of the last bin of the cluster
+    uint64_t count;
+} DurationHistogramPeak;
+
+// the maximum number of peaks DurationHistogramGetPeaks() returns
+#define DurationHistogramMaxPeakCount 16
+
+typedef struct DurationHistogramSuggestion
+{
+    uint32_t singlePulseDuration; // µs
+    uint32_t positiveTolerance;   // percentage
+    uint32_t negativeTolerance;   // percentage
+    uint32_t matchedPeakCount;    // the number of multiples a peak was found for
+} DurationHistogramSuggestion;
+
+/*
+Creates a new, empty histogram, or NULL if a histogram could not be created.
+You are responsible for releasing this object using DurationHistogramRelease().
+*/
+DurationHistogramRef DurationHistogramCreate();
+
+/*
+Releases a DurationHistogramRef. This function is safe to call when
+`histogram` is NULL.
+*/
+void DurationHistogramRelease(DurationHistogramRef histogram);
+
+/*
+Feed it the edges of the GPIO: `level` is the level after the edge at
+`timestamp` (µs, e.g. the PIGPIO tick), so the pulse that ended had the other
+level. The first edge, and an edge to the level that the GPIO already had
+(i.e. an edge was missed), only start a new pulse.
+*/
+void DurationHistogramFeedEdge(DurationHistogramRef histogram, uint32_t timestamp, uint32_t level);
+
+/*
+Counts one duration of `level` (low or high).
+*/
+void DurationHistogramAddDuration(DurationHistogramRef histogram, DurationHistogramLevel level, uint32_t duration);
+
+// the number of durations counted, including the ones outside the bins
+uint64_t DurationHistogramGetCount(DurationHistogramRef histogram, DurationHistogramLevel level);
+
+void DurationHistogramReset(DurationHistogramRef histogram);
+
+/*
+Finds the clusters of durations of `level`: runs of bins that each hold more
+than 0.2% of all durations (and at least 2), which ignores the random
+durations of noise. Writes at most `maxPeakCount` peaks to `peaks`, in order
+of duration, and returns the number written.
+*/
+uint32_t DurationHistogramGetPeaks(DurationHistogramRef histogram, DurationHistogramLevel level,
+                                   DurationHistogramPeak * peaks, uint32_t maxPeakCount);
+
+/*
+Suggests the settings of a receiver for a protocol whose durations are the
+`multiples` (e.g. 1, 4, 10 and 40 for COCO) of a single pulse duration of about
+`nominalPulseDuration` µs. The single pulse duration is the mean of the
+largest peak within 40% of `nominalPulseDuration`; the tolerances are the
+largest deviation of the peaks found within 20% of the multiples of it, plus
+a 5% margin. Returns false if no peak was found near `nominalPulseDuration`.
+*/
+bool DurationHistogramSuggestTolerances(DurationHistogramRef histogram, uint32_t nominalPulseDuration,
+                                        const uint32_t * multiples, uint32_t multipleCount,
+                                        DurationHistogramSuggestion * suggestion);
+
+/*
+Prints the non-empty bins, with the number of low and high durations in each,
+followed by the peaks of both levels.
+*/
+void DurationHistogramPrint(DurationHistogramRef histogram, FILE * output);
+
+#endif
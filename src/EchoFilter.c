@@ -0,0 +1,141 @@
+#include <stdio.h>
+#include <assert.h>
+#include <pthread.h>
+#include "EchoFilter.h"
+
+// the number of recent transmissions that are remembered. Messages are sent
+// one after the other, so only the last few can still produce echoes.
+#define EchoFilterTransmissionCount 8
+
+struct EchoFilterTransmission
+{
+    EchoFilterProtocol protocol;
+    uint64_t code;
+    uint32_t startTime;
+    uint32_t endTime;
+    bool inProgress;
+    bool valid;
+};
+
+struct EchoFilter
+{
+    uint32_t guardPeriod; // µicro seconds
+    uint32_t echoCount;
+
+    // for internal use
+    //
+    struct EchoFilterTransmission transmissions[EchoFilterTransmissionCount];
+    uint32_t transmissionsIndex; // index of the most recent transmission
+    pthread_mutex_t lock;
+};
+
+EchoFilterRef EchoFilterCreate()
+{
+    EchoFilterRef newFilter = malloc(sizeof(struct EchoFilter));
+    if (NULL != newFilter)
+    {
+        newFilter->guardPeriod = 100000;
+        newFilter->echoCount = 0;
+        newFilter->transmissionsIndex = 0;
+        for (uint32_t index = 0; index < EchoFilterTransmissionCount; index++)
+        {
+            newFilter->transmissions[index].valid = false;
+            newFilter->transmissions[index].inProgress = false;
+        }
+        pthread_mutex_init(&newFilter->lock, NULL);
+    }
+    return newFilter;
+}
+
+void EchoFilterRelease(EchoFilterRef filter)
+{
+    if (NULL != filter)
+    {
+        pthread_mutex_destroy(&filter->lock);
+        free(filter);
+    }
+}
+
+void EchoFilterTransmissionBegan(EchoFilterRef filter,
+                                 EchoFilterProtocol protocol,
+                                 uint64_t code,
+                                 uint32_t timestamp)
+{
+    assert(NULL != filter);
+
+    pthread_mutex_lock(&filter->lock);
+    filter->transmissionsIndex = (filter->transmissionsIndex + 1) % EchoFilterTransmissionCount;
+    struct EchoFilterTransmission *transmission = &filter->transmissions[filter->transmissionsIndex];
+    transmission->protocol = protocol;
+    transmission->code = code;
+    transmission->startTime = timestamp;
+    transmission->endTime = timestamp;
+    transmission->inProgress = true;
+    transmission->valid = true;
+    pthread_mutex_unlock(&filter->lock);
+}
+
+void EchoFilterTransmissionEnded(EchoFilterRef filter, uint32_t timestamp)
+{
+    assert(NULL != filter);
+
+    pthread_mutex_lock(&filter->lock);
+    struct EchoFilterTransmission *transmission = &filter->transmissions[filter->transmissionsIndex];
+    if (transmission->valid && transmission->inProgress)
+    {
+        transmission->endTime = timestamp;
+        transmission->inProgress = false;
+    }
+    pthread_mutex_unlock(&filter->lock);
+}
+
+bool EchoFilterIsEcho(EchoFilterRef filter,
+                      EchoFilterProtocol protocol,
+                      uint64_t code,
+                      uint32_t timestamp)
+{
+    assert(NULL != filter);
+
+    bool isEcho = false;
+    pthread_mutex_lock(&filter->lock);
+    for (uint32_t index = 0; index < EchoFilterTransmissionCount && !isEcho; index++)
+    {
+        struct EchoFilterTransmission *transmission = &filter->transmissions[index];
+        if (!transmission->valid ||
+            transmission->protocol != protocol ||
+            transmission->code != code)
+        { continue; }
+
+        // timestamps wrap around every ~72 minutes, so compare differences
+        // instead of absolute values
+        int32_t sinceStart = (int32_t) (timestamp - transmission->startTime);
+        int32_t sinceEnd = (int32_t) (timestamp - transmission->endTime);
+        if (sinceStart >= 0 &&
+            (transmission->inProgress || sinceEnd <= (int32_t) filter->guardPeriod))
+        {
+            isEcho = true;
+        }
+    }
+    if (isEcho) { filter->echoCount += 1; }
+    pthread_mutex_unlock(&filter->lock);
+
+    return isEcho;
+}
+
+void EchoFilterSetGuardPeriod(EchoFilterRef filter, uint32_t guardPeriod)
+{
+    assert(NULL != filter);
+    filter->guardPeriod = guardPeriod;
+}
+
+uint32_t EchoFilterGetGuardPeriod(EchoFilterRef filter)
+{
+    assert(NULL != filter);
+    return filter->guardPeriod;
+}
+
+uint32_t EchoFilterGetEchoCount(EchoFilterRef filter)
+{
+    assert(NULL != filter);
+    return filter->echoCount;
+}
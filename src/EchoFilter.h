@@ -0,0 +1,78 @@
+#ifndef EchoFilter_h
+#define EchoFilter_h
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+
+/*
+An EchoFilter remembers the codes this program transmitted recently, so that
+a receiver listening in the same process (and the same 433MHz band) can
+recognise its own transmissions when they are decoded.
+All timestamps are expressed in microseconds on the same timeline as the
+timestamps fed to the receivers (i.e. the PIGPIO `tick`, see gpioTick()).
+All functions are safe to call from multiple threads: typically the sending
+thread marks transmissions, while the PIGPIO callback thread queries.
+*/
+
+typedef struct EchoFilter *EchoFilterRef;
+
+typedef enum EchoFilterProtocol
+{
+    EchoFilterProtocolCOCO = 1,
+    EchoFilterProtocolKFS = 2
+} EchoFilterProtocol;
+
+/*
+Creates a new EchoFilter, or NULL if a filter could not be created. You are
+responsible for releasing this object using EchoFilterRelease().
+*/
+EchoFilterRef EchoFilterCreate();
+
+/*
+Releases an EchoFilterRef. This function is safe to call when `filter` is NULL.
+*/
+void EchoFilterRelease(EchoFilterRef filter);
+
+/*
+Call this right before the first pulse of a message is transmitted.
+`code` identifies the message as it goes out over the air (see
+COCOMessageGetCode() and KFSMessageGetIdentifier()), the same way as for
+EchoFilterIsEcho(). Include anything that tells messages apart that the code
+leaves out, such as the dim level of a COCO message, in the bits above it.
+*/
+void EchoFilterTransmissionBegan(EchoFilterRef filter,
+                                 EchoFilterProtocol protocol,
+                                 uint64_t code,
+                                 uint32_t timestamp);
+
+/*
+Call this right after the last pulse of the message that was passed to
+EchoFilterTransmissionBegan() has been transmitted.
+*/
+void EchoFilterTransmissionEnded(EchoFilterRef filter, uint32_t timestamp);
+
+/*
+Returns true if a message with `code` detected at `timestamp` was most likely
+our own transmission: the same code was transmitted during, or up to the guard
+period before, `timestamp`. Each call that returns true increments the echo count.
+*/
+bool EchoFilterIsEcho(EchoFilterRef filter,
+                      EchoFilterProtocol protocol,
+                      uint64_t code,
+                      uint32_t timestamp);
+
+/*
+Defaults to 100000, expressed in microseconds.
+The time after the end of a transmission during which a detected message with
+the same code is still considered an echo. Receivers report a message some time
+after it was received (the KFSReceiver only reports a message when the next
+start-sync arrives), so this should be at least the duration of one message.
+*/
+void EchoFilterSetGuardPeriod(EchoFilterRef filter, uint32_t guardPeriod);
+uint32_t EchoFilterGetGuardPeriod(EchoFilterRef filter);
+
+// the number of times EchoFilterIsEcho() returned true
+uint32_t EchoFilterGetEchoCount(EchoFilterRef filter);
+
+#endif
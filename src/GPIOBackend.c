@@ -0,0 +1,71 @@
+#include <stdio.h>
+#include <assert.h>
+#include "GPIOBackend.h"
+
+int GPIOBackendInitialise(GPIOBackendRef backend)
+{
+    assert(NULL != backend);
+    return backend->initialise(backend);
+}
+
+void GPIOBackendTerminate(GPIOBackendRef backend)
+{
+    assert(NULL != backend);
+    backend->terminate(backend);
+}
+
+void GPIOBackendRelease(GPIOBackendRef backend)
+{
+    if (NULL != backend && NULL != backend->release)
+    {
+        backend->release(backend);
+    }
+}
+
+int GPIOBackendSetOutput(GPIOBackendRef backend, uint32_t gpio)
+{
+    assert(NULL != backend);
+    return backend->setOutput(backend, gpio);
+}
+
+int GPIOBackendWrite(GPIOBackendRef backend, uint32_t gpio, uint32_t level)
+{
+    assert(NULL != backend);
+    return backend->write(backend, gpio, level);
+}
+
+int GPIOBackendSetEdgeFunction(GPIOBackendRef backend, uint32_t gpio, GPIOBackendEdgeFunction function, void * userdata)
+{
+    assert(NULL != backend);
+    return backend->setEdgeFunction(backend, gpio, function, userdata);
+}
+
+int GPIOBackendSetTimerFunction(GPIOBackendRef backend, uint32_t timer, uint32_t millis, GPIOBackendTimerFunction function, void * userdata)
+{
+    assert(NULL != backend);
+    return backend->setTimerFunction(backend, timer, millis, function, userdata);
+}
+
+uint32_t GPIOBackendGetTick(GPIOBackendRef backend)
+{
+    assert(NULL != backend);
+    return backend->tick(backend);
+}
+
+uint64_t GPIOBackendGetTime(GPIOBackendRef backend)
+{
+    assert(NULL != backend);
+    return backend->time(backend);
+}
+
+void GPIOBackendWaitUntil(GPIOBackendRef backend, uint64_t time)
+{
+    assert(NULL != backend);
+    backend->waitUntil(backend, time);
+}
+
+void GPIOBackendSleep(GPIOBackendRef backend, uint32_t duration)
+{
+    assert(NULL != backend);
+    backend->sleep(backend, duration);
+}
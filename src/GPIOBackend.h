@@ -0,0 +1,119 @@
+#ifndef GPIOBackend_h
+#define GPIOBackend_h
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+
+/*
+Set this to `0` (e.g. `gcc -DLPD433PIGPIO=0 ...`) to build without the PIGPIO
+library, for instance on a machine that is not a Raspberry Pi. Only the
+simulated backend is available then.
+*/
+#ifndef LPD433PIGPIO
+    #define LPD433PIGPIO 1
+#endif
+
+/*
+A GPIOBackend is everything this program needs from the hardware: edges on
+input pins, levels on output pins, timers and a time source. The PIGPIO
+backend (see PIGPIOBackend.h) drives the real GPIO pins, the simulated backend
+(see SimulatedGPIOBackend.h) runs on a virtual clock and can loop output pins
+back to input pins, so that senders and receivers can be run anywhere, faster
+than real time.
+A backend is a table of functions, call them through the GPIOBackend...()
+functions below. GPIO numbers are PIGPIO (Broadcom) numbers.
+*/
+
+typedef struct GPIOBackend *GPIOBackendRef;
+
+/*
+Called for every level change of an input pin. `tick` is the time of the edge
+in microseconds, as returned by GPIOBackendGetTick(). Same signature as
+PIGPIO's `gpioAlertFuncEx_t`.
+*/
+typedef void (*GPIOBackendEdgeFunction)(int gpio, int level, uint32_t tick, void * userdata);
+
+// the `level` of a call without an edge, when a watchdog timed out (PIGPIO's
+// PI_TIMEOUT)
+#define GPIOBackendLevelTimeout 2
+
+typedef void (*GPIOBackendTimerFunction)(void * userdata);
+
+struct GPIOBackend
+{
+    const char * name;
+    void * state; // for use by the backend
+
+    // all functions returning int return 0 on succes, and a negative number
+    // on failure
+    int (*initialise)(GPIOBackendRef backend);
+    void (*terminate)(GPIOBackendRef backend);
+    void (*release)(GPIOBackendRef backend);
+
+    int (*setOutput)(GPIOBackendRef backend, uint32_t gpio);
+    int (*write)(GPIOBackendRef backend, uint32_t gpio, uint32_t level);
+    int (*setEdgeFunction)(GPIOBackendRef backend, uint32_t gpio, GPIOBackendEdgeFunction function, void * userdata);
+    int (*setTimerFunction)(GPIOBackendRef backend, uint32_t timer, uint32_t millis, GPIOBackendTimerFunction function, void * userdata);
+
+    uint32_t (*tick)(GPIOBackendRef backend);
+    uint64_t (*time)(GPIOBackendRef backend);
+    void (*waitUntil)(GPIOBackendRef backend, uint64_t time);
+    void (*sleep)(GPIOBackendRef backend, uint32_t duration);
+};
+
+/*
+Initialises the backend. Returns a negative number if this failed, in which
+case the backend can not be used.
+*/
+int GPIOBackendInitialise(GPIOBackendRef backend);
+
+/*
+Stops all timers and edge functions, and releases the hardware.
+*/
+void GPIOBackendTerminate(GPIOBackendRef backend);
+
+/*
+Releases a backend that was created by one of the ...BackendCreate()
+functions. This function is safe to call when `backend` is NULL.
+*/
+void GPIOBackendRelease(GPIOBackendRef backend);
+
+/*
+Configures `gpio` as an output, and sets its level.
+*/
+int GPIOBackendSetOutput(GPIOBackendRef backend, uint32_t gpio);
+int GPIOBackendWrite(GPIOBackendRef backend, uint32_t gpio, uint32_t level);
+
+/*
+Configures `gpio` as an input, and calls `function` for every level change.
+Pass NULL to stop receiving edges. The function is called on a thread of the
+backend (PIGPIO), or on the thread that caused the edge (simulated).
+*/
+int GPIOBackendSetEdgeFunction(GPIOBackendRef backend, uint32_t gpio, GPIOBackendEdgeFunction function, void * userdata);
+
+/*
+Calls `function` every `millis` milliseconds. `timer` (0 - 9) identifies the
+timer, pass NULL as `function` to cancel it.
+*/
+int GPIOBackendSetTimerFunction(GPIOBackendRef backend, uint32_t timer, uint32_t millis, GPIOBackendTimerFunction function, void * userdata);
+
+/*
+The current time in microseconds. The tick wraps around every ~72 minutes,
+the time does not.
+*/
+uint32_t GPIOBackendGetTick(GPIOBackendRef backend);
+uint64_t GPIOBackendGetTime(GPIOBackendRef backend);
+
+/*
+Returns at GPIOBackendGetTime() `time`, as accurately as possible (e.g. by
+busy waiting). Used to time pulses.
+*/
+void GPIOBackendWaitUntil(GPIOBackendRef backend, uint64_t time);
+
+/*
+Returns after at least `duration` microseconds, without using the CPU.
+*/
+void GPIOBackendSleep(GPIOBackendRef backend, uint32_t duration);
+
+#endif
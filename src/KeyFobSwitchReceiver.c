@@ -7,6 +7,7 @@
 #include <assert.h>
 #include "KeyFobSwitchReceiver.h"
 #include "PulseRecorder.h"
+#include "Tracepoints.h"
 
 #if KFSRDebugLogging
     #define DebugLog(format, ...) printf(format, ## __VA_ARGS__)
@@ -41,16 +42,29 @@ const uint32_t KFSPulsesShort = 1;
 // the length of a long start sync pulse, expressed in number of singlepulseDuration
 const uint32_t KFSStartSyncLowPulsesCount = 31;
 
+// whether a pulse was high (carrier) or low (no carrier). Durations fed 
+// without a level are `unknown`, and are never checked.
+typedef enum KFSPulseLevel
+{
+    KFSPulseLevelUnknown = -1,
+    KFSPulseLevelLow = 0,
+    KFSPulseLevelHigh = 1
+} KFSPulseLevel;
+
 struct KFSMessage 
 {
     uint32_t identifier;
     uint8_t  identifierBitSize;
     uint32_t timestamp;
+    uint32_t startTimestamp; // timestamp of the end of the start-sync
+    uint32_t endTimestamp;   // timestamp of the start-sync that ended the message
+    uint8_t  quality; // 0 - 100
 };
 
 struct KFSReceiver 
 {
     KFSMessageDetected callback;
+    void * context;
 
     uint32_t repeatCount;       // count of repeated detections of a KFSMessage that should trigger a callback
     uint32_t refractoryPeriod;  // seconds
@@ -58,6 +72,7 @@ struct KFSReceiver
     uint32_t positiveTolerance; // percentage, e.g. 40 means 40%
     uint32_t negativeTolerance; // percentage, e.g. 40 means 40%
     uint32_t singlePulseDuration; // µicro seconds
+    bool inverted;
 
     uint32_t timestamp; // timestamp of the end of the long part of the start-sync 
     uint32_t lastTimestamp;
@@ -77,6 +92,15 @@ struct KFSReceiver
     uint32_t previousMessageIdentifier;
     uint32_t previousIdentifierBitSize;
 
+    // only used when levels are fed: the level after the last edge (-1 before
+    // the first edge), and whether the stored durations started with a 
+    // start-sync and all had the level expected at their index
+    int32_t lastLevel;
+    bool synchronised;
+    _Atomic uint32_t polarityErrorCount;
+
+    struct ReceiverCounters counters;
+
     PulseRecorderRef pulseRecorder;
 };
 
@@ -86,6 +110,24 @@ uint32_t KFSMessageGetIdentifier(KFSMessageRef message)
     return message->identifier;
 }
 
+uint8_t KFSMessageGetQuality(KFSMessageRef message)
+{
+    assert(NULL != message);
+    return message->quality;
+}
+
+uint32_t KFSMessageGetStartTimestamp(KFSMessageRef message)
+{
+    assert(NULL != message);
+    return message->startTimestamp;
+}
+
+uint32_t KFSMessageGetEndTimestamp(KFSMessageRef message)
+{
+    assert(NULL != message);
+    return message->endTimestamp;
+}
+
 void KFSMessageSetIdentifier(KFSMessageRef message, uint32_t identifier)
 {
     assert(NULL != message);
@@ -125,6 +167,7 @@ KFSReceiverRef KFSReceiverCreate()
         newReceiver->positiveTolerance = 20;
         newReceiver->negativeTolerance = 20;
         newReceiver->singlePulseDuration = 350;
+        newReceiver->inverted = false;
 
         KFSUpdateDurationsForReceiver(newReceiver);
 
@@ -141,11 +184,33 @@ KFSReceiverRef KFSReceiverCreate()
         newReceiver->repeats = 0;
         newReceiver->receivedCode = 0;
         newReceiver->receivedCodeTimestamp = 0;
+        newReceiver->lastLevel = -1;
+        newReceiver->synchronised = false;
+        atomic_init(&newReceiver->polarityErrorCount, 0);
+        ReceiverCountersReset(&newReceiver->counters);
+
+        newReceiver->callback = NULL;
+        newReceiver->context = NULL;
+        newReceiver->pulseRecorder = NULL;
 
     }
     return newReceiver;
 }
 
+// counts and traces a frame that was rejected
+void KFSReceiverReject(KFSReceiverRef receiver, ReceiverRejectReason reason, uint32_t bitIndex)
+{
+    ReceiverCountersCountReject(&receiver->counters, reason, bitIndex);
+    LPD433Trace3(kfs_frame_reject, receiver, reason, bitIndex);
+}
+
+// the deviation of `duration` from `nominalDuration`, in percent
+uint32_t KFSPulseDeviation(uint32_t duration, uint32_t nominalDuration)
+{
+    uint32_t difference = duration > nominalDuration ? duration - nominalDuration : nominalDuration - duration;
+    return difference * 100 / nominalDuration;
+}
+
 bool arePulsesValidCode(KFSReceiverRef receiver, uint32_t timestamp, KFSMessageRef message)
 { 
     assert(NULL != receiver);
@@ -154,6 +219,11 @@ bool arePulsesValidCode(KFSReceiverRef receiver, uint32_t timestamp, KFSMessageR
     uint32_t code = 0;
     uint8_t codeLength = 0;
 
+    // sum of the deviations from the nominal pulse durations, in percent
+    uint32_t deviation = 0;
+    uint32_t shortDuration = receiver->singlePulseDuration * KFSPulsesShort;
+    uint32_t longDuration = receiver->singlePulseDuration * KFSPulsesLong;
+
     // skipping the SYNC
     for (int i = 1; i < receiver->durationsIndex; i+=2)
     {
@@ -162,6 +232,8 @@ bool arePulsesValidCode(KFSReceiverRef receiver, uint32_t timestamp, KFSMessageR
         {
             code <<= 1;
             codeLength += 1;
+            deviation += KFSPulseDeviation(receiver->durations[i], shortDuration) + 
+                         KFSPulseDeviation(receiver->durations[i+1], longDuration);
         }
         else if (receiver->durations[i] > receiver->singlePulseMinDuration * KFSPulsesLong && receiver->durations[i] < receiver->singlePulseMaxDuration *  KFSPulsesLong &&
             receiver->durations[i+1] > receiver->singlePulseMinDuration * KFSPulsesShort && receiver->durations[i+1] < receiver->singlePulseMaxDuration * KFSPulsesShort)
@@ -169,6 +241,8 @@ bool arePulsesValidCode(KFSReceiverRef receiver, uint32_t timestamp, KFSMessageR
             code <<= 1;
             code |= 1;
             codeLength += 1;
+            deviation += KFSPulseDeviation(receiver->durations[i], longDuration) + 
+                         KFSPulseDeviation(receiver->durations[i+1], shortDuration);
         }
         else
         {
@@ -187,6 +261,9 @@ bool arePulsesValidCode(KFSReceiverRef receiver, uint32_t timestamp, KFSMessageR
         message->identifierBitSize = codeLength;
         message->timestamp = timestamp;
 
+        uint32_t averageDeviation = deviation / (codeLength * KFSPulsesPerBit);
+        message->quality = (uint8_t) (averageDeviation >= 100 ? 0 : 100 - averageDeviation);
+
         if (NULL != receiver->pulseRecorder)
         {   
             char* description;
@@ -200,6 +277,7 @@ bool arePulsesValidCode(KFSReceiverRef receiver, uint32_t timestamp, KFSMessageR
 
         return true;
     }
+    KFSReceiverReject(receiver, ReceiverRejectReasonCodeLength, codeLength);
     return false;
 }
 
@@ -231,88 +309,180 @@ KFSMessageRef KFSMessageCreate()
         message->identifier = 0;
         message->identifierBitSize = 0;
         message->timestamp = 0;
+        message->startTimestamp = 0;
+        message->endTimestamp = 0;
+        message->quality = 100;
     }
     return message;
 }
 
-void KFSReceiverFeedGPIOValueChangeTime(KFSReceiverRef receiver, uint32_t timestamp)
+KFSMessageRef KFSMessageCreateWithIdentifier(uint32_t identifier, uint8_t identifierBitSize, uint8_t quality,
+                                             uint32_t startTimestamp, uint32_t endTimestamp)
 {
-    //  timestamp in microseconds:
-    uint32_t duration = timestamp - receiver->lastTimestamp;
-
-    if (0 == receiver->lastTimestamp)
+    KFSMessageRef message = KFSMessageCreate();
+    if (NULL != message)
     {
-        // first callback, no actual duration yet
-        receiver->lastTimestamp = timestamp;
-        return;
+        message->identifier = identifier;
+        message->identifierBitSize = identifierBitSize;
+        message->timestamp = startTimestamp;
+        message->startTimestamp = startTimestamp;
+        message->endTimestamp = endTimestamp;
+        message->quality = quality;
     }
+    return message;
+}
 
-    if (duration > receiver->startSyncLowMinDuration &&
-        duration < receiver->startSyncLowMaxDuration)
+// the bit that the duration at `durationsIndex` is part of; index 0 is the
+// start-sync
+uint32_t KFSBitIndex(uint32_t durationsIndex)
+{
+    return (0 == durationsIndex) ? 0 : (durationsIndex - 1) / KFSPulsesPerBit;
+}
+
+// analyses the durations collected since the start-sync at `startTimestamp`,
+// as a message that ended at `endTimestamp`. There is no end-sync: the next
+// start-sync, or a silence (see KFSReceiverFeedTimeout()), ends a message.
+void KFSReceiverFinishMessage(KFSReceiverRef receiver, uint32_t startTimestamp, uint32_t endTimestamp)
+{
+    if (receiver->durationsIndex > 0)
     {
-        receiver->startTime = timestamp;
-        
-        // start-sync detected. If we were already collecting durations
-        // let's analyze what we have so far
-        if (receiver->durationsIndex >= KFSMessageMinPulseCount)
-        {
-            KFSMessageRef message = malloc(sizeof(struct KFSMessage));
-            message->identifier = 0;
-            message->identifierBitSize = 0;
-            message->timestamp = 0;
+        ReceiverCountersIncrement(receiver->counters.endSyncCount);
+        if (receiver->durationsIndex < KFSMessageMinPulseCount)
+        { KFSReceiverReject(receiver, ReceiverRejectReasonPulseCount, KFSBitIndex(receiver->durationsIndex)); }
+    }
+    if (receiver->durationsIndex >= KFSMessageMinPulseCount)
+    {
+        ReceiverCountersIncrement(receiver->counters.frameCount);
+        KFSMessageRef message = malloc(sizeof(struct KFSMessage));
+        message->identifier = 0;
+        message->identifierBitSize = 0;
+        message->timestamp = 0;
+        message->startTimestamp = startTimestamp;
+        message->endTimestamp = endTimestamp;
+        message->quality = 0;
 
-            bool messageOwnedByUs = true;
+        bool messageOwnedByUs = true;
 
-            if (arePulsesValidCode(receiver, receiver->startTime, message))
+        if (arePulsesValidCode(receiver, endTimestamp, message))
+        {
+            // code detected
+            ReceiverCountersIncrement(receiver->counters.acceptedCount);
+            LPD433Trace3(kfs_frame_accept, receiver, message->identifier, message->quality);
+            if (message->identifier != 0 &&
+                message->identifier == receiver->previousMessageIdentifier &&
+                message->identifierBitSize == receiver->previousIdentifierBitSize
+                )
             {
-                // code detected
-                if (message->identifier != 0 &&
-                    message->identifier == receiver->previousMessageIdentifier &&
-                    message->identifierBitSize == receiver->previousIdentifierBitSize
-                    )
+                receiver->repeats += 1;
+                ReceiverCountersIncrement(receiver->counters.repeatCount);
+                LPD433Trace3(kfs_repeat, receiver, message->identifier, receiver->repeats);
+                if (receiver->repeats == receiver->repeatCount)
                 {
-                    receiver->repeats += 1;
-                    if (receiver->repeats == receiver->repeatCount)
+                    // only count this as a hit, if the previous hit
+                    // was more than 3 seconds ago (this program was written for
+                    // a doorbell originally, for (dimming) switches, maybe 
+                    // 3-seconds spacing is too much. You might want none, and
+                    // just increase the repeats instead.
+                    if (message->timestamp - receiver->timestampPreviousHit > (receiver->refractoryPeriod * 1000000))
                     {
-                        // only count this as a hit, if the previous hit
-                        // was more than 3 seconds ago (this program was written for
-                        // a doorbell originally, for (dimming) switches, maybe 
-                        // 3-seconds spacing is too much. You might want none, and
-                        // just increase the repeats instead.
-                        if (message->timestamp - receiver->timestampPreviousHit > (receiver->refractoryPeriod * 1000000))
+                        receiver->timestampPreviousHit = message->timestamp;
+                        messageOwnedByUs = false;
+                        receiver->repeats = 0;
+                        receiver->previousMessageIdentifier = 0;
+                        receiver->previousIdentifierBitSize = 0;
+                      
+                        if (NULL != receiver->callback)
                         {
-                            receiver->timestampPreviousHit = message->timestamp;
-                            messageOwnedByUs = false;
-                            receiver->repeats = 0;
-                            receiver->previousMessageIdentifier = 0;
-                            receiver->previousIdentifierBitSize = 0;
-                          
-                            if (NULL != receiver->callback)
-                            {
-                                receiver->callback(receiver, message);
-                            }
+                            ReceiverCountersIncrement(receiver->counters.callbackCount);
+                            // the callback owns the message, it may be gone after the call
+                            uint32_t identifier = message->identifier;
+                            LPD433Trace2(kfs_callback_entry, receiver, identifier);
+                            receiver->callback(receiver, message);
+                            LPD433Trace2(kfs_callback_exit, receiver, identifier);
                         }
                     }
+                    else
+                    {
+                        ReceiverCountersIncrement(receiver->counters.suppressedCount);
+                        LPD433Trace3(kfs_refractory, receiver, message->identifier, message->timestamp - receiver->timestampPreviousHit);
+                    }
                 }
-                else 
-                {
-                    receiver->repeats = 0;
-                }
-                receiver->previousMessageIdentifier = message->identifier;
-                receiver->previousIdentifierBitSize = message->identifierBitSize;
             }
-            if (messageOwnedByUs)
+            else 
             {
-                free(message);
-                message = NULL;
+                // a repeat already matches the previous message, and after a
+                // hit `message` belongs to the callback and stays forgotten
+                receiver->repeats = 0;
+                receiver->previousMessageIdentifier = message->identifier;
+                receiver->previousIdentifierBitSize = message->identifierBitSize;
             }
         }
-        receiver->durationsIndex = 0;
+        if (messageOwnedByUs)
+        {
+            free(message);
+            message = NULL;
+        }
+    }
+    receiver->durationsIndex = 0;
+}
+
+// the pulse that ended at `timestamp`
+void KFSReceiverFeedPulse(KFSReceiverRef receiver, uint32_t timestamp, KFSPulseLevel level)
+{
+    //  timestamp in microseconds:
+    uint32_t duration = timestamp - receiver->lastTimestamp;
+
+    if (0 == receiver->lastTimestamp)
+    {
+        // first callback, no actual duration yet
+        receiver->lastTimestamp = timestamp;
+        return;
+    }
+
+    // the start-sync is low: a high pulse of the same length is not one
+    if (KFSPulseLevelHigh != level &&
+        duration > receiver->startSyncLowMinDuration &&
+        duration < receiver->startSyncLowMaxDuration)
+    {
+        // the previous start-sync started the message that this one ends
+        uint32_t messageStartTime = receiver->startTime;
+        receiver->startTime = timestamp;
+        ReceiverCountersIncrement(receiver->counters.startSyncCount);
+        LPD433Trace3(kfs_start_sync, receiver, timestamp, duration);
+        
+        // start-sync detected. If we were already collecting durations
+        // let's analyze what we have so far: the start-sync ends the message
+        // before it, unless a timeout ended that already.
+        KFSReceiverFinishMessage(receiver, messageStartTime, timestamp);
+        receiver->synchronised = true;
     }
 
     if (receiver->durationsIndex >= KFSMessageMaxPulseCount)
     {
         receiver->durationsIndex = 0;
+        // with levels, only a start-sync starts the next message
+        receiver->synchronised = false;
+    }
+
+    if (KFSPulseLevelUnknown != level)
+    {
+        // the start-sync is at index 0, after which high and low pulses 
+        // alternate. A pulse of the wrong level means an edge was missed (or 
+        // noise added one): drop this message, rather than analysing the
+        // misaligned pulses at the next start-sync.
+        KFSPulseLevel expectedLevel = (0 == receiver->durationsIndex % 2) ? KFSPulseLevelLow : KFSPulseLevelHigh;
+        if (receiver->synchronised && level != expectedLevel)
+        {
+            receiver->synchronised = false;
+            ReceiverCountersIncrement(receiver->polarityErrorCount);
+            KFSReceiverReject(receiver, ReceiverRejectReasonPolarity, KFSBitIndex(receiver->durationsIndex));
+        }
+        if (!receiver->synchronised)
+        {
+            receiver->durationsIndex = 0;
+            receiver->lastTimestamp = timestamp;
+            return;
+        }
     }
 
     receiver->durations[receiver->durationsIndex] = duration;
@@ -321,6 +491,69 @@ void KFSReceiverFeedGPIOValueChangeTime(KFSReceiverRef receiver, uint32_t timest
     receiver->lastTimestamp = timestamp;
 }
 
+void KFSReceiverFeedGPIOValueChangeTime(KFSReceiverRef receiver, uint32_t timestamp)
+{
+    assert(NULL != receiver);
+    ReceiverCountersIncrement(receiver->counters.edgeCount);
+    KFSReceiverFeedPulse(receiver, timestamp, KFSPulseLevelUnknown);
+}
+
+void KFSReceiverFeedGPIOLevelChange(KFSReceiverRef receiver, uint32_t timestamp, uint32_t level)
+{
+    assert(NULL != receiver);
+    ReceiverCountersIncrement(receiver->counters.edgeCount);
+
+    int32_t newLevel = ((0 != level) != receiver->inverted) ? 1 : 0;
+    if (newLevel == receiver->lastLevel)
+    {
+        // no change: an edge in between was missed, so the level (and 
+        // length) of the pulse that ended is unknown
+        receiver->lastTimestamp = timestamp;
+        if (receiver->synchronised)
+        {
+            ReceiverCountersIncrement(receiver->polarityErrorCount);
+            KFSReceiverReject(receiver, ReceiverRejectReasonPolarity, KFSBitIndex(receiver->durationsIndex));
+        }
+        receiver->synchronised = false;
+        receiver->durationsIndex = 0;
+        return;
+    }
+    // the pulse that ended had the other level; before the first edge it is
+    // unknown
+    KFSPulseLevel pulseLevel = (receiver->lastLevel < 0) ? KFSPulseLevelUnknown : 
+                               (1 == receiver->lastLevel) ? KFSPulseLevelHigh : KFSPulseLevelLow;
+    receiver->lastLevel = newLevel;
+    if (KFSPulseLevelUnknown == pulseLevel)
+    {
+        receiver->lastTimestamp = timestamp;
+        return;
+    }
+    KFSReceiverFeedPulse(receiver, timestamp, pulseLevel);
+}
+
+void KFSReceiverFeedTimeout(KFSReceiverRef receiver, uint32_t timestamp)
+{
+    assert(NULL != receiver);
+
+    // a message ends with a short high pulse, after which the line stays low:
+    // a silence longer than the long pulse of a bit can not be part of it.
+    // Only durations that started with a start-sync are a message, the
+    // others are noise the next start-sync would discard.
+    uint32_t silence = timestamp - receiver->lastTimestamp;
+    if (silence <= receiver->singlePulseMaxDuration * KFSPulsesLong ||
+        receiver->durationsIndex < KFSMessageMinPulseCount ||
+        1 == receiver->lastLevel ||
+        receiver->durations[0] <= receiver->startSyncLowMinDuration ||
+        receiver->durations[0] >= receiver->startSyncLowMaxDuration)
+    { return; }
+
+    // the message ended at the last edge. Measured from there, the silence
+    // is a start-sync when the next edge arrives; with levels, nothing but a
+    // start-sync is stored until then.
+    KFSReceiverFinishMessage(receiver, receiver->startTime, receiver->lastTimestamp);
+    if (receiver->lastLevel >= 0) { receiver->synchronised = false; }
+}
+
 void KFSMessageRelease(KFSMessageRef message)
 {
     assert(NULL != message);
@@ -347,6 +580,18 @@ void KFSReceiverSetCallback(KFSReceiverRef receiver, KFSMessageDetected callback
     receiver->callback = callback;
 }
 
+void KFSReceiverSetContext(KFSReceiverRef receiver, void * context)
+{
+    assert(NULL != receiver);
+    receiver->context = context;
+}
+
+void * KFSReceiverGetContext(KFSReceiverRef receiver)
+{
+    assert(NULL != receiver);
+    return receiver->context;
+}
+
 void KFSReceiverSetRepeatCount(KFSReceiverRef receiver, uint32_t repeatCount)
 {
     assert(NULL != receiver);
@@ -363,18 +608,47 @@ void KFSReceiverSetSinglePulseDuration(KFSReceiverRef receiver, uint32_t pulseDu
 {
     assert(NULL != receiver);
     receiver->singlePulseDuration = pulseDuration;
+    KFSUpdateDurationsForReceiver(receiver);
 }
 
 void KFSReceiverSetPositiveTolerance(KFSReceiverRef receiver, uint32_t tolerance)
 {
     assert(NULL != receiver);
     receiver->positiveTolerance = tolerance;
+    KFSUpdateDurationsForReceiver(receiver);
 }
 
 void KFSReceiverSetNegativeTolerance(KFSReceiverRef receiver, uint32_t tolerance)
 {
     assert(NULL != receiver);
     receiver->negativeTolerance = tolerance;
+    KFSUpdateDurationsForReceiver(receiver);
+}
+
+void KFSReceiverSetInverted(KFSReceiverRef receiver, bool inverted)
+{
+    assert(NULL != receiver);
+    receiver->inverted = inverted;
+    receiver->lastLevel = -1;
+    receiver->synchronised = false;
+}
+
+bool KFSReceiverGetInverted(KFSReceiverRef receiver)
+{
+    assert(NULL != receiver);
+    return receiver->inverted;
+}
+
+uint32_t KFSReceiverGetPolarityErrorCount(KFSReceiverRef receiver)
+{
+    assert(NULL != receiver);
+    return atomic_load_explicit(&receiver->polarityErrorCount, memory_order_relaxed);
+}
+
+void KFSReceiverGetStatistics(KFSReceiverRef receiver, ReceiverStatistics * statistics)
+{
+    assert(NULL != receiver);
+    ReceiverCountersGetStatistics(&receiver->counters, statistics);
 }
 
 // Querying the reeiver.
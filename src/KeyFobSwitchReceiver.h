@@ -1,6 +1,7 @@
 #include <stdlib.h>
 #include <inttypes.h>
 #include <stdbool.h>
+#include "ReceiverStatistics.h"
 
 // set this to non-zero to enable extensive printout of received signals
 #define KFSDebugLogging 0
@@ -14,6 +15,23 @@ typedef void (*KFSMessageDetected)(KFSReceiverRef, KFSMessageRef);
 // querying a KFSMessageRef
 uint32_t KFSMessageGetIdentifier(KFSMessageRef message);
 
+/*
+An estimate of how well the received pulses matched the protocol, from 0 (at 
+the edge of the tolerances) to 100 (perfect timing). Use this to pick the best
+of several copies of the same message, e.g. received through different receivers.
+*/
+uint8_t KFSMessageGetQuality(KFSMessageRef message);
+
+/*
+The timestamps (in the time base of the timestamps fed to the receiver) of the
+end of the start-sync of a received message, and of the end of the start-sync
+that followed it, which ended the message (or of its last edge, when a silence
+ended it, see KFSReceiverFeedTimeout()). The time from the first edge to the
+moment the message is handled is how long it took to receive it.
+*/
+uint32_t KFSMessageGetStartTimestamp(KFSMessageRef message);
+uint32_t KFSMessageGetEndTimestamp(KFSMessageRef message);
+
 /*
 Releases a KFSMessageRef. The advantage of using this function over
 free(), is that this function is save when `receiver` is NULL.
@@ -41,6 +59,13 @@ If your callback is never called, try tweaking some of the parameters.
 */
 void KFSReceiverSetCallback(KFSReceiverRef receiver, KFSMessageDetected callback);
 
+/*
+Defaults to NULL. A pointer that is not used by the receiver, so that your
+callback can tell receivers apart (e.g. when listening on several GPIOs).
+*/
+void KFSReceiverSetContext(KFSReceiverRef receiver, void * context);
+void * KFSReceiverGetContext(KFSReceiverRef receiver);
+
 /*
 Every time the GPIO that you are monitoring changes state, call this function 
 the timestammp of that change. 
@@ -50,6 +75,31 @@ set with `gpioSetAlertFunc`.
 */
 void KFSReceiverFeedGPIOValueChangeTime(KFSReceiverRef receiver, uint32_t timestamp);
 
+/*
+Like KFSReceiverFeedGPIOValueChangeTime(), but with the `level` (0 or 1) of
+the GPIO after the change, as PIGPIO passes it to an alert function. Prefer
+this function when the level is known: the start-sync is then only accepted
+when it is low, and every pulse of a message is checked to be high or low as
+the protocol requires. When an edge was missed (the level did not change, or a
+pulse has the wrong level), the message that is being received is dropped at
+once, and the receiver waits for the next start-sync, instead of analysing the
+misaligned pulses.
+Do not mix this function and KFSReceiverFeedGPIOValueChangeTime() on one
+receiver.
+*/
+void KFSReceiverFeedGPIOLevelChange(KFSReceiverRef receiver, uint32_t timestamp, uint32_t level);
+
+/*
+Call this when the GPIO did not change state since the last edge until
+`timestamp`, e.g. from the timeout of a PIGPIO ISR or watchdog. A KFS message
+has no end-sync: without this, a message is only analysed when the start-sync
+of the next one arrives, about 31 pulses later, and the last message of a
+transmission not at all. Once the silence is longer than any pulse of a bit,
+the message is analysed right away.
+Calling this function more than once during the same silence is harmless.
+*/
+void KFSReceiverFeedTimeout(KFSReceiverRef receiver, uint32_t timestamp);
+
 /*
 This value defaults to 1: any identical message coming in this number of repeated times
 will trigger KFSReceiver to call your callback/
@@ -115,6 +165,27 @@ Second and 4th value would need a positive tolerance to be considered valid.
 */
 void KFSReceiverSetNegativeTolerance(KFSReceiverRef receiver, uint32_t tolerance);
 
+/*
+Defaults to false. Set this to true for a receiver module whose output is low
+while it receives a carrier, and high otherwise. Only used by
+KFSReceiverFeedGPIOLevelChange().
+*/
+void KFSReceiverSetInverted(KFSReceiverRef receiver, bool inverted);
+bool KFSReceiverGetInverted(KFSReceiverRef receiver);
+
+/*
+The number of times KFSReceiverFeedGPIOLevelChange() dropped a message that
+was being received, because an edge was missed. Safe to call from any thread.
+*/
+uint32_t KFSReceiverGetPolarityErrorCount(KFSReceiverRef receiver);
+
+/*
+Copies the counters of what this receiver did with the edges it was fed (see
+ReceiverStatistics.h) into `statistics`. Safe to call from any thread, at any
+time.
+*/
+void KFSReceiverGetStatistics(KFSReceiverRef receiver, ReceiverStatistics * statistics);
+
 // Querying the reeiver.
 uint32_t KFSReceiverGetRepeatCount(KFSReceiverRef receiver);
 uint32_t KFSReceiverGetRefractoryPeriod(KFSReceiverRef receiver);
@@ -134,5 +205,13 @@ KFSMessageRef KFSMessageCreate();
 
 void KFSMessageSetIdentifier(KFSMessageRef message, uint32_t identifier);
 
+/*
+Creates a KFSMessageRef for a message that was decoded by something else than
+a KFSReceiver, e.g. a ProtocolEngine. You are responsible for releasing it
+using KFSMessageRelease().
+*/
+KFSMessageRef KFSMessageCreateWithIdentifier(uint32_t identifier, uint8_t identifierBitSize, uint8_t quality,
+                                             uint32_t startTimestamp, uint32_t endTimestamp);
+
 // default is `false`
 void KFSSetRecordReceivedTransmissions(KFSReceiverRef receiver, bool shouldRecord);
@@ -15,10 +15,35 @@ priviliges.
 */
 
 #include <stdio.h>
-#include <pigpio.h>
+#include "GPIOBackend.h"
+#if LPD433PIGPIO
+    #include <pigpio.h>
+#endif
+#include "PIGPIOBackend.h"
+#include "SimulatedGPIOBackend.h"
+#include "CharacterDeviceGPIOBackend.h"
+#include "LoopbackBenchmark.h"
 #include "COCOReceiver.h"
 #include "KeyFobSwitchReceiver.h"
+#include "OregonReceiver.h"
 #include "OOKSender.h"
+#include "EchoFilter.h"
+#include "CommandServer.h"
+#include "DiversityCombiner.h"
+#include "SampleEdgeExtractor.h"
+#include "NotificationPipeReader.h"
+#include "MessageWriter.h"
+#include "MessageDispatcher.h"
+#include "LatencyHistogram.h"
+#include "DurationHistogram.h"
+#include "ProtocolEngine.h"
+#include "DecoderPlugins.h"
+#include "ProtocolFramePool.h"
+#include "OOKEncoder.h"
+#include "BoundedQueue.h"
+#include <signal.h> // SIGINT, SIGTERM
+#include <time.h> // clock_gettime()
+#include <stdatomic.h>
 #include <unistd.h> // sleep()
 #include <string.h> // strcmp()
 #include <ctype.h> // isspace()
@@ -29,11 +54,19 @@ typedef enum Mode
 {
     OperationModeUnknown = 0,
     OperationModerReceiving = 1,
-    OperationModerSending = 2
+    OperationModerSending = 2,
+    OperationModerDuplex = 3,
+    OperationModerDaemon = 4,
+    OperationModerBatch = 5,
+    OperationModerLoopbackBenchmark = 6,
+    OperationModerIngestBenchmark = 7
 } OperationMode;
 
 OperationMode mode = OperationModeUnknown;
 
+// the GPIO pins and time source: PIGPIO, or simulated for the loopback benchmark
+GPIOBackendRef backend = NULL;
+
 // flipped to `false` upon the user hitting <enter>, causing the program to end
 // when in receiver mode
 bool receiving = true; 
@@ -41,291 +74,2383 @@ bool receiving = true;
 // the PIN to use for either receiving or sending
 int PIN = 0;
 
-// the protocol to use when in sending mode (`COCO` or `KFS`)
-char * protocol = NULL;
+// the maximum number of PINs to receive on at the same time
+#define MaxReceivePINCount 8
+
+// how the GPIO edges of the receive PINs get into this program
+typedef enum Ingest
+{
+    IngestAlert = 0,    // an alert function per PIN (gpioSetAlertFuncEx)
+    IngestSamples = 1,  // the raw level samples of all PINs at once (gpioSetGetSamplesFunc)
+    IngestCharacterDevice = 2, // kernel-timestamped edges from the GPIO character device, without PIGPIO
+    IngestISR = 3,      // an interrupt handler per PIN (gpioSetISRFuncEx), no sampling
+    IngestNotify = 4    // the level reports of all PINs, read in blocks from a PIGPIO notification pipe
+} Ingest;
+Ingest ingest = IngestAlert;
+
+// only used with IngestISR: the time without edges after which a message that
+// is being received is finalised, in milliseconds
+uint32_t ISRTimeout = 20;
+
+// only used with IngestAlert and PIGPIO: the time without edges after which a
+// PIGPIO watchdog has the receivers finalise a message, in milliseconds (0: no
+// watchdog). Longer than any pulse of a KFS bit, shorter than its start-sync.
+uint32_t alertWatchdogTimeout = 3;
+
+// only used in receiving mode with `-S SECONDS`: the counters of the receivers
+// are printed every `statisticsInterval` seconds
+uint32_t statisticsInterval = 0;
+
+// only used in receiving mode with `-E`, and in the loopback benchmark with
+// `engine`: the edges of each PIN are decoded by one ProtocolEngine, with the
+// COCO and KFS descriptors, instead of by a COCOReceiver and a KFSReceiver
+bool useProtocolEngine = false;
+
+// the protocols of the ProtocolEngine, set with `-p`
+const ProtocolDescriptor * engineDescriptors[ProtocolEngineMaxProtocolCount] = { &ProtocolDescriptorCOCO, &ProtocolDescriptorKFS };
+uint32_t engineDescriptorCount = 2;
+
+// only used in receiving mode with `Oregon` in the list of `-p`: each PIN
+// feeds its edges to an OregonReceiver too
+bool receiveOregon = false;
+
+// only used with `useProtocolEngine`: the frames of protocols other than COCO
+// and KFS are passed on in frames of this pool, so that receiving them never
+// allocates memory
+#define FramePoolCapacity 256
+ProtocolFramePoolRef framePool = NULL;
+
+// only used in receiving mode with `-H`: the duration histogram of each PIN,
+// its peaks and the single pulse durations and tolerances they suggest are
+// printed on SIGUSR1 and when receiving stops
+bool printDurationHistograms = false;
+
+// only used in receiving and sending mode with `-P DIRECTORY`: the decoder
+// plugins in that directory. When receiving, each PIN feeds its edges to a
+// decoder of each plugin too.
+char * pluginDirectory = NULL;
+PluginLibraryRef pluginLibrary = NULL;
+
+// only used in sending mode with a protocol that parseMessage() does not know
+// (one of a ProtocolDescriptor or of a plugin): the message as given
+char * messageKeyValues = NULL;
+
+// only used in receiving mode with `-o FORMAT`: writes the received messages
+// in a machine-readable format to the standard output, on a thread of its own.
+// Everything else that is printed then goes to `statusOutput`, the standard 
+// error, so that the standard output only holds messages.
+bool hasOutputFormat = false;
+MessageWriterFormat outputFormat = MessageWriterFormatJSON;
+MessageWriterRef messageWriter = NULL;
+FILE * statusOutput = NULL; // stdout, or stderr with an output format
+
+// only used in receiving mode with `-w WORKERS`: received messages are printed
+// or written by a pool of worker threads, instead of on the decoding thread
+uint32_t dispatchWorkerCount = 0;
+MessageDispatcherRef messageDispatcher = NULL;
+
+// set when the receiver modules output low while they receive a carrier
+bool invertedReceivers = false;
+
+// only used in receiving mode: how long it takes from the first edge of a 
+// message until it is handled, in microseconds, in stages:
+// - decode: from the first edge until the receiver's callback
+// - queue: from the last edge until the handler starts (combining and queueing)
+// - handler: printing, writing or broadcasting the message
+// - total: from the first edge until the handler is done
+// Printed on SIGUSR1, and answered to the daemon's LATENCY command.
+LatencyHistogramRef decodeLatency = NULL;
+LatencyHistogramRef queueLatency = NULL;
+LatencyHistogramRef handlerLatency = NULL;
+LatencyHistogramRef totalLatency = NULL;
+_Atomic bool latencyPrintRequested = false;
+
+// only used with IngestCharacterDevice
+const char * characterDevicePath = "/dev/gpiochip0";
+
+// only used with IngestSamples and IngestNotify: finds the edges of all 
+// receive PINs in the samples
+SampleEdgeExtractorRef sampleEdgeExtractor = NULL;
+
+// only used with IngestNotify: the pipe to read, or NULL to open one of this
+// process' PIGPIO
+const char * notificationPipePath = NULL;
+int notificationPipeHandle = -1;
+NotificationPipeReaderRef notificationPipeReader = NULL;
+
+// the PIN to use for sending when in duplex mode (`PIN` is used for receiving)
+int transmitPIN = 0;
+
+// the protocol to use when in sending mode (`COCO` or `KFS`)
+char * protocol = NULL;
+
+// KFS identifier
+uint32_t identifier = 0;
+
+// COCO properties
+uint32_t address = 0;
+bool onOff = 0;
+bool group = 0;
+uint16_t channel = 0;
+int8_t dimLevel = COCOMessageNoDimLevel;
+
+// a PIN to receive on. Each PIN has its own receivers. These are given the 
+// timestamp of GPIO changes and will try and detect messages of a specific 
+// protocol, and callback once such a message is detected.
+struct ReceivePIN
+{
+    int PIN;
+    uint32_t index; // index in `receivePINs`
+    COCOReceiverRef COCOReceiver;
+    KFSReceiverRef KFSReceiver;
+    _Atomic uint32_t edgeCount;
+
+    // edge-gap detection: two edges to the same level mean that the edge in
+    // between was lost
+    int32_t lastLevel; // -1 before the first edge
+    _Atomic uint32_t lostEdgeCount;
+
+    // the durations of all pulses and gaps, with the level of the carrier
+    DurationHistogramRef durationHistogram;
+
+    // only with `useProtocolEngine`: decodes instead of the receivers
+    ProtocolEngineRef protocolEngine;
+
+    // only with `pluginLibrary`: decodes next to the receivers
+    PluginDecoderSetRef pluginDecoders;
+
+    // only with `receiveOregon`: decodes next to the receivers
+    OregonReceiverRef OregonReceiver;
+
+    // of ReceiverSetting: the daemon's CONFIG commands, applied by the thread
+    // that decodes the edges of this PIN, before it feeds the next one
+    BoundedQueueRef pendingSettings;
+};
+
+// a property of the COCO or KFS receivers, set with `CONFIG COCO|KFS key value`
+typedef enum ReceiverSettingKey
+{
+    ReceiverSettingRepeatCount = 0,
+    ReceiverSettingRefractoryPeriod = 1,
+    ReceiverSettingSinglePulseDuration = 2,
+    ReceiverSettingPositiveTolerance = 3,
+    ReceiverSettingNegativeTolerance = 4
+} ReceiverSettingKey;
+
+typedef struct ReceiverSetting
+{
+    bool isCOCO; // or KFS
+    ReceiverSettingKey key;
+    uint32_t value;
+} ReceiverSetting;
+struct ReceivePIN receivePINs[MaxReceivePINCount];
+uint32_t receivePINCount = 0;
+
+// identifies the protocol of a message passed through the combiner
+typedef enum MessageProtocol
+{
+    MessageProtocolCOCO = 1,
+    MessageProtocolKFS = 2,
+    MessageProtocolOregon = 3,
+    MessageProtocolPlugin = 16, // plus the index of the plugin in `pluginLibrary`
+    MessageProtocolFrame = 32   // plus the index of the protocol in the ProtocolEngines, the message is a ProtocolFrame from `framePool`
+} MessageProtocol;
+
+// a frame decoded by a plugin, passed through the combiner
+typedef struct PluginMessage
+{
+    uint32_t pluginIndex;
+    LPD433PluginFrame frame;
+} PluginMessage;
+
+// merges the messages received on all PINs, so that a message that is 
+// received on more than one PIN is only reported once
+DiversityCombinerRef combiner = NULL;
+
+// only used in duplex and daemon mode: remembers what we sent, so that the 
+// receivers' callbacks can recognise our own transmissions
+EchoFilterRef echoFilter = NULL;
+
+// only used in duplex and daemon mode: the sender, which is also fed the 
+// received edges when listen-before-talk is enabled
+OOKSenderRef duplexSender = NULL;
+bool listenBeforeTalk = false;
+
+// only used in daemon mode: accepts commands on `socketPath` and forwards
+// received messages to subscribed clients
+CommandServerRef commandServer = NULL;
+char * socketPath = NULL;
+
+// only used in loopback and ingest benchmark mode
+uint32_t benchmarkMessageCount = 1000;
+uint32_t benchmarkJitter = 0; // µs
+
+// only used in ingest benchmark mode: while `benchmarking`, received messages 
+// are counted instead of printed, and the ticks of all edges are recorded.
+// Written by the benchmark, read by the edge callbacks and the message handlers.
+_Atomic bool benchmarking = false;
+_Atomic uint32_t benchmarkExpectedProtocol = 0; // LoopbackBenchmarkProtocol
+_Atomic uint32_t benchmarkExpectedCode = 0;
+_Atomic uint32_t benchmarkReceivedCount = 0;
+_Atomic uint32_t benchmarkWrongCount = 0;
+_Atomic bool benchmarkReceived = false;
+#define BenchmarkEdgeCount 400
+uint32_t benchmarkEdgeTicks[BenchmarkEdgeCount];
+_Atomic uint32_t benchmarkEdgeTickCount = 0;
+
+// only used in batch mode: the file to read the messages from, or NULL to
+// read from the standard input
+char * batchFilePath = NULL;
+
+// applies the settings that configure() queued for `receivePIN`, on the
+// thread that feeds its receivers
+void applyPendingSettings(struct ReceivePIN * receivePIN)
+{
+    ReceiverSetting setting;
+    while (BoundedQueueTryPop(receivePIN->pendingSettings, &setting))
+    {
+        if (setting.isCOCO)
+        {
+            COCOReceiverRef COCOReceiver = receivePIN->COCOReceiver;
+            switch (setting.key)
+            {
+                case ReceiverSettingRepeatCount:         COCOReceiverSetRepeatCount(COCOReceiver, setting.value); break;
+                case ReceiverSettingRefractoryPeriod:    COCOReceiverSetRefractoryPeriod(COCOReceiver, setting.value); break;
+                case ReceiverSettingSinglePulseDuration: COCOReceiverSetSinglePulseDuration(COCOReceiver, setting.value); break;
+                case ReceiverSettingPositiveTolerance:   COCOReceiverSetPositiveTolerance(COCOReceiver, setting.value); break;
+                case ReceiverSettingNegativeTolerance:   COCOReceiverSetNegativeTolerance(COCOReceiver, setting.value); break;
+            }
+        }
+        else
+        {
+            KFSReceiverRef KFSReceiver = receivePIN->KFSReceiver;
+            switch (setting.key)
+            {
+                case ReceiverSettingRepeatCount:         KFSReceiverSetRepeatCount(KFSReceiver, setting.value); break;
+                case ReceiverSettingRefractoryPeriod:    KFSReceiverSetRefractoryPeriod(KFSReceiver, setting.value); break;
+                case ReceiverSettingSinglePulseDuration: KFSReceiverSetSinglePulseDuration(KFSReceiver, setting.value); break;
+                case ReceiverSettingPositiveTolerance:   KFSReceiverSetPositiveTolerance(KFSReceiver, setting.value); break;
+                case ReceiverSettingNegativeTolerance:   KFSReceiverSetNegativeTolerance(KFSReceiver, setting.value); break;
+            }
+        }
+    }
+}
+
+// `receivePIN` had no edges since the last one until `timestamp`
+void receivePINTimedOut(struct ReceivePIN * receivePIN, uint32_t timestamp)
+{
+    applyPendingSettings(receivePIN);
+    if (NULL != receivePIN->protocolEngine)
+    { ProtocolEngineFeedTimeout(receivePIN->protocolEngine, timestamp); }
+    else
+    {
+        COCOReceiverFeedTimeout(receivePIN->COCOReceiver, timestamp);
+        KFSReceiverFeedTimeout(receivePIN->KFSReceiver, timestamp);
+    }
+    if (NULL != receivePIN->OregonReceiver)
+    { OregonReceiverFeedTimeout(receivePIN->OregonReceiver, timestamp); }
+    if (NULL != receivePIN->pluginDecoders)
+    { PluginDecoderSetFeedTimeout(receivePIN->pluginDecoders, timestamp); }
+}
+
+// GPIOBackend edge function. 
+void gpioValueChanged(int gpio, int level, uint32_t timestamp, void * userdata)
+{
+    struct ReceivePIN * receivePIN = userdata;
+
+    // the watchdog of an alert function, not an edge
+    if (GPIOBackendLevelTimeout == level)
+    {
+        receivePINTimedOut(receivePIN, timestamp);
+        return;
+    }
+    applyPendingSettings(receivePIN);
+
+    // only edges are counted, and fed to the receivers, which check the level
+    // of each pulse
+    if (level > 1) { return; }
+    atomic_fetch_add_explicit(&receivePIN->edgeCount, 1, memory_order_relaxed);
+
+    if (atomic_load_explicit(&benchmarking, memory_order_relaxed))
+    {
+        uint32_t count = atomic_load_explicit(&benchmarkEdgeTickCount, memory_order_relaxed);
+        if (count < BenchmarkEdgeCount)
+        {
+            benchmarkEdgeTicks[count] = timestamp;
+            atomic_store_explicit(&benchmarkEdgeTickCount, count + 1, memory_order_release);
+        }
+    }
+
+    if (level == receivePIN->lastLevel)
+    { atomic_fetch_add_explicit(&receivePIN->lostEdgeCount, 1, memory_order_relaxed); }
+    receivePIN->lastLevel = level;
+    DurationHistogramFeedEdge(receivePIN->durationHistogram, timestamp, (uint32_t) level ^ (invertedReceivers ? 1 : 0));
+    if (NULL != receivePIN->protocolEngine)
+    { ProtocolEngineFeedGPIOLevelChange(receivePIN->protocolEngine, timestamp, (uint32_t) level); }
+    else
+    {
+        COCOReceiverFeedGPIOLevelChange(receivePIN->COCOReceiver, timestamp, (uint32_t) level);
+        KFSReceiverFeedGPIOLevelChange(receivePIN->KFSReceiver, timestamp, (uint32_t) level);
+    }
+    if (NULL != receivePIN->OregonReceiver)
+    { OregonReceiverFeedGPIOLevelChange(receivePIN->OregonReceiver, timestamp, (uint32_t) level); }
+    if (NULL != receivePIN->pluginDecoders)
+    { PluginDecoderSetFeedGPIOLevelChange(receivePIN->pluginDecoders, timestamp, (uint32_t) level); }
+
+    // listen-before-talk needs the edges of one receiver, interleaving the 
+    // edges of several PINs would produce nonsense durations
+    if (NULL != duplexSender && listenBeforeTalk && 0 == receivePIN->index)
+    { OOKSenderFeedGPIOValueChangeTime(duplexSender, timestamp); }
+}
+
+// The code of a COCO message for the EchoFilter and the DiversityCombiner.
+// COCOMessageGetCode() leaves out the dim level (and is the same for `off` and
+// every dim level), so it goes above the 32 bits of the code: 0 for an on/off
+// message, 1 - 16 for dim level 0 - 15.
+uint64_t COCOMessageKey(COCOMessageRef message)
+{
+    return ((uint64_t) (COCOMessageGetDimLevel(message) + 1) << 32) | COCOMessageGetCode(message);
+}
+
+// prints or broadcasts a COCO message that was received on `receivePINs[source]`
+void COCOMessageReceived(COCOMessageRef message, uint32_t source)
+{
+    bool isEcho = (NULL != echoFilter &&
+                   EchoFilterIsEcho(echoFilter, EchoFilterProtocolCOCO, COCOMessageKey(message), GPIOBackendGetTick(backend)));
+
+    if (NULL != commandServer)
+    {
+        char dimLevelField[24] = "";
+        if (COCOMessageNoDimLevel != COCOMessageGetDimLevel(message))
+        { snprintf(dimLevelField, sizeof(dimLevelField), " dimLevel %i", COCOMessageGetDimLevel(message)); }
+        CommandServerBroadcast(commandServer, "COCO address %u group %i onOff %i channel %u%s PIN %i%s",
+            COCOMessageGetAddress(message),
+            COCOMessageGetGroup(message),
+            COCOMessageGetOnOff(message),
+            COCOMessageGetChannel(message),
+            dimLevelField,
+            receivePINs[source].PIN,
+            isEcho ? " echo" : "");
+        COCOMessageRelease(message);
+        return;
+    }
+
+    if (NULL != messageWriter)
+    {
+        MessageWriterRecord record;
+        record.time = MessageWriterGetTime();
+        record.code = COCOMessageGetCode(message);
+        record.protocol = MessageWriterProtocolCOCO;
+        record.dimLevel = COCOMessageGetDimLevel(message);
+        record.quality = COCOMessageGetQuality(message);
+        record.PIN = (uint8_t) receivePINs[source].PIN;
+        record.isEcho = isEcho;
+        MessageWriterSubmit(messageWriter, &record);
+        COCOMessageRelease(message);
+        return;
+    }
+
+    char dimLevelLine[64] = "";
+    if (COCOMessageNoDimLevel != COCOMessageGetDimLevel(message))
+    { snprintf(dimLevelLine, sizeof(dimLevelLine), "║ dim level:\t%8i ║\n", COCOMessageGetDimLevel(message)); }
+
+    char PINLine[64] = "";
+    if (receivePINCount > 1)
+    { snprintf(PINLine, sizeof(PINLine), "║ PIN:\t\t%8i ║\n", receivePINs[source].PIN); }
+
+    // a COCO message was detected
+    printf("\n╔═════ COCO Message ═════╗\n║ address:\t%8lu ║\n║ group:\t%8i ║\n║ onOff:\t%8i ║\n║ channel:\t%8i ║\n%s%s%s╚════════════════════════╝\n", 
+        COCOMessageGetAddress(message),
+        COCOMessageGetGroup(message),
+        COCOMessageGetOnOff(message),
+        COCOMessageGetChannel(message),
+        dimLevelLine,
+        PINLine,
+        isEcho ? "║ (echo of own message)  ║\n" : "");
+
+    COCOMessageRelease(message);
+}
+
+// prints or broadcasts a KFS message that was received on `receivePINs[source]`
+void KFSMessageReceived(KFSMessageRef message, uint32_t source)
+{
+    bool isEcho = (NULL != echoFilter &&
+                   EchoFilterIsEcho(echoFilter, EchoFilterProtocolKFS, KFSMessageGetIdentifier(message), GPIOBackendGetTick(backend)));
+
+    if (NULL != commandServer)
+    {
+        CommandServerBroadcast(commandServer, "KFS identifier %u PIN %i%s",
+            KFSMessageGetIdentifier(message),
+            receivePINs[source].PIN,
+            isEcho ? " echo" : "");
+        KFSMessageRelease(message);
+        return;
+    }
+
+    if (NULL != messageWriter)
+    {
+        MessageWriterRecord record;
+        record.time = MessageWriterGetTime();
+        record.code = KFSMessageGetIdentifier(message);
+        record.protocol = MessageWriterProtocolKFS;
+        record.dimLevel = COCOMessageNoDimLevel;
+        record.quality = KFSMessageGetQuality(message);
+        record.PIN = (uint8_t) receivePINs[source].PIN;
+        record.isEcho = isEcho;
+        MessageWriterSubmit(messageWriter, &record);
+        KFSMessageRelease(message);
+        return;
+    }
+
+    char PINLine[64] = "";
+    if (receivePINCount > 1)
+    { snprintf(PINLine, sizeof(PINLine), "║ PIN:\t\t%8i ║\n", receivePINs[source].PIN); }
+
+    // a KFSR message was detected
+    printf("\n╔════ KeyFob Message ════╗\n║ identifier:\t%8lu ║\n%s%s╚════════════════════════╝\n", 
+        KFSMessageGetIdentifier(message),
+        PINLine,
+        isEcho ? "║ (echo of own message)  ║\n" : "");
+
+    KFSMessageRelease(message);
+}
+
+// prints or broadcasts a message of an Oregon Scientific sensor that was received on `receivePINs[source]`
+void OregonMessageReceived(OregonMessageRef message, uint32_t source)
+{
+    char text[MessageWriterMaxTextLength];
+    OregonMessageFormat(message, text, sizeof(text));
+
+    if (NULL != commandServer)
+    { CommandServerBroadcast(commandServer, "%s PIN %i", text, receivePINs[source].PIN); }
+    else if (NULL != messageWriter)
+    {
+        MessageWriterRecord record;
+        record.time = MessageWriterGetTime();
+        record.code = OregonMessageGetCode(message);
+        record.protocol = MessageWriterProtocolOregon;
+        record.dimLevel = COCOMessageNoDimLevel;
+        record.quality = OregonMessageGetQuality(message);
+        record.PIN = (uint8_t) receivePINs[source].PIN;
+        record.isEcho = false;
+        memcpy(record.text, text, sizeof(record.text));
+        record.oregon.sensorName = OregonMessageGetSensorName(message);
+        record.oregon.temperature = OregonMessageGetTemperature(message);
+        record.oregon.channel = OregonMessageGetChannel(message);
+        record.oregon.rollingCode = OregonMessageGetRollingCode(message);
+        record.oregon.humidity = OregonMessageGetHumidity(message);
+        record.oregon.hasHumidity = OregonMessageHasHumidity(message);
+        record.oregon.batteryLow = OregonMessageGetBatteryLow(message);
+        MessageWriterSubmit(messageWriter, &record);
+    }
+    else
+    {
+        if (receivePINCount > 1) { printf("\n%s (PIN %i)\n", text, receivePINs[source].PIN); }
+        else { printf("\n%s\n", text); }
+    }
+    OregonMessageRelease(message);
+}
+
+// prints or broadcasts a message of a plugin that was received on `receivePINs[source]`
+void pluginMessageReceived(PluginMessage * message, uint32_t source)
+{
+    const LPD433Plugin * plugin = PluginLibraryGetPlugin(pluginLibrary, message->pluginIndex);
+    char text[MessageWriterMaxTextLength];
+    if (plugin->format(&message->frame, text, sizeof(text)) < 0)
+    { snprintf(text, sizeof(text), "%s [code %llu]", plugin->name, (unsigned long long) message->frame.code); }
+
+    if (NULL != commandServer)
+    { CommandServerBroadcast(commandServer, "%s PIN %i", text, receivePINs[source].PIN); }
+    else if (NULL != messageWriter)
+    {
+        MessageWriterRecord record;
+        record.time = MessageWriterGetTime();
+        record.code = (uint32_t) message->frame.code;
+        record.protocol = MessageWriterProtocolPlugin;
+        record.dimLevel = COCOMessageNoDimLevel;
+        record.quality = message->frame.quality;
+        record.PIN = (uint8_t) receivePINs[source].PIN;
+        record.isEcho = false;
+        memcpy(record.text, text, sizeof(record.text));
+        // the plugins stay loaded until after the writer was released
+        record.plugin.name = plugin->name;
+        record.plugin.code = message->frame.code;
+        MessageWriterSubmit(messageWriter, &record);
+    }
+    else
+    {
+        if (receivePINCount > 1) { printf("\n%s (PIN %i)\n", text, receivePINs[source].PIN); }
+        else { printf("\n%s\n", text); }
+    }
+    free(message);
+}
+
+// prints or broadcasts a frame of the ProtocolEngine that was received on `receivePINs[source]`
+void frameMessageReceived(ProtocolFrame * frame, uint32_t source)
+{
+    char text[MessageWriterMaxTextLength];
+    ProtocolFrameFormat(frame, text, sizeof(text));
+
+    if (NULL != commandServer)
+    { CommandServerBroadcast(commandServer, "%s PIN %i", text, receivePINs[source].PIN); }
+    else if (NULL != messageWriter)
+    {
+        MessageWriterRecord record;
+        record.time = MessageWriterGetTime();
+        record.code = (uint32_t) frame->code;
+        record.protocol = MessageWriterProtocolFrame;
+        record.dimLevel = COCOMessageNoDimLevel;
+        record.quality = frame->quality;
+        record.PIN = (uint8_t) receivePINs[source].PIN;
+        record.isEcho = false;
+        memcpy(record.text, text, sizeof(record.text));
+        record.frame.descriptor = frame->descriptor;
+        record.frame.code = frame->code;
+        record.frame.bitCount = frame->bitCount;
+        MessageWriterSubmit(messageWriter, &record);
+    }
+    else
+    {
+        if (receivePINCount > 1) { printf("\n%s (PIN %i)\n", text, receivePINs[source].PIN); }
+        else { printf("\n%s\n", text); }
+    }
+    ProtocolFramePoolReturn(framePool, frame);
+}
+
+void releaseCOCOMessage(void * message) { COCOMessageRelease(message); }
+void releaseKFSMessage(void * message) { KFSMessageRelease(message); }
+void releaseOregonMessage(void * message) { OregonMessageRelease(message); }
+void releasePluginMessage(void * message) { free(message); }
+void releaseFrameMessage(void * message) { ProtocolFramePoolReturn(framePool, message); }
+
+void releaseMessage(uint32_t protocol, void * message)
+{
+    if (MessageProtocolCOCO == protocol) { COCOMessageRelease(message); }
+    else if (MessageProtocolKFS == protocol) { KFSMessageRelease(message); }
+    else if (MessageProtocolOregon == protocol) { OregonMessageRelease(message); }
+    else if (protocol >= MessageProtocolFrame) { releaseFrameMessage(message); }
+    else { free(message); }
+}
+
+// handles a message, and records how long it took to get here and to handle it
+void messageReceived(uint32_t protocol, void * message, uint32_t source)
+{
+    // the handlers release the message
+    uint32_t startTimestamp;
+    uint32_t endTimestamp;
+    if (MessageProtocolCOCO == protocol)
+    {
+        startTimestamp = COCOMessageGetStartTimestamp(message);
+        endTimestamp = COCOMessageGetEndTimestamp(message);
+    }
+    else if (MessageProtocolKFS == protocol)
+    {
+        startTimestamp = KFSMessageGetStartTimestamp(message);
+        endTimestamp = KFSMessageGetEndTimestamp(message);
+    }
+    else if (MessageProtocolOregon == protocol)
+    {
+        startTimestamp = OregonMessageGetStartTimestamp(message);
+        endTimestamp = OregonMessageGetEndTimestamp(message);
+    }
+    else if (protocol >= MessageProtocolFrame)
+    {
+        startTimestamp = ((ProtocolFrame *) message)->startTimestamp;
+        endTimestamp = ((ProtocolFrame *) message)->endTimestamp;
+    }
+    else
+    {
+        startTimestamp = ((PluginMessage *) message)->frame.startTimestamp;
+        endTimestamp = ((PluginMessage *) message)->frame.endTimestamp;
+    }
+
+    uint32_t handlerStart = GPIOBackendGetTick(backend);
+    LatencyHistogramRecord(queueLatency, handlerStart - endTimestamp);
+    if (MessageProtocolCOCO == protocol)
+    { COCOMessageReceived(message, source); }
+    else if (MessageProtocolKFS == protocol)
+    { KFSMessageReceived(message, source); }
+    else if (MessageProtocolOregon == protocol)
+    { OregonMessageReceived(message, source); }
+    else if (protocol >= MessageProtocolFrame)
+    { frameMessageReceived(message, source); }
+    else
+    { pluginMessageReceived(message, source); }
+
+    uint32_t handlerEnd = GPIOBackendGetTick(backend);
+    LatencyHistogramRecord(handlerLatency, handlerEnd - handlerStart);
+    LatencyHistogramRecord(totalLatency, handlerEnd - startTimestamp);
+}
+
+// DiversityCombiner callback: the best copy of a message received on one or more PINs
+void combinedMessageReceived(DiversityCombinerRef combiner, uint32_t protocol, void * message, uint32_t source)
+{
+    if (atomic_load_explicit(&benchmarking, memory_order_relaxed))
+    {
+        uint32_t code = (MessageProtocolCOCO == protocol) ? COCOMessageGetCode(message) : 
+                        (MessageProtocolKFS == protocol) ? KFSMessageGetIdentifier(message) : 0;
+        if (protocol == atomic_load_explicit(&benchmarkExpectedProtocol, memory_order_acquire) &&
+            code == atomic_load_explicit(&benchmarkExpectedCode, memory_order_acquire))
+        {
+            if (!atomic_exchange(&benchmarkReceived, true)) { atomic_fetch_add(&benchmarkReceivedCount, 1); }
+        }
+        else { atomic_fetch_add(&benchmarkWrongCount, 1); }
+
+        releaseMessage(protocol, message);
+        return;
+    }
+
+    if (NULL != messageDispatcher)
+    {
+        // the messages of one device are handled in order, by one worker
+        if (MessageProtocolCOCO == protocol)
+        {
+            uint64_t deviceKey = ((uint64_t) MessageProtocolCOCO << 32) | COCOMessageGetAddress(message);
+            MessageDispatcherSubmit(messageDispatcher, protocol, deviceKey, source, message, &releaseCOCOMessage);
+        }
+        else if (MessageProtocolKFS == protocol)
+        {
+            uint64_t deviceKey = ((uint64_t) MessageProtocolKFS << 32) | KFSMessageGetIdentifier(message);
+            MessageDispatcherSubmit(messageDispatcher, protocol, deviceKey, source, message, &releaseKFSMessage);
+        }
+        else if (MessageProtocolOregon == protocol)
+        {
+            // a sensor is its type, channel and rolling code
+            uint64_t deviceKey = ((uint64_t) MessageProtocolOregon << 32) | ((uint32_t) OregonMessageGetSensor(message) << 16) |
+                                 ((uint32_t) OregonMessageGetChannel(message) << 8) | OregonMessageGetRollingCode(message);
+            MessageDispatcherSubmit(messageDispatcher, protocol, deviceKey, source, message, &releaseOregonMessage);
+        }
+        else if (protocol >= MessageProtocolFrame)
+        {
+            uint64_t deviceKey = ((uint64_t) protocol << 32) ^ ((ProtocolFrame *) message)->code;
+            MessageDispatcherSubmit(messageDispatcher, protocol, deviceKey, source, message, &releaseFrameMessage);
+        }
+        else
+        {
+            uint64_t deviceKey = ((uint64_t) protocol << 32) ^ ((PluginMessage *) message)->frame.code;
+            MessageDispatcherSubmit(messageDispatcher, protocol, deviceKey, source, message, &releasePluginMessage);
+        }
+        return;
+    }
+
+    messageReceived(protocol, message, source);
+}
+
+// MessageDispatcher handler: called on one of the worker threads
+void dispatchedMessageReceived(MessageDispatcherRef dispatcher, uint32_t protocol, void * message, uint32_t source, void * context)
+{
+    messageReceived(protocol, message, source);
+}
+
+// SampleEdgeExtractor callback: an edge of a receive PIN was found in the samples
+void sampleEdgeDetected(SampleEdgeExtractorRef extractor, uint32_t gpio, uint32_t level, uint32_t timestamp, void * context)
+{
+    gpioValueChanged((int) gpio, (int) level, timestamp, context);
+}
+
+#if LPD433PIGPIO
+// PIGPIO ISR-callback: an edge, or `ISRTimeout` ms without edges
+void gpioInterruptReceived(int gpio, int level, uint32_t timestamp, void * userdata)
+{
+    struct ReceivePIN * receivePIN = userdata;
+    if (PI_TIMEOUT == level)
+    {
+        receivePINTimedOut(receivePIN, timestamp);
+        return;
+    }
+    gpioValueChanged(gpio, level, timestamp, userdata);
+}
+
+// PIGPIO-callback, with the level samples of all GPIOs of bank 1 since the last call
+void gpioSamplesReceived(const gpioSample_t * samples, int numSamples)
+{
+    // SampleEdgeExtractorSample has the layout of gpioSample_t
+    SampleEdgeExtractorFeedSamples(sampleEdgeExtractor, (const SampleEdgeExtractorSample *) samples, (uint32_t) numSamples);
+}
+#endif
+
+// COCO receiver callback
+void COCOCallback(COCOReceiverRef receiver, COCOMessageRef message)
+{
+    struct ReceivePIN * receivePIN = COCOReceiverGetContext(receiver);
+    uint32_t now = GPIOBackendGetTick(backend);
+    LatencyHistogramRecord(decodeLatency, now - COCOMessageGetStartTimestamp(message));
+    DiversityCombinerSubmit(combiner, MessageProtocolCOCO, COCOMessageKey(message), now,
+                            COCOMessageGetQuality(message), receivePIN->index, message, releaseCOCOMessage);
+}
+
+void KFSCallback(KFSReceiverRef receiver, KFSMessageRef message)
+{
+    struct ReceivePIN * receivePIN = KFSReceiverGetContext(receiver);
+    uint32_t now = GPIOBackendGetTick(backend);
+    LatencyHistogramRecord(decodeLatency, now - KFSMessageGetStartTimestamp(message));
+    DiversityCombinerSubmit(combiner, MessageProtocolKFS, KFSMessageGetIdentifier(message), now,
+                            KFSMessageGetQuality(message), receivePIN->index, message, releaseKFSMessage);
+}
+
+void OregonCallback(OregonReceiverRef receiver, OregonMessageRef message)
+{
+    struct ReceivePIN * receivePIN = OregonReceiverGetContext(receiver);
+    uint32_t now = GPIOBackendGetTick(backend);
+    LatencyHistogramRecord(decodeLatency, now - OregonMessageGetStartTimestamp(message));
+    DiversityCombinerSubmit(combiner, MessageProtocolOregon, OregonMessageGetCode(message), now,
+                            OregonMessageGetQuality(message), receivePIN->index, message, releaseOregonMessage);
+}
+
+// ProtocolEngine callback: the frames become the messages of the receivers
+void protocolFrameDetected(ProtocolEngineRef engine, const ProtocolFrame * frame)
+{
+    struct ReceivePIN * receivePIN = ProtocolEngineGetContext(engine);
+    uint32_t now = GPIOBackendGetTick(backend);
+    LatencyHistogramRecord(decodeLatency, now - frame->startTimestamp);
+    if (&ProtocolDescriptorCOCO == frame->descriptor)
+    {
+        COCOMessageRef message = COCOMessageCreateWithCode((uint32_t) frame->code, frame->quality,
+                                                           frame->startTimestamp, frame->endTimestamp);
+        DiversityCombinerSubmit(combiner, MessageProtocolCOCO, COCOMessageKey(message), now,
+                                frame->quality, receivePIN->index, message, releaseCOCOMessage);
+    }
+    else if (&ProtocolDescriptorKFS == frame->descriptor)
+    {
+        KFSMessageRef message = KFSMessageCreateWithIdentifier((uint32_t) frame->code, (uint8_t) frame->bitCount, frame->quality,
+                                                               frame->startTimestamp, frame->endTimestamp);
+        DiversityCombinerSubmit(combiner, MessageProtocolKFS, KFSMessageGetIdentifier(message), now,
+                                frame->quality, receivePIN->index, message, releaseKFSMessage);
+    }
+    else
+    {
+        // when the pool is empty, the frame is dropped and counted
+        ProtocolFrame * message = ProtocolFramePoolTake(framePool, frame);
+        if (NULL == message) { return; }
+        DiversityCombinerSubmit(combiner, MessageProtocolFrame + frame->protocolIndex, frame->code, now,
+                                frame->quality, receivePIN->index, message, releaseFrameMessage);
+    }
+}
+
+// PluginDecoderSet callback: the frame is copied, to be handled like the
+// messages of the receivers
+void pluginFrameDetected(PluginDecoderSetRef set, uint32_t pluginIndex, const LPD433PluginFrame * frame)
+{
+    struct ReceivePIN * receivePIN = PluginDecoderSetGetContext(set);
+    uint32_t now = GPIOBackendGetTick(backend);
+    LatencyHistogramRecord(decodeLatency, now - frame->startTimestamp);
+
+    PluginMessage * message = malloc(sizeof(PluginMessage));
+    if (NULL == message) { return; }
+    message->pluginIndex = pluginIndex;
+    message->frame = *frame;
+    DiversityCombinerSubmit(combiner, MessageProtocolPlugin + pluginIndex, frame->code, now,
+                            frame->quality, receivePIN->index, message, releasePluginMessage);
+}
+
+// GPIOBackend timer function: passes on the combined messages
+void combinerTimerFired(void * userdata)
+{
+    DiversityCombinerFlush(combiner, GPIOBackendGetTick(backend));
+}
+
+// prints per plugin how many frames its decoder on `receivePIN` reported, and 
+// how much CPU time it used
+void printPluginCounters(struct ReceivePIN * receivePIN)
+{
+    if (NULL == receivePIN->pluginDecoders) { return; }
+
+    uint64_t edgeCount = PluginDecoderSetGetEdgeCount(receivePIN->pluginDecoders);
+    for (uint32_t pluginIndex = 0; pluginIndex < PluginLibraryGetPluginCount(pluginLibrary); pluginIndex++)
+    {
+        if (!PluginDecoderSetHasDecoder(receivePIN->pluginDecoders, pluginIndex)) { continue; }
+        uint64_t CPUTime = PluginDecoderSetGetCPUTime(receivePIN->pluginDecoders, pluginIndex);
+        fprintf(statusOutput, "PIN %i plugin %s: edges %llu, frames %llu, CPU time %llu µs (%llu ns per edge)\n",
+                receivePIN->PIN, PluginLibraryGetPlugin(pluginLibrary, pluginIndex)->name,
+                (unsigned long long) edgeCount,
+                (unsigned long long) PluginDecoderSetGetFrameCount(receivePIN->pluginDecoders, pluginIndex),
+                (unsigned long long) CPUTime,
+                (unsigned long long) ((0 == edgeCount) ? 0 : CPUTime * 1000 / edgeCount));
+    }
+}
+
+// prints the counters of the receivers of all PINs, and the edges that were
+// lost on the way to them. Called from a timer, while receiving continues.
+void printReceiverCounters()
+{
+    for (uint32_t index = 0; index < receivePINCount; index++)
+    {
+        struct ReceivePIN * receivePIN = &receivePINs[index];
+        char name[32];
+        ReceiverStatistics statistics;
+
+        fprintf(statusOutput, "PIN %i: edges %u, lost edges %u\n", receivePIN->PIN,
+                atomic_load_explicit(&receivePIN->edgeCount, memory_order_relaxed),
+                atomic_load_explicit(&receivePIN->lostEdgeCount, memory_order_relaxed));
+        if (NULL != receivePIN->OregonReceiver)
+        {
+            OregonReceiverGetStatistics(receivePIN->OregonReceiver, &statistics);
+            snprintf(name, sizeof(name), "PIN %i Oregon:", receivePIN->PIN);
+            ReceiverStatisticsPrint(statusOutput, name, &statistics);
+        }
+        if (NULL != receivePIN->protocolEngine)
+        {
+            for (uint32_t protocolIndex = 0; protocolIndex < ProtocolEngineGetProtocolCount(receivePIN->protocolEngine); protocolIndex++)
+            {
+                ProtocolEngineGetStatistics(receivePIN->protocolEngine, protocolIndex, &statistics);
+                snprintf(name, sizeof(name), "PIN %i %s:", receivePIN->PIN, 
+                         ProtocolEngineGetDescriptor(receivePIN->protocolEngine, protocolIndex)->name);
+                ReceiverStatisticsPrint(statusOutput, name, &statistics);
+            }
+            printPluginCounters(receivePIN);
+            continue;
+        }
+        printPluginCounters(receivePIN);
+        COCOReceiverGetStatistics(receivePIN->COCOReceiver, &statistics);
+        snprintf(name, sizeof(name), "PIN %i COCO:", receivePIN->PIN);
+        ReceiverStatisticsPrint(statusOutput, name, &statistics);
+        KFSReceiverGetStatistics(receivePIN->KFSReceiver, &statistics);
+        snprintf(name, sizeof(name), "PIN %i KFS:", receivePIN->PIN);
+        ReceiverStatisticsPrint(statusOutput, name, &statistics);
+    }
+    if (IngestSamples == ingest && NULL != sampleEdgeExtractor)
+    {
+        fprintf(statusOutput, "Samples: %llu gaps in which samples were lost.\n",
+                (unsigned long long) SampleEdgeExtractorGetGapCount(sampleEdgeExtractor));
+    }
+    fflush(statusOutput);
+}
+
+// GPIOBackend timer function, every `statisticsInterval` seconds
+void statisticsTimerFired(void * userdata)
+{
+    printReceiverCounters();
+}
+
+// writes one line per latency histogram, `lineFunction` is called for each line
+void describeLatencies(void (*lineFunction)(const char * line, void * context), void * context)
+{
+    char line[256];
+    LatencyHistogramFormat(decodeLatency, "receive decode", line, sizeof(line));
+    lineFunction(line, context);
+    LatencyHistogramFormat(queueLatency, "receive queue", line, sizeof(line));
+    lineFunction(line, context);
+    LatencyHistogramFormat(handlerLatency, "receive handler", line, sizeof(line));
+    lineFunction(line, context);
+    LatencyHistogramFormat(totalLatency, "receive total", line, sizeof(line));
+    lineFunction(line, context);
+    if (NULL != duplexSender)
+    {
+        LatencyHistogramFormat(OOKSenderGetStartLatencyHistogram(duplexSender), "send first pulse", line, sizeof(line));
+        lineFunction(line, context);
+        LatencyHistogramFormat(OOKSenderGetCompletionLatencyHistogram(duplexSender), "send completion", line, sizeof(line));
+        lineFunction(line, context);
+    }
+}
+
+// prints the duration histogram of each PIN, and the single pulse durations
+// and tolerances that its peaks suggest for the receivers
+void printDurationHistogramsOfPINs()
+{
+    static const uint32_t COCOMultiples[] = { 1, 4, 10, 40 };
+    static const uint32_t KFSMultiples[] = { 1, 3, 31 };
+
+    for (uint32_t index = 0; index < receivePINCount; index++)
+    {
+        struct ReceivePIN * receivePIN = &receivePINs[index];
+        DurationHistogramSuggestion suggestion;
+
+        fprintf(statusOutput, "PIN %i: %llu durations\n", receivePIN->PIN,
+                (unsigned long long) DurationHistogramGetCount(receivePIN->durationHistogram, DurationHistogramLevelBoth));
+        DurationHistogramPrint(receivePIN->durationHistogram, statusOutput);
+        if (DurationHistogramSuggestTolerances(receivePIN->durationHistogram,
+                                               COCOReceiverGetSinglePulseDuration(receivePIN->COCOReceiver),
+                                               COCOMultiples, sizeof(COCOMultiples) / sizeof(COCOMultiples[0]), &suggestion))
+        {
+            fprintf(statusOutput, "PIN %i COCO: single pulse %uµs, tolerance +%u%% -%u%% (%u of 4 peaks found)\n",
+                    receivePIN->PIN, suggestion.singlePulseDuration, suggestion.positiveTolerance,
+                    suggestion.negativeTolerance, suggestion.matchedPeakCount);
+        }
+        if (DurationHistogramSuggestTolerances(receivePIN->durationHistogram,
+                                               KFSReceiverGetSinglePulseDuration(receivePIN->KFSReceiver),
+                                               KFSMultiples, sizeof(KFSMultiples) / sizeof(KFSMultiples[0]), &suggestion))
+        {
+            fprintf(statusOutput, "PIN %i KFS: single pulse %uµs, tolerance +%u%% -%u%% (%u of 3 peaks found)\n",
+                    receivePIN->PIN, suggestion.singlePulseDuration, suggestion.positiveTolerance,
+                    suggestion.negativeTolerance, suggestion.matchedPeakCount);
+        }
+    }
+}
+
+void printLatencyLine(const char * line, void * context)
+{
+    fprintf(statusOutput, "%s\n", line);
+}
+
+// signal handler for SIGUSR1: printing is not safe here, a timer does it
+void latencySignalReceived(int signal)
+{
+    atomic_store(&latencyPrintRequested, true);
+}
+
+// GPIOBackend timer function: prints the latencies when SIGUSR1 was received
+void latencyTimerFired(void * userdata)
+{
+    if (!atomic_exchange(&latencyPrintRequested, false)) { return; }
+    describeLatencies(&printLatencyLine, NULL);
+    if (printDurationHistograms) { printDurationHistogramsOfPINs(); }
+    fflush(statusOutput);
+}
+
+char * trimWhitespacesFromString(char * string)
+{
+    // Trim leading space
+    while(isspace((unsigned char) *string)) 
+    { string += 1; }
+
+    // the entire string is made up of whitespace
+    // return a pointer to the terminating NULL char
+    if(*string == '\0') 
+    { return NULL; }
+
+    // Trim trailing space
+    char *end = string + strlen(string) - 1;
+    while((end > string) && isspace((unsigned char) *end)) 
+    { end -= 1; }
+
+    end[1] = '\0';
+
+    return string;
+}
+
+/*
+Parses a key-value array such as "[address 494949, onOff 1, group 0, channel 4]"
+for `protocolName` (`COCO` or `KFS`) into the global message properties. A
+COCO message may have a `dimLevel` (0 - 15), which makes it a dim message.
+Note: `keyValues` is modified while parsing.
+*/
+bool parseMessage(char * protocolName, char * keyValues)
+{
+    if ('[' != keyValues[0])
+    {
+        printf("Error: expected opening of array with [, got %c.\n", keyValues[0]);
+        return false;
+    }
+
+    // KFS values
+    identifier = 0;
+    uint32_t * identifierPtr = NULL;
+
+    // COCO values
+    address = 0;
+    onOff = 0;
+    group = 0;
+    channel = 0;
+    dimLevel = COCOMessageNoDimLevel;
+    uint32_t * addressPtr = NULL;
+    bool * onOffPtr = NULL;
+    bool * groupPtr = NULL;
+    uint16_t * channelPtr = NULL;
+
+    char * currentKey = NULL;
+    char *keyValuePair;
+    while ((keyValuePair = strsep(&keyValues, ","))) 
+    {
+        char * trimmedKeyValuePair = trimWhitespacesFromString(keyValuePair);
+        if (NULL != trimmedKeyValuePair)
+        {
+            char *keyOrValue;
+            while ((keyOrValue = strsep(&keyValuePair, " "))) 
+            {
+                char * trimmedKeyOrValue = trimWhitespacesFromString(keyOrValue);
+                if (NULL != trimmedKeyOrValue)
+                {
+                    if (!strcmp("[", trimmedKeyOrValue) || !strcmp("]", trimmedKeyOrValue))
+                    { /* noting to do, just the opening or closing of the array */ }
+                    else 
+                    {
+                        if (trimmedKeyOrValue[0] == '[')
+                        { trimmedKeyOrValue += 1; }
+                        
+                        int length = strlen(trimmedKeyOrValue);
+                        if (trimmedKeyOrValue[length - 1] == ']')
+                        { trimmedKeyOrValue[length - 1] = '\0'; }
+
+                        if (NULL == currentKey)
+                        { currentKey = trimmedKeyOrValue; }
+                        else 
+                        {
+                            if (!strcmp(currentKey, "identifier"))
+                            {
+                                identifier = atoi(trimmedKeyOrValue);
+                                identifierPtr = &identifier;
+                            }
+                            else if (!strcmp(currentKey, "address"))
+                            {
+                                address = atoi(trimmedKeyOrValue);
+                                addressPtr = &address;
+                            }
+                            else if (!strcmp(currentKey, "onOff"))
+                            {
+                                onOff = atoi(trimmedKeyOrValue);
+                                onOffPtr = &onOff;
+                            }
+                            else if (!strcmp(currentKey, "group"))
+                            {
+                                group = atoi(trimmedKeyOrValue);
+                                groupPtr = &group;
+                            }
+                            else if (!strcmp(currentKey, "channel"))
+                            {
+                                channel = atoi(trimmedKeyOrValue);
+                                channelPtr = &channel;
+                            }
+                            else if (!strcmp(currentKey, "dimLevel"))
+                            {
+                                int value = atoi(trimmedKeyOrValue);
+                                if (value < 0 || value > 15)
+                                {
+                                    printf("Error: dimLevel should be 0 - 15, got %i.\n", value);
+                                    return false;
+                                }
+                                dimLevel = (int8_t) value;
+                            }
+                            else 
+                            {
+                                printf("Error: unkown key in key-value list: %s\n", currentKey);
+                                return false;
+                            }
+                            currentKey = NULL;
+                        }
+                    }
+                }
+            }
+            if (NULL != currentKey)
+            {
+                printf("Error: extraneous token found: `%s`. Did you forget to specify a key or its value?\n", currentKey);
+                return false;
+            }
+        }
+    }
+
+    if (!strcmp(protocolName, "KFS"))
+    {
+        if (NULL == identifierPtr)
+        {
+            printf("Error: no key-value specified for identifier.\n");
+            return false;
+        }
+        return true;
+    }
+    else if (!strcmp(protocolName, "COCO"))
+    {
+        bool shouldExit = false;
+        if (NULL == addressPtr)
+        {
+            printf("Error: no key-value specified for address.\n");
+            shouldExit = true;
+        }
+        if (NULL == onOffPtr)
+        {
+            printf("Error: no key-value specified for onOff.\n");
+            shouldExit = true;
+        }
+        if (NULL == groupPtr)
+        {
+            printf("Error: no key-value specified for group.\n");
+            shouldExit = true;
+        }
+        if (NULL == channelPtr)
+        {
+            printf("Error: no key-value specified for channel.\n");
+            shouldExit = true;
+        }
+        
+        if (shouldExit) { return false; }           
+
+        return true;
+    }
+
+    printf("Error: unknown protocol `%s`. Expected `COCO`, `KFS`, `EV1527` or `PT2262`.\n", protocolName);
+    return false;
+}
+
+bool addReceivePIN(int newPIN)
+{
+    for (uint32_t index = 0; index < receivePINCount; index++)
+    {
+        if (receivePINs[index].PIN == newPIN)
+        {
+            printf("Error: PIN %i is specified more than once.\n", newPIN);
+            return false;
+        }
+    }
+    receivePINs[receivePINCount].PIN = newPIN;
+    receivePINs[receivePINCount].index = receivePINCount;
+    receivePINCount += 1;
+    return true;
+}
+
+/*
+Parses a comma-separated list of protocols, e.g. `COCO,EV1527`, into
+`engineDescriptors`. `Oregon` is not a protocol of the ProtocolEngine, it sets
+`receiveOregon`.
+*/
+bool parseEngineProtocols(const char * list)
+{
+    char names[256];
+    snprintf(names, sizeof(names), "%s", list);
+    engineDescriptorCount = 0;
+
+    char * remainingNames = names;
+    char * name;
+    while ((name = strsep(&remainingNames, ",")))
+    {
+        if (!strcmp(name, "Oregon"))
+        {
+            receiveOregon = true;
+            continue;
+        }
+        const ProtocolDescriptor * descriptor = ProtocolDescriptorFind(name);
+        if (NULL == descriptor)
+        {
+            printf("ERROR: unknown protocol `%s`. Expected COCO, KFS, EV1527, PT2262 or Oregon.\n", name);
+            return false;
+        }
+        if (engineDescriptorCount == ProtocolEngineMaxProtocolCount) { break; }
+        engineDescriptors[engineDescriptorCount] = descriptor;
+        engineDescriptorCount += 1;
+    }
+    return true;
+}
+
+bool parseIngest(const char * name)
+{
+    if (!strcmp(name, "alert"))        { ingest = IngestAlert; }
+    else if (!strncmp(name, "alert:", 6))
+    {
+        ingest = IngestAlert;
+        alertWatchdogTimeout = (uint32_t) strtoul(name + 6, NULL, 10);
+    }
+#if LPD433PIGPIO
+    else if (!strcmp(name, "samples")) { ingest = IngestSamples; }
+    else if (!strcmp(name, "isr"))     { ingest = IngestISR; }
+    else if (!strncmp(name, "isr:", 4))
+    {
+        ingest = IngestISR;
+        ISRTimeout = (uint32_t) strtoul(name + 4, NULL, 10);
+        if (0 == ISRTimeout)
+        {
+            printf("Error: the ISR timeout must be at least 1 millisecond.\n");
+            return false;
+        }
+    }
+#endif
+#if LPD433PIGPIO
+    else if (!strcmp(name, "notify"))  { ingest = IngestNotify; }
+#endif
+    else if (!strncmp(name, "notify:", 7))
+    {
+        ingest = IngestNotify;
+        notificationPipePath = name + 7;
+    }
+    else if (!strcmp(name, "cdev"))    { ingest = IngestCharacterDevice; }
+    else if (!strncmp(name, "cdev:", 5))
+    {
+        ingest = IngestCharacterDevice;
+        characterDevicePath = name + 5;
+    }
+    else
+    {
+        printf("Error: unknown ingest `%s`. Expected `alert[:MILLIS]`, `samples`, `isr[:MILLIS]`, `notify[:PATH]` or `cdev[:CHIPPATH]`.\n", name);
+        return false;
+    }
+    return true;
+}
+
+bool parseArgs(int argc, char *argv[])
+{
+    // the only mode without a PIN
+    if (argc >= 2 && !strcmp(argv[1], "-t"))
+    {
+        if (argc > 2) { benchmarkMessageCount = (uint32_t) strtoul(argv[2], NULL, 10); }
+        if (argc > 3) { benchmarkJitter = (uint32_t) strtoul(argv[3], NULL, 10); }
+        for (int index = 4; index < argc; index++)
+        {
+            if (!strcmp(argv[index], "notify")) { ingest = IngestNotify; }
+            else if (!strcmp(argv[index], "engine")) { useProtocolEngine = true; }
+            else
+            {
+                printf("ERROR: unknown argument `%s`. Expecting: -t [COUNT [JITTER [notify] [engine]]]\n", argv[index]);
+                return false;
+            }
+        }
+        mode = OperationModerLoopbackBenchmark;
+        return true;
+    }
+
+    if (argc < 3) 
+    {
+        printf("ERROR: incorect number of arguments.\n");
+        return false; 
+    }
+
+    PIN = atoi(argv[2]);
+
+    // strcmp returns 0 when strings are equal
+    if (!strcmp(argv[1], "-s")) 
+    {
+        mode = OperationModerSending;
+        if (7 == argc && !strcmp(argv[5], "-P")) { pluginDirectory = argv[6]; }
+        else if (5 != argc)
+        {
+            printf("Incorrect number of arguments for sending a message. Expecting: -s PIN PROTOCOL \"[key value...]\" [-P DIRECTORY]. Did you forget quotes around the key-value array?\n");
+            return false;
+        }
+
+        // get protocol
+        protocol = argv[3];
+        // the fields of a descriptor are parsed when sending, a plugin parses
+        // its own messages once it is loaded
+        if (strcmp(protocol, "COCO") && strcmp(protocol, "KFS") &&
+            (NULL != ProtocolDescriptorFind(protocol) || NULL != pluginDirectory))
+        {
+            messageKeyValues = argv[4];
+            return true;
+        }
+        // parse the keyvalue array
+        return parseMessage(protocol, argv[4]);
+    }
+    else if (!strcmp(argv[1], "-r"))
+    {
+        for (int index = 2; index < argc; index++)
+        {
+            if (!strcmp(argv[index], "-i"))
+            {
+                if (index + 1 >= argc || !parseIngest(argv[index + 1])) { return false; }
+                index += 1;
+            }
+            else if (!strcmp(argv[index], "-n")) { invertedReceivers = true; }
+            else if (!strcmp(argv[index], "-H")) { printDurationHistograms = true; }
+            else if (!strcmp(argv[index], "-E")) { useProtocolEngine = true; }
+            else if (!strcmp(argv[index], "-p"))
+            {
+                if (index + 1 >= argc || !parseEngineProtocols(argv[index + 1])) { return false; }
+                index += 1;
+                useProtocolEngine = true;
+            }
+            else if (!strcmp(argv[index], "-P"))
+            {
+                if (index + 1 >= argc) 
+                {
+                    printf("ERROR: -P needs the directory of the plugins.\n");
+                    return false;
+                }
+                index += 1;
+                pluginDirectory = argv[index];
+            }
+            else if (!strcmp(argv[index], "-S"))
+            {
+                if (index + 1 >= argc) 
+                {
+                    printf("ERROR: -S needs the number of seconds between statistics.\n");
+                    return false;
+                }
+                index += 1;
+                statisticsInterval = (uint32_t) strtoul(argv[index], NULL, 10);
+                if (statisticsInterval < 1 || statisticsInterval > 60)
+                {
+                    printf("Error: the number of seconds between statistics must be 1 - 60.\n");
+                    return false;
+                }
+            }
+            else if (!strcmp(argv[index], "-w"))
+            {
+                if (index + 1 >= argc) 
+                {
+                    printf("ERROR: -w needs the number of worker threads.\n");
+                    return false;
+                }
+                index += 1;
+                dispatchWorkerCount = (uint32_t) strtoul(argv[index], NULL, 10);
+                if (dispatchWorkerCount < 1 || dispatchWorkerCount > 64)
+                {
+                    printf("Error: the number of worker threads must be 1 - 64.\n");
+                    return false;
+                }
+            }
+            else if (!strcmp(argv[index], "-o"))
+            {
+                if (index + 1 >= argc) 
+                {
+                    printf("ERROR: -o needs a format: text, json, csv or binary.\n");
+                    return false;
+                }
+                index += 1;
+                if (!strcmp(argv[index], "text")) { hasOutputFormat = false; }
+                else if (MessageWriterParseFormat(argv[index], &outputFormat)) { hasOutputFormat = true; }
+                else
+                {
+                    printf("Error: unknown output format `%s`. Expected `text`, `json`, `csv` or `binary`.\n", argv[index]);
+                    return false;
+                }
+            }
+            else if (receivePINCount == MaxReceivePINCount)
+            {
+                printf("ERROR: too many arguments, at most %i PINs are supported.\n", MaxReceivePINCount);
+                return false; 
+            }
+            else if (!addReceivePIN(atoi(argv[index]))) { return false; }
+        }
+        if (0 == receivePINCount)
+        {
+            printf("ERROR: no PIN to receive on.\n");
+            return false;
+        }
+        for (uint32_t index = 0; index < receivePINCount && (IngestSamples == ingest || IngestNotify == ingest); index++)
+        {
+            if (receivePINs[index].PIN < 0 || receivePINs[index].PIN > 31)
+            {
+                printf("ERROR: the samples and notify ingests only support PINs 0 - 31.\n");
+                return false;
+            }
+        }
+        mode = OperationModerReceiving;
+        return true; 
+    }
+    else if (!strcmp(argv[1], "-d"))
+    {
+        if (4 != argc && 5 != argc)
+        {
+            printf("Incorrect number of arguments for duplex mode. Expecting: -d RECEIVEPIN TRANSMITPIN [-l]\n");
+            return false;
+        }
+        if (5 == argc)
+        {
+            if (strcmp(argv[4], "-l"))
+            {
+                printf("Error: unknown option `%s`. Expected `-l`.\n", argv[4]);
+                return false;
+            }
+            listenBeforeTalk = true;
+        }
+        transmitPIN = atoi(argv[3]);
+        if (transmitPIN == PIN)
+        {
+            printf("Error: the receive PIN and the transmit PIN must differ.\n");
+            return false;
+        }
+        addReceivePIN(PIN);
+        mode = OperationModerDuplex;
+        return true;
+    }
+    else if (!strcmp(argv[1], "-b"))
+    {
+        if (argc > 4)
+        {
+            printf("ERROR: too many arguments. Expecting: -b PIN [FILE]\n");
+            return false;
+        }
+        if (4 == argc) { batchFilePath = argv[3]; }
+        mode = OperationModerBatch;
+        return true;
+    }
+#if LPD433PIGPIO
+    else if (!strcmp(argv[1], "-T"))
+    {
+        if (4 != argc && 5 != argc)
+        {
+            printf("Incorrect number of arguments for the ingest benchmark. Expecting: -T RECEIVEPIN TRANSMITPIN [COUNT]\n");
+            return false;
+        }
+        transmitPIN = atoi(argv[3]);
+        if (transmitPIN == PIN)
+        {
+            printf("Error: the receive PIN and the transmit PIN must differ.\n");
+            return false;
+        }
+        if (PIN < 0 || PIN > 31)
+        {
+            printf("ERROR: the samples ingest only supports PINs 0 - 31.\n");
+            return false;
+        }
+        if (5 == argc) { benchmarkMessageCount = (uint32_t) strtoul(argv[4], NULL, 10); }
+        else { benchmarkMessageCount = 100; }
+        addReceivePIN(PIN);
+        mode = OperationModerIngestBenchmark;
+        return true;
+    }
+#endif
+    else if (!strcmp(argv[1], "-D"))
+    {
+        if (5 != argc)
+        {
+            printf("Incorrect number of arguments for daemon mode. Expecting: -D SOCKETPATH RECEIVEPIN TRANSMITPIN\n");
+            return false;
+        }
+        socketPath = argv[2];
+        PIN = atoi(argv[3]);
+        transmitPIN = atoi(argv[4]);
+        if (transmitPIN == PIN)
+        {
+            printf("Error: the receive PIN and the transmit PIN must differ.\n");
+            return false;
+        }
+        addReceivePIN(PIN);
+        mode = OperationModerDaemon;
+        return true;
+    }
+    else 
+    {
+        printf("Incorrect 2nd argument. Expected \"-r\", \"-s\", \"-b\", \"-d\", \"-D\", \"-t\" or \"-T\", but got \"%s\".", argv[1]);
+        return false;
+    }
+	return false;
+}
+
+void sendCOCOMessage(OOKSenderRef sender, uint32_t address, bool onOff, bool group, uint16_t channel, int8_t dimLevel)
+{
+    COCOMessageRef message = COCOMessageCreate();
+    COCOMessageSetAddress(message, address); // 26541806
+    COCOMessageSetGroup(message, group);
+    COCOMessageSetOnOff(message, onOff);
+    COCOMessageSetChannel(message, channel);
+    COCOMessageSetDimLevel(message, dimLevel);
+
+    printf("Sending COCO message with address = %lu, group = %u, onOff = %u, channel = %u, dimLevel = %i\n", 
+            COCOMessageGetAddress(message),
+            COCOMessageGetGroup(message),
+            COCOMessageGetOnOff(message),
+            COCOMessageGetChannel(message),
+            COCOMessageGetDimLevel(message));
+
+    if (NULL != echoFilter)
+    { EchoFilterTransmissionBegan(echoFilter, EchoFilterProtocolCOCO, COCOMessageKey(message), GPIOBackendGetTick(backend)); }
+
+    OOKSenderSendCOCO(sender, message);
+
+    if (NULL != echoFilter)
+    { EchoFilterTransmissionEnded(echoFilter, GPIOBackendGetTick(backend)); }
+
+    // cleanup
+    COCOMessageRelease(message);
+}
+void sendKFSMessage(OOKSenderRef sender, uint32_t identifier)
+{
+    KFSMessageRef message = KFSMessageCreate();
+    KFSMessageSetIdentifier(message, identifier);
+
+    printf("Sending KFSMessage with identifier = %lu ...\n", identifier);
+
+    if (NULL != echoFilter)
+    { EchoFilterTransmissionBegan(echoFilter, EchoFilterProtocolKFS, identifier, GPIOBackendGetTick(backend)); }
+
+    OOKSenderSendKFS(sender, message);
+
+    if (NULL != echoFilter)
+    { EchoFilterTransmissionEnded(echoFilter, GPIOBackendGetTick(backend)); }
+
+    // cleanup
+    KFSMessageRelease(message);
+}
+
+/*
+Sends the message `keyValues`, e.g. "[id 12345, data 3]", with a value for each
+field of `descriptor`, encoded by an OOKEncoder. Returns false if the message
+could not be parsed or encoded.
+Note: `keyValues` is modified while parsing.
+*/
+bool sendDescriptorMessage(OOKSenderRef sender, const ProtocolDescriptor * descriptor, char * keyValues)
+{
+    uint64_t code = 0;
+    uint32_t parsedFields = 0;
+    char * keyValuePair;
+    while ((keyValuePair = strsep(&keyValues, ",")))
+    {
+        // remove the brackets of the array
+        for (char * character = keyValuePair; '\0' != *character; character++)
+        {
+            if ('[' == *character || ']' == *character) { *character = ' '; }
+        }
+        char * trimmedKeyValuePair = trimWhitespacesFromString(keyValuePair);
+        if (NULL == trimmedKeyValuePair) { continue; }
+
+        char * key = strsep(&trimmedKeyValuePair, " ");
+        char * value = (NULL == trimmedKeyValuePair) ? NULL : trimWhitespacesFromString(trimmedKeyValuePair);
+        if (NULL == value || !ProtocolCodeParseField(descriptor, &code, key, value))
+        {
+            printf("Error: `%s %s` is not a field of %s and its value.\n", key, (NULL == value) ? "" : value, descriptor->name);
+            return false;
+        }
+        for (uint32_t index = 0; index < descriptor->fieldCount; index++)
+        {
+            if (!strcmp(descriptor->fields[index].name, key)) { parsedFields |= 1u << index; }
+        }
+    }
+    for (uint32_t index = 0; index < descriptor->fieldCount; index++)
+    {
+        if (0 == (parsedFields & (1u << index)))
+        {
+            printf("Error: no key-value specified for %s.\n", descriptor->fields[index].name);
+            return false;
+        }
+    }
+
+    OOKEncoderRef encoder = OOKEncoderCreate(descriptor);
+    if (NULL == encoder) { return false; }
+    char text[256];
+    ProtocolFrame frame = { .descriptor = descriptor, .code = code, .bitCount = descriptor->maxBitCount };
+    ProtocolFrameFormat(&frame, text, sizeof(text));
+    printf("Sending %s\n", text);
+    bool sent = OOKSenderSendCode(sender, encoder, code, descriptor->maxBitCount);
+    OOKEncoderRelease(encoder);
+    return sent;
+}
+
+/*
+Loads the plugins in `pluginDirectory`, and sends `keyValues` as encoded by 
+the plugin called `protocolName`. Returns false if that is not possible.
+*/
+bool sendPluginMessage(OOKSenderRef sender, const char * protocolName, const char * keyValues)
+{
+    PluginLibraryRef library = PluginLibraryCreate();
+    if (NULL == library) { return false; }
+    PluginLibraryLoadDirectory(library, pluginDirectory);
+
+    int32_t pluginIndex = PluginLibraryFindPlugin(library, protocolName);
+    const LPD433Plugin * plugin = (pluginIndex < 0) ? NULL : PluginLibraryGetPlugin(library, (uint32_t) pluginIndex);
+    uint32_t durations[1024];
+    uint32_t repeatCount = 0;
+    uint32_t length = 0;
+    if (NULL == plugin)
+    { printf("Error: unknown protocol `%s`. Expected `COCO`, `KFS` or a plugin in %s.\n", protocolName, pluginDirectory); }
+    else if (NULL == plugin->encode)
+    { printf("Error: the %s plugin can not send.\n", protocolName); }
+    else
+    {
+        length = plugin->encode(keyValues, durations, sizeof(durations) / sizeof(durations[0]), &repeatCount);
+        if (0 == length) { printf("Error: the %s plugin could not encode %s.\n", protocolName, keyValues); }
+    }
+
+    if (length > 0)
+    {
+        printf("Sending %s message %s\n", protocolName, keyValues);
+        OOKSenderSendDurations(sender, durations, length, repeatCount);
+    }
+    PluginLibraryRelease(library);
+    return length > 0;
+}
+
+/*
+Sends the message described by `line`, which has the form
+`PROTOCOL [messageField value, ...]`, e.g. `KFS [identifier 38883]`.
+Returns false if the line could not be parsed.
+*/
+bool sendMessageLine(OOKSenderRef sender, char * line)
+{
+    char * trimmedLine = trimWhitespacesFromString(line);
+    if (NULL == trimmedLine) { return false; }
+
+    char * keyValues = strchr(trimmedLine, '[');
+    if (NULL == keyValues)
+    {
+        printf("Error: expected `PROTOCOL [messageField value, ...]`, got `%s`.\n", trimmedLine);
+        return false;
+    }
+
+    // the protocol name is everything up to the first whitespace or `[`, copied so
+    // that the line itself is not written to in front of the `[`
+    char protocolToken[32];
+    size_t protocolLength = strcspn(trimmedLine, " \t[");
+    if (protocolLength >= sizeof(protocolToken))
+    {
+        printf("Error: protocol name `%.*s` is too long.\n", (int) protocolLength, trimmedLine);
+        return false;
+    }
+    memcpy(protocolToken, trimmedLine, protocolLength);
+    protocolToken[protocolLength] = '\0';
+    char * protocolName = (protocolLength > 0) ? protocolToken : NULL;
+    if (NULL == protocolName)
+    {
+        printf("Error: no protocol specified.\n");
+        return false;
+    }
+
+    const ProtocolDescriptor * descriptor = ProtocolDescriptorFind(protocolName);
+    if (NULL != descriptor && strcmp(protocolName, "COCO") && strcmp(protocolName, "KFS"))
+    { return sendDescriptorMessage(sender, descriptor, keyValues); }
+
+    if (!parseMessage(protocolName, keyValues)) { return false; }
+
+    if (!strcmp(protocolName, "COCO"))
+    { sendCOCOMessage(sender, address, onOff, group, channel, dimLevel); }
+    else
+    { sendKFSMessage(sender, identifier); }
+
+    return true;
+}
+
+void startReceiving()
+{
+    if (hasOutputFormat)
+    {
+        messageWriter = MessageWriterCreate(stdout, outputFormat, 1024);
+        if (NULL == messageWriter) { fprintf(statusOutput, "Could not create the message writer, printing messages instead.\n"); }
+    }
+
+    if (dispatchWorkerCount > 0)
+    {
+        messageDispatcher = MessageDispatcherCreate(dispatchWorkerCount, 256);
+        if (NULL != messageDispatcher) { MessageDispatcherSetHandler(messageDispatcher, &dispatchedMessageReceived, NULL); }
+    }
+
+    combiner = DiversityCombinerCreate(receivePINCount);
+    DiversityCombinerSetCallback(combiner, &combinedMessageReceived);
+
+    decodeLatency = LatencyHistogramCreate();
+    queueLatency = LatencyHistogramCreate();
+    handlerLatency = LatencyHistogramCreate();
+    totalLatency = LatencyHistogramCreate();
+
+    if (useProtocolEngine) { framePool = ProtocolFramePoolCreate(FramePoolCapacity); }
+
+    if (NULL != pluginDirectory)
+    {
+        pluginLibrary = PluginLibraryCreate();
+        int32_t pluginCount = (NULL == pluginLibrary) ? -1 : PluginLibraryLoadDirectory(pluginLibrary, pluginDirectory);
+        if (pluginCount > 0)
+        {
+            fprintf(statusOutput, "Loaded %i plugin%s:", pluginCount, (1 == pluginCount) ? "" : "s");
+            for (uint32_t pluginIndex = 0; pluginIndex < (uint32_t) pluginCount; pluginIndex++)
+            { fprintf(statusOutput, " %s", PluginLibraryGetPlugin(pluginLibrary, pluginIndex)->name); }
+            fprintf(statusOutput, "\n");
+        }
+        else
+        {
+            fprintf(statusOutput, "No plugins were loaded from %s.\n", pluginDirectory);
+            PluginLibraryRelease(pluginLibrary);
+            pluginLibrary = NULL;
+        }
+    }
+
+    for (uint32_t index = 0; index < receivePINCount; index++)
+    {
+        struct ReceivePIN * receivePIN = &receivePINs[index];
+        atomic_init(&receivePIN->edgeCount, 0);
+        atomic_init(&receivePIN->lostEdgeCount, 0);
+        receivePIN->lastLevel = -1;
+        receivePIN->durationHistogram = DurationHistogramCreate();
+        receivePIN->pendingSettings = BoundedQueueCreate(16, sizeof(ReceiverSetting));
+
+        receivePIN->COCOReceiver = COCOReceiverCreate();
+        COCOReceiverSetInverted(receivePIN->COCOReceiver, invertedReceivers);
+        COCOReceiverSetCallback(receivePIN->COCOReceiver, &COCOCallback);
+        COCOReceiverSetContext(receivePIN->COCOReceiver, receivePIN);
+        COCOReceiverSetRefractoryPeriod(receivePIN->COCOReceiver, 0);
+        COCOReceiverSetRepeatCount(receivePIN->COCOReceiver, 1);
+        // the next line could be usefull for debugging
+        // COCOReceiverSetRecordReceivedTransmissions(receivePIN->COCOReceiver, true);
+
+        receivePIN->KFSReceiver = KFSReceiverCreate();
+        KFSReceiverSetInverted(receivePIN->KFSReceiver, invertedReceivers);
+        KFSReceiverSetCallback(receivePIN->KFSReceiver, &KFSCallback);
+        KFSReceiverSetContext(receivePIN->KFSReceiver, receivePIN);
+        KFSReceiverSetRefractoryPeriod(receivePIN->KFSReceiver, 0);
+        KFSReceiverSetRepeatCount(receivePIN->KFSReceiver, 1);
+
+        receivePIN->protocolEngine = NULL;
+        if (useProtocolEngine)
+        {
+            // the same settings as the receivers above
+            receivePIN->protocolEngine = ProtocolEngineCreate();
+            ProtocolEngineSetInverted(receivePIN->protocolEngine, invertedReceivers);
+            ProtocolEngineSetCallback(receivePIN->protocolEngine, &protocolFrameDetected);
+            ProtocolEngineSetContext(receivePIN->protocolEngine, receivePIN);
+            for (uint32_t descriptorIndex = 0; descriptorIndex < engineDescriptorCount; descriptorIndex++)
+            {
+                int32_t protocolIndex = ProtocolEngineAddProtocol(receivePIN->protocolEngine, engineDescriptors[descriptorIndex]);
+                if (protocolIndex < 0) { continue; }
+                ProtocolEngineSetRefractoryPeriod(receivePIN->protocolEngine, (uint32_t) protocolIndex, 0);
+                ProtocolEngineSetRepeatCount(receivePIN->protocolEngine, (uint32_t) protocolIndex, 1);
+            }
+        }
+        // the next line could be usefull for debugging
+        // KFSSetRecordReceivedTransmissions(receivePIN->KFSReceiver, true);
+
+        receivePIN->OregonReceiver = NULL;
+        if (receiveOregon)
+        {
+            receivePIN->OregonReceiver = OregonReceiverCreate();
+            OregonReceiverSetInverted(receivePIN->OregonReceiver, invertedReceivers);
+            OregonReceiverSetCallback(receivePIN->OregonReceiver, &OregonCallback);
+            OregonReceiverSetContext(receivePIN->OregonReceiver, receivePIN);
+        }
+
+        receivePIN->pluginDecoders = NULL;
+        if (NULL != pluginLibrary)
+        {
+            receivePIN->pluginDecoders = PluginDecoderSetCreate(pluginLibrary);
+            if (NULL != receivePIN->pluginDecoders)
+            {
+                PluginDecoderSetSetInverted(receivePIN->pluginDecoders, invertedReceivers);
+                PluginDecoderSetSetCallback(receivePIN->pluginDecoders, &pluginFrameDetected);
+                PluginDecoderSetSetContext(receivePIN->pluginDecoders, receivePIN);
+            }
+        }
+
+        // the character device backend delivers its edges like alerts
+        if (IngestAlert == ingest || IngestCharacterDevice == ingest)
+        {
+            GPIOBackendSetEdgeFunction(backend, receivePIN->PIN, gpioValueChanged, receivePIN);
+#if LPD433PIGPIO
+            // the watchdog calls the alert function, on the thread of the edges
+            if (IngestAlert == ingest && PIGPIOBackendGet() == backend && alertWatchdogTimeout > 0)
+            { gpioSetWatchdog(receivePIN->PIN, alertWatchdogTimeout); }
+#endif
+        }
+#if LPD433PIGPIO
+        else if (IngestISR == ingest)
+        {
+            gpioSetMode(receivePIN->PIN, PI_INPUT);
+            gpioSetISRFuncEx(receivePIN->PIN, EITHER_EDGE, ISRTimeout, gpioInterruptReceived, receivePIN);
+        }
+#endif
+    }
+
+    if (IngestSamples == ingest || IngestNotify == ingest)
+    {
+        uint32_t PINMask = 0;
+        for (uint32_t index = 0; index < receivePINCount; index++)
+        { PINMask |= (1u << receivePINs[index].PIN); }
+
+        sampleEdgeExtractor = SampleEdgeExtractorCreate(PINMask);
+        SampleEdgeExtractorSetCallback(sampleEdgeExtractor, &sampleEdgeDetected);
+        for (uint32_t index = 0; index < receivePINCount; index++)
+        { SampleEdgeExtractorSetGPIOContext(sampleEdgeExtractor, receivePINs[index].PIN, &receivePINs[index]); }
+        // PIGPIO samples every 5µs: a longer gap between two batches means 
+        // its buffer overflowed. The shortest pulse is still longer than 100µs.
+        if (IngestSamples == ingest) { SampleEdgeExtractorSetMaxSampleInterval(sampleEdgeExtractor, 100); }
+#if LPD433PIGPIO
+        // without a path, the pipe is one of this process' PIGPIO
+        char PIGPIOPipePath[32];
+        if (IngestSamples == ingest || NULL == notificationPipePath)
+        {
+            for (uint32_t index = 0; index < receivePINCount; index++)
+            { gpioSetMode(receivePINs[index].PIN, PI_INPUT); }
+        }
+        if (IngestSamples == ingest)
+        { gpioSetGetSamplesFunc(gpioSamplesReceived, PINMask); }
+        else if (NULL == notificationPipePath)
+        {
+            notificationPipeHandle = gpioNotifyOpen();
+            if (notificationPipeHandle < 0)
+            { fprintf(statusOutput, "Could not open a PIGPIO notification pipe (error %d).\n", notificationPipeHandle); }
+            else
+            { snprintf(PIGPIOPipePath, sizeof(PIGPIOPipePath), "/dev/pigpio%d", notificationPipeHandle); }
+        }
+#endif
+        if (IngestNotify == ingest)
+        {
+#if LPD433PIGPIO
+            const char * path = (NULL != notificationPipePath) ? notificationPipePath :
+                                (notificationPipeHandle >= 0) ? PIGPIOPipePath : NULL;
+#else
+            const char * path = notificationPipePath;
+#endif
+            if (NULL != path)
+            {
+                notificationPipeReader = NotificationPipeReaderCreate(path, sampleEdgeExtractor);
+                if (NULL != notificationPipeReader) { NotificationPipeReaderStart(notificationPipeReader); }
+            }
+#if LPD433PIGPIO
+            if (notificationPipeHandle >= 0) { gpioNotifyBegin(notificationPipeHandle, PINMask); }
+#endif
+        }
+    }
+
+    // with more than one PIN, copies of a message are held back until the 
+    // combiner's window passes
+    if (receivePINCount > 1)
+    { GPIOBackendSetTimerFunction(backend, 0, 10, combinerTimerFired, NULL); }
+    if (statisticsInterval > 0)
+    { GPIOBackendSetTimerFunction(backend, 1, statisticsInterval * 1000, statisticsTimerFired, NULL); }
+
+    // `kill -USR1` prints the latencies
+    GPIOBackendSetTimerFunction(backend, 2, 100, latencyTimerFired, NULL);
+#if LPD433PIGPIO
+    if (PIGPIOBackendGet() == backend) { gpioSetSignalFunc(SIGUSR1, latencySignalReceived); }
+    else
+#endif
+    { signal(SIGUSR1, latencySignalReceived); }
+}
+
+void printReceiveStatistics()
+{
+    fprintf(statusOutput, "  PIN\t   edges\t resyncs\tmessages\treported\tduplicates\n");
+    for (uint32_t index = 0; index < receivePINCount; index++)
+    {
+        fprintf(statusOutput, "  %3i\t%8u\t%8u\t%8u\t%8u\t%10u\n", 
+               receivePINs[index].PIN,
+               atomic_load(&receivePINs[index].edgeCount),
+               (NULL != receivePINs[index].protocolEngine) ?
+               ProtocolEngineGetPolarityErrorCount(receivePINs[index].protocolEngine) :
+               COCOReceiverGetPolarityErrorCount(receivePINs[index].COCOReceiver) + 
+               KFSReceiverGetPolarityErrorCount(receivePINs[index].KFSReceiver) +
+               ((NULL != receivePINs[index].OregonReceiver) ? OregonReceiverGetPolarityErrorCount(receivePINs[index].OregonReceiver) : 0),
+               DiversityCombinerGetSubmittedCount(combiner, index),
+               DiversityCombinerGetSelectedCount(combiner, index),
+               DiversityCombinerGetDuplicateCount(combiner, index));
+    }
+}
+
+void stopReceiving()
+{
+    if (receivePINCount > 1)
+    { GPIOBackendSetTimerFunction(backend, 0, 10, NULL, NULL); }
+    if (statisticsInterval > 0)
+    {
+        GPIOBackendSetTimerFunction(backend, 1, statisticsInterval * 1000, NULL, NULL);
+        printReceiverCounters();
+    }
+    else
+    {
+        // the CPU time of the plugins is always worth knowing
+        for (uint32_t index = 0; index < receivePINCount; index++)
+        { printPluginCounters(&receivePINs[index]); }
+    }
+    GPIOBackendSetTimerFunction(backend, 2, 100, NULL, NULL);
+    if (printDurationHistograms) { printDurationHistogramsOfPINs(); }
+
+    if (IngestNotify == ingest)
+    {
+#if LPD433PIGPIO
+        if (notificationPipeHandle >= 0) { gpioNotifyClose(notificationPipeHandle); }
+        notificationPipeHandle = -1;
+#endif
+        if (NULL != notificationPipeReader)
+        {
+            NotificationPipeReaderStop(notificationPipeReader);
+            fprintf(statusOutput, "Read %llu reports in %llu reads, %llu reports were lost.\n",
+                   (unsigned long long) NotificationPipeReaderGetReportCount(notificationPipeReader),
+                   (unsigned long long) NotificationPipeReaderGetReadCount(notificationPipeReader),
+                   (unsigned long long) NotificationPipeReaderGetLostReportCount(notificationPipeReader));
+            NotificationPipeReaderRelease(notificationPipeReader);
+            notificationPipeReader = NULL;
+        }
+        SampleEdgeExtractorRelease(sampleEdgeExtractor);
+        sampleEdgeExtractor = NULL;
+    }
+#if LPD433PIGPIO
+    else if (IngestSamples == ingest)
+    {
+        gpioSetGetSamplesFunc(NULL, 0);
+        SampleEdgeExtractorRelease(sampleEdgeExtractor);
+        sampleEdgeExtractor = NULL;
+    }
+    else if (IngestISR == ingest)
+    {
+        for (uint32_t index = 0; index < receivePINCount; index++)
+        { gpioSetISRFuncEx(receivePINs[index].PIN, EITHER_EDGE, 0, NULL, NULL); }
+    }
+    else
+#endif
+    {
+        for (uint32_t index = 0; index < receivePINCount; index++)
+        {
+            struct ReceivePIN * receivePIN = &receivePINs[index];
+#if LPD433PIGPIO
+            if (IngestAlert == ingest && PIGPIOBackendGet() == backend && alertWatchdogTimeout > 0)
+            { gpioSetWatchdog(receivePIN->PIN, 0); }
+#endif
+            GPIOBackendSetEdgeFunction(backend, receivePIN->PIN, NULL, NULL);
+        }
+    }
+
+    // pass on what is still being combined
+    DiversityCombinerFlush(combiner, GPIOBackendGetTick(backend) + DiversityCombinerGetWindow(combiner) + 1);
+    if (receivePINCount > 1) { printReceiveStatistics(); }
+    if (IngestCharacterDevice == ingest)
+    {
+        fprintf(statusOutput, "Read %llu edges in %llu reads, the kernel dropped %llu edges.\n",
+               (unsigned long long) CharacterDeviceGPIOBackendGetEventCount(backend),
+               (unsigned long long) CharacterDeviceGPIOBackendGetReadCount(backend),
+               (unsigned long long) CharacterDeviceGPIOBackendGetLostEventCount(backend));
+    }
 
-// KFS identifier
-uint32_t identifier = 0;
+    for (uint32_t index = 0; index < receivePINCount; index++)
+    {
+        struct ReceivePIN * receivePIN = &receivePINs[index];
+        KFSReceiverRelease(receivePIN->KFSReceiver);
+        COCOReceiverRelease(receivePIN->COCOReceiver);
+        DurationHistogramRelease(receivePIN->durationHistogram);
+        BoundedQueueRelease(receivePIN->pendingSettings);
+        ProtocolEngineRelease(receivePIN->protocolEngine);
+        PluginDecoderSetRelease(receivePIN->pluginDecoders);
+        OregonReceiverRelease(receivePIN->OregonReceiver);
+        receivePIN->KFSReceiver = NULL;
+        receivePIN->COCOReceiver = NULL;
+        receivePIN->durationHistogram = NULL;
+        receivePIN->pendingSettings = NULL;
+        receivePIN->protocolEngine = NULL;
+        receivePIN->pluginDecoders = NULL;
+        receivePIN->OregonReceiver = NULL;
+    }
+    DiversityCombinerRelease(combiner);
+    combiner = NULL;
 
-// COCO properties
-uint32_t address = 0;
-bool onOff = 0;
-bool group = 0;
-uint16_t channel = 0;
+    // handles what is still queued, so it must go before the writer
+    if (NULL != messageDispatcher)
+    {
+        fprintf(statusOutput, "Dispatched %llu messages, queue latency average %u µs, maximum %u µs, %llu messages were dropped, %u are still queued.\n",
+                (unsigned long long) MessageDispatcherGetDispatchedCount(messageDispatcher),
+                MessageDispatcherGetAverageLatency(messageDispatcher), 
+                MessageDispatcherGetMaxLatency(messageDispatcher),
+                (unsigned long long) MessageDispatcherGetDroppedCount(messageDispatcher),
+                MessageDispatcherGetBacklog(messageDispatcher));
+        MessageDispatcherRelease(messageDispatcher);
+        messageDispatcher = NULL;
+    }
 
-// receivers. These are given the timestamp of GPIO changes and will try and 
-// detect messages of a specific protocol, and callback once such a message is 
-// detected.
-COCOReceiverRef COCOReceiver = NULL;
-KFSReceiverRef KFSReceiver = NULL;
+    if (NULL != messageWriter)
+    {
+        uint64_t droppedCount = MessageWriterGetDroppedCount(messageWriter);
+        MessageWriterRelease(messageWriter);
+        messageWriter = NULL;
+        if (droppedCount > 0) { fprintf(statusOutput, "%llu messages were dropped, the output was not read fast enough.\n", (unsigned long long) droppedCount); }
+    }
+    // the handlers format the messages of plugins with them
+    PluginLibraryRelease(pluginLibrary);
+    pluginLibrary = NULL;
+    if (NULL != framePool && ProtocolFramePoolGetDroppedCount(framePool) > 0)
+    {
+        fprintf(statusOutput, "%llu frames were dropped, more than %u were waiting to be handled.\n",
+                (unsigned long long) ProtocolFramePoolGetDroppedCount(framePool), FramePoolCapacity);
+    }
+    ProtocolFramePoolRelease(framePool);
+    framePool = NULL;
+    // the dispatcher's workers record into these
+    LatencyHistogramRelease(decodeLatency);
+    LatencyHistogramRelease(queueLatency);
+    LatencyHistogramRelease(handlerLatency);
+    LatencyHistogramRelease(totalLatency);
+    decodeLatency = NULL;
+    queueLatency = NULL;
+    handlerLatency = NULL;
+    totalLatency = NULL;
+}
 
-// PIGPIO-callback. 
-void gpioValueChanged(int gpio, int level, uint32_t timestamp)
+#if LPD433PIGPIO
+uint64_t CPUTimeInMicroSeconds(clockid_t clock)
 {
-    // timestamp is simply forwarde to the receivers
-    COCOReceiverFeedGPIOValueChangeTime(COCOReceiver, timestamp);
-    KFSReceiverFeedGPIOValueChangeTime(KFSReceiver, timestamp);
+    struct timespec time;
+    clock_gettime(clock, &time);
+    return (uint64_t) time.tv_sec * 1000000 + (uint64_t) time.tv_nsec / 1000;
 }
 
-// COCO receiver callback
-void COCOCallback(COCOReceiverRef receiver, COCOMessageRef message)
+struct IngestBenchmarkResult
 {
-    // a COCO message was detected
-    printf("\n╔═════ COCO Message ═════╗\n║ address:\t%8lu ║\n║ group:\t%8i ║\n║ onOff:\t%8i ║\n║ channel:\t%8i ║\n╚════════════════════════╝\n", 
-        COCOMessageGetAddress(message),
-        COCOMessageGetGroup(message),
-        COCOMessageGetOnOff(message),
-        COCOMessageGetChannel(message) );
-
-    COCOMessageRelease(message);
-}
+    double idleCPU;           // percentage of one core, no edges
+    double busyCPU;           // percentage of one core, while receiving messages
+    uint32_t matchedEdges;    // of BenchmarkEdgeCount / 2 edges written
+    double meanError;         // µs between writing and receiving an edge
+    uint32_t maxError;        // µs
+    uint32_t receivedCount;   // of `benchmarkMessageCount` messages
+    uint32_t wrongCount;
+};
 
-void KFSCallback(KFSReceiverRef receiver, KFSMessageRef message)
+/*
+Runs the ingest benchmark for the current `ingest`: receiving on the first 
+receive PIN, while sending through `sender`, whose PIN must be connected to the
+receive PIN by a wire.
+The CPU time of the receiving side is the CPU time of the process, minus that
+of this (the sending) thread.
+*/
+struct IngestBenchmarkResult runIngestBenchmark(OOKSenderRef sender)
 {
-    // a KFSR message was detected
-    printf("\n╔════ KeyFob Message ════╗\n║ identifier:\t%8lu ║\n╚════════════════════════╝\n", 
-        KFSMessageGetIdentifier(message) );
+    struct IngestBenchmarkResult result;
+    clockid_t processClock = CLOCK_PROCESS_CPUTIME_ID;
+    clockid_t threadClock = CLOCK_THREAD_CPUTIME_ID;
 
-    KFSMessageRelease(message);
-}
+    startReceiving();
+    GPIOBackendSleep(backend, 200000);
 
-char * trimWhitespacesFromString(char * string)
-{
-    // Trim leading space
-    while(isspace((unsigned char) *string)) 
-    { string += 1; }
+    // idle
+    uint64_t processStart = CPUTimeInMicroSeconds(processClock);
+    uint64_t threadStart = CPUTimeInMicroSeconds(threadClock);
+    uint64_t wallStart = GPIOBackendGetTime(backend);
+    GPIOBackendSleep(backend, 2000000);
+    uint64_t wallDuration = GPIOBackendGetTime(backend) - wallStart;
+    uint64_t receiveCPU = (CPUTimeInMicroSeconds(processClock) - processStart) - 
+                          (CPUTimeInMicroSeconds(threadClock) - threadStart);
+    result.idleCPU = 100.0 * (double) receiveCPU / (double) wallDuration;
 
-    // the entire string is made up of whitespace
-    // return a pointer to the terminating NULL char
-    if(*string == '\0') 
-    { return NULL; }
+    // timestamp accuracy: single edges, far enough apart to pair each written
+    // edge with the edge received after it
+    uint32_t sentTicks[BenchmarkEdgeCount / 2];
+    atomic_store(&benchmarkEdgeTickCount, 0);
+    atomic_store(&benchmarking, true);
+    for (uint32_t index = 0; index < BenchmarkEdgeCount / 2; index++)
+    {
+        sentTicks[index] = GPIOBackendGetTick(backend);
+        GPIOBackendWrite(backend, transmitPIN, (index + 1) % 2);
+        GPIOBackendSleep(backend, 2000 + (index * 7919) % 1000);
+    }
+    GPIOBackendWrite(backend, transmitPIN, 0);
+    GPIOBackendSleep(backend, 50000);
 
-    // Trim trailing space
-    char *end = string + strlen(string) - 1;
-    while((end > string) && isspace((unsigned char) *end)) 
-    { end -= 1; }
+    uint32_t receivedEdgeCount = atomic_load_explicit(&benchmarkEdgeTickCount, memory_order_acquire);
+    uint64_t errorSum = 0;
+    result.matchedEdges = 0;
+    result.maxError = 0;
+    uint32_t receivedIndex = 0;
+    for (uint32_t index = 0; index < BenchmarkEdgeCount / 2 && receivedIndex < receivedEdgeCount; index++)
+    {
+        // skip received edges from before this one was written (noise)
+        while (receivedIndex < receivedEdgeCount && 
+               (int32_t) (benchmarkEdgeTicks[receivedIndex] - sentTicks[index]) < 0)
+        { receivedIndex++; }
+        if (receivedIndex == receivedEdgeCount) { break; }
 
-    end[1] = '\0';
+        uint32_t error = benchmarkEdgeTicks[receivedIndex] - sentTicks[index];
+        if (error < 1000)
+        {
+            result.matchedEdges += 1;
+            errorSum += error;
+            if (error > result.maxError) { result.maxError = error; }
+            receivedIndex++;
+        }
+    }
+    result.meanError = (result.matchedEdges > 0) ? (double) errorSum / result.matchedEdges : 0;
 
-    return string;
+    // decode rate, and the CPU time that costs
+    atomic_store(&benchmarkReceivedCount, 0);
+    atomic_store(&benchmarkWrongCount, 0);
+    uint32_t randomState = 2020;
+    processStart = CPUTimeInMicroSeconds(processClock);
+    threadStart = CPUTimeInMicroSeconds(threadClock);
+    wallStart = GPIOBackendGetTime(backend);
+    for (uint32_t index = 0; index < benchmarkMessageCount; index++)
+    {
+        atomic_store(&benchmarkReceived, false);
+        LoopbackBenchmarkSendMessage(sender, index, &randomState, &benchmarkExpectedProtocol, &benchmarkExpectedCode);
+
+        // a short spike ends the last pulse of a KFS message, the ISR timeout
+        // (or the spike) that of a COCO message
+        GPIOBackendSleep(backend, 20000 + 1000 * ISRTimeout);
+        GPIOBackendWrite(backend, transmitPIN, 1);
+        GPIOBackendSleep(backend, 50);
+        GPIOBackendWrite(backend, transmitPIN, 0);
+        GPIOBackendSleep(backend, 20000);
+    }
+    wallDuration = GPIOBackendGetTime(backend) - wallStart;
+    receiveCPU = (CPUTimeInMicroSeconds(processClock) - processStart) - 
+                 (CPUTimeInMicroSeconds(threadClock) - threadStart);
+    result.busyCPU = 100.0 * (double) receiveCPU / (double) wallDuration;
+    result.receivedCount = atomic_load(&benchmarkReceivedCount);
+    result.wrongCount = atomic_load(&benchmarkWrongCount);
+
+    atomic_store(&benchmarking, false);
+    stopReceiving();
+    return result;
 }
 
-bool parseArgs(int argc, char *argv[])
+/*
+Receives the same traffic with each of the PIGPIO ingests, and prints how they
+compare on CPU use, timestamp accuracy and the number of decoded messages.
+*/
+void runIngestBenchmarks(OOKSenderRef sender)
 {
-    if (argc < 3) 
+    const Ingest ingests[] = { IngestAlert, IngestISR, IngestSamples };
+    const char * names[] = { "alert", "isr", "samples" };
+    struct IngestBenchmarkResult results[3];
+    for (uint32_t index = 0; index < 3; index++)
     {
-        printf("ERROR: incorect number of arguments.\n");
-        return false; 
+        printf("Benchmarking the %s ingest...\n", names[index]);
+        ingest = ingests[index];
+        results[index] = runIngestBenchmark(sender);
     }
 
-    PIN = atoi(argv[2]);
+    printf("\n  ingest \t idle CPU\t busy CPU\t   edges\tmean error\t max error\treceived\t  wrong\n");
+    for (uint32_t index = 0; index < 3; index++)
+    {
+        printf("  %-7s\t%8.2f%%\t%8.2f%%\t%4u/%3u\t%7.1fµs\t%7uµs\t%4u/%u\t%7u\n",
+               names[index],
+               results[index].idleCPU,
+               results[index].busyCPU,
+               results[index].matchedEdges, BenchmarkEdgeCount / 2,
+               results[index].meanError,
+               results[index].maxError,
+               results[index].receivedCount, benchmarkMessageCount,
+               results[index].wrongCount);
+    }
+}
+#endif
 
-    // strcmp returns 0 when strings are equal
-    if (!strcmp(argv[1], "-s")) 
+/*
+Sends every message in `input`, one per line, back to back using a single 
+sender, and prints a summary of the timing of each message afterwards.
+A line looks like `PROTOCOL [messageField value, ...] [delay MILLISECONDS]`, 
+where the optional delay is a pause after the message was sent. Empty lines
+and lines starting with `#` are skipped.
+*/
+void sendBatch(OOKSenderRef sender, FILE * input)
+{
+    struct BatchResult
     {
-        mode = OperationModerSending;
-        if (5 != argc)
-        {
-            printf("Incorrect number of arguments for sending a message. Expecting: -s PIN PROTOCOL \"[key value...]\". Did you forget quotes around the key-value array?\n");
-            return false;
-        }
+        uint32_t lineNumber;
+        char protocolName[8];
+        uint32_t airtime;   // µs
+        uint32_t delay;     // ms
+        bool sent;
+    };
+    struct BatchResult * results = NULL;
+    uint32_t resultsCount = 0;
+    uint32_t resultsCapacity = 0;
 
-        // get protocol
-        protocol = argv[3];
-        // parse the keyvalue array
-        char *keyValues = argv[4];
-        if ('[' != keyValues[0])
+    uint32_t batchStartTime = GPIOBackendGetTick(backend);
+    uint32_t lineNumber = 0;
+    char line[256];
+    while (NULL != fgets(line, sizeof(line), input))
+    {
+        lineNumber += 1;
+        char * trimmedLine = trimWhitespacesFromString(line);
+        if (NULL == trimmedLine || '#' == trimmedLine[0]) { continue; }
+
+        if (resultsCount == resultsCapacity)
         {
-            printf("Error: expected opening of array with [, got %c.\n", keyValues[0]);
-            return false;
+            resultsCapacity = (0 == resultsCapacity) ? 32 : resultsCapacity * 2;
+            struct BatchResult * newResults = realloc(results, sizeof(struct BatchResult) * resultsCapacity);
+            if (NULL == newResults)
+            {
+                printf("Error: out of memory, stopped at line %u.\n", lineNumber);
+                break;
+            }
+            results = newResults;
         }
+        struct BatchResult * result = &results[resultsCount];
+        resultsCount += 1;
+        result->lineNumber = lineNumber;
+        result->delay = 0;
+        result->airtime = 0;
+        result->sent = false;
+        snprintf(result->protocolName, sizeof(result->protocolName), "%.*s", 
+                 (int) strcspn(trimmedLine, " ["), trimmedLine);
 
-        // KFS values
-        identifier = 0;
-        uint32_t * identifierPtr = NULL;
-
-        // COCO values
-        address = 0;
-        onOff = 0;
-        group = 0;
-        channel = 0;
-        uint32_t * addressPtr = NULL;
-        bool * onOffPtr = NULL;
-        bool * groupPtr = NULL;
-        uint16_t * channelPtr = NULL;
-
-        char * currentKey = NULL;
-        char *keyValuePair;
-        while ((keyValuePair = strsep(&keyValues, ","))) 
+        // split off the optional delay after the key-value array
+        char * arrayEnd = strrchr(trimmedLine, ']');
+        if (NULL != arrayEnd)
         {
-            char * trimmedKeyValuePair = trimWhitespacesFromString(keyValuePair);
-            if (NULL != trimmedKeyValuePair)
+            char * delayKeyValue = trimWhitespacesFromString(arrayEnd + 1);
+            arrayEnd[1] = '\0';
+            if (NULL != delayKeyValue)
             {
-                char *keyOrValue;
-                while ((keyOrValue = strsep(&keyValuePair, " "))) 
-                {
-                    char * trimmedKeyOrValue = trimWhitespacesFromString(keyOrValue);
-                    if (NULL != trimmedKeyOrValue)
-                    {
-                        if (!strcmp("[", trimmedKeyOrValue) || !strcmp("]", trimmedKeyOrValue))
-                        { /* noting to do, just the opening or closing of the array */ }
-                        else 
-                        {
-                            if (trimmedKeyOrValue[0] == '[')
-                            { trimmedKeyOrValue += 1; }
-                            
-                            int length = strlen(trimmedKeyOrValue);
-                            if (trimmedKeyOrValue[length - 1] == ']')
-                            { trimmedKeyOrValue[length - 1] = '\0'; }
-
-                            if (NULL == currentKey)
-                            { currentKey = trimmedKeyOrValue; }
-                            else 
-                            {
-                                if (!strcmp(currentKey, "identifier"))
-                                {
-                                    identifier = atoi(trimmedKeyOrValue);
-                                    identifierPtr = &identifier;
-                                }
-                                else if (!strcmp(currentKey, "address"))
-                                {
-                                    address = atoi(trimmedKeyOrValue);
-                                    addressPtr = &address;
-                                }
-                                else if (!strcmp(currentKey, "onOff"))
-                                {
-                                    onOff = atoi(trimmedKeyOrValue);
-                                    onOffPtr = &onOff;
-                                }
-                                else if (!strcmp(currentKey, "group"))
-                                {
-                                    group = atoi(trimmedKeyOrValue);
-                                    groupPtr = &group;
-                                }
-                                else if (!strcmp(currentKey, "channel"))
-                                {
-                                    channel = atoi(trimmedKeyOrValue);
-                                    channelPtr = &channel;
-                                }
-                                else 
-                                {
-                                    printf("Error: unkown key in key-value list: %s\n", currentKey);
-                                    return false;
-                                }
-                                currentKey = NULL;
-                            }
-                        }
-                    }
-                }
-                if (NULL != currentKey)
+                char * delayValue = NULL;
+                if (!strncmp(delayKeyValue, "delay", 5) &&
+                    NULL != (delayValue = trimWhitespacesFromString(delayKeyValue + 5)))
+                { result->delay = (uint32_t) strtoul(delayValue, NULL, 10); }
+                else
                 {
-                    printf("Error: extraneous token found: `%s`. Did you forget to specify a key or its value?\n", currentKey);
-                    return false;
+                    printf("Error on line %u: expected `delay MILLISECONDS` after the message, got `%s`.\n", lineNumber, delayKeyValue);
+                    continue;
                 }
             }
         }
 
-        if (!strcmp(protocol, "KFS"))
+        uint32_t startTime = GPIOBackendGetTick(backend);
+        if (sendMessageLine(sender, trimmedLine))
         {
-            if (NULL == identifierPtr)
-            {
-                printf("Error: no key-value specified for identifier.\n");
-                return false;
-            }
-            return true;
+            result->airtime = GPIOBackendGetTick(backend) - startTime;
+            result->sent = true;
         }
-        else if (!strcmp(protocol, "COCO"))
+        else
         {
-            bool shouldExit = false;
-            if (NULL == addressPtr)
-            {
-                printf("Error: no key-value specified for address.\n");
-                shouldExit = true;
-            }
-            if (NULL == onOffPtr)
-            {
-                printf("Error: no key-value specified for onOff.\n");
-                shouldExit = true;
-            }
-            if (NULL == groupPtr)
-            {
-                printf("Error: no key-value specified for group.\n");
-                shouldExit = true;
-            }
-            if (NULL == channelPtr)
-            {
-                printf("Error: no key-value specified for channel.\n");
-                shouldExit = true;
-            }
-            
-            if (shouldExit) { return false; }           
-
-            return true;
+            printf("Error on line %u: message not sent.\n", lineNumber);
         }
+
+        if (result->delay > 0) { GPIOBackendSleep(backend, result->delay * 1000); }
     }
-    else if (!strcmp(argv[1], "-r"))
+    uint32_t batchDuration = GPIOBackendGetTick(backend) - batchStartTime;
+
+    uint32_t sentCount = 0;
+    uint64_t totalAirtime = 0;
+    printf("\n╔══════╤══════════╤══════════════╤════════════╗\n");
+    printf("║ line │ protocol │ airtime (ms) │ delay (ms) ║\n");
+    printf("╟──────┼──────────┼──────────────┼────────────╢\n");
+    for (uint32_t index = 0; index < resultsCount; index++)
     {
-        if (argc > 3) 
+        struct BatchResult * result = &results[index];
+        if (result->sent)
         {
-            printf("ERROR: too many arguments.\n");
-            return false; 
+            printf("║ %4u │ %-8s │ %12.1f │ %10u ║\n", result->lineNumber, result->protocolName, result->airtime / 1000.0, result->delay);
+            sentCount += 1;
+            totalAirtime += result->airtime;
+        }
+        else
+        {
+            printf("║ %4u │ %-8s │   not sent   │ %10u ║\n", result->lineNumber, result->protocolName, result->delay);
         }
-        mode = OperationModerReceiving;
-        return true; 
-    }
-    else 
-    {
-        printf("Incorrect 2nd argument. Expected \"-r\" or \"-s\", but got \"%s\".", argv[1]);
-        return false;
     }
-	return false;
+    printf("╚══════╧══════════╧══════════════╧════════════╝\n");
+    printf("Sent %u of %u messages in %.1f ms (%.1f ms airtime).\n", 
+           sentCount, resultsCount, batchDuration / 1000.0, totalAirtime / 1000.0);
+
+    free(results);
 }
 
-void sendCOCOMessage(int PIN, uint32_t address, bool onOff, bool group, uint16_t channel)
+/*
+Handles `CONFIG TARGET key value`, where TARGET is COCO, KFS, LBT or ECHO, and 
+key the name of one of its properties (e.g. `CONFIG COCO repeatCount 3`).
+Tolerances are 1 - 100 (%). The receivers take a COCO or KFS setting before
+they are fed their next edge.
+*/
+bool configure(char * arguments)
 {
-    COCOMessageRef message = COCOMessageCreate();
-    COCOMessageSetAddress(message, address); // 26541806
-    COCOMessageSetGroup(message, group);
-    COCOMessageSetOnOff(message, onOff);
-    COCOMessageSetChannel(message, channel);
+    char * target = strsep(&arguments, " ");
+    char * key = strsep(&arguments, " ");
+    char * value = (NULL != arguments) ? trimWhitespacesFromString(arguments) : NULL;
+    if (NULL == target || NULL == key || NULL == value) { return false; }
 
-    OOKSenderRef sender = OOKSenderCreate();
-    OOKSenderSetTransmitGPIO(sender, PIN);
+    uint32_t number = (uint32_t) strtoul(value, NULL, 10);
+    if (!strcmp(target, "COCO") || !strcmp(target, "KFS"))
+    {
+        ReceiverSetting setting;
+        setting.isCOCO = !strcmp(target, "COCO");
+        setting.value = number;
+        if (!strcmp(key, "repeatCount"))              { setting.key = ReceiverSettingRepeatCount; }
+        else if (!strcmp(key, "refractoryPeriod"))    { setting.key = ReceiverSettingRefractoryPeriod; }
+        else if (!strcmp(key, "singlePulseDuration")) { setting.key = ReceiverSettingSinglePulseDuration; }
+        else if (!strcmp(key, "positiveTolerance"))   { setting.key = ReceiverSettingPositiveTolerance; }
+        else if (!strcmp(key, "negativeTolerance"))   { setting.key = ReceiverSettingNegativeTolerance; }
+        else { return false; }
 
-    printf("Sending COCO message with address = %lu, group = %u, onOff = %u, channel = %u\n", 
-            COCOMessageGetAddress(message),
-            COCOMessageGetGroup(message),
-            COCOMessageGetOnOff(message),
-            COCOMessageGetChannel(message));
-    OOKSenderSendCOCO(sender, message);
+        bool isTolerance = (ReceiverSettingPositiveTolerance == setting.key || ReceiverSettingNegativeTolerance == setting.key);
+        if (isTolerance && (number < 1 || number > 100)) { return false; }
 
-    // cleanup
-    OOKSenderRelease(sender);
-    COCOMessageRelease(message);
+        // the receivers are fed on another thread: that thread applies it
+        for (uint32_t index = 0; index < receivePINCount; index++)
+        {
+            if (!BoundedQueueTryPush(receivePINs[index].pendingSettings, &setting)) { return false; }
+        }
+    }
+    else if (!strcmp(target, "LBT"))
+    {
+        if (!strcmp(key, "enabled"))
+        {
+            listenBeforeTalk = (0 != number);
+            OOKSenderSetListenBeforeTalk(duplexSender, listenBeforeTalk);
+        }
+        else if (!strcmp(key, "deadline")) { OOKSenderSetListenBeforeTalkDeadline(duplexSender, number); }
+        else { return false; }
+    }
+    else if (!strcmp(target, "ECHO"))
+    {
+        if (!strcmp(key, "guardPeriod")) { EchoFilterSetGuardPeriod(echoFilter, number); }
+        else { return false; }
+    }
+    else { return false; }
+
+    return true;
 }
-void sendKFSMessage(int PIN, uint32_t identifier)
-{
-    KFSMessageRef message = KFSMessageCreate();
-    KFSMessageSetIdentifier(message, identifier);
 
-    OOKSenderRef sender = OOKSenderCreate();
-    OOKSenderSetTransmitGPIO(sender, PIN);
+void replyLatencyLine(const char * line, void * context)
+{
+    CommandServerReply(context, "LATENCY %s", line);
+}
 
-    printf("Sending KFSMessage with identifier = %lu ...\n", identifier);
-    OOKSenderSendKFS(sender, message);
+/*
+The daemon's commands, one per line:
+    SEND PROTOCOL [messageField value, ...]  -> `OK <airtime in µs>`
+    SUBSCRIBE / UNSUBSCRIBE                  -> `OK`, after which received messages 
+                                                are sent as e.g. `KFS identifier 38883`
+    CONFIG TARGET key value                  -> `OK`
+    LATENCY                                  -> one `LATENCY ...` line per latency,
+                                                then `OK`
+    PING                                     -> `OK`
+Any command that fails is answered with `ERR <reason>`.
+*/
+void daemonCommandReceived(CommandServerRef server, CommandServerClientRef client, char * line)
+{
+    char * command = strsep(&line, " ");
+    if (!strcmp(command, "SEND"))
+    {
+        uint32_t startTime = GPIOBackendGetTick(backend);
+        if (NULL != line && sendMessageLine(duplexSender, line))
+        { CommandServerReply(client, "OK %u", GPIOBackendGetTick(backend) - startTime); }
+        else
+        { CommandServerReply(client, "ERR invalid message, expected: SEND PROTOCOL [messageField value, ...]"); }
+    }
+    else if (!strcmp(command, "SUBSCRIBE"))
+    {
+        CommandServerClientSetSubscribed(client, true);
+        CommandServerReply(client, "OK");
+    }
+    else if (!strcmp(command, "UNSUBSCRIBE"))
+    {
+        CommandServerClientSetSubscribed(client, false);
+        CommandServerReply(client, "OK");
+    }
+    else if (!strcmp(command, "CONFIG"))
+    {
+        if (NULL != line && configure(line))
+        { CommandServerReply(client, "OK"); }
+        else
+        { CommandServerReply(client, "ERR invalid configuration, expected: CONFIG COCO|KFS|LBT|ECHO key value"); }
+    }
+    else if (!strcmp(command, "LATENCY"))
+    {
+        describeLatencies(&replyLatencyLine, client);
+        CommandServerReply(client, "OK");
+    }
+    else if (!strcmp(command, "PING"))
+    {
+        CommandServerReply(client, "OK");
+    }
+    else if ('\0' != command[0])
+    {
+        CommandServerReply(client, "ERR unknown command `%s`", command);
+    }
+}
 
-    // cleanup
-    OOKSenderRelease(sender);
-    KFSMessageRelease(message);
+// PIGPIO installs its own signal handlers, this one replaces it for SIGINT and 
+// SIGTERM in daemon mode, so that the daemon can clean up.
+void daemonSignalReceived(int signal)
+{
+    if (NULL != commandServer) { CommandServerStop(commandServer); }
 }
 
 int main(int argc, char *argv[]) 
 {	
+    statusOutput = stdout;
     if (parseArgs(argc, argv))
     {
-        if (gpioInitialise() == PI_INIT_FAILED)
+        if (hasOutputFormat) { statusOutput = stderr; }
+
+        // the benchmark brings its own, simulated, backend
+        if (OperationModerLoopbackBenchmark == mode)
+        {
+            return LoopbackBenchmarkRun(benchmarkMessageCount, benchmarkJitter, IngestNotify == ingest, useProtocolEngine) ? 0 : 1;
+        }
+
+        if (IngestCharacterDevice == ingest)
+        {
+            backend = CharacterDeviceGPIOBackendCreate(characterDevicePath);
+            if (NULL == backend) { return 1; }
+        }
+        else if (IngestNotify == ingest && NULL != notificationPipePath)
         {
-            fprintf(stderr, "pigpio initialisation failed.\n");
+            // another process (e.g. the PIGPIO daemon) owns the GPIOs: only 
+            // a clock and timers are needed
+            backend = CharacterDeviceGPIOBackendCreate(NULL);
+            if (NULL == backend) { return 1; }
+        }
+        else
+        {
+            backend = PIGPIOBackendGet();
+            if (NULL == backend)
+            {
+                fprintf(stderr, "LPD433 was built without PIGPIO, only -t and -r with -i cdev or -i notify:PATH are available.\n");
+                return 1;
+            }
+        }
+        if (GPIOBackendInitialise(backend) < 0)
+        {
+            fprintf(stderr, "%s initialisation failed.\n", backend->name);
+            GPIOBackendRelease(backend);
             return 1;
         }
         else
@@ -338,43 +2463,61 @@ int main(int argc, char *argv[])
                     printf("Programmer error: unknonw operation mode.\n");
                     exit(1);
                     break;
+                case OperationModerLoopbackBenchmark:
+                    // handled above
+                    break;
+                case OperationModerIngestBenchmark:
+                {
+#if LPD433PIGPIO
+                    OOKSenderRef sender = OOKSenderCreate();
+                    OOKSenderSetBackend(sender, backend);
+                    OOKSenderSetTransmitGPIO(sender, transmitPIN);
+                    runIngestBenchmarks(sender);
+                    OOKSenderRelease(sender);
+#endif
+                    break;
+                }
                 case OperationModerSending:
                 {
-                    gpioSetMode(PIN, PI_OUTPUT);
+                    OOKSenderRef sender = OOKSenderCreate();
+                    OOKSenderSetBackend(sender, backend);
+                    OOKSenderSetTransmitGPIO(sender, PIN);
                     if (!strcmp(protocol, "COCO"))
                     {
-                        sendCOCOMessage(PIN, address, onOff, group, channel);
+                        sendCOCOMessage(sender, address, onOff, group, channel, dimLevel);
                     }
                     else if (!strcmp(protocol, "KFS"))
                     {
-                        sendKFSMessage(PIN, identifier);
+                        sendKFSMessage(sender, identifier);
+                    }
+                    else if (NULL != ProtocolDescriptorFind(protocol))
+                    {
+                        if (!sendDescriptorMessage(sender, ProtocolDescriptorFind(protocol), messageKeyValues))
+                        {
+                            OOKSenderRelease(sender);
+                            GPIOBackendTerminate(backend);
+                            return 1;
+                        }
+                    }
+                    else if (!sendPluginMessage(sender, protocol, messageKeyValues))
+                    {
+                        OOKSenderRelease(sender);
+                        GPIOBackendTerminate(backend);
+                        return 1;
                     }
+                    OOKSenderRelease(sender);
                     break;
                 }
                 case OperationModerReceiving:
                 {
-                    printf("Listening on PIN %i...\n", PIN);
-
-                    COCOReceiver = COCOReceiverCreate();
-                    COCOReceiverSetCallback(COCOReceiver, &COCOCallback);
-                    COCOReceiverSetRefractoryPeriod(COCOReceiver, 0);
-                    COCOReceiverSetRepeatCount(COCOReceiver, 1);
-                    // the next line could be usefull for debugging
-                    // COCOReceiverSetRecordReceivedTransmissions(COCOReceiver, true);
-
-                    KFSReceiver = KFSReceiverCreate();
-                    KFSReceiverSetCallback(KFSReceiver, &KFSCallback);
-                    KFSReceiverSetRefractoryPeriod(KFSReceiver, 0);
-                    KFSReceiverSetRepeatCount(KFSReceiver, 1);
-                    // the next line could be usefull for debugging
-                    // KFSSetRecordReceivedTransmissions(KFSReceiver, true);
-
-                    
-                    gpioSetMode(PIN, PI_INPUT);
-                    gpioSetAlertFunc(PIN, gpioValueChanged);
+                    fprintf(statusOutput, "Listening on PIN");
+                    for (uint32_t index = 0; index < receivePINCount; index++)
+                    { fprintf(statusOutput, " %i", receivePINs[index].PIN); }
+                    fprintf(statusOutput, "...\n");
+                    startReceiving();
 
                     char input[20];
-                    printf("Type <enter> to stop listening and exit the program.\n");
+                    fprintf(statusOutput, "Type <enter> to stop listening and exit the program.\n");
                     fgets(input,20,stdin);
 
                     if (strcmp(input, ""))
@@ -384,9 +2527,111 @@ int main(int argc, char *argv[])
                     while (receiving) { ; }
 
                     // cleanup
-                    gpioSetAlertFunc(PIN, NULL);    
-                    KFSReceiverRelease(KFSReceiver);
-                    COCOReceiverRelease(COCOReceiver);
+                    stopReceiving();
+                    break;
+                }
+                case OperationModerDuplex:
+                {
+                    // both sides share this single PIGPIO instance: the 
+                    // receivers get called on PIGPIO's thread, while messages
+                    // are sent from this thread.
+                    echoFilter = EchoFilterCreate();
+                    OOKSenderRef sender = OOKSenderCreate();
+                    OOKSenderSetBackend(sender, backend);
+                    OOKSenderSetTransmitGPIO(sender, transmitPIN);
+                    OOKSenderSetListenBeforeTalk(sender, listenBeforeTalk);
+                    duplexSender = sender;
+
+                    printf("Listening on PIN %i, sending on PIN %i...\n", PIN, transmitPIN);
+                    startReceiving();
+
+                    printf("Type a message to send, e.g. `KFS [identifier 38883]`, or <enter> to stop and exit the program.\n");
+                    char input[256];
+                    while (receiving && NULL != fgets(input, sizeof(input), stdin))
+                    {
+                        if (NULL == trimWhitespacesFromString(input))
+                        { receiving = false; }
+                        else 
+                        { sendMessageLine(sender, input); }
+                    }
+
+                    // cleanup
+                    stopReceiving();
+                    if (listenBeforeTalk)
+                    {
+                        printf("Listen-before-talk: channel busy %u times, backed off %u times (%llu ms in total), transmitted on a busy channel %u times.\n",
+                            OOKSenderGetBusyCount(sender),
+                            OOKSenderGetBackoffCount(sender),
+                            (unsigned long long) (OOKSenderGetBackoffTime(sender) / 1000),
+                            OOKSenderGetDeadlineExpiredCount(sender));
+                    }
+                    duplexSender = NULL;
+                    OOKSenderRelease(sender);
+                    printf("Recognised %u echoes of our own messages.\n", EchoFilterGetEchoCount(echoFilter));
+                    EchoFilterRelease(echoFilter);
+                    echoFilter = NULL;
+                    break;
+                }
+                case OperationModerBatch:
+                {
+                    FILE * input = stdin;
+                    if (NULL != batchFilePath)
+                    {
+                        input = fopen(batchFilePath, "r");
+                        if (NULL == input)
+                        {
+                            printf("Error: could not open `%s`.\n", batchFilePath);
+                            GPIOBackendTerminate(backend);
+                            return 1;
+                        }
+                    }
+
+                    OOKSenderRef sender = OOKSenderCreate();
+                    OOKSenderSetBackend(sender, backend);
+                    OOKSenderSetTransmitGPIO(sender, PIN);
+                    sendBatch(sender, input);
+                    OOKSenderRelease(sender);
+
+                    if (stdin != input) { fclose(input); }
+                    break;
+                }
+                case OperationModerDaemon:
+                {
+                    commandServer = CommandServerCreate(socketPath);
+                    if (NULL == commandServer)
+                    {
+                        GPIOBackendTerminate(backend);
+                        return 1;
+                    }
+                    CommandServerSetCallback(commandServer, &daemonCommandReceived);
+
+                    // everything is set up once, each command only costs 
+                    // the time it takes to transmit
+                    echoFilter = EchoFilterCreate();
+                    duplexSender = OOKSenderCreate();
+                    OOKSenderSetBackend(duplexSender, backend);
+                    OOKSenderSetTransmitGPIO(duplexSender, transmitPIN);
+                    startReceiving();
+
+#if LPD433PIGPIO
+                    gpioSetSignalFunc(SIGINT, daemonSignalReceived);
+                    gpioSetSignalFunc(SIGTERM, daemonSignalReceived);
+#else
+                    signal(SIGINT, daemonSignalReceived);
+                    signal(SIGTERM, daemonSignalReceived);
+#endif
+
+                    printf("Listening on PIN %i, sending on PIN %i, accepting commands on `%s`...\n", PIN, transmitPIN, socketPath);
+                    CommandServerRun(commandServer);
+
+                    // cleanup
+                    stopReceiving();
+                    CommandServerRelease(commandServer);
+                    commandServer = NULL;
+                    OOKSenderRelease(duplexSender);
+                    duplexSender = NULL;
+                    EchoFilterRelease(echoFilter);
+                    echoFilter = NULL;
                     break;
                 }
             }
@@ -399,6 +2644,8 @@ int main(int argc, char *argv[])
     	exit(1);
     }
 
+    GPIOBackendTerminate(backend);
+    GPIOBackendRelease(backend);
 	return 0;
 }
 
@@ -413,8 +2660,13 @@ void printUsage()
     LPD433 - (\e[1mL\e[0mow \e[1mP\e[0mower \e[1mD\e[0mevice \e[1m433\e[0mMHz) send or receive messages in the 433MHz band\n\
 \n\
 \e[1mSYNOPSIS\e[0m\n\
-    LPD433 -r PIN\n\
-    LPD433 -s PIN PROTOCOL \"[messageField value, ...]\"\n\
+    LPD433 -r PIN [PIN ...] [-i INGEST] [-n] [-E] [-p PROTOCOLS] [-P DIRECTORY] [-S SECONDS] [-H] [-w WORKERS] [-o FORMAT]\n\
+    LPD433 -s PIN PROTOCOL \"[messageField value, ...]\" [-P DIRECTORY]\n\
+    LPD433 -b PIN [FILE]\n\
+    LPD433 -d RECEIVEPIN TRANSMITPIN [-l]\n\
+    LPD433 -D SOCKETPATH RECEIVEPIN TRANSMITPIN\n\
+    LPD433 -t [COUNT [JITTER [notify] [engine]]]\n\
+    LPD433 -T RECEIVEPIN TRANSMITPIN [COUNT]\n\
 \n\
 \e[1mDESCRIPTION\e[0m\n\
     433MHz send and/or receive hardware is required to be connected to the Raspberry Pi's GPIO pins.\n\
@@ -426,10 +2678,91 @@ void printUsage()
         Send a message on the GPIO PIN specified. PROTOCOL should be either `COCO`, for a ClickOnClickOff messate, or KFS for a KeyFobSwitch\n\
         message. All fields are required. Fields and valuetypes:\n\
         COCO: \"[address <26 bit unsigned integer>, onOff <1 or 0>, group <1 or 0, channel <16bit unsigned integer>]\"\n\
+              An optional \"dimLevel <0 - 15>\" sends a dim message, which sets a dimmer to that level instead of on or off.\n\
         KFS:  \"[identifier, <24 bit unsigned integer>]\"\n\
+        EV1527: \"[id <20 bit unsigned integer>, data <4 bit unsigned integer>]\"\n\
+        PT2262: \"[address <8 trits: 0, 1 or F>, data <4 trits>]\", e.g. \"[address 0F1F0011, data F010]\"\n\
         N.b. the array of messageField names and values \e[4mmust\e[0m be enclosed in quotes.\n\
-    -r  PIN\n\
+        -P DIRECTORY  PROTOCOL may also be the name of a decoder plugin in DIRECTORY that can encode, see -r.\n\
+    -b  PIN [FILE]\n\
+        Batch: send all messages in FILE (or read from the standard input) through PIN, one message per line, then print the timing\n\
+        of each message. A line looks like: PROTOCOL [messageField value, ...] [delay MILLISECONDS], e.g.\n\
+        COCO [address 235498, onOff 1, group 0, channel 3] delay 500\n\
+        The optional delay is a pause after sending the message. Empty lines and lines starting with # are skipped.\n\
+    -r  PIN [PIN ...]\n\
         Receive messages. Details of the messages are printed to the standard output. PIN is a required number that specifies through which GPIO pin the message needs to be received. The program will run until you hit <enter>, or use CTRL-C.\n\
+        Up to 8 PINs, each with its own receiver module, can be given to extend the range. A message received on more than one PIN is\n\
+        reported once, from the PIN that received it best. Per-PIN statistics are printed when the program ends.\n\
+        -i INGEST selects how the GPIO edges are read:\n\
+            alert[:MILLIS]  (default) one PIGPIO alert callback per edge per PIN. A PIGPIO watchdog finalises a message\n\
+                     that is followed by MILLIS (default 3, 0: no watchdog) ms without edges, e.g. the last KFS message of a\n\
+                     transmission, which has no end-sync.\n\
+            samples  the raw level samples of all PINs are processed in bulk, which costs less with many PINs.\n\
+            isr[:MILLIS]  one interrupt handler per PIN, no sampling: edges cost no CPU until they occur. A message that is\n\
+                     followed by MILLIS (default 20) ms without edges is finalised without waiting for the next edge.\n\
+            notify[:PATH]  the level changes of all PINs are read in blocks from a PIGPIO notification pipe: one read per\n\
+                     block of changes instead of one callback per edge. Without PATH, this process opens a pipe. With PATH\n\
+                     (e.g. /dev/pigpio0 opened by `pigs no` and `pigs nb 0 MASK`, or any FIFO PIGPIO reports are written to), the\n\
+                     GPIOs are left to that process, e.g. the PIGPIO daemon, and PIGPIO is not initialised.\n\
+            cdev[:CHIPPATH]  no PIGPIO: the kernel timestamps the edges, which are read in batches from the GPIO character device\n\
+                     CHIPPATH (default /dev/gpiochip0). Uses no CPU while the band is silent.\n\
+        -n  the receiver modules are inverted: their output is low while they receive a carrier.\n\
+        -E  decode with one ProtocolEngine per PIN, which describes COCO and KFS as tables (see ProtocolDescriptor.h), instead\n\
+            of with the hand-written receivers: an edge only reaches the decoders whose start-sync was seen, so that more\n\
+            protocols do not cost more per edge.\n\
+        -p PROTOCOLS  decode the comma-separated PROTOCOLS with the ProtocolEngine (implies -E): COCO, KFS, EV1527 and PT2262\n\
+            (default COCO,KFS). EV1527 and PT2262 are the chips of most cheap sensors and remotes; their frames look like KFS\n\
+            frames, so only list the protocols that are around. Frames of EV1527 and PT2262 are printed as text, also with -o.\n\
+            Oregon adds an OregonReceiver per PIN for the Manchester-coded temperature and humidity sensors of Oregon\n\
+            Scientific (protocol 2.1 and 3), printed as text too.\n\
+        -P DIRECTORY  load every decoder plugin (`*.so`, see src/LPD433Plugin.h) in DIRECTORY, and feed the edges of each PIN\n\
+            to a decoder of each plugin too, in batches. Their messages are printed as the plugin formats them. The CPU time\n\
+            each plugin used is printed when the program ends, and with -S.\n\
+        -S SECONDS  every SECONDS (1 - 60) seconds, and when the program ends, print per PIN and protocol how many edges,\n\
+            syncs and frames were received, why and at which bit frames were rejected, how many messages were repeats or\n\
+            suppressed, and how many edges were lost before they reached the receivers.\n\
+        -H  on `kill -USR1`, and when the program ends, print per PIN the histogram of the durations of all pulses and gaps,\n\
+            the clusters (peaks) in it, and the single pulse duration and tolerances they suggest for the COCO and KFS\n\
+            receivers: to tune them to the remotes that are actually around.\n\
+        The latency of every message is recorded: from its first edge until the receiver recognised it (decode), from its\n\
+        last edge until it is printed (queue), the printing itself (handler) and from its first edge until it was printed\n\
+        (total). `kill -USR1` prints the percentiles; with -d and -D also those of sending: from the request until the first\n\
+        pulse, and until the last repeat was sent. Not with -i notify:PATH, whose edges are timed by another process.\n\
+        -w WORKERS  print (or write) received messages on a pool of WORKERS (1 - 64) threads, instead of on the thread that\n\
+            decodes the edges, so that slow output never delays decoding. The messages of one device stay in order. The queue\n\
+            latency is printed when the program ends.\n\
+        -o FORMAT  how received messages are written to the standard output: text (default), or in a machine-readable format:\n\
+            json     one JSON object per line, e.g. {\"time\":1595321234567890,\"protocol\":\"KFS\",\"pin\":27,\"code\":235498,...}\n\
+            csv      a header line, then one line per message\n\
+            binary   a 16 byte record per message: time (µs since 1970, uint64), code (uint32), protocol (1: COCO, 2: KFS,\n\
+                     3: Oregon, 4: -p/-E protocols, 5: plugins), quality, pin, flags (bit 0: echo, bit 1: COCO dim message,\n\
+                     bits 4 - 7: its dim level, bit 2: followed by the message as text, a uint8 length and that many bytes);\n\
+                     little-endian. See MessageWriter.h.\n\
+            Messages are written on a separate thread, so a slow reader never delays receiving: when 1024 messages are waiting\n\
+            to be written, further messages are dropped and counted. All other output goes to the standard error.\n\
+    -d  RECEIVEPIN TRANSMITPIN [-l]\n\
+        Duplex: receive messages on RECEIVEPIN like -r does, while sending messages on TRANSMITPIN. Each line typed on the standard input\n\
+        is sent as a message: PROTOCOL [messageField value, ...], e.g. KFS [identifier 235498]. Received messages that match one of our\n\
+        own transmissions are tagged as an echo. An empty line ends the program.\n\
+        -l  listen-before-talk: before sending, wait (with a random backoff) until no other transmission is received on RECEIVEPIN.\n\
+    -D  SOCKETPATH RECEIVEPIN TRANSMITPIN\n\
+        Daemon: like -d, but commands are read from clients connecting to the Unix domain socket SOCKETPATH, one command per line:\n\
+        SEND PROTOCOL [messageField value, ...]   send a message, answers `OK <airtime in µs>`\n\
+        SUBSCRIBE | UNSUBSCRIBE                   (stop) receive detected messages, e.g. `KFS identifier 235498`\n\
+        CONFIG COCO|KFS|LBT|ECHO key value        e.g. `CONFIG COCO repeatCount 3`, `CONFIG LBT enabled 1`\n\
+        PING\n\
+        LATENCY                                   the receive and send latencies, one `LATENCY ...` line each, see -r\n\
+        Failing commands are answered with `ERR <reason>`. The daemon runs until it receives SIGINT or SIGTERM.\n\
+    -t  [COUNT [JITTER [notify] [engine]]]\n\
+        Loopback benchmark: no hardware is used. COUNT (default 1000) messages are sent on a simulated PIN that is connected to\n\
+        the receivers on another simulated PIN, with each edge delayed by up to JITTER (default 0) µs. Prints how many messages\n\
+        were received, and how much faster than real time sending and receiving ran. Does not need root priviliges.\n\
+        With `notify`, the edges go to the receivers through a FIFO, as PIGPIO notification reports, like -i notify reads them.\n\
+        With `engine`, the edges are decoded by the ProtocolEngine, like -r -E does.\n\
+    -T  RECEIVEPIN TRANSMITPIN [COUNT]\n\
+        Ingest benchmark: TRANSMITPIN must be connected to RECEIVEPIN by a wire. For each of the alert, isr and samples ingests,\n\
+        measures the CPU use while idle and while receiving, the delay between writing an edge and receiving it, and how many\n\
+        of COUNT (default 100) messages are decoded. Prints a table comparing the ingests.\n\
 \n\
 \e[1mAuthor\e[0m\n\
     LPD433 is written and maintained by Jorrit van Asselt, \e[4mhttps://github.com/Joride/\e[0m.\n\
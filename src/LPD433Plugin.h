@@ -0,0 +1,89 @@
+#ifndef LPD433Plugin_h
+#define LPD433Plugin_h
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+
+/*
+The interface between LPD433 and a decoder plugin: a shared library that
+decodes (and optionally encodes) one more protocol, without rebuilding
+LPD433. This file is all a plugin needs, e.g.
+    gcc -shared -fPIC -o plugins/MyRemote.so MyRemote.c
+and `LPD433 -r 27 -P plugins` loads every `.so` in the `plugins` directory.
+
+A plugin exports one function,
+    const LPD433Plugin * LPD433PluginGet(void);
+(its name is in LPD433PluginEntryPoint), that returns a pointer to an
+LPD433Plugin that stays valid until the library is closed. plugins/Example.c
+is a complete plugin to start from.
+LPD433 creates one decoder per receive PIN, and feeds it the edges of that
+PIN in batches, always from the same thread. A decoder reports each frame it
+decodes by calling the `frameFunction` it was created with, from within
+`feedEdges`.
+
+The structs only ever grow at the end, and LPD433PluginABIVersion changes
+whenever they change in another way: LPD433 refuses plugins built for another
+version.
+*/
+
+#define LPD433PluginABIVersion 1
+#define LPD433PluginEntryPoint "LPD433PluginGet"
+
+// the level of an edge that is not an edge, but a silence of at least
+// `timestamp` minus the previous edge: finish what is being received
+#define LPD433PluginLevelTimeout 2
+
+#define LPD433PluginMaxDataLength 16
+
+typedef struct LPD433PluginEdge
+{
+    uint32_t timestamp; // µs, wraps around
+    uint32_t level;     // of the carrier after the edge: 1 while it is on (inverted receivers are already accounted for), or LPD433PluginLevelTimeout
+} LPD433PluginEdge;
+
+typedef struct LPD433PluginFrame
+{
+    uint64_t code;           // identifies the message, e.g. to drop the copies received on several PINs
+    uint32_t bitCount;
+    uint8_t quality;         // 0 - 100, see COCOMessageGetQuality()
+    uint32_t startTimestamp; // of the first edge of the frame
+    uint32_t endTimestamp;   // of the last edge of the frame
+    uint32_t dataLength;     // of what does not fit in `code`, if anything
+    uint8_t data[LPD433PluginMaxDataLength];
+} LPD433PluginFrame;
+
+// `frame` is copied during the call
+typedef void (*LPD433PluginFrameFunction)(void * host, const LPD433PluginFrame * frame);
+
+typedef struct LPD433Plugin
+{
+    uint32_t ABIVersion; // LPD433PluginABIVersion
+    const char * name;   // the protocol, e.g. as given to `LPD433 -s`
+
+    // Returns a new decoder, or NULL. It reports frames by calling
+    // `frameFunction` with `host`.
+    void * (*create)(LPD433PluginFrameFunction frameFunction, void * host);
+    void (*release)(void * decoder);
+
+    // forget the frame that is being received, e.g. after edges were lost
+    void (*reset)(void * decoder);
+
+    // `count` edges of one PIN, oldest first
+    void (*feedEdges)(void * decoder, const LPD433PluginEdge * edges, uint32_t count);
+
+    // Writes `frame` as text, e.g. `MyRemote [button 3]`. Returns what
+    // snprintf() returns.
+    int (*format)(const LPD433PluginFrame * frame, char * buffer, size_t size);
+
+    // Optional, NULL if the plugin can not send. Writes the durations (µs) of
+    // the pulses of the message `keyValues` (as given to `LPD433 -s`, e.g.
+    // `[ button 3 ]`) into `durations`, alternately high and low, starting
+    // high, and the number of times to send them after the first time into
+    // `repeatCount`. Returns the number of durations, or 0 on error.
+    uint32_t (*encode)(const char * keyValues, uint32_t * durations, uint32_t capacity, uint32_t * repeatCount);
+} LPD433Plugin;
+
+typedef const LPD433Plugin * (*LPD433PluginGetFunction)(void);
+
+#endif
@@ -0,0 +1,169 @@
+#include <assert.h>
+#include <stdatomic.h>
+#include "LatencyHistogram.h"
+
+// every power of two is split into 2^LatencyHistogramSubBucketBits buckets of
+// equal width: values are known to within 1 / 2^(bits) = 3%
+#define LatencyHistogramSubBucketBits 5
+#define LatencyHistogramSubBucketCount (1u << LatencyHistogramSubBucketBits)
+
+// values below 2 * LatencyHistogramSubBucketCount get a bucket of their own,
+// then 32 buckets per power of two, up to 2^32
+#define LatencyHistogramBucketCount ((32 - LatencyHistogramSubBucketBits + 1) * LatencyHistogramSubBucketCount)
+
+struct LatencyHistogram
+{
+    _Atomic uint64_t counts[LatencyHistogramBucketCount];
+    _Atomic uint64_t count;
+    _Atomic uint64_t sum;
+    _Atomic uint32_t max;
+};
+
+uint32_t LatencyHistogramBucketIndex(uint32_t value)
+{
+    if (value < LatencyHistogramSubBucketCount) { return value; }
+
+    // the position of the highest bit, at least LatencyHistogramSubBucketBits
+    uint32_t exponent = 31 - (uint32_t) __builtin_clz(value);
+    uint32_t shift = exponent - LatencyHistogramSubBucketBits;
+    uint32_t subBucket = (value >> shift) & (LatencyHistogramSubBucketCount - 1);
+    return ((exponent - LatencyHistogramSubBucketBits + 1) << LatencyHistogramSubBucketBits) + subBucket;
+}
+
+// the highest value that is counted in the bucket at `index`
+uint32_t LatencyHistogramBucketMaxValue(uint32_t index)
+{
+    if (index < LatencyHistogramSubBucketCount) { return index; }
+
+    uint32_t exponent = (index >> LatencyHistogramSubBucketBits) + LatencyHistogramSubBucketBits - 1;
+    uint32_t shift = exponent - LatencyHistogramSubBucketBits;
+    uint64_t lowest = (uint64_t) (LatencyHistogramSubBucketCount + (index & (LatencyHistogramSubBucketCount - 1))) << shift;
+    uint64_t highest = lowest + ((uint64_t) 1 << shift) - 1;
+    return highest > UINT32_MAX ? UINT32_MAX : (uint32_t) highest;
+}
+
+LatencyHistogramRef LatencyHistogramCreate()
+{
+    LatencyHistogramRef newHistogram = malloc(sizeof(struct LatencyHistogram));
+    if (NULL != newHistogram)
+    {
+        for (uint32_t index = 0; index < LatencyHistogramBucketCount; index++)
+        {
+            atomic_init(&newHistogram->counts[index], 0);
+        }
+        atomic_init(&newHistogram->count, 0);
+        atomic_init(&newHistogram->sum, 0);
+        atomic_init(&newHistogram->max, 0);
+    }
+    return newHistogram;
+}
+
+void LatencyHistogramRelease(LatencyHistogramRef histogram)
+{
+    free(histogram);
+}
+
+void LatencyHistogramRecord(LatencyHistogramRef histogram, uint32_t microseconds)
+{
+    assert(NULL != histogram);
+
+    atomic_fetch_add_explicit(&histogram->counts[LatencyHistogramBucketIndex(microseconds)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&histogram->count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&histogram->sum, microseconds, memory_order_relaxed);
+
+    uint32_t max = atomic_load_explicit(&histogram->max, memory_order_relaxed);
+    while (microseconds > max &&
+           !atomic_compare_exchange_weak_explicit(&histogram->max, &max, microseconds,
+                                                  memory_order_relaxed, memory_order_relaxed))
+    { ; }
+}
+
+void LatencyHistogramReset(LatencyHistogramRef histogram)
+{
+    assert(NULL != histogram);
+    for (uint32_t index = 0; index < LatencyHistogramBucketCount; index++)
+    {
+        atomic_store_explicit(&histogram->counts[index], 0, memory_order_relaxed);
+    }
+    atomic_store_explicit(&histogram->count, 0, memory_order_relaxed);
+    atomic_store_explicit(&histogram->sum, 0, memory_order_relaxed);
+    atomic_store_explicit(&histogram->max, 0, memory_order_relaxed);
+}
+
+uint64_t LatencyHistogramGetCount(LatencyHistogramRef histogram)
+{
+    assert(NULL != histogram);
+    return atomic_load_explicit(&histogram->count, memory_order_relaxed);
+}
+
+uint32_t LatencyHistogramGetMean(LatencyHistogramRef histogram)
+{
+    assert(NULL != histogram);
+    uint64_t count = atomic_load_explicit(&histogram->count, memory_order_relaxed);
+    return (0 == count) ? 0 : (uint32_t) (atomic_load_explicit(&histogram->sum, memory_order_relaxed) / count);
+}
+
+uint32_t LatencyHistogramGetMax(LatencyHistogramRef histogram)
+{
+    assert(NULL != histogram);
+    return atomic_load_explicit(&histogram->max, memory_order_relaxed);
+}
+
+uint32_t LatencyHistogramGetPercentile(LatencyHistogramRef histogram, double percentile)
+{
+    assert(NULL != histogram);
+    if (percentile < 0.0) { percentile = 0.0; }
+    if (percentile > 100.0) { percentile = 100.0; }
+
+    // sum the buckets first: `count` may already include values that are not
+    // in a bucket yet, or the other way around
+    uint64_t total = 0;
+    for (uint32_t index = 0; index < LatencyHistogramBucketCount; index++)
+    {
+        total += atomic_load_explicit(&histogram->counts[index], memory_order_relaxed);
+    }
+    if (0 == total) { return 0; }
+
+    // the rank of the value that is looked for, at least the first value
+    double exactRank = percentile / 100.0 * (double) total;
+    uint64_t rank = (uint64_t) exactRank;
+    if ((double) rank < exactRank) { rank += 1; }
+    if (rank < 1) { rank = 1; }
+    if (rank > total) { rank = total; }
+
+    uint32_t max = atomic_load_explicit(&histogram->max, memory_order_relaxed);
+    uint64_t seen = 0;
+    for (uint32_t index = 0; index < LatencyHistogramBucketCount; index++)
+    {
+        seen += atomic_load_explicit(&histogram->counts[index], memory_order_relaxed);
+        if (seen >= rank)
+        {
+            uint32_t value = LatencyHistogramBucketMaxValue(index);
+            return (value > max && max > 0) ? max : value;
+        }
+    }
+    return max;
+}
+
+void LatencyHistogramFormat(LatencyHistogramRef histogram, const char * name, char * buffer, size_t size)
+{
+    assert(NULL != histogram);
+    assert(NULL != buffer);
+    snprintf(buffer, size, "%s: count %llu, mean %uµs, p50 %uµs, p90 %uµs, p99 %uµs, p99.9 %uµs, max %uµs",
+             name,
+             (unsigned long long) LatencyHistogramGetCount(histogram),
+             LatencyHistogramGetMean(histogram),
+             LatencyHistogramGetPercentile(histogram, 50.0),
+             LatencyHistogramGetPercentile(histogram, 90.0),
+             LatencyHistogramGetPercentile(histogram, 99.0),
+             LatencyHistogramGetPercentile(histogram, 99.9),
+             LatencyHistogramGetMax(histogram));
+}
+
+void LatencyHistogramPrint(LatencyHistogramRef histogram, FILE * output, const char * name)
+{
+    assert(NULL != output);
+    char line[256];
+    LatencyHistogramFormat(histogram, name, line, sizeof(line));
+    fprintf(output, "%s\n", line);
+}
@@ -0,0 +1,71 @@
+#ifndef LatencyHistogram_h
+#define LatencyHistogram_h
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+/*
+A LatencyHistogram records durations in microseconds (0 µs to over an hour),
+and answers percentile queries about them, like a HdrHistogram does: values
+are counted in buckets whose width grows with the value, so that every value
+is known to within 3% (values below 64µs exactly), while the histogram has a
+fixed size and recording a value never allocates.
+Recording is a handful of relaxed atomic increments, without locks: cheap
+enough to always stay enabled, and safe from any number of threads, while
+other threads query the histogram. A query reads the buckets one by one, so
+values recorded during the query may or may not be part of the result.
+*/
+
+typedef struct LatencyHistogram *LatencyHistogramRef;
+
+/*
+Creates a new, empty histogram, or NULL if a histogram could not be created.
+You are responsible for releasing this object using LatencyHistogramRelease().
+*/
+LatencyHistogramRef LatencyHistogramCreate();
+
+/*
+Releases a LatencyHistogramRef. This function is safe to call when
+`histogram` is NULL.
+*/
+void LatencyHistogramRelease(LatencyHistogramRef histogram);
+
+/*
+Records one duration of `microseconds`. Thread-safe.
+*/
+void LatencyHistogramRecord(LatencyHistogramRef histogram, uint32_t microseconds);
+
+/*
+Forgets all recorded values. Values that are recorded while resetting may
+survive the reset.
+*/
+void LatencyHistogramReset(LatencyHistogramRef histogram);
+
+/*
+Querying, all in microseconds:
+- count: the number of values recorded
+- mean, max: of the values recorded, 0 when none were recorded
+- percentile: the value that `percentile` (0 - 100, e.g. 99.9) percent of the
+  recorded values are smaller than or equal to, rounded up to the end of its
+  bucket (but never above the maximum). 0 when no values were recorded.
+*/
+uint64_t LatencyHistogramGetCount(LatencyHistogramRef histogram);
+uint32_t LatencyHistogramGetMean(LatencyHistogramRef histogram);
+uint32_t LatencyHistogramGetMax(LatencyHistogramRef histogram);
+uint32_t LatencyHistogramGetPercentile(LatencyHistogramRef histogram, double percentile);
+
+/*
+Writes a one-line summary, e.g.
+`decode: count 12, mean 1534µs, p50 1520µs, p90 1600µs, p99 2011µs, p99.9 2011µs, max 2011µs`
+to `buffer`, which holds `size` bytes including the terminating NUL.
+*/
+void LatencyHistogramFormat(LatencyHistogramRef histogram, const char * name, char * buffer, size_t size);
+
+/*
+Prints the summary of LatencyHistogramFormat(), followed by a newline.
+*/
+void LatencyHistogramPrint(LatencyHistogramRef histogram, FILE * output, const char * name);
+
+#endif
@@ -0,0 +1,462 @@
+#include <stdio.h>
+#include <time.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "LoopbackBenchmark.h"
+#include "SimulatedGPIOBackend.h"
+#include "SampleEdgeExtractor.h"
+#include "NotificationPipeReader.h"
+#include "OOKSender.h"
+#include "COCOReceiver.h"
+#include "KeyFobSwitchReceiver.h"
+#include "OregonReceiver.h"
+#include "ProtocolEngine.h"
+
+// the simulated GPIOs: the sender's output is looped back to the receivers' input
+#define LoopbackBenchmarkTransmitGPIO 17
+#define LoopbackBenchmarkReceiveGPIO 27
+
+// silence between two messages, in microseconds
+#define LoopbackBenchmarkMessageGap 20000
+
+// the number of reports written to the notification pipe at once
+#define LoopbackBenchmarkReportBlockLength 128
+
+// the half bit of the Oregon Manchester code, 1/2048 s
+#define LoopbackBenchmarkOregonHalfBit 488
+
+// the Oregon preambles: version 3 sends 24 ones, version 2.1 sends 16 ones, every
+// bit twice
+#define LoopbackBenchmarkOregonV3PreambleBitCount 24
+#define LoopbackBenchmarkOregonV21PreambleBitCount 16
+
+// the longest Oregon frame in pulses: a preamble, the sync and 17 nibbles of
+// version 2.1, two bits per bit and two pulses per bit at most
+#define LoopbackBenchmarkOregonMaxPulseCount ((LoopbackBenchmarkOregonV21PreambleBitCount + 4 + 17 * 4) * 2 * 2)
+
+// the Oregon frames that are sent after the COCO and KFS messages: one of each
+// protocol version, with the fields that OregonReceiver.c expects
+typedef struct LoopbackBenchmarkOregonFrame
+{
+    OregonSensor sensor;
+    uint16_t identifier; // the first 4 nibbles, in the order they are sent
+    uint8_t channel;
+    uint8_t rollingCode;
+    int16_t temperature; // in 0.1 °C
+    uint8_t humidity;    // in %
+} LoopbackBenchmarkOregonFrame;
+
+static const LoopbackBenchmarkOregonFrame LoopbackBenchmarkOregonFrames[] =
+{
+    { OregonSensorTHGR122N, 0x1D20, 3, 0xBB, 214, 45 },
+    { OregonSensorTHGR810, 0xF824, 2, 0x37, -51, 63 }
+};
+#define LoopbackBenchmarkOregonFrameCount (sizeof(LoopbackBenchmarkOregonFrames) / sizeof(LoopbackBenchmarkOregonFrame))
+
+struct LoopbackBenchmark
+{
+    COCOReceiverRef COCOReceiver;
+    KFSReceiverRef KFSReceiver;
+    OregonReceiverRef OregonReceiver; // in both modes, the ProtocolEngine has no Manchester codes
+    ProtocolEngineRef protocolEngine; // NULL: the receivers decode
+
+    // the message being sent, read by the thread that decodes the edges
+    _Atomic uint32_t expectedProtocol; // LoopbackBenchmarkProtocol
+    _Atomic uint32_t expectedCode;
+    bool received;
+
+    uint32_t receivedCount;  // messages that were decoded at least once
+    uint32_t decodedCount;   // all correct decodes, including repeats
+    uint32_t wrongCount;     // decodes that do not match the message being sent
+
+    // only used when the edges go through a notification pipe: the edges are
+    // written as PIGPIO reports to `pipeFileDescriptor`, and read back by
+    // `reader`
+    int pipeFileDescriptor;
+    NotificationPipeReaderRef reader;
+    NotificationPipeReport reports[LoopbackBenchmarkReportBlockLength];
+    uint32_t reportCount;   // buffered in `reports`
+    uint64_t writtenCount;  // all reports written
+    uint16_t sequenceNumber;
+};
+
+void LoopbackBenchmarkMessageDecoded(struct LoopbackBenchmark * benchmark, LoopbackBenchmarkProtocol protocol, uint32_t code)
+{
+    if (protocol == atomic_load_explicit(&benchmark->expectedProtocol, memory_order_acquire) &&
+        code == atomic_load_explicit(&benchmark->expectedCode, memory_order_acquire))
+    {
+        benchmark->decodedCount += 1;
+        if (!benchmark->received)
+        {
+            benchmark->received = true;
+            benchmark->receivedCount += 1;
+        }
+    }
+    else
+    {
+        benchmark->wrongCount += 1;
+    }
+}
+
+void LoopbackBenchmarkCOCOCallback(COCOReceiverRef receiver, COCOMessageRef message)
+{
+    LoopbackBenchmarkMessageDecoded(COCOReceiverGetContext(receiver), LoopbackBenchmarkProtocolCOCO, COCOMessageGetCode(message));
+    COCOMessageRelease(message);
+}
+
+void LoopbackBenchmarkKFSCallback(KFSReceiverRef receiver, KFSMessageRef message)
+{
+    LoopbackBenchmarkMessageDecoded(KFSReceiverGetContext(receiver), LoopbackBenchmarkProtocolKFS, KFSMessageGetIdentifier(message));
+    KFSMessageRelease(message);
+}
+
+// the code of an Oregon message is the index of its frame in
+// LoopbackBenchmarkOregonFrames, if the sensor, channel and readings all match
+void LoopbackBenchmarkOregonCallback(OregonReceiverRef receiver, OregonMessageRef message)
+{
+    uint32_t code = UINT32_MAX;
+    for (uint32_t index = 0; index < LoopbackBenchmarkOregonFrameCount; index++)
+    {
+        const LoopbackBenchmarkOregonFrame * frame = &LoopbackBenchmarkOregonFrames[index];
+        if (frame->sensor == OregonMessageGetSensor(message) &&
+            frame->channel == OregonMessageGetChannel(message) &&
+            frame->rollingCode == OregonMessageGetRollingCode(message) &&
+            frame->temperature == OregonMessageGetTemperature(message) &&
+            OregonMessageHasHumidity(message) &&
+            frame->humidity == OregonMessageGetHumidity(message))
+        { code = index; }
+    }
+    LoopbackBenchmarkMessageDecoded(OregonReceiverGetContext(receiver), LoopbackBenchmarkProtocolOregon, code);
+    OregonMessageRelease(message);
+}
+
+void LoopbackBenchmarkFrameCallback(ProtocolEngineRef engine, const ProtocolFrame * frame)
+{
+    LoopbackBenchmarkProtocol protocol = (&ProtocolDescriptorCOCO == frame->descriptor) ? 
+                                         LoopbackBenchmarkProtocolCOCO : LoopbackBenchmarkProtocolKFS;
+    LoopbackBenchmarkMessageDecoded(ProtocolEngineGetContext(engine), protocol, (uint32_t) frame->code);
+}
+
+void LoopbackBenchmarkEdge(int gpio, int level, uint32_t tick, void * userdata)
+{
+    struct LoopbackBenchmark * benchmark = userdata;
+    OregonReceiverFeedGPIOLevelChange(benchmark->OregonReceiver, tick, (uint32_t) level);
+    if (NULL != benchmark->protocolEngine)
+    {
+        ProtocolEngineFeedGPIOLevelChange(benchmark->protocolEngine, tick, (uint32_t) level);
+        return;
+    }
+    COCOReceiverFeedGPIOLevelChange(benchmark->COCOReceiver, tick, (uint32_t) level);
+    KFSReceiverFeedGPIOLevelChange(benchmark->KFSReceiver, tick, (uint32_t) level);
+}
+
+void LoopbackBenchmarkSampleEdge(SampleEdgeExtractorRef extractor, uint32_t gpio, uint32_t level, uint32_t timestamp, void * context)
+{
+    LoopbackBenchmarkEdge((int) gpio, (int) level, timestamp, context);
+}
+
+bool LoopbackBenchmarkWriteReports(struct LoopbackBenchmark * benchmark)
+{
+    size_t length = benchmark->reportCount * sizeof(NotificationPipeReport);
+    const char * bytes = (const char *) benchmark->reports;
+    while (length > 0)
+    {
+        ssize_t written = write(benchmark->pipeFileDescriptor, bytes, length);
+        if (written <= 0) { return false; }
+        bytes += written;
+        length -= (size_t) written;
+    }
+    benchmark->writtenCount += benchmark->reportCount;
+    benchmark->reportCount = 0;
+    return true;
+}
+
+// the simulated edges of the receive GPIO, written to the pipe like PIGPIO would
+void LoopbackBenchmarkReportEdge(int gpio, int level, uint32_t tick, void * userdata)
+{
+    struct LoopbackBenchmark * benchmark = userdata;
+    NotificationPipeReport * report = &benchmark->reports[benchmark->reportCount];
+    report->seqno = benchmark->sequenceNumber++;
+    report->flags = 0;
+    report->tick = tick;
+    report->level = (uint32_t) level << gpio;
+    benchmark->reportCount += 1;
+    if (LoopbackBenchmarkReportBlockLength == benchmark->reportCount) { LoopbackBenchmarkWriteReports(benchmark); }
+}
+
+// writes the buffered reports, and waits until the reader processed them all
+void LoopbackBenchmarkDrainPipe(struct LoopbackBenchmark * benchmark)
+{
+    LoopbackBenchmarkWriteReports(benchmark);
+    while (NotificationPipeReaderGetReportCount(benchmark->reader) < benchmark->writtenCount) { usleep(10); }
+}
+
+uint64_t LoopbackBenchmarkWallTime()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000 + (uint64_t) now.tv_nsec / 1000;
+}
+
+void LoopbackBenchmarkSendMessage(OOKSenderRef sender, uint32_t index, uint32_t * randomState, 
+                                  _Atomic uint32_t * protocol, _Atomic uint32_t * code)
+{
+    // xorshift, so that every run sends the same messages
+    uint32_t random = *randomState;
+    random ^= random << 13;
+    random ^= random >> 17;
+    random ^= random << 5;
+    *randomState = random;
+
+    if (0 == index % 2)
+    {
+        COCOMessageRef message = COCOMessageCreate();
+        COCOMessageSetAddress(message, random & 0x3FFFFFF);
+        COCOMessageSetGroup(message, (random >> 26) & 1);
+        COCOMessageSetOnOff(message, (random >> 27) & 1);
+        COCOMessageSetChannel(message, (random >> 28) & 0xF);
+        atomic_store_explicit(code, COCOMessageGetCode(message), memory_order_release);
+        atomic_store_explicit(protocol, LoopbackBenchmarkProtocolCOCO, memory_order_release);
+        OOKSenderSendCOCO(sender, message);
+        COCOMessageRelease(message);
+    }
+    else
+    {
+        KFSMessageRef message = KFSMessageCreate();
+        KFSMessageSetIdentifier(message, random & 0xFFFFFF);
+        atomic_store_explicit(code, KFSMessageGetIdentifier(message), memory_order_release);
+        atomic_store_explicit(protocol, LoopbackBenchmarkProtocolKFS, memory_order_release);
+        OOKSenderSendKFS(sender, message);
+        KFSMessageRelease(message);
+    }
+}
+
+// appends a half bit of `level` to `durations`, which alternate high and low,
+// starting high: a half bit of the same level as the last pulse lengthens it
+void LoopbackBenchmarkAddOregonHalfBit(uint32_t * durations, uint32_t * length, uint32_t level)
+{
+    // before the first high pulse, there is only silence
+    if (0 == *length && 0 == level) { return; }
+    bool lastPulseHigh = (1 == *length % 2);
+    if (*length > 0 && lastPulseHigh == (1 == level)) { durations[*length - 1] += LoopbackBenchmarkOregonHalfBit; }
+    else { durations[(*length)++] = LoopbackBenchmarkOregonHalfBit; }
+}
+
+// Manchester codes `bit`: a one falls, a zero rises in the middle of the bit,
+// version 2.1 sends the inverted bit first
+void LoopbackBenchmarkAddOregonBit(uint32_t * durations, uint32_t * length, uint32_t bit, uint8_t version)
+{
+    if (2 == version)
+    {
+        LoopbackBenchmarkAddOregonHalfBit(durations, length, bit ^ 1);
+        LoopbackBenchmarkAddOregonHalfBit(durations, length, bit);
+    }
+    LoopbackBenchmarkAddOregonHalfBit(durations, length, bit);
+    LoopbackBenchmarkAddOregonHalfBit(durations, length, bit ^ 1);
+}
+
+// sends Oregon frame `index` of LoopbackBenchmarkOregonFrames through `sender`
+void LoopbackBenchmarkSendOregon(OOKSenderRef sender, uint32_t index, _Atomic uint32_t * protocol, _Atomic uint32_t * code)
+{
+    const LoopbackBenchmarkOregonFrame * frame = &LoopbackBenchmarkOregonFrames[index];
+    uint8_t version = (OregonSensorTHGR810 == frame->sensor) ? 3 : 2;
+    uint32_t temperature = (uint32_t) (frame->temperature < 0 ? -frame->temperature : frame->temperature);
+
+    // version 2.1 sends the channel as one bit: 1, 2 or 4
+    uint8_t channel = frame->channel;
+    if (2 == version) { channel = (uint8_t) (1u << (channel - 1)); }
+
+    // the sensor type, the channel, the rolling code, the flags, the readings
+    // (decimal digits, the last one first) and the checksum
+    uint8_t nibbles[17] =
+    {
+        (frame->identifier >> 12) & 0xF, (frame->identifier >> 8) & 0xF, (frame->identifier >> 4) & 0xF, frame->identifier & 0xF,
+        channel, frame->rollingCode >> 4, frame->rollingCode & 0xF, 0,
+        temperature % 10, temperature / 10 % 10, temperature / 100 % 10, frame->temperature < 0 ? 8 : 0,
+        frame->humidity % 10, frame->humidity / 10 % 10, 0
+    };
+    uint32_t sum = 0;
+    for (uint32_t nibble = 0; nibble < 15; nibble++) { sum += nibbles[nibble]; }
+    nibbles[15] = sum & 0xF;
+    nibbles[16] = (sum >> 4) & 0xF;
+
+    uint32_t durations[LoopbackBenchmarkOregonMaxPulseCount];
+    uint32_t length = 0;
+    uint32_t preambleBitCount = (3 == version) ? LoopbackBenchmarkOregonV3PreambleBitCount : LoopbackBenchmarkOregonV21PreambleBitCount;
+    for (uint32_t bit = 0; bit < preambleBitCount; bit++) { LoopbackBenchmarkAddOregonBit(durations, &length, 1, version); }
+    // the sync nibble 0xA, and the nibbles, least significant bit first
+    for (uint32_t bit = 0; bit < 4; bit++) { LoopbackBenchmarkAddOregonBit(durations, &length, (0xA >> bit) & 1, version); }
+    for (uint32_t nibble = 0; nibble < 17; nibble++)
+    {
+        for (uint32_t bit = 0; bit < 4; bit++) { LoopbackBenchmarkAddOregonBit(durations, &length, (nibbles[nibble] >> bit) & 1, version); }
+    }
+
+    atomic_store_explicit(code, index, memory_order_release);
+    atomic_store_explicit(protocol, LoopbackBenchmarkProtocolOregon, memory_order_release);
+    OOKSenderSendDurations(sender, durations, length, 0);
+}
+
+// the silence after a message, ended by a short spike, like the noise of a
+// real receiver would
+void LoopbackBenchmarkEndMessage(struct LoopbackBenchmark * benchmark, GPIOBackendRef backend, bool throughNotificationPipe)
+{
+    GPIOBackendSleep(backend, LoopbackBenchmarkMessageGap);
+    GPIOBackendWrite(backend, LoopbackBenchmarkTransmitGPIO, 1);
+    GPIOBackendSleep(backend, 50);
+    GPIOBackendWrite(backend, LoopbackBenchmarkTransmitGPIO, 0);
+    GPIOBackendSleep(backend, LoopbackBenchmarkMessageGap);
+
+    // the message must be decoded before the next one is sent
+    if (throughNotificationPipe) { LoopbackBenchmarkDrainPipe(benchmark); }
+}
+
+bool LoopbackBenchmarkRun(uint32_t messageCount, uint32_t maxJitter, bool throughNotificationPipe, bool throughProtocolEngine)
+{
+    GPIOBackendRef backend = SimulatedGPIOBackendCreate();
+    if (NULL == backend || GPIOBackendInitialise(backend) < 0)
+    {
+        printf("LoopbackBenchmarkRun(): could not create the simulated backend.\n");
+        GPIOBackendRelease(backend);
+        return false;
+    }
+    SimulatedGPIOBackendConnect(backend, LoopbackBenchmarkTransmitGPIO, LoopbackBenchmarkReceiveGPIO);
+    SimulatedGPIOBackendSetJitter(backend, maxJitter, 433);
+
+    struct LoopbackBenchmark benchmark;
+    benchmark.receivedCount = 0;
+    benchmark.decodedCount = 0;
+    benchmark.wrongCount = 0;
+    benchmark.received = false;
+    atomic_init(&benchmark.expectedCode, 0);
+    atomic_init(&benchmark.expectedProtocol, LoopbackBenchmarkProtocolCOCO);
+
+    benchmark.COCOReceiver = COCOReceiverCreate();
+    COCOReceiverSetCallback(benchmark.COCOReceiver, &LoopbackBenchmarkCOCOCallback);
+    COCOReceiverSetContext(benchmark.COCOReceiver, &benchmark);
+    COCOReceiverSetRefractoryPeriod(benchmark.COCOReceiver, 0);
+    COCOReceiverSetRepeatCount(benchmark.COCOReceiver, 1);
+
+    benchmark.KFSReceiver = KFSReceiverCreate();
+    KFSReceiverSetCallback(benchmark.KFSReceiver, &LoopbackBenchmarkKFSCallback);
+    KFSReceiverSetContext(benchmark.KFSReceiver, &benchmark);
+    KFSReceiverSetRefractoryPeriod(benchmark.KFSReceiver, 0);
+    KFSReceiverSetRepeatCount(benchmark.KFSReceiver, 1);
+
+    benchmark.OregonReceiver = OregonReceiverCreate();
+    OregonReceiverSetCallback(benchmark.OregonReceiver, &LoopbackBenchmarkOregonCallback);
+    OregonReceiverSetContext(benchmark.OregonReceiver, &benchmark);
+
+    benchmark.protocolEngine = NULL;
+    if (throughProtocolEngine)
+    {
+        benchmark.protocolEngine = ProtocolEngineCreate();
+        ProtocolEngineSetCallback(benchmark.protocolEngine, &LoopbackBenchmarkFrameCallback);
+        ProtocolEngineSetContext(benchmark.protocolEngine, &benchmark);
+        int32_t COCOIndex = ProtocolEngineAddProtocol(benchmark.protocolEngine, &ProtocolDescriptorCOCO);
+        int32_t KFSIndex = ProtocolEngineAddProtocol(benchmark.protocolEngine, &ProtocolDescriptorKFS);
+        ProtocolEngineSetRepeatCount(benchmark.protocolEngine, (uint32_t) COCOIndex, 1);
+        ProtocolEngineSetRepeatCount(benchmark.protocolEngine, (uint32_t) KFSIndex, 1);
+    }
+
+    benchmark.pipeFileDescriptor = -1;
+    benchmark.reader = NULL;
+    benchmark.reportCount = 0;
+    benchmark.writtenCount = 0;
+    benchmark.sequenceNumber = 0;
+    SampleEdgeExtractorRef extractor = NULL;
+    char directory[] = "/tmp/LPD433-XXXXXX";
+    char pipePath[sizeof(directory) + 8] = "";
+    if (throughNotificationPipe)
+    {
+        // a FIFO stands in for the notification pipe of PIGPIO
+        extractor = SampleEdgeExtractorCreate(1u << LoopbackBenchmarkReceiveGPIO);
+        SampleEdgeExtractorSetCallback(extractor, &LoopbackBenchmarkSampleEdge);
+        SampleEdgeExtractorSetGPIOContext(extractor, LoopbackBenchmarkReceiveGPIO, &benchmark);
+        if (NULL != mkdtemp(directory))
+        {
+            snprintf(pipePath, sizeof(pipePath), "%s/pigpio", directory);
+            if (0 == mkfifo(pipePath, 0600)) { benchmark.reader = NotificationPipeReaderCreate(pipePath, extractor); }
+        }
+        if (NULL == benchmark.reader || !NotificationPipeReaderStart(benchmark.reader) ||
+            (benchmark.pipeFileDescriptor = open(pipePath, O_WRONLY | O_CLOEXEC)) < 0)
+        {
+            printf("LoopbackBenchmarkRun(): could not create the notification pipe.\n");
+            throughNotificationPipe = false;
+        }
+    }
+    if (throughNotificationPipe)
+    {
+        // PIGPIO starts with a report of the current levels
+        LoopbackBenchmarkReportEdge(LoopbackBenchmarkReceiveGPIO, 0, GPIOBackendGetTick(backend), &benchmark);
+        GPIOBackendSetEdgeFunction(backend, LoopbackBenchmarkReceiveGPIO, &LoopbackBenchmarkReportEdge, &benchmark);
+    }
+    else
+    {
+        GPIOBackendSetEdgeFunction(backend, LoopbackBenchmarkReceiveGPIO, &LoopbackBenchmarkEdge, &benchmark);
+    }
+
+    OOKSenderRef sender = OOKSenderCreate();
+    OOKSenderSetBackend(sender, backend);
+    OOKSenderSetTransmitGPIO(sender, LoopbackBenchmarkTransmitGPIO);
+
+    uint32_t randomState = 2020;
+    uint64_t virtualStartTime = GPIOBackendGetTime(backend);
+    uint64_t wallStartTime = LoopbackBenchmarkWallTime();
+    for (uint32_t index = 0; index < messageCount; index++)
+    {
+        benchmark.received = false;
+        LoopbackBenchmarkSendMessage(sender, index, &randomState, &benchmark.expectedProtocol, &benchmark.expectedCode);
+        LoopbackBenchmarkEndMessage(&benchmark, backend, throughNotificationPipe);
+    }
+    uint32_t COCOKFSReceivedCount = benchmark.receivedCount;
+    for (uint32_t index = 0; index < LoopbackBenchmarkOregonFrameCount; index++)
+    {
+        benchmark.received = false;
+        LoopbackBenchmarkSendOregon(sender, index, &benchmark.expectedProtocol, &benchmark.expectedCode);
+        LoopbackBenchmarkEndMessage(&benchmark, backend, throughNotificationPipe);
+    }
+    uint32_t OregonReceivedCount = benchmark.receivedCount - COCOKFSReceivedCount;
+    uint32_t sentCount = messageCount + LoopbackBenchmarkOregonFrameCount;
+    uint64_t wallDuration = LoopbackBenchmarkWallTime() - wallStartTime;
+    uint64_t virtualDuration = GPIOBackendGetTime(backend) - virtualStartTime;
+    if (0 == wallDuration) { wallDuration = 1; }
+
+    printf("\n╔═════ Loopback benchmark ═════╗\n");
+    printf("║ messages sent:    %10u ║\n", sentCount);
+    printf("║ received:         %10u ║\n", benchmark.receivedCount);
+    printf("║ missed:           %10u ║\n", sentCount - benchmark.receivedCount);
+    printf("║ Oregon received:  %6u / %u ║\n", OregonReceivedCount, (uint32_t) LoopbackBenchmarkOregonFrameCount);
+    printf("║ decodes:          %10u ║\n", benchmark.decodedCount);
+    printf("║ wrong decodes:    %10u ║\n", benchmark.wrongCount);
+    printf("║ edges:            %10llu ║\n", (unsigned long long) SimulatedGPIOBackendGetEdgeCount(backend));
+    printf("║ simulated (ms):   %10llu ║\n", (unsigned long long) (virtualDuration / 1000));
+    printf("║ wall clock (ms):  %10llu ║\n", (unsigned long long) (wallDuration / 1000));
+    printf("║ speedup:          %9.1fx ║\n", (double) virtualDuration / (double) wallDuration);
+    printf("║ messages/s:       %10.0f ║\n", (double) sentCount * 1000000.0 / (double) wallDuration);
+    printf("║ decoder:      %14s ║\n", throughProtocolEngine ? "ProtocolEngine" : "receivers");
+    if (throughNotificationPipe)
+    {
+        uint64_t readCount = NotificationPipeReaderGetReadCount(benchmark.reader);
+        printf("║ pipe reads:       %10llu ║\n", (unsigned long long) readCount);
+        printf("║ reports/read:     %10.1f ║\n", (double) benchmark.writtenCount / (double) (readCount > 0 ? readCount : 1));
+        printf("║ lost reports:     %10llu ║\n", (unsigned long long) NotificationPipeReaderGetLostReportCount(benchmark.reader));
+    }
+    printf("╚══════════════════════════════╝\n");
+
+    GPIOBackendSetEdgeFunction(backend, LoopbackBenchmarkReceiveGPIO, NULL, NULL);
+    if (benchmark.pipeFileDescriptor >= 0) { close(benchmark.pipeFileDescriptor); }
+    NotificationPipeReaderRelease(benchmark.reader);
+    SampleEdgeExtractorRelease(extractor);
+    if (0 != pipePath[0]) { unlink(pipePath); }
+    if (0 != strcmp(directory, "/tmp/LPD433-XXXXXX")) { rmdir(directory); }
+    OOKSenderRelease(sender);
+    KFSReceiverRelease(benchmark.KFSReceiver);
+    OregonReceiverRelease(benchmark.OregonReceiver);
+    COCOReceiverRelease(benchmark.COCOReceiver);
+    ProtocolEngineRelease(benchmark.protocolEngine);
+    GPIOBackendTerminate(backend);
+    GPIOBackendRelease(backend);
+    return true;
+}
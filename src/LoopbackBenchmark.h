@@ -0,0 +1,52 @@
+#ifndef LoopbackBenchmark_h
+#define LoopbackBenchmark_h
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "OOKSender.h"
+
+typedef enum LoopbackBenchmarkProtocol
+{
+    LoopbackBenchmarkProtocolCOCO = 1,
+    LoopbackBenchmarkProtocolKFS = 2,
+    LoopbackBenchmarkProtocolOregon = 3
+} LoopbackBenchmarkProtocol;
+
+/*
+Measures the throughput and accuracy of the OOKSender and the receivers
+without any hardware. An OOKSender transmits `messageCount` messages
+(alternately COCO and KFS, with pseudo-random content) on a simulated GPIO
+that is looped back to a simulated GPIO with a COCO and a KFS receiver. Each
+edge is delayed by a pseudo-random 0 - `maxJitter` microseconds.
+After those, it sends a THGR122N (version 2.1) and a THGR810 (version 3)
+frame to an OregonReceiver, which only counts as received if the sensor,
+channel, rolling code, temperature and humidity all match what was sent.
+The simulated clock runs as fast as the CPU allows, so this also shows how
+much faster than real time the sender and receivers are. The results are
+printed to the standard output. The run is deterministic: the same arguments
+give the same counts.
+With `throughNotificationPipe`, the edges are not passed to the receivers
+directly, but written as PIGPIO reports to a FIFO that stands in for a PIGPIO
+notification pipe, and read back by a NotificationPipeReader, as `-i notify`
+does.
+With `throughProtocolEngine`, the edges are decoded by a ProtocolEngine with
+the COCO and KFS descriptors, instead of by a COCOReceiver and a KFSReceiver.
+Returns false if the benchmark could not be set up.
+*/
+bool LoopbackBenchmarkRun(uint32_t messageCount, uint32_t maxJitter, bool throughNotificationPipe, bool throughProtocolEngine);
+
+/*
+Sends message number `index` of the benchmark traffic through `sender`: even
+numbers are COCO, odd numbers KFS messages, with content from the pseudo-random
+`randomState` (start with any non-zero value, the same value gives the same
+traffic). The protocol (a LoopbackBenchmarkProtocol) and code
+(COCOMessageGetCode() or the KFS identifier) of the message are stored in
+`protocol` and `code` (with release semantics) before it is sent, so that the
+thread that decodes it can read them.
+*/
+void LoopbackBenchmarkSendMessage(OOKSenderRef sender, uint32_t index, uint32_t * randomState, 
+                                  _Atomic uint32_t * protocol, _Atomic uint32_t * code);
+
+#endif
@@ -0,0 +1,237 @@
+#include <stdio.h>
+#include <assert.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include "MessageDispatcher.h"
+#include "BoundedQueue.h"
+
+#define MessageDispatcherMaxWorkerCount 64
+
+struct MessageDispatcherItem
+{
+    uint32_t protocol;
+    uint32_t source;
+    void * message;
+    uint64_t submitTime; // µs, CLOCK_MONOTONIC
+};
+
+struct MessageDispatcherWorker
+{
+    MessageDispatcherRef dispatcher;
+    BoundedQueueRef queue;
+    sem_t queuedItems; // posted for every item pushed, and to stop
+    pthread_t thread;
+    bool started;
+};
+
+struct MessageDispatcher
+{
+    MessageDispatcherHandler handler;
+    void * context;
+
+    // for internal use
+    //
+    uint32_t workerCount;
+    struct MessageDispatcherWorker workers[MessageDispatcherMaxWorkerCount];
+    _Atomic bool stopping;
+
+    _Atomic uint64_t dispatchedCount;
+    _Atomic uint64_t droppedCount;
+    _Atomic uint64_t totalLatency;
+    _Atomic uint32_t maxLatency;
+};
+
+uint64_t MessageDispatcherGetTime()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000 + (uint64_t) now.tv_nsec / 1000;
+}
+
+void MessageDispatcherHandle(MessageDispatcherRef dispatcher, struct MessageDispatcherItem * item)
+{
+    uint64_t latency = MessageDispatcherGetTime() - item->submitTime;
+    uint32_t clampedLatency = latency > UINT32_MAX ? UINT32_MAX : (uint32_t) latency;
+    atomic_fetch_add_explicit(&dispatcher->totalLatency, latency, memory_order_relaxed);
+    uint32_t maxLatency = atomic_load_explicit(&dispatcher->maxLatency, memory_order_relaxed);
+    while (clampedLatency > maxLatency &&
+           !atomic_compare_exchange_weak_explicit(&dispatcher->maxLatency, &maxLatency, clampedLatency,
+                                                  memory_order_relaxed, memory_order_relaxed))
+    { ; }
+
+    dispatcher->handler(dispatcher, item->protocol, item->message, item->source, dispatcher->context);
+    atomic_fetch_add_explicit(&dispatcher->dispatchedCount, 1, memory_order_relaxed);
+}
+
+void * MessageDispatcherRun(void * argument)
+{
+    struct MessageDispatcherWorker * worker = argument;
+    MessageDispatcherRef dispatcher = worker->dispatcher;
+    struct MessageDispatcherItem item;
+    while (true)
+    {
+        if (0 != sem_wait(&worker->queuedItems))
+        {
+            if (EINTR == errno) { continue; }
+            break;
+        }
+        // the semaphore counts the items, but the stop post has no item
+        if (BoundedQueueTryPop(worker->queue, &item))
+        {
+            MessageDispatcherHandle(dispatcher, &item);
+        }
+        else if (atomic_load(&dispatcher->stopping))
+        {
+            break;
+        }
+    }
+    // handle what was queued before stopping
+    while (BoundedQueueTryPop(worker->queue, &item)) { MessageDispatcherHandle(dispatcher, &item); }
+    return NULL;
+}
+
+void MessageDispatcherStopWorkers(MessageDispatcherRef dispatcher)
+{
+    atomic_store(&dispatcher->stopping, true);
+    for (uint32_t index = 0; index < dispatcher->workerCount; index++)
+    {
+        struct MessageDispatcherWorker * worker = &dispatcher->workers[index];
+        if (worker->started)
+        {
+            sem_post(&worker->queuedItems);
+            pthread_join(worker->thread, NULL);
+        }
+        if (NULL != worker->queue) { sem_destroy(&worker->queuedItems); }
+        BoundedQueueRelease(worker->queue);
+        worker->queue = NULL;
+        worker->started = false;
+    }
+}
+
+MessageDispatcherRef MessageDispatcherCreate(uint32_t workerCount, uint32_t capacity)
+{
+    assert(workerCount > 0 && workerCount <= MessageDispatcherMaxWorkerCount);
+
+    MessageDispatcherRef newDispatcher = malloc(sizeof(struct MessageDispatcher));
+    if (NULL == newDispatcher) { return NULL; }
+
+    newDispatcher->handler = NULL;
+    newDispatcher->context = NULL;
+    newDispatcher->workerCount = workerCount;
+    atomic_init(&newDispatcher->stopping, false);
+    atomic_init(&newDispatcher->dispatchedCount, 0);
+    atomic_init(&newDispatcher->droppedCount, 0);
+    atomic_init(&newDispatcher->totalLatency, 0);
+    atomic_init(&newDispatcher->maxLatency, 0);
+
+    for (uint32_t index = 0; index < workerCount; index++)
+    {
+        newDispatcher->workers[index].started = false;
+        newDispatcher->workers[index].queue = NULL;
+    }
+    for (uint32_t index = 0; index < workerCount; index++)
+    {
+        struct MessageDispatcherWorker * worker = &newDispatcher->workers[index];
+        worker->dispatcher = newDispatcher;
+        worker->queue = BoundedQueueCreate(capacity, sizeof(struct MessageDispatcherItem));
+        if (NULL == worker->queue) { break; }
+        if (0 != sem_init(&worker->queuedItems, 0, 0))
+        {
+            BoundedQueueRelease(worker->queue);
+            worker->queue = NULL;
+            break;
+        }
+        if (0 != pthread_create(&worker->thread, NULL, &MessageDispatcherRun, worker)) { break; }
+        worker->started = true;
+    }
+    if (!newDispatcher->workers[workerCount - 1].started)
+    {
+        printf("MessageDispatcher: could not start the worker threads.\n");
+        MessageDispatcherStopWorkers(newDispatcher);
+        free(newDispatcher);
+        return NULL;
+    }
+    return newDispatcher;
+}
+
+void MessageDispatcherRelease(MessageDispatcherRef dispatcher)
+{
+    if (NULL == dispatcher) { return; }
+    MessageDispatcherStopWorkers(dispatcher);
+    free(dispatcher);
+}
+
+void MessageDispatcherSetHandler(MessageDispatcherRef dispatcher, MessageDispatcherHandler handler, void * context)
+{
+    assert(NULL != dispatcher);
+    dispatcher->handler = handler;
+    dispatcher->context = context;
+}
+
+bool MessageDispatcherSubmit(MessageDispatcherRef dispatcher,
+                             uint32_t protocol,
+                             uint64_t deviceKey,
+                             uint32_t source,
+                             void * message,
+                             MessageDispatcherMessageReleaser releaser)
+{
+    assert(NULL != dispatcher);
+    assert(NULL != dispatcher->handler);
+
+    // spread the keys over the workers: consecutive addresses are common
+    uint64_t hash = deviceKey * 0x9E3779B97F4A7C15ull;
+    struct MessageDispatcherWorker * worker = &dispatcher->workers[(hash >> 32) % dispatcher->workerCount];
+
+    struct MessageDispatcherItem item;
+    item.protocol = protocol;
+    item.source = source;
+    item.message = message;
+    item.submitTime = MessageDispatcherGetTime();
+    if (!BoundedQueueTryPush(worker->queue, &item))
+    {
+        atomic_fetch_add_explicit(&dispatcher->droppedCount, 1, memory_order_relaxed);
+        if (NULL != releaser) { releaser(message); }
+        return false;
+    }
+    sem_post(&worker->queuedItems);
+    return true;
+}
+
+uint32_t MessageDispatcherGetBacklog(MessageDispatcherRef dispatcher)
+{
+    assert(NULL != dispatcher);
+    uint32_t backlog = 0;
+    for (uint32_t index = 0; index < dispatcher->workerCount; index++)
+    {
+        backlog += BoundedQueueGetCount(dispatcher->workers[index].queue);
+    }
+    return backlog;
+}
+
+uint64_t MessageDispatcherGetDispatchedCount(MessageDispatcherRef dispatcher)
+{
+    assert(NULL != dispatcher);
+    return atomic_load(&dispatcher->dispatchedCount);
+}
+
+uint64_t MessageDispatcherGetDroppedCount(MessageDispatcherRef dispatcher)
+{
+    assert(NULL != dispatcher);
+    return atomic_load(&dispatcher->droppedCount);
+}
+
+uint32_t MessageDispatcherGetAverageLatency(MessageDispatcherRef dispatcher)
+{
+    assert(NULL != dispatcher);
+    uint64_t count = atomic_load(&dispatcher->dispatchedCount);
+    return (0 == count) ? 0 : (uint32_t) (atomic_load(&dispatcher->totalLatency) / count);
+}
+
+uint32_t MessageDispatcherGetMaxLatency(MessageDispatcherRef dispatcher)
+{
+    assert(NULL != dispatcher);
+    return atomic_load(&dispatcher->maxLatency);
+}
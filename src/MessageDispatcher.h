@@ -0,0 +1,81 @@
+#ifndef MessageDispatcher_h
+#define MessageDispatcher_h
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+
+/*
+A MessageDispatcher moves the handling of received messages off the thread
+that decodes them. The receivers call their callback on the thread that feeds
+them the edges (e.g. the PIGPIO alert thread), so a slow callback (a HTTP
+request, a disk write, switching a relay) holds up the edges of every protocol
+and every GPIO. Instead, a callback can submit the message to a dispatcher,
+which only queues it and returns. A pool of worker threads calls your handler.
+Each device (identified by a key, e.g. the COCO address or the KFS identifier)
+is always handled by the same worker, through its own lock-free queue (see
+BoundedQueue.h), so the messages of one device are handled in the order they
+were submitted, while slow messages of one device do not delay the others
+(unless they share a worker).
+Submitting never blocks: when the queue of the worker is full the message is
+released right away and counted as dropped.
+*/
+
+typedef struct MessageDispatcher *MessageDispatcherRef;
+
+// releases a message that was submitted, but could not be queued
+typedef void (*MessageDispatcherMessageReleaser)(void * message);
+
+/*
+Called on a worker thread for every message that was submitted. Ownership of
+`message` is handed over to the handler.
+*/
+typedef void (*MessageDispatcherHandler)(MessageDispatcherRef, uint32_t protocol, void * message, uint32_t source, void * context);
+
+/*
+Creates a new dispatcher with `workerCount` (1 - 64) worker threads, each with
+a queue for `capacity` messages, or NULL if a dispatcher could not be created.
+Set the handler before submitting messages. You are responsible for releasing
+this object using MessageDispatcherRelease().
+*/
+MessageDispatcherRef MessageDispatcherCreate(uint32_t workerCount, uint32_t capacity);
+
+/*
+Handles the messages that are still queued, stops the workers and releases the
+dispatcher. This function is safe to call when `dispatcher` is NULL.
+*/
+void MessageDispatcherRelease(MessageDispatcherRef dispatcher);
+
+/*
+`context` is passed to the handler as is.
+*/
+void MessageDispatcherSetHandler(MessageDispatcherRef dispatcher, MessageDispatcherHandler handler, void * context);
+
+/*
+Queues `message` for the worker of `deviceKey`. `protocol` and `source` are
+passed to the handler as is. Never blocks. Returns false if the queue was
+full, in which case `message` was released using `releaser`.
+Thread-safe: may be called from any number of threads.
+*/
+bool MessageDispatcherSubmit(MessageDispatcherRef dispatcher,
+                             uint32_t protocol,
+                             uint64_t deviceKey,
+                             uint32_t source,
+                             void * message,
+                             MessageDispatcherMessageReleaser releaser);
+
+/*
+Statistics:
+- backlog: the number of messages queued, but not handled yet
+- dispatched: the number of messages passed to the handler
+- dropped: the number of messages that were released because a queue was full
+- latency: the time between submitting a message and the start of its
+  handler, in microseconds; the average and the maximum
+*/
+uint32_t MessageDispatcherGetBacklog(MessageDispatcherRef dispatcher);
+uint64_t MessageDispatcherGetDispatchedCount(MessageDispatcherRef dispatcher);
+uint64_t MessageDispatcherGetDroppedCount(MessageDispatcherRef dispatcher);
+uint32_t MessageDispatcherGetAverageLatency(MessageDispatcherRef dispatcher);
+uint32_t MessageDispatcherGetMaxLatency(MessageDispatcherRef dispatcher);
+
+#endif
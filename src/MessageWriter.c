@@ -0,0 +1,341 @@
+#include <assert.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include "MessageWriter.h"
+#include "BoundedQueue.h"
+
+struct MessageWriter
+{
+    FILE * output;
+    MessageWriterFormat format;
+
+    // for internal use
+    //
+    BoundedQueueRef queue;
+    sem_t queuedRecords; // posted for every record pushed, and to stop
+    pthread_t thread;
+    _Atomic bool stopping;
+    _Atomic uint64_t writtenCount;
+    _Atomic uint64_t droppedCount;
+};
+
+uint64_t MessageWriterGetTime()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    return (uint64_t) now.tv_sec * 1000000 + (uint64_t) now.tv_nsec / 1000;
+}
+
+// writes `text` as a JSON string
+void MessageWriterWriteJSONString(FILE * output, const char * text)
+{
+    fputc('"', output);
+    for (const char * character = text; '\0' != *character; character++)
+    {
+        if ('"' == *character || '\\' == *character) { fprintf(output, "\\%c", *character); }
+        else if ((unsigned char) *character < 0x20) { fprintf(output, "\\u%04x", (unsigned char) *character); }
+        else { fputc(*character, output); }
+    }
+    fputc('"', output);
+}
+
+// writes `text` as a CSV field, between double quotes if it needs them
+void MessageWriterWriteCSVString(FILE * output, const char * text)
+{
+    if ('\0' == text[strcspn(text, ",\"\r\n")])
+    {
+        fputs(text, output);
+        return;
+    }
+    fputc('"', output);
+    for (const char * character = text; '\0' != *character; character++)
+    {
+        if ('"' == *character) { fputc('"', output); }
+        fputc(*character, output);
+    }
+    fputc('"', output);
+}
+
+// the JSON object or CSV line of an Oregon message, or of a frame of a
+// ProtocolEngine or plugin
+void MessageWriterWriteTextRecord(MessageWriterRef writer, const MessageWriterRecord * record)
+{
+    FILE * output = writer->output;
+    bool isJSON = (MessageWriterFormatJSON == writer->format);
+    const char * name = (MessageWriterProtocolOregon == record->protocol) ? "Oregon" :
+                        (MessageWriterProtocolFrame == record->protocol) ? record->frame.descriptor->name :
+                        record->plugin.name;
+    uint64_t code = (MessageWriterProtocolFrame == record->protocol) ? record->frame.code :
+                    (MessageWriterProtocolPlugin == record->protocol) ? record->plugin.code :
+                    record->code;
+
+    if (isJSON)
+    {
+        fprintf(output, "{\"time\":%llu,\"protocol\":", (unsigned long long) record->time);
+        MessageWriterWriteJSONString(output, name);
+        fprintf(output, ",\"pin\":%u,\"code\":%llu", record->PIN, (unsigned long long) code);
+    }
+    else
+    {
+        fprintf(output, "%llu,", (unsigned long long) record->time);
+        MessageWriterWriteCSVString(output, name);
+        fprintf(output, ",%u,%llu,,,,", record->PIN, (unsigned long long) code);
+    }
+
+    if (MessageWriterProtocolOregon == record->protocol)
+    {
+        int32_t temperature = record->oregon.temperature;
+        char temperatureField[16];
+        snprintf(temperatureField, sizeof(temperatureField), "%s%i.%i",
+                 (temperature < 0) ? "-" : "", abs(temperature) / 10, abs(temperature) % 10);
+        char humidityField[24] = "";
+        if (record->oregon.hasHumidity)
+        {
+            snprintf(humidityField, sizeof(humidityField), isJSON ? ",\"humidity\":%u" : "%u",
+                     record->oregon.humidity);
+        }
+
+        if (isJSON)
+        {
+            fprintf(output, ",\"sensor\":\"%s\",\"channel\":%u,\"rollingCode\":%u,\"temperature\":%s%s,\"batteryLow\":%s",
+                    record->oregon.sensorName, record->oregon.channel, record->oregon.rollingCode,
+                    temperatureField, humidityField, record->oregon.batteryLow ? "true" : "false");
+        }
+        else
+        {
+            fprintf(output, "%u,,,%u,%u,%s,%u,%s,%s,%u,", record->oregon.channel, record->quality, record->isEcho ? 1 : 0,
+                    record->oregon.sensorName, record->oregon.rollingCode, temperatureField, humidityField,
+                    record->oregon.batteryLow ? 1 : 0);
+        }
+    }
+    else if (isJSON && MessageWriterProtocolFrame == record->protocol)
+    {
+        const ProtocolDescriptor * descriptor = record->frame.descriptor;
+        fprintf(output, ",\"bits\":%u", record->frame.bitCount);
+        for (uint32_t index = 0; index < descriptor->fieldCount; index++)
+        {
+            const ProtocolField * field = &descriptor->fields[index];
+            char value[40];
+            ProtocolFieldFormatValue(field, record->frame.code, value, sizeof(value));
+            bool isString = (ProtocolFieldFormatTriState == field->format);
+            fprintf(output, ",\"%s\":%s%s%s", field->name, isString ? "\"" : "", value, isString ? "\"" : "");
+        }
+    }
+    else if (isJSON)
+    {
+        fprintf(output, ",\"text\":");
+        MessageWriterWriteJSONString(output, record->text);
+    }
+    else
+    {
+        fprintf(output, ",,,%u,%u,,,,,,", record->quality, record->isEcho ? 1 : 0);
+    }
+
+    if (isJSON)
+    {
+        fprintf(output, ",\"quality\":%u,\"echo\":%s}\n", record->quality, record->isEcho ? "true" : "false");
+    }
+    else
+    {
+        MessageWriterWriteCSVString(output, record->text);
+        fputc('\n', output);
+    }
+}
+
+void MessageWriterWriteRecord(MessageWriterRef writer, const MessageWriterRecord * record)
+{
+    bool hasText = (record->protocol >= MessageWriterProtocolOregon);
+    if (hasText && MessageWriterFormatBinary != writer->format)
+    {
+        MessageWriterWriteTextRecord(writer, record);
+        return;
+    }
+
+    bool isCOCO = (MessageWriterProtocolCOCO == record->protocol);
+    uint32_t address = record->code >> 6;
+    uint32_t group = (record->code >> 5) & 1;
+    uint32_t onOff = (record->code >> 4) & 1;
+    uint32_t channel = record->code & 0xF;
+    bool isDim = isCOCO && record->dimLevel >= 0;
+
+    char dimLevelField[24] = "";
+    if (isDim && MessageWriterFormatJSON == writer->format)
+    { snprintf(dimLevelField, sizeof(dimLevelField), ",\"dimLevel\":%i", record->dimLevel); }
+    else if (isDim)
+    { snprintf(dimLevelField, sizeof(dimLevelField), "%i", record->dimLevel); }
+
+    switch (writer->format)
+    {
+        case MessageWriterFormatJSON:
+            if (isCOCO)
+            {
+                fprintf(writer->output,
+                        "{\"time\":%llu,\"protocol\":\"COCO\",\"pin\":%u,\"code\":%u,\"address\":%u,\"group\":%u,\"onOff\":%u,\"channel\":%u%s,\"quality\":%u,\"echo\":%s}\n",
+                        (unsigned long long) record->time, record->PIN, record->code,
+                        address, group, onOff, channel, dimLevelField, record->quality, record->isEcho ? "true" : "false");
+            }
+            else
+            {
+                fprintf(writer->output,
+                        "{\"time\":%llu,\"protocol\":\"KFS\",\"pin\":%u,\"code\":%u,\"identifier\":%u,\"quality\":%u,\"echo\":%s}\n",
+                        (unsigned long long) record->time, record->PIN, record->code,
+                        record->code, record->quality, record->isEcho ? "true" : "false");
+            }
+            break;
+        case MessageWriterFormatCSV:
+            if (isCOCO)
+            {
+                fprintf(writer->output, "%llu,COCO,%u,%u,%u,%u,%u,%u,%s,,%u,%u,,,,,,\n",
+                        (unsigned long long) record->time, record->PIN, record->code,
+                        address, group, onOff, channel, dimLevelField, record->quality, record->isEcho ? 1 : 0);
+            }
+            else
+            {
+                fprintf(writer->output, "%llu,KFS,%u,%u,,,,,,%u,%u,%u,,,,,,\n",
+                        (unsigned long long) record->time, record->PIN, record->code,
+                        record->code, record->quality, record->isEcho ? 1 : 0);
+            }
+            break;
+        case MessageWriterFormatBinary:
+        {
+            uint8_t bytes[MessageWriterBinaryRecordSize];
+            for (uint32_t index = 0; index < 8; index++) { bytes[index] = (uint8_t) (record->time >> (8 * index)); }
+            for (uint32_t index = 0; index < 4; index++) { bytes[8 + index] = (uint8_t) (record->code >> (8 * index)); }
+            bytes[12] = record->protocol;
+            bytes[13] = record->quality;
+            bytes[14] = record->PIN;
+            bytes[15] = (uint8_t) ((record->isEcho ? 1 : 0) |
+                                   (isDim ? 2 | (record->dimLevel << 4) : 0) |
+                                   (hasText ? 4 : 0));
+            fwrite(bytes, sizeof(bytes), 1, writer->output);
+            if (hasText)
+            {
+                uint8_t length = (uint8_t) strnlen(record->text, MessageWriterMaxTextLength - 1);
+                fputc(length, writer->output);
+                fwrite(record->text, 1, length, writer->output);
+            }
+            break;
+        }
+    }
+}
+
+void * MessageWriterRun(void * argument)
+{
+    MessageWriterRef writer = argument;
+    MessageWriterRecord record;
+    while (true)
+    {
+        if (0 != sem_wait(&writer->queuedRecords))
+        {
+            if (EINTR == errno) { continue; }
+            break;
+        }
+
+        // write everything that is queued, then flush once
+        uint64_t count = 0;
+        while (BoundedQueueTryPop(writer->queue, &record))
+        {
+            MessageWriterWriteRecord(writer, &record);
+            count += 1;
+        }
+        if (count > 0)
+        {
+            fflush(writer->output);
+            atomic_fetch_add(&writer->writtenCount, count);
+        }
+        if (atomic_load(&writer->stopping)) { break; }
+    }
+    return NULL;
+}
+
+MessageWriterRef MessageWriterCreate(FILE * output, MessageWriterFormat format, uint32_t capacity)
+{
+    assert(NULL != output);
+
+    MessageWriterRef newWriter = malloc(sizeof(struct MessageWriter));
+    if (NULL == newWriter) { return NULL; }
+
+    newWriter->output = output;
+    newWriter->format = format;
+    newWriter->queue = BoundedQueueCreate(capacity, sizeof(MessageWriterRecord));
+    atomic_init(&newWriter->stopping, false);
+    atomic_init(&newWriter->writtenCount, 0);
+    atomic_init(&newWriter->droppedCount, 0);
+    if (NULL == newWriter->queue || 0 != sem_init(&newWriter->queuedRecords, 0, 0))
+    {
+        BoundedQueueRelease(newWriter->queue);
+        free(newWriter);
+        return NULL;
+    }
+
+    if (MessageWriterFormatCSV == format)
+    {
+        fprintf(output, "time,protocol,pin,code,address,group,onOff,channel,dimLevel,identifier,quality,echo,"
+                        "sensor,rollingCode,temperature,humidity,batteryLow,text\n");
+        fflush(output);
+    }
+
+    if (0 != pthread_create(&newWriter->thread, NULL, &MessageWriterRun, newWriter))
+    {
+        printf("MessageWriter: could not start the writer thread.\n");
+        sem_destroy(&newWriter->queuedRecords);
+        BoundedQueueRelease(newWriter->queue);
+        free(newWriter);
+        return NULL;
+    }
+    return newWriter;
+}
+
+void MessageWriterRelease(MessageWriterRef writer)
+{
+    if (NULL == writer) { return; }
+
+    atomic_store(&writer->stopping, true);
+    sem_post(&writer->queuedRecords);
+    pthread_join(writer->thread, NULL);
+
+    sem_destroy(&writer->queuedRecords);
+    BoundedQueueRelease(writer->queue);
+    free(writer);
+}
+
+bool MessageWriterSubmit(MessageWriterRef writer, const MessageWriterRecord * record)
+{
+    assert(NULL != writer);
+    assert(NULL != record);
+
+    if (!BoundedQueueTryPush(writer->queue, record))
+    {
+        atomic_fetch_add_explicit(&writer->droppedCount, 1, memory_order_relaxed);
+        return false;
+    }
+    // sem_post() does not block: it only wakes up the writer if it waits
+    sem_post(&writer->queuedRecords);
+    return true;
+}
+
+uint64_t MessageWriterGetWrittenCount(MessageWriterRef writer)
+{
+    assert(NULL != writer);
+    return atomic_load(&writer->writtenCount);
+}
+
+uint64_t MessageWriterGetDroppedCount(MessageWriterRef writer)
+{
+    assert(NULL != writer);
+    return atomic_load(&writer->droppedCount);
+}
+
+bool MessageWriterParseFormat(const char * name, MessageWriterFormat * format)
+{
+    assert(NULL != format);
+    if (!strcmp(name, "json"))        { *format = MessageWriterFormatJSON; }
+    else if (!strcmp(name, "csv"))    { *format = MessageWriterFormatCSV; }
+    else if (!strcmp(name, "binary")) { *format = MessageWriterFormatBinary; }
+    else { return false; }
+    return true;
+}
@@ -0,0 +1,165 @@
+#ifndef MessageWriter_h
+#define MessageWriter_h
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "ProtocolDescriptor.h"
+
+/*
+A MessageWriter writes received messages in a machine-readable format to a
+stream, on a thread of its own. MessageWriterSubmit() only copies the record
+into a bounded lock-free queue (see BoundedQueue.h) and wakes up the writer
+thread, so it never blocks the thread that decodes messages, even when the
+reader of the stream is slow. When the queue is full the record is dropped and
+counted instead.
+Formats:
+- JSON: one JSON object per line, e.g.
+  {"time":1595321234567890,"protocol":"COCO","pin":27,"code":60287110,
+   "address":941986,"group":0,"onOff":1,"channel":6,"quality":92,"echo":false}
+  A COCO dim message also has "dimLevel" (0 - 15). KFS messages have
+  "identifier" instead of the COCO fields. The other protocols have:
+  - Oregon: "sensor", "channel", "rollingCode", "temperature" (°C),
+    "humidity" (if the sensor has it) and "batteryLow", e.g.
+    {"time":1595321234567890,"protocol":"Oregon","pin":27,"code":2868423,
+     "sensor":"THGR122N","channel":1,"rollingCode":187,"temperature":21.4,
+     "humidity":45,"batteryLow":false,"quality":88,"echo":false}
+  - a frame of a ProtocolEngine: the name of its descriptor as "protocol",
+    "bits", and the fields of the descriptor, e.g.
+    {"time":1595321234567890,"protocol":"EV1527","pin":27,"code":10468249,
+     "bits":24,"id":654321,"data":9,"quality":95,"echo":false}
+    with the code in full, and tri-state fields as strings ("0F1F0011").
+  - a frame of a plugin: the name of the plugin as "protocol", and "text", the
+    frame as the plugin formats it, e.g. "Example [id 42, button 3]".
+- CSV: a header line, followed by one line per message:
+  time,protocol,pin,code,address,group,onOff,channel,dimLevel,identifier,quality,echo,sensor,rollingCode,temperature,humidity,batteryLow,text
+  The fields that do not apply to the protocol are empty. An Oregon message
+  uses `channel`, the columns from `sensor` up to `batteryLow`. For the frames
+  of a ProtocolEngine and of plugins, `code` is their code in full, and `text`
+  is the frame as it is printed without an output format (e.g.
+  `EV1527 [id 654321, data 9]`), between double quotes when it has a comma.
+- binary: one MessageWriterBinaryRecordSize (16) byte record per message, all
+  numbers little-endian:
+    0  uint64  time      microseconds since the Unix epoch
+    8  uint32  code      COCO: COCOMessageGetCode(), KFS: the identifier,
+                         Oregon: OregonMessageGetCode(), frames of a
+                         ProtocolEngine or plugin: the lowest 32 bits of
+                         their code
+    12 uint8   protocol  MessageWriterProtocol: 1: COCO, 2: KFS, 3: Oregon,
+                         4: a frame of a ProtocolEngine, 5: of a plugin
+    13 uint8   quality   0 - 100
+    14 uint8   pin
+    15 uint8   flags     bit 0: echo of our own transmission,
+                         bit 1: a COCO dim message, bits 4 - 7: its dim level,
+                         bit 2: the record is followed by text
+  The fields of a COCO message follow from its code: address = code >> 6,
+  group = bit 5, onOff = bit 4, channel = the lowest 4 bits.
+  The records of Oregon messages and of frames are followed by text: a uint8
+  length, and that many bytes of the message as it is printed without an
+  output format (e.g. `Oregon THGR122N [channel 1, ...]`), without a '\0'.
+*/
+
+typedef struct MessageWriter *MessageWriterRef;
+
+typedef enum MessageWriterFormat
+{
+    MessageWriterFormatJSON = 1,
+    MessageWriterFormatCSV = 2,
+    MessageWriterFormatBinary = 3
+} MessageWriterFormat;
+
+typedef enum MessageWriterProtocol
+{
+    MessageWriterProtocolCOCO = 1,
+    MessageWriterProtocolKFS = 2,
+    MessageWriterProtocolOregon = 3,
+    MessageWriterProtocolFrame = 4, // of a ProtocolEngine
+    MessageWriterProtocolPlugin = 5
+} MessageWriterProtocol;
+
+#define MessageWriterBinaryRecordSize 16
+
+// the longest text of a record, including the '\0'
+#define MessageWriterMaxTextLength 128
+
+typedef struct MessageWriterRecord
+{
+    uint64_t time;      // microseconds since the Unix epoch
+    uint32_t code;      // COCO: COCOMessageGetCode(), KFS: the identifier, Oregon: OregonMessageGetCode()
+    uint8_t protocol;   // MessageWriterProtocol
+    int8_t dimLevel;    // COCO: COCOMessageGetDimLevel(), others: -1
+    uint8_t quality;
+    uint8_t PIN;
+    bool isEcho;
+
+    // Oregon, frames and plugins: the message as it is printed without an
+    // output format, e.g. by OregonMessageFormat()
+    char text[MessageWriterMaxTextLength];
+
+    // the fields of the other protocols than COCO and KFS
+    union
+    {
+        struct
+        {
+            const char * sensorName; // OregonMessageGetSensorName()
+            int16_t temperature;     // in tenths of a degree Celsius
+            uint8_t channel;
+            uint8_t rollingCode;
+            uint8_t humidity;
+            bool hasHumidity;
+            bool batteryLow;
+        } oregon;
+        struct
+        {
+            const ProtocolDescriptor * descriptor;
+            uint64_t code;
+            uint32_t bitCount;
+        } frame;
+        struct
+        {
+            const char * name; // must stay valid until the writer is released
+            uint64_t code;
+        } plugin;
+    };
+} MessageWriterRecord;
+
+/*
+Creates a new writer that writes to `output` in `format`, holding at most
+`capacity` records that were not written yet, or NULL if a writer could not be
+created. The writer thread is started right away. You are responsible for
+releasing this object using MessageWriterRelease().
+*/
+MessageWriterRef MessageWriterCreate(FILE * output, MessageWriterFormat format, uint32_t capacity);
+
+/*
+Writes the records that are still queued, stops the writer thread and
+releases the writer. This function is safe to call when `writer` is NULL.
+*/
+void MessageWriterRelease(MessageWriterRef writer);
+
+/*
+Queues `record` for writing. Never blocks. Returns false if the queue was
+full, in which case the record is dropped.
+Thread-safe: may be called from any number of threads.
+*/
+bool MessageWriterSubmit(MessageWriterRef writer, const MessageWriterRecord * record);
+
+/*
+The number of records written, and the number of records that were dropped
+because the queue was full.
+*/
+uint64_t MessageWriterGetWrittenCount(MessageWriterRef writer);
+uint64_t MessageWriterGetDroppedCount(MessageWriterRef writer);
+
+/*
+Parses `json`, `csv` or `binary`. Returns false for anything else.
+*/
+bool MessageWriterParseFormat(const char * name, MessageWriterFormat * format);
+
+/*
+The current time, for MessageWriterRecord.time.
+*/
+uint64_t MessageWriterGetTime();
+
+#endif
@@ -0,0 +1,232 @@
+#include <stdio.h>
+#include <assert.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "NotificationPipeReader.h"
+
+// the number of reports read at once
+#define NotificationPipeReaderBlockLength 256
+
+#define NotificationPipeReaderSkippedFlags (NotificationPipeReportFlagWatchdog | NotificationPipeReportFlagKeepAlive | NotificationPipeReportFlagEvent)
+
+struct NotificationPipeReader
+{
+    char * path;
+    SampleEdgeExtractorRef extractor;
+
+    // for internal use
+    //
+    int fileDescriptor;
+    int stopFileDescriptors[2]; // a pipe that wakes up the thread to stop it
+    pthread_t thread;
+    bool running;
+
+    bool hasSequenceNumber;
+    uint16_t nextSequenceNumber;
+    _Atomic uint64_t reportCount;
+    _Atomic uint64_t readCount;
+    _Atomic uint64_t lostReportCount;
+};
+
+NotificationPipeReaderRef NotificationPipeReaderCreate(const char * path, SampleEdgeExtractorRef extractor)
+{
+    assert(NULL != path);
+    assert(NULL != extractor);
+
+    NotificationPipeReaderRef newReader = malloc(sizeof(struct NotificationPipeReader));
+    if (NULL != newReader)
+    {
+        newReader->path = strdup(path);
+        newReader->extractor = extractor;
+        newReader->fileDescriptor = -1;
+        newReader->stopFileDescriptors[0] = -1;
+        newReader->stopFileDescriptors[1] = -1;
+        newReader->running = false;
+        newReader->hasSequenceNumber = false;
+        newReader->nextSequenceNumber = 0;
+        atomic_init(&newReader->reportCount, 0);
+        atomic_init(&newReader->readCount, 0);
+        atomic_init(&newReader->lostReportCount, 0);
+    }
+    return newReader;
+}
+
+void NotificationPipeReaderRelease(NotificationPipeReaderRef reader)
+{
+    if (NULL == reader) { return; }
+    NotificationPipeReaderStop(reader);
+    free(reader->path);
+    free(reader);
+}
+
+void NotificationPipeReaderCloseFileDescriptors(NotificationPipeReaderRef reader)
+{
+    if (reader->fileDescriptor >= 0) { close(reader->fileDescriptor); }
+    if (reader->stopFileDescriptors[0] >= 0) { close(reader->stopFileDescriptors[0]); }
+    if (reader->stopFileDescriptors[1] >= 0) { close(reader->stopFileDescriptors[1]); }
+    reader->fileDescriptor = -1;
+    reader->stopFileDescriptors[0] = -1;
+    reader->stopFileDescriptors[1] = -1;
+}
+
+// converts a block of reports to samples, and feeds them to the extractor
+void NotificationPipeReaderFeedReports(NotificationPipeReaderRef reader, const NotificationPipeReport * reports, uint32_t count)
+{
+    SampleEdgeExtractorSample samples[NotificationPipeReaderBlockLength];
+    uint32_t sampleCount = 0;
+    uint64_t lostCount = 0;
+    for (uint32_t index = 0; index < count; index++)
+    {
+        const NotificationPipeReport * report = &reports[index];
+        if (reader->hasSequenceNumber)
+        { lostCount += (uint16_t) (report->seqno - reader->nextSequenceNumber); }
+        reader->hasSequenceNumber = true;
+        reader->nextSequenceNumber = report->seqno + 1;
+
+        if (0 != (report->flags & NotificationPipeReaderSkippedFlags)) { continue; }
+        samples[sampleCount].tick = report->tick;
+        samples[sampleCount].level = report->level;
+        sampleCount++;
+    }
+
+    atomic_fetch_add(&reader->lostReportCount, lostCount);
+    SampleEdgeExtractorFeedSamples(reader->extractor, samples, sampleCount);
+    // counted after feeding, so that the count says what was processed
+    atomic_fetch_add(&reader->reportCount, count);
+}
+
+// after the writer closed a FIFO (or the pipe of a PIGPIO that restarted): opens
+// it again, to wait for the next writer. A regular file has simply ended.
+bool NotificationPipeReaderReopen(NotificationPipeReaderRef reader)
+{
+    struct stat status;
+    if (0 != fstat(reader->fileDescriptor, &status) || !S_ISFIFO(status.st_mode)) { return false; }
+
+    close(reader->fileDescriptor);
+    reader->fileDescriptor = open(reader->path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (reader->fileDescriptor < 0)
+    {
+        fprintf(stderr, "NotificationPipeReader: could not reopen `%s`: %s\n", reader->path, strerror(errno));
+        return false;
+    }
+    // a new writer starts its own sequence numbers
+    reader->hasSequenceNumber = false;
+    return true;
+}
+
+void * NotificationPipeReaderRun(void * argument)
+{
+    NotificationPipeReaderRef reader = argument;
+    NotificationPipeReport reports[NotificationPipeReaderBlockLength];
+    size_t bufferedLength = 0; // bytes of a partially read report
+
+    struct pollfd pollFileDescriptors[2];
+    pollFileDescriptors[0].fd = reader->fileDescriptor;
+    pollFileDescriptors[0].events = POLLIN;
+    pollFileDescriptors[1].fd = reader->stopFileDescriptors[0];
+    pollFileDescriptors[1].events = POLLIN;
+
+    while (true)
+    {
+        if (poll(pollFileDescriptors, 2, -1) < 0)
+        {
+            if (EINTR == errno) { continue; }
+            fprintf(stderr, "NotificationPipeReader: could not wait for `%s`: %s\n", reader->path, strerror(errno));
+            break;
+        }
+
+        // read what is there before stopping, so that nothing written before
+        // the stop is lost
+        if (0 != pollFileDescriptors[0].revents)
+        {
+            ssize_t length = read(reader->fileDescriptor, (char *) reports + bufferedLength, sizeof(reports) - bufferedLength);
+            if (length < 0 && (EAGAIN == errno || EINTR == errno)) { continue; }
+            if (length < 0)
+            {
+                fprintf(stderr, "NotificationPipeReader: could not read `%s`: %s\n", reader->path, strerror(errno));
+                break;
+            }
+            if (0 == length)
+            {
+                // the writer closed the pipe: a partial report is lost
+                bufferedLength = 0;
+                if (!NotificationPipeReaderReopen(reader)) { break; }
+                pollFileDescriptors[0].fd = reader->fileDescriptor;
+                continue;
+            }
+
+            length += bufferedLength;
+            uint32_t count = (uint32_t) (length / sizeof(NotificationPipeReport));
+            if (count > 0)
+            {
+                atomic_fetch_add(&reader->readCount, 1);
+                NotificationPipeReaderFeedReports(reader, reports, count);
+            }
+            bufferedLength = (size_t) length % sizeof(NotificationPipeReport);
+            memmove(reports, &reports[count], bufferedLength);
+            continue;
+        }
+        if (0 != pollFileDescriptors[1].revents) { break; }
+    }
+    return NULL;
+}
+
+bool NotificationPipeReaderStart(NotificationPipeReaderRef reader)
+{
+    assert(NULL != reader);
+    if (reader->running) { return true; }
+
+    // non-blocking, so that opening a FIFO does not wait for its writer
+    reader->fileDescriptor = open(reader->path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (reader->fileDescriptor < 0 || 0 != pipe(reader->stopFileDescriptors))
+    {
+        printf("NotificationPipeReader: could not open `%s`: %s\n", reader->path, strerror(errno));
+        NotificationPipeReaderCloseFileDescriptors(reader);
+        return false;
+    }
+    if (0 != pthread_create(&reader->thread, NULL, &NotificationPipeReaderRun, reader))
+    {
+        printf("NotificationPipeReader: could not start the reading thread.\n");
+        NotificationPipeReaderCloseFileDescriptors(reader);
+        return false;
+    }
+    reader->running = true;
+    return true;
+}
+
+void NotificationPipeReaderStop(NotificationPipeReaderRef reader)
+{
+    assert(NULL != reader);
+    if (!reader->running) { return; }
+
+    char stop = 1;
+    ssize_t written = write(reader->stopFileDescriptors[1], &stop, sizeof(stop));
+    (void) written;
+    pthread_join(reader->thread, NULL);
+    reader->running = false;
+    NotificationPipeReaderCloseFileDescriptors(reader);
+}
+
+uint64_t NotificationPipeReaderGetReportCount(NotificationPipeReaderRef reader)
+{
+    assert(NULL != reader);
+    return atomic_load(&reader->reportCount);
+}
+
+uint64_t NotificationPipeReaderGetReadCount(NotificationPipeReaderRef reader)
+{
+    assert(NULL != reader);
+    return atomic_load(&reader->readCount);
+}
+
+uint64_t NotificationPipeReaderGetLostReportCount(NotificationPipeReaderRef reader)
+{
+    assert(NULL != reader);
+    return atomic_load(&reader->lostReportCount);
+}
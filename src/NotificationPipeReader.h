@@ -0,0 +1,80 @@
+#ifndef NotificationPipeReader_h
+#define NotificationPipeReader_h
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include "SampleEdgeExtractor.h"
+
+/*
+A NotificationPipeReader reads the level reports that PIGPIO writes to a
+notification pipe (`/dev/pigpioN`, see gpioNotifyOpen() and gpioNotifyBegin(),
+or `pigs no` and `pigs nb` when the PIGPIO daemon runs), and passes them on to
+a SampleEdgeExtractor. PIGPIO writes a report for every sample in which one of
+the notified GPIOs changed, and many reports arrive per read(): they are read
+in blocks of up to 256, and each block is fed to the extractor in one call.
+So the cost of a read and a callback is paid per block instead of per edge,
+and the decoding can run in another process than PIGPIO.
+Any file or FIFO holding reports can be read as well: a FIFO that another
+program writes reports to stands in for the pipe of PIGPIO.
+The reports are read on a thread of the reader, the extractor's callback is
+called on that thread.
+*/
+
+typedef struct NotificationPipeReader *NotificationPipeReaderRef;
+
+/*
+One report, as PIGPIO writes it (`gpioReport_t`). Reports of which `flags`
+has one of the bits below set are not level changes, and are skipped.
+*/
+typedef struct NotificationPipeReport
+{
+    uint16_t seqno;
+    uint16_t flags;
+    uint32_t tick;
+    uint32_t level;
+} NotificationPipeReport;
+
+#define NotificationPipeReportFlagWatchdog (1 << 5)
+#define NotificationPipeReportFlagKeepAlive (1 << 6)
+#define NotificationPipeReportFlagEvent (1 << 7)
+
+/*
+Creates a new reader for the pipe at `path`, that feeds the reports to
+`extractor`, or NULL if a reader could not be created. The pipe is opened by
+NotificationPipeReaderStart(). You are responsible for releasing this object
+using NotificationPipeReaderRelease(), and for keeping the extractor around
+until then.
+*/
+NotificationPipeReaderRef NotificationPipeReaderCreate(const char * path, SampleEdgeExtractorRef extractor);
+
+/*
+Stops and releases a NotificationPipeReaderRef. This function is safe to call
+when `reader` is NULL.
+*/
+void NotificationPipeReaderRelease(NotificationPipeReaderRef reader);
+
+/*
+Opens the pipe, and starts reading it. Returns false if the pipe could not be
+opened. When the writer of a FIFO closes it (e.g. the PIGPIO daemon
+restarted), the FIFO is opened again for the next writer. Reading ends at the
+end of a regular file, when reading fails (which is printed to the standard
+error), or when NotificationPipeReaderStop() is called, which returns after
+the last report was fed.
+*/
+bool NotificationPipeReaderStart(NotificationPipeReaderRef reader);
+void NotificationPipeReaderStop(NotificationPipeReaderRef reader);
+
+/*
+Statistics on the reports read:
+- reports: the number of reports read
+- reads: the number of read() calls that returned reports; reports / reads is
+  the average block size
+- lost: the number of reports that PIGPIO dropped, from gaps in the sequence
+  numbers
+*/
+uint64_t NotificationPipeReaderGetReportCount(NotificationPipeReaderRef reader);
+uint64_t NotificationPipeReaderGetReadCount(NotificationPipeReaderRef reader);
+uint64_t NotificationPipeReaderGetLostReportCount(NotificationPipeReaderRef reader);
+
+#endif
@@ -0,0 +1,192 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include "OOKEncoder.h"
+
+struct OOKEncoder
+{
+    const ProtocolDescriptor * descriptor;
+    uint32_t singlePulseDuration; // µs
+    uint32_t repeatCount;
+
+    uint32_t symbolBitCount;
+    int32_t symbolForValue[256]; // -1: the protocol has no symbol for the value
+
+    // per value of a byte, the durations of the pulses of its symbols, and
+    // their number (0: a group of bits of the byte has no symbol)
+    uint32_t pulsesPerByte;
+    uint32_t * byteDurations;
+    uint32_t bytePulseCounts[256];
+};
+
+// appends the pulses of `symbol` to `durations`, returns their number
+uint32_t OOKEncoderAppendSymbol(OOKEncoderRef encoder, const ProtocolSymbol * symbol, uint32_t * durations)
+{
+    for (uint32_t pulse = 0; pulse < symbol->pulseCount; pulse++)
+    {
+        durations[pulse] = symbol->pulses[pulse] * encoder->singlePulseDuration;
+    }
+    return symbol->pulseCount;
+}
+
+void OOKEncoderUpdateTable(OOKEncoderRef encoder)
+{
+    const ProtocolDescriptor * descriptor = encoder->descriptor;
+    uint32_t symbolMask = (1u << encoder->symbolBitCount) - 1;
+    for (uint32_t byte = 0; byte < 256; byte++)
+    {
+        uint32_t * durations = encoder->byteDurations + byte * encoder->pulsesPerByte;
+        uint32_t count = 0;
+        for (int32_t shift = 8 - encoder->symbolBitCount; shift >= 0; shift -= encoder->symbolBitCount)
+        {
+            int32_t symbol = encoder->symbolForValue[(byte >> shift) & symbolMask];
+            if (symbol < 0)
+            {
+                count = 0;
+                break;
+            }
+            count += OOKEncoderAppendSymbol(encoder, &descriptor->symbols[symbol], durations + count);
+        }
+        encoder->bytePulseCounts[byte] = count;
+    }
+}
+
+OOKEncoderRef OOKEncoderCreate(const ProtocolDescriptor * descriptor)
+{
+    assert(NULL != descriptor);
+
+    uint32_t symbolBitCount = (descriptor->symbolCount > 0) ? descriptor->symbols[0].bitCount : 0;
+    bool encodable = (0 != descriptor->startSyncHigh && 0 != descriptor->singlePulseDuration &&
+                      symbolBitCount > 0 && 0 == 8 % symbolBitCount &&
+                      descriptor->symbolCount <= ProtocolMaxSymbolCount &&
+                      descriptor->maxBitCount <= ProtocolMaxBitCount);
+    for (uint32_t symbol = 0; encodable && symbol < descriptor->symbolCount; symbol++)
+    {
+        encodable = (descriptor->symbols[symbol].bitCount == symbolBitCount &&
+                     descriptor->symbols[symbol].pulseCount <= ProtocolMaxSymbolPulseCount);
+    }
+    if (!encodable)
+    {
+        printf("OOKEncoderCreate(): can not encode %s.\n", (NULL == descriptor->name) ? "(unnamed)" : descriptor->name);
+        return NULL;
+    }
+
+    OOKEncoderRef newEncoder = malloc(sizeof(struct OOKEncoder));
+    if (NULL != newEncoder)
+    {
+        newEncoder->descriptor = descriptor;
+        newEncoder->singlePulseDuration = descriptor->singlePulseDuration;
+        newEncoder->repeatCount = descriptor->transmitRepeatCount;
+        newEncoder->symbolBitCount = symbolBitCount;
+        for (uint32_t value = 0; value < 256; value++)
+        {
+            newEncoder->symbolForValue[value] = -1;
+        }
+        for (uint32_t symbol = 0; symbol < descriptor->symbolCount; symbol++)
+        {
+            newEncoder->symbolForValue[descriptor->symbols[symbol].value & ((1u << symbolBitCount) - 1)] = symbol;
+        }
+
+        newEncoder->pulsesPerByte = (8 / symbolBitCount) * ProtocolMaxSymbolPulseCount;
+        newEncoder->byteDurations = malloc(256 * newEncoder->pulsesPerByte * sizeof(uint32_t));
+        if (NULL == newEncoder->byteDurations)
+        {
+            free(newEncoder);
+            return NULL;
+        }
+        OOKEncoderUpdateTable(newEncoder);
+    }
+    return newEncoder;
+}
+
+void OOKEncoderRelease(OOKEncoderRef encoder)
+{
+    if (NULL == encoder) { return; }
+    free(encoder->byteDurations);
+    free(encoder);
+}
+
+const ProtocolDescriptor * OOKEncoderGetDescriptor(OOKEncoderRef encoder)
+{
+    assert(NULL != encoder);
+    return encoder->descriptor;
+}
+
+void OOKEncoderSetSinglePulseDuration(OOKEncoderRef encoder, uint32_t pulseDuration)
+{
+    assert(NULL != encoder);
+    assert(pulseDuration > 0);
+    encoder->singlePulseDuration = pulseDuration;
+    OOKEncoderUpdateTable(encoder);
+}
+
+uint32_t OOKEncoderGetSinglePulseDuration(OOKEncoderRef encoder)
+{
+    assert(NULL != encoder);
+    return encoder->singlePulseDuration;
+}
+
+void OOKEncoderSetRepeatCount(OOKEncoderRef encoder, uint32_t repeatCount)
+{
+    assert(NULL != encoder);
+    encoder->repeatCount = repeatCount;
+}
+
+uint32_t OOKEncoderGetRepeatCount(OOKEncoderRef encoder)
+{
+    assert(NULL != encoder);
+    return encoder->repeatCount;
+}
+
+uint32_t OOKEncoderEncode(OOKEncoderRef encoder, uint64_t code, uint32_t bitCount,
+                          uint32_t * durations, uint32_t capacity)
+{
+    assert(NULL != encoder);
+    assert(NULL != durations);
+
+    const ProtocolDescriptor * descriptor = encoder->descriptor;
+    if (bitCount < descriptor->minBitCount || bitCount > descriptor->maxBitCount ||
+        0 != bitCount % encoder->symbolBitCount ||
+        capacity < 4 + bitCount / encoder->symbolBitCount * ProtocolMaxSymbolPulseCount)
+    { return 0; }
+
+    uint32_t length = 0;
+    durations[length++] = descriptor->startSyncHigh * encoder->singlePulseDuration;
+    durations[length++] = descriptor->startSyncLow * encoder->singlePulseDuration;
+
+    // the bits before the first whole byte, symbol by symbol
+    uint32_t symbolMask = (1u << encoder->symbolBitCount) - 1;
+    uint32_t shift = bitCount;
+    for (; shift % 8 != 0; shift -= encoder->symbolBitCount)
+    {
+        int32_t symbol = encoder->symbolForValue[(code >> (shift - encoder->symbolBitCount)) & symbolMask];
+        if (symbol < 0) { return 0; }
+        length += OOKEncoderAppendSymbol(encoder, &descriptor->symbols[symbol], durations + length);
+    }
+
+    // the whole bytes from the table
+    for (; shift > 0; shift -= 8)
+    {
+        uint32_t byte = (code >> (shift - 8)) & 0xFF;
+        uint32_t count = encoder->bytePulseCounts[byte];
+        if (0 == count) { return 0; }
+        memcpy(durations + length, encoder->byteDurations + byte * encoder->pulsesPerByte, count * sizeof(uint32_t));
+        length += count;
+    }
+
+    // without an end-sync, the start-sync of the next repeat ends the frame
+    if (0 != descriptor->endSyncLow)
+    {
+        if (0 != descriptor->endHigh)
+        {
+            durations[length++] = descriptor->endHigh * encoder->singlePulseDuration;
+            durations[length++] = descriptor->endSyncLow * encoder->singlePulseDuration;
+        }
+        else
+        {
+            // the last symbol ends low
+            durations[length - 1] += descriptor->endSyncLow * encoder->singlePulseDuration;
+        }
+    }
+    return length;
+}
@@ -0,0 +1,67 @@
+#ifndef OOKEncoder_h
+#define OOKEncoder_h
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include "ProtocolDescriptor.h"
+
+/*
+An OOKEncoder turns the code of a frame into the durations of its pulses, for
+any protocol that a ProtocolDescriptor describes: the start-sync, a symbol
+per group of bits (most-significant first), and the end (see
+ProtocolDescriptor.h). A sender transmits the durations alternately high and
+low, starting high, `repeatCount` more times.
+When the single pulse duration is set, the encoder builds a table that holds
+the pulses of every possible byte of the code, so that encoding a frame is
+copying one row of the table per byte.
+*/
+
+// the maximum number of pulses in one frame
+#define OOKEncoderMaxPulseCount (4 + ProtocolMaxBitCount * ProtocolMaxSymbolPulseCount)
+
+typedef struct OOKEncoder *OOKEncoderRef;
+
+/*
+Creates a new OOKEncoder for `descriptor`, with its single pulse duration and
+transmit repeat count. The descriptor is not copied, it must outlive the
+encoder. Returns NULL if the encoder could not be created, or if the protocol
+can not be encoded: its start-sync must start high, and all of its symbols
+must have the same bit count, which divides 8.
+You are responsible for releasing this object using OOKEncoderRelease().
+*/
+OOKEncoderRef OOKEncoderCreate(const ProtocolDescriptor * descriptor);
+
+/*
+Releases an OOKEncoderRef. This function is safe to call when `encoder` is
+NULL.
+*/
+void OOKEncoderRelease(OOKEncoderRef encoder);
+
+const ProtocolDescriptor * OOKEncoderGetDescriptor(OOKEncoderRef encoder);
+
+/*
+Defaults to the single pulse duration of the descriptor, in microseconds.
+Setting it rebuilds the table, so do not set it for every frame.
+*/
+void OOKEncoderSetSinglePulseDuration(OOKEncoderRef encoder, uint32_t pulseDuration);
+uint32_t OOKEncoderGetSinglePulseDuration(OOKEncoderRef encoder);
+
+/*
+Defaults to the transmit repeat count of the descriptor: the number of times
+a frame is sent after the first time.
+*/
+void OOKEncoderSetRepeatCount(OOKEncoderRef encoder, uint32_t repeatCount);
+uint32_t OOKEncoderGetRepeatCount(OOKEncoderRef encoder);
+
+/*
+Writes the durations (µs) of the pulses of a frame with the lowest `bitCount`
+bits of `code` into `durations`, which has room for `capacity` durations (at
+most OOKEncoderMaxPulseCount are needed). Returns the number of durations, or
+0 if `bitCount` is not valid for the protocol, if the code contains a group of
+bits for which the protocol has no symbol, or if `durations` is too small.
+*/
+uint32_t OOKEncoderEncode(OOKEncoderRef encoder, uint64_t code, uint32_t bitCount,
+                          uint32_t * durations, uint32_t capacity);
+
+#endif
@@ -2,11 +2,65 @@
 #include <time.h>
 #include <sys/time.h>
 #include <assert.h>
+#include <stdatomic.h>
 #include "OOKSender.h"
+#include "PIGPIOBackend.h"
+#include "Tracepoints.h"
+
+// the number of most recent edges of the receiver that are remembered for
+// listen-before-talk
+#define OOKSenderEdgeHistoryLength 64
+
+// the window before a burst in which the channel is checked, in microseconds.
+// This is longer than the longest gap in the supported protocols (the COCO 
+// stop-sync), so an ongoing transmission is always noticed.
+const uint32_t OOKSenderListenWindow = 15000;
+
+// durations between two edges that look like they could be part of a 
+// transmission: noise from the receiver is typically much shorter, silence
+// much longer.
+const uint32_t OOKSenderValidPulseMinDuration = 150;
+const uint32_t OOKSenderValidPulseMaxDuration = 12000;
+
+// the number of valid-looking durations in the listen window that mark the 
+// channel as busy
+const uint32_t OOKSenderBusyPulseCount = 8;
+
+// backoff slot in microseconds. The backoff after the n-th busy channel is a
+// random number of slots between 1 and 2^n, n is capped at OOKSenderMaxBackoffExponent
+const uint32_t OOKSenderBackoffSlot = 2000;
+const uint32_t OOKSenderMaxBackoffExponent = 6;
 
 struct OOKSender
 {
 	uint8_t GPIO;
+	GPIOBackendRef backend;
+
+	// listen-before-talk
+	bool listenBeforeTalk;
+	uint32_t listenBeforeTalkDeadline; // µicro seconds
+	// written from the sending thread, read from any thread
+	_Atomic uint32_t busyCount;
+	_Atomic uint32_t backoffCount;
+	_Atomic uint64_t backoffTime; // µicro seconds
+	_Atomic uint32_t deadlineExpiredCount;
+	unsigned int randomSeed;
+
+	// written from the thread calling OOKSenderFeedGPIOValueChangeTime(),
+	// read from the sending thread
+	_Atomic uint32_t edgeTimestamps[OOKSenderEdgeHistoryLength];
+	_Atomic uint32_t edgeTimestampsIndex; // index of the next edge to write
+	_Atomic bool transmitting;
+	_Atomic bool hasTransmitted;
+	_Atomic uint32_t transmissionEndTime; // edges before this are our own echo
+
+	// from the call to OOKSenderTransmit() to its first pulse, and to the end
+	// of the last repeat
+	LatencyHistogramRef startLatency;
+	LatencyHistogramRef completionLatency;
+
+	OOKEncoderRef COCOEncoder;
+	OOKEncoderRef KFSEncoder;
 
 #if OOKSenderDebugLogging
 	FILE * OUTFILE;
@@ -61,6 +115,37 @@ OOKSenderRef OOKSenderCreate()
 	if (NULL != sender)
 	{
 		sender->GPIO = 0xFF; // nonsense value
+		sender->backend = PIGPIOBackendGet();
+
+		sender->listenBeforeTalk = false;
+		sender->listenBeforeTalkDeadline = 500000;
+		atomic_init(&sender->busyCount, 0);
+		atomic_init(&sender->backoffCount, 0);
+		atomic_init(&sender->backoffTime, 0);
+		atomic_init(&sender->deadlineExpiredCount, 0);
+		sender->randomSeed = (unsigned int) timeInMicroSeconds();
+		for (uint32_t index = 0; index < OOKSenderEdgeHistoryLength; index++)
+		{
+			atomic_init(&sender->edgeTimestamps[index], 0);
+		}
+		atomic_init(&sender->edgeTimestampsIndex, 0);
+		atomic_init(&sender->transmitting, false);
+		atomic_init(&sender->hasTransmitted, false);
+		atomic_init(&sender->transmissionEndTime, 0);
+		sender->startLatency = LatencyHistogramCreate();
+		sender->completionLatency = LatencyHistogramCreate();
+		sender->COCOEncoder = OOKEncoderCreate(&ProtocolDescriptorCOCO);
+		sender->KFSEncoder = OOKEncoderCreate(&ProtocolDescriptorKFS);
+		if (NULL == sender->startLatency || NULL == sender->completionLatency ||
+			NULL == sender->COCOEncoder || NULL == sender->KFSEncoder)
+		{
+			LatencyHistogramRelease(sender->startLatency);
+			LatencyHistogramRelease(sender->completionLatency);
+			OOKEncoderRelease(sender->COCOEncoder);
+			OOKEncoderRelease(sender->KFSEncoder);
+			free(sender);
+			return NULL;
+		}
 
 #if OOKSenderDebugLogging
 		// clear file
@@ -88,16 +173,170 @@ void OOKSenderRelease(OOKSenderRef sender)
 #if OOKSenderDebugLogging
 	fclose(sender->OUTFILE);
 #endif
+	LatencyHistogramRelease(sender->startLatency);
+	LatencyHistogramRelease(sender->completionLatency);
+	OOKEncoderRelease(sender->COCOEncoder);
+	OOKEncoderRelease(sender->KFSEncoder);
 	free(sender);
 }
+void OOKSenderSetBackend(OOKSenderRef sender, GPIOBackendRef backend)
+{
+	assert(NULL != sender);
+	sender->backend = backend;
+}
+GPIOBackendRef OOKSenderGetBackend(OOKSenderRef sender)
+{
+	assert(NULL != sender);
+	return sender->backend;
+}
 void OOKSenderSetTransmitGPIO(OOKSenderRef sender, uint8_t GPIO)
 {
 	assert(NULL != sender);
+	assert(NULL != sender->backend);
 	sender->GPIO = GPIO;
-	gpioSetMode(GPIO, PI_OUTPUT);
+	GPIOBackendSetOutput(sender->backend, GPIO);
+}
+void OOKSenderSetListenBeforeTalk(OOKSenderRef sender, bool listenBeforeTalk)
+{
+	assert(NULL != sender);
+	sender->listenBeforeTalk = listenBeforeTalk;
+}
+bool OOKSenderGetListenBeforeTalk(OOKSenderRef sender)
+{
+	assert(NULL != sender);
+	return sender->listenBeforeTalk;
+}
+void OOKSenderSetListenBeforeTalkDeadline(OOKSenderRef sender, uint32_t deadline)
+{
+	assert(NULL != sender);
+	sender->listenBeforeTalkDeadline = deadline;
+}
+uint32_t OOKSenderGetListenBeforeTalkDeadline(OOKSenderRef sender)
+{
+	assert(NULL != sender);
+	return sender->listenBeforeTalkDeadline;
+}
+uint32_t OOKSenderGetBusyCount(OOKSenderRef sender)
+{
+	assert(NULL != sender);
+	return atomic_load_explicit(&sender->busyCount, memory_order_relaxed);
+}
+uint32_t OOKSenderGetBackoffCount(OOKSenderRef sender)
+{
+	assert(NULL != sender);
+	return atomic_load_explicit(&sender->backoffCount, memory_order_relaxed);
+}
+uint64_t OOKSenderGetBackoffTime(OOKSenderRef sender)
+{
+	assert(NULL != sender);
+	return atomic_load_explicit(&sender->backoffTime, memory_order_relaxed);
+}
+uint32_t OOKSenderGetDeadlineExpiredCount(OOKSenderRef sender)
+{
+	assert(NULL != sender);
+	return atomic_load_explicit(&sender->deadlineExpiredCount, memory_order_relaxed);
+}
+LatencyHistogramRef OOKSenderGetStartLatencyHistogram(OOKSenderRef sender)
+{
+	assert(NULL != sender);
+	return sender->startLatency;
+}
+LatencyHistogramRef OOKSenderGetCompletionLatencyHistogram(OOKSenderRef sender)
+{
+	assert(NULL != sender);
+	return sender->completionLatency;
+}
+OOKEncoderRef OOKSenderGetCOCOEncoder(OOKSenderRef sender)
+{
+	assert(NULL != sender);
+	return sender->COCOEncoder;
+}
+OOKEncoderRef OOKSenderGetKFSEncoder(OOKSenderRef sender)
+{
+	assert(NULL != sender);
+	return sender->KFSEncoder;
+}
+
+void OOKSenderFeedGPIOValueChangeTime(OOKSenderRef sender, uint32_t timestamp)
+{
+	assert(NULL != sender);
+
+	// while transmitting, the receiver picks up our own pulses
+	if (atomic_load_explicit(&sender->transmitting, memory_order_relaxed))
+	{ return; }
+
+	uint32_t index = atomic_load_explicit(&sender->edgeTimestampsIndex, memory_order_relaxed);
+	atomic_store_explicit(&sender->edgeTimestamps[index % OOKSenderEdgeHistoryLength], timestamp, memory_order_relaxed);
+	atomic_store_explicit(&sender->edgeTimestampsIndex, index + 1, memory_order_release);
+}
+
+/*
+Returns true if the edge history shows valid-looking pulses in the listen 
+window that ends at `now`.
+*/
+bool OOKSenderIsChannelBusy(OOKSenderRef sender, uint32_t now)
+{
+	uint32_t lastIndex = atomic_load_explicit(&sender->edgeTimestampsIndex, memory_order_acquire);
+	bool hasTransmitted = atomic_load_explicit(&sender->hasTransmitted, memory_order_relaxed);
+	uint32_t transmissionEndTime = atomic_load_explicit(&sender->transmissionEndTime, memory_order_relaxed);
+	uint32_t historyLength = lastIndex < OOKSenderEdgeHistoryLength ? lastIndex : OOKSenderEdgeHistoryLength;
+
+	uint32_t validPulseCount = 0;
+	uint32_t laterTimestamp = 0;
+	for (uint32_t count = 0; count < historyLength; count++)
+	{
+		uint32_t timestamp = atomic_load_explicit(&sender->edgeTimestamps[(lastIndex - 1 - count) % OOKSenderEdgeHistoryLength], memory_order_relaxed);
+
+		// timestamps wrap around, so compare differences. Stop at the first
+		// edge outside the window, or at the echo of our previous transmission
+		if ((int32_t) (now - timestamp) > (int32_t) OOKSenderListenWindow ||
+			(hasTransmitted && (int32_t) (timestamp - transmissionEndTime) <= 0))
+		{ break; }
+
+		if (count > 0)
+		{
+			uint32_t duration = laterTimestamp - timestamp;
+			if (duration > OOKSenderValidPulseMinDuration && duration < OOKSenderValidPulseMaxDuration)
+			{ validPulseCount += 1; }
+		}
+		laterTimestamp = timestamp;
+	}
+
+	return validPulseCount >= OOKSenderBusyPulseCount;
+}
+
+/*
+Blocks until the channel is free, or until the listen-before-talk deadline passes.
+*/
+void OOKSenderWaitForFreeChannel(OOKSenderRef sender)
+{
+	uint32_t startTime = GPIOBackendGetTick(sender->backend);
+	uint32_t exponent = 0;
+	while (OOKSenderIsChannelBusy(sender, GPIOBackendGetTick(sender->backend)))
+	{
+		atomic_fetch_add_explicit(&sender->busyCount, 1, memory_order_relaxed);
+
+		uint32_t elapsed = GPIOBackendGetTick(sender->backend) - startTime;
+		if (elapsed >= sender->listenBeforeTalkDeadline)
+		{
+			atomic_fetch_add_explicit(&sender->deadlineExpiredCount, 1, memory_order_relaxed);
+			return;
+		}
+
+		if (exponent < OOKSenderMaxBackoffExponent) { exponent += 1; }
+		uint32_t slots = 1 + (uint32_t) rand_r(&sender->randomSeed) % (1 << exponent);
+		uint32_t backoff = slots * OOKSenderBackoffSlot;
+		if (backoff > sender->listenBeforeTalkDeadline - elapsed)
+		{ backoff = sender->listenBeforeTalkDeadline - elapsed; }
+
+		atomic_fetch_add_explicit(&sender->backoffCount, 1, memory_order_relaxed);
+		atomic_fetch_add_explicit(&sender->backoffTime, backoff, memory_order_relaxed);
+		GPIOBackendSleep(sender->backend, backoff);
+	}
 }
+
 void OOKSenderTransmit(OOKSenderRef sender, 
-					   uint32_t *durations, 
+					   const uint32_t *durations, 
 					   uint32_t length, 
 					   bool firstValueHigh,
 					   uint32_t repeats)
@@ -120,6 +359,12 @@ void OOKSenderTransmit(OOKSenderRef sender,
 		return; 
 	}
 
+	uint64_t requestTime = GPIOBackendGetTime(sender->backend);
+	if (sender->listenBeforeTalk)
+	{ OOKSenderWaitForFreeChannel(sender); }
+	atomic_store_explicit(&sender->transmitting, true, memory_order_relaxed);
+	LPD433Trace3(ook_transmit_start, sender, length, repeats);
+
 #if OOKSenderDebugLogging
 	uint8_t **repeatedLevels = malloc(sizeof(uint8_t *) * (repeats + 1));
 	uint64_t **repeatedActualDurations = malloc(sizeof(uint64_t *) * (repeats + 1));
@@ -141,8 +386,11 @@ void OOKSenderTransmit(OOKSenderRef sender,
 #endif
 		for (uint32_t index = 0; index < length; index++)
 		{
-			uint64_t startTime = timeInMicroSeconds(); 
-			gpioWrite(sender->GPIO, level);
+			uint64_t startTime = GPIOBackendGetTime(sender->backend); 
+			GPIOBackendWrite(sender->backend, sender->GPIO, level);
+			LPD433Trace5(ook_pulse, sender, repeatIndex, index, level, durations[index]);
+			if (0 == repeatIndex && 0 == index)
+			{ LatencyHistogramRecord(sender->startLatency, (uint32_t) (startTime - requestTime)); }
 
 #if OOKSenderDebugLogging
 			repeatedLevels[repeatIndex][index] = level;
@@ -160,16 +408,15 @@ void OOKSenderTransmit(OOKSenderRef sender,
 			}
 #endif
 
-			// busywait is more accurate than some form of sleep()			
-			volatile uint64_t endTime = startTime + durations[index];
-			while (timeInMicroSeconds() < endTime) { ; }
+			// the backend busywaits, which is more accurate than some form of sleep()
+			GPIOBackendWaitUntil(sender->backend, startTime + durations[index]);
 
 			// update for next round
 			level = (level == 0) ? 1 : 0;
 		}
 
 #if OOKSenderDebugLogging
-		uint64_t startTime = timeInMicroSeconds(); 
+		uint64_t startTime = GPIOBackendGetTime(sender->backend); 
 		uint64_t actualDuration = startTime - previousStartTime;
 		uint64_t delta = actualDuration > durations[length-1] ? 
 										actualDuration - durations[length-1] : 
@@ -202,116 +449,100 @@ void OOKSenderTransmit(OOKSenderRef sender,
 #endif
 
 	// turn off the transmitter
-	gpioWrite(sender->GPIO, 0);
+	GPIOBackendWrite(sender->backend, sender->GPIO, 0);
+	LatencyHistogramRecord(sender->completionLatency, (uint32_t) (GPIOBackendGetTime(sender->backend) - requestTime));
+
+	atomic_store_explicit(&sender->transmissionEndTime, GPIOBackendGetTick(sender->backend), memory_order_relaxed);
+	atomic_store_explicit(&sender->hasTransmitted, true, memory_order_relaxed);
+	atomic_store_explicit(&sender->transmitting, false, memory_order_relaxed);
+	LPD433Trace1(ook_transmit_end, sender);
 }
 
-void OOKSenderSendCOCO(OOKSenderRef sender, COCOMessageRef message)
+bool OOKSenderSendCode(OOKSenderRef sender, OOKEncoderRef encoder, uint64_t code, uint32_t bitCount)
 {
-	uint32_t address = COCOMessageGetAddress(message);
-	bool group = COCOMessageGetGroup(message);
-	bool onOff = COCOMessageGetOnOff(message);
-	uint16_t channel = COCOMessageGetChannel(message);
-
-	// 26-bit address | 1-bit group | 1-bit on/off | 4-bit channel | stop-sync 
-	// bit 6 - 32 are the address
-	// bit 5 is the group value
-	// bit 4 is the onOff value
-	// least significant 4 bits are the channel
-
-	uint32_t fullCode = address;
-	
-	fullCode <<= 1;
-	fullCode |= group ? 1 : 0;
-
-	fullCode <<= 1;
-	fullCode |= onOff ? 1 : 0;
-
-	fullCode <<= 4;
-	fullCode |= channel;
-
-	#define kCOCOSinglePulseLength 260
-	#define kCOCOTotalNumberOfPulses 132
-	uint32_t durations[kCOCOTotalNumberOfPulses];
-
-	durations[0] = kCOCOSinglePulseLength;
-	durations[1] = 10 * kCOCOSinglePulseLength;
-	durations[kCOCOTotalNumberOfPulses - 2] =  1 * kCOCOSinglePulseLength;
-	durations[kCOCOTotalNumberOfPulses - 1] = 40 * kCOCOSinglePulseLength;
+	assert(NULL != sender);
+	assert(NULL != encoder);
 
-	for (uint32_t index = 2; index < kCOCOTotalNumberOfPulses - 2; index += 4)
+	uint32_t durations[OOKEncoderMaxPulseCount];
+	uint32_t length = OOKEncoderEncode(encoder, code, bitCount, durations, OOKEncoderMaxPulseCount);
+	if (0 == length)
 	{
-		// most-significant bit gets sent first
-		uint8_t shiftValue = 31 - (index - 2) / 4;
-		uint8_t bitValue = (fullCode >> shiftValue) & 1;
-		if (0 == bitValue)
-		{
-			durations[index]     = 1 * kCOCOSinglePulseLength;
-			durations[index + 1] = 1 * kCOCOSinglePulseLength;
-			durations[index + 2] = 1 * kCOCOSinglePulseLength;
-			durations[index + 3] = 4 * kCOCOSinglePulseLength;
-		}
-		else if (1 == bitValue)
-		{
-			durations[index]     = 1 * kCOCOSinglePulseLength;
-			durations[index + 1] = 4 * kCOCOSinglePulseLength;
-			durations[index + 2] = 1 * kCOCOSinglePulseLength;
-			durations[index + 3] = 1 * kCOCOSinglePulseLength;
-		}
-		else 
-		{
-			printf("Programming error: value should be zero or one");
-		}
+		printf("OOKSender: can not encode code 0x%llx of %u bits as %s.\n", 
+			   (unsigned long long) code, bitCount, OOKEncoderGetDescriptor(encoder)->name);
+		return false;
 	}
 
 	OOKSenderTransmit(sender, 
 					  durations, 
-					  kCOCOTotalNumberOfPulses, 
+					  length, 
 					  true,
-					  15);
+					  OOKEncoderGetRepeatCount(encoder));
+	return true;
+}
 
-	#undef kCOCOSinglePulseLength
-	#undef kCOCOTotalNumberOfPulses
+void OOKSenderSendDurations(OOKSenderRef sender, const uint32_t * durations, uint32_t length, uint32_t repeatCount)
+{
+	assert(NULL != sender);
+	assert(NULL != durations);
+	if (0 == length) { return; }
+	OOKSenderTransmit(sender, durations, length, true, repeatCount);
 }
 
-void OOKSenderSendKFS(OOKSenderRef sender, KFSMessageRef message)
+void OOKSenderSendCOCO(OOKSenderRef sender, COCOMessageRef message)
 {
-	uint32_t identifier = KFSMessageGetIdentifier(message);
+	assert(NULL != sender);
+	assert(NULL != message);
 
-	#define kKFSSinglePulseLength 350
-	#define kKFSTotalNumberOfPulses 50 // 24 bits, 2 pulses per bit, 2 pulses for the start sync
-	uint32_t durations[kKFSTotalNumberOfPulses];
+	// 26-bit address | 1-bit group | 1-bit on/off | 4-bit channel, see ProtocolDescriptorCOCO
+	int8_t dimLevel = COCOMessageGetDimLevel(message);
+	if (COCOMessageNoDimLevel == dimLevel)
+	{
+		OOKSenderSendCode(sender, sender->COCOEncoder, COCOMessageGetCode(message), 32);
+		return;
+	}
 
-	durations[0] = kKFSSinglePulseLength;
-	durations[1] = 31 * kKFSSinglePulseLength;
-	
-	for (uint32_t index = 2; index < kKFSTotalNumberOfPulses; index += 2)
+	// A dim message has no symbol of its own in ProtocolDescriptorCOCO: the
+	// 32 bits are encoded with an on/off bit of 0, of which the last, long low
+	// becomes short (the dim pattern), and the 4 bits of the dim level are
+	// inserted before the end-sync.
+	uint32_t onOffBit = 1u << 4;
+	uint32_t durations[OOKEncoderMaxPulseCount];
+	uint32_t length = OOKEncoderEncode(sender->COCOEncoder, COCOMessageGetCode(message) & ~onOffBit, 32, durations, OOKEncoderMaxPulseCount);
+	if (0 == length) { return; }
+
+	const ProtocolDescriptor * descriptor = OOKEncoderGetDescriptor(sender->COCOEncoder);
+	uint32_t singlePulseDuration = OOKEncoderGetSinglePulseDuration(sender->COCOEncoder);
+	// the on/off bit is the 28th bit that is sent, after the start-sync
+	uint32_t dimBitIndex = 27;
+	durations[2 + dimBitIndex * 4 + 3] = singlePulseDuration;
+
+	length -= 2;
+	for (int32_t shift = 3; shift >= 0; shift--)
 	{
-		// most-significant bit gets sent first
-		uint8_t shiftValue = 23 - ((index - 2) / 2);
-		uint8_t bitValue = (identifier >> shiftValue) & 1;
-		if (0 == bitValue)
-		{
-			durations[index]     = 1 * kKFSSinglePulseLength;
-			durations[index + 1] = 3 * kKFSSinglePulseLength;
-		}
-		else if (1 == bitValue)
-		{
-			durations[index]     = 3 * kKFSSinglePulseLength;
-			durations[index + 1] = 1 * kKFSSinglePulseLength;
-		}
-		else 
-		{
-			printf("Programming error: value should be zero or one");
-		}
+		const ProtocolSymbol * symbol = &descriptor->symbols[(dimLevel >> shift) & 1];
+		for (uint32_t pulse = 0; pulse < symbol->pulseCount; pulse++)
+		{ durations[length++] = symbol->pulses[pulse] * singlePulseDuration; }
 	}
+	durations[length++] = descriptor->endHigh * singlePulseDuration;
+	durations[length++] = descriptor->endSyncLow * singlePulseDuration;
 
-	OOKSenderTransmit(sender, 
-					  durations, 
-					  kKFSTotalNumberOfPulses, 
-					  true,
-					  6);
+	OOKSenderTransmit(sender, durations, length, true, OOKEncoderGetRepeatCount(sender->COCOEncoder));
+}
 
-	#undef kKFSSinglePulseLength
-	#undef kKFSTotalNumberOfPulses
+void OOKSenderSendCOCOScene(OOKSenderRef sender, COCOScenePlannerRef planner)
+{
+	assert(NULL != sender);
+	assert(NULL != planner);
+
+	uint32_t count = COCOScenePlannerGetMessageCount(planner);
+	for (uint32_t index = 0; index < count; index++)
+	{
+		OOKSenderSendCOCO(sender, COCOScenePlannerGetMessageAtIndex(planner, index));
+	}
 }
 
+void OOKSenderSendKFS(OOKSenderRef sender, KFSMessageRef message)
+{
+	// the identifier is always sent as 24 bits
+	OOKSenderSendCode(sender, sender->KFSEncoder, KFSMessageGetIdentifier(message), 24);
+}
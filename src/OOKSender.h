@@ -1,9 +1,12 @@
 #include <stdlib.h>
 #include <inttypes.h>
 #include <stdbool.h>
-#include <pigpio.h> // install this library by running: `sudo apt-get install pigpio`
+#include "GPIOBackend.h"
 #include "COCOReceiver.h"
 #include "KeyFobSwitchReceiver.h"
+#include "COCOScenePlanner.h"
+#include "LatencyHistogram.h"
+#include "OOKEncoder.h"
 
 // Set this to `1` to have the sender output some info that might help in debugging
 #define OOKSenderDebugLogging 0
@@ -25,17 +28,59 @@ memorystructures.
 */
 void OOKSenderRelease();
 
+/**
+The backend through which the pulses are output and timed. Defaults to the 
+PIGPIO backend (see PIGPIOBackendGet()). Set the backend before setting the
+transmit GPIO.
+*/
+void OOKSenderSetBackend(OOKSenderRef sender, GPIOBackendRef backend);
+GPIOBackendRef OOKSenderGetBackend(OOKSenderRef sender);
+
 /**
 Set the PIN number on which to output the pulses. Default PIGPIO numbering.
 */
 void OOKSenderSetTransmitGPIO(OOKSenderRef sender, uint8_t GPIO);
 
 /**
-This function will send the COCOMessageRef according to the COCO protocol.
+Sends a frame with the lowest `bitCount` bits of `code`, encoded by `encoder`,
+followed by the repeats of the encoder. Any protocol that a ProtocolDescriptor
+describes can be sent this way: build the code with ProtocolCodeSetField().
+This function blocks until the frame and its repeats have been sent. Returns
+false, without sending anything, if the code can not be encoded.
+*/
+bool OOKSenderSendCode(OOKSenderRef sender, OOKEncoderRef encoder, uint64_t code, uint32_t bitCount);
+
+/**
+Sends `length` pulses of `durations` µs, alternately high and low, starting
+high, followed by `repeatCount` repeats: for pulses that were encoded by 
+something else than an OOKEncoder, e.g. a decoder plugin.
+This function blocks until the pulses and their repeats have been sent.
+*/
+void OOKSenderSendDurations(OOKSenderRef sender, const uint32_t * durations, uint32_t length, uint32_t repeatCount);
+
+/**
+The encoders that OOKSenderSendCOCO() and OOKSenderSendKFS() use, e.g. to 
+change the single pulse duration or the number of repeats they send. They are
+owned by the sender.
+*/
+OOKEncoderRef OOKSenderGetCOCOEncoder(OOKSenderRef sender);
+OOKEncoderRef OOKSenderGetKFSEncoder(OOKSenderRef sender);
+
+/**
+This function will send the COCOMessageRef according to the COCO protocol:
+a dim message (see COCOMessageGetDimLevel()) as the 36 bits of a dim message.
 This function blocks until the message has been sent (~72ms).
 */
 void OOKSenderSendCOCO(OOKSenderRef sender, COCOMessageRef message);
 
+/**
+Sends the messages planned by `planner`, back to back, in order. If 
+COCOScenePlannerPlan() was not called since the last change to the planner,
+call it first.
+This function blocks until all messages have been sent (~72ms per message).
+*/
+void OOKSenderSendCOCOScene(OOKSenderRef sender, COCOScenePlannerRef planner);
+
 /**
 This function will send the KFSMessageRef according to a specific KFS protocol,
 one that works with most key fob switches that can be found by searching
@@ -43,3 +88,56 @@ for "Car Key Led Dimmer met RF Key Remote, 8A, 12V-24V"
 This function blocks until the message has been sent (~45ms).
 */
 void OOKSenderSendKFS(OOKSenderRef sender, KFSMessageRef message);
+
+/**
+Listen-before-talk (LBT). Defaults to `false`.
+When enabled, the sender checks the edges of a receiver in the same band
+before each burst of pulses it transmits. If the channel is busy (i.e. 
+someone else is transmitting valid-looking pulses), it backs off for a random, 
+exponentially growing, period and tries again, until the deadline passes. When
+the deadline passes, the burst is transmitted anyway.
+The edges need to be supplied by calling OOKSenderFeedGPIOValueChangeTime().
+*/
+void OOKSenderSetListenBeforeTalk(OOKSenderRef sender, bool listenBeforeTalk);
+bool OOKSenderGetListenBeforeTalk(OOKSenderRef sender);
+
+/**
+Every time the GPIO of the receiver changes state, call this function with the 
+timestamp of that change: the same timestamp that is fed to 
+COCOReceiverFeedGPIOValueChangeTime() and KFSReceiverFeedGPIOValueChangeTime().
+Only used for listen-before-talk. This function can be called from another 
+thread than the one that is sending (e.g. the PIGPIO callback thread).
+*/
+void OOKSenderFeedGPIOValueChangeTime(OOKSenderRef sender, uint32_t timestamp);
+
+/**
+Defaults to 500000, expressed in microseconds.
+The maximum time a burst is delayed by listen-before-talk.
+*/
+void OOKSenderSetListenBeforeTalkDeadline(OOKSenderRef sender, uint32_t deadline);
+uint32_t OOKSenderGetListenBeforeTalkDeadline(OOKSenderRef sender);
+
+/**
+Listen-before-talk counters:
+- busy: the number of times the channel was sensed busy before a burst
+- backoff: the number of times the sender backed off (waited)
+- backoff time: the total time spent backing off, in microseconds
+- deadline expired: the number of bursts that were transmitted on a busy
+  channel because the deadline passed, i.e. probable collisions
+Safe to call from any thread, also while a message is being sent.
+*/
+uint32_t OOKSenderGetBusyCount(OOKSenderRef sender);
+uint32_t OOKSenderGetBackoffCount(OOKSenderRef sender);
+uint64_t OOKSenderGetBackoffTime(OOKSenderRef sender);
+uint32_t OOKSenderGetDeadlineExpiredCount(OOKSenderRef sender);
+
+/*
+Latencies of sending, in microseconds, recorded for every burst (a message and
+its repeats) that is sent:
+- start: from the call to send until the first pulse is written, i.e. the time
+  spent on listen-before-talk, if enabled
+- completion: from the call to send until the last repeat was written
+Query them at any time, from any thread. They are owned by the sender.
+*/
+LatencyHistogramRef OOKSenderGetStartLatencyHistogram(OOKSenderRef sender);
+LatencyHistogramRef OOKSenderGetCompletionLatencyHistogram(OOKSenderRef sender);
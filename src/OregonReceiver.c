@@ -0,0 +1,573 @@
+#include <stdio.h>
+#include <assert.h>
+#include "OregonReceiver.h"
+#include "Tracepoints.h"
+
+/*
+Manchester coding, as seen on the GPIO:
+        1         0         0         1
+    |‾‾‾‾|    |    |‾‾‾‾|    |‾‾‾‾‾‾‾‾‾|    |
+    |    |____|____|    |____|         |____|
+         ^         ^         ^         ^
+The transition in the middle of a bit (^) is the bit: carrier off for a one,
+on for a zero. Between two equal bits there is one more transition, at the
+bit boundary. A pulse or gap is therefore either half a bit long, and ends at
+a boundary after a transition in the middle or the other way around, or a
+whole bit, and ends in the middle of a bit, as the previous one did. Which of
+the two conventions a sensor uses does not matter: the sync is accepted
+inverted too, and then all bits are inverted.
+*/
+
+// the clock may drift this far (%) from the half-bit duration
+#define OregonClockDrift 30
+
+// version 3: 12 ones of the preamble and the sync nibble 0xA, least
+// significant bit first, in the order they were received
+#define OregonV3SyncBitCount 16
+#define OregonV3Sync 0xFFF5
+
+// version 2.1: 8 ones of the preamble and the sync nibble, every bit sent
+// inverted and then as it is
+#define OregonV21SyncBitCount 24
+#define OregonV21Sync 0x555599
+
+// the longest message, in nibbles
+#define OregonMaxNibbleCount 17
+
+// a message equal to the previous one within this time (µs) is a repeat
+#define OregonRepeatPeriod 1000000
+
+typedef struct OregonSensorDescription
+{
+    uint16_t identifier; // the first 4 nibbles, in the order they are sent
+    const char * name;
+    uint8_t version;     // 2 (2.1) or 3
+    uint8_t nibbleCount; // including the 2 nibbles of the checksum
+    bool hasHumidity;
+} OregonSensorDescription;
+
+// indexed by OregonSensor
+static const OregonSensorDescription OregonSensorDescriptions[OregonSensorCount] =
+{
+    { 0x1D20, "THGR122N", 2, 17, true },
+    { 0x1A2D, "THGR228N", 2, 17, true },
+    { 0xEC40, "THN132N", 2, 14, false },
+    { 0xF824, "THGR810", 3, 17, true },
+    { 0xC844, "THN802", 3, 14, false }
+};
+
+typedef enum OregonState
+{
+    OregonStateSearching = 0, // for the preamble and the sync
+    OregonStateData = 1       // collecting the nibbles of the message
+} OregonState;
+
+struct OregonMessage
+{
+    OregonSensor sensor;
+    uint8_t channel;
+    uint8_t rollingCode;
+    bool batteryLow;
+    int16_t temperature; // tenths of °C
+    uint8_t humidity;
+    uint32_t code;
+    uint8_t quality; // 0 - 100
+    uint32_t startTimestamp;
+    uint32_t endTimestamp;
+};
+
+struct OregonReceiver
+{
+    OregonMessageDetected callback;
+    void * context;
+
+    uint32_t halfBitDuration; // µs
+    uint32_t minimumClock;
+    uint32_t maximumClock;
+    bool inverted;
+
+    // clock recovery: the current half-bit duration, and whether the last
+    // edge was in the middle of a bit
+    uint32_t clock;
+    bool atMidBit;
+    int32_t lastLevel; // -1 before the first edge
+    uint32_t lastTimestamp;
+    uint32_t runStartTimestamp; // of the first pulse since the last invalid one
+
+    OregonState state;
+    uint32_t recentBits;   // as received, the last one in the lowest bit
+    uint32_t runBitCount;  // bits in `recentBits` since the last reset
+    uint8_t version;       // of the frame being received
+    bool invertedBits;     // the sync matched inverted
+    bool pairFirstBit;     // version 2.1: the inverted copy of the next bit
+    bool hasPairFirstBit;
+    uint32_t dataBitCount;
+    uint8_t nibbles[OregonMaxNibbleCount];
+    int32_t sensor;        // -1 until the 4 nibbles of the sensor type arrived
+    uint32_t deviation;    // sum of the deviations from the clock, µs
+    uint32_t nominalDuration;
+
+    uint32_t previousCode;
+    uint32_t previousCodeTimestamp;
+    bool hasPreviousCode;
+
+    _Atomic uint32_t polarityErrorCount;
+    struct ReceiverCounters counters;
+};
+
+OregonSensor OregonMessageGetSensor(OregonMessageRef message)
+{
+    assert(NULL != message);
+    return message->sensor;
+}
+
+const char * OregonMessageGetSensorName(OregonMessageRef message)
+{
+    assert(NULL != message);
+    return OregonSensorDescriptions[message->sensor].name;
+}
+
+uint8_t OregonMessageGetChannel(OregonMessageRef message)
+{
+    assert(NULL != message);
+    return message->channel;
+}
+
+uint8_t OregonMessageGetRollingCode(OregonMessageRef message)
+{
+    assert(NULL != message);
+    return message->rollingCode;
+}
+
+bool OregonMessageGetBatteryLow(OregonMessageRef message)
+{
+    assert(NULL != message);
+    return message->batteryLow;
+}
+
+int16_t OregonMessageGetTemperature(OregonMessageRef message)
+{
+    assert(NULL != message);
+    return message->temperature;
+}
+
+bool OregonMessageHasHumidity(OregonMessageRef message)
+{
+    assert(NULL != message);
+    return OregonSensorDescriptions[message->sensor].hasHumidity;
+}
+
+uint8_t OregonMessageGetHumidity(OregonMessageRef message)
+{
+    assert(NULL != message);
+    return message->humidity;
+}
+
+uint32_t OregonMessageGetCode(OregonMessageRef message)
+{
+    assert(NULL != message);
+    return message->code;
+}
+
+uint8_t OregonMessageGetQuality(OregonMessageRef message)
+{
+    assert(NULL != message);
+    return message->quality;
+}
+
+uint32_t OregonMessageGetStartTimestamp(OregonMessageRef message)
+{
+    assert(NULL != message);
+    return message->startTimestamp;
+}
+
+uint32_t OregonMessageGetEndTimestamp(OregonMessageRef message)
+{
+    assert(NULL != message);
+    return message->endTimestamp;
+}
+
+int OregonMessageFormat(OregonMessageRef message, char * buffer, size_t size)
+{
+    assert(NULL != message);
+    assert(NULL != buffer);
+
+    int32_t temperature = message->temperature;
+    char humidity[32] = "";
+    if (OregonMessageHasHumidity(message))
+    { snprintf(humidity, sizeof(humidity), ", humidity %u", message->humidity); }
+
+    return snprintf(buffer, size, "Oregon %s [channel %u, rolling code %u, temperature %s%i.%i%s, battery %s]",
+                    OregonSensorDescriptions[message->sensor].name,
+                    message->channel,
+                    message->rollingCode,
+                    (temperature < 0) ? "-" : "",
+                    abs(temperature) / 10,
+                    abs(temperature) % 10,
+                    humidity,
+                    message->batteryLow ? "low" : "ok");
+}
+
+void OregonMessageRelease(OregonMessageRef message)
+{
+    free(message);
+}
+
+void OregonReceiverUpdateDurations(OregonReceiverRef receiver)
+{
+    receiver->minimumClock = receiver->halfBitDuration * (100 - OregonClockDrift) / 100;
+    receiver->maximumClock = receiver->halfBitDuration * (100 + OregonClockDrift) / 100;
+    receiver->clock = receiver->halfBitDuration;
+}
+
+// waits for the next preamble, with the clock at its nominal duration
+void OregonReceiverResetRun(OregonReceiverRef receiver, uint32_t timestamp)
+{
+    receiver->state = OregonStateSearching;
+    receiver->recentBits = 0;
+    receiver->runBitCount = 0;
+    receiver->clock = receiver->halfBitDuration;
+    receiver->atMidBit = true;
+    receiver->runStartTimestamp = timestamp;
+}
+
+OregonReceiverRef OregonReceiverCreate()
+{
+    OregonReceiverRef newReceiver = malloc(sizeof(struct OregonReceiver));
+    if (NULL != newReceiver)
+    {
+        newReceiver->callback = NULL;
+        newReceiver->context = NULL;
+        newReceiver->halfBitDuration = 488;
+        newReceiver->inverted = false;
+        OregonReceiverUpdateDurations(newReceiver);
+
+        newReceiver->lastLevel = -1;
+        newReceiver->lastTimestamp = 0;
+        newReceiver->version = 0;
+        newReceiver->invertedBits = false;
+        newReceiver->hasPairFirstBit = false;
+        newReceiver->pairFirstBit = false;
+        newReceiver->dataBitCount = 0;
+        newReceiver->sensor = -1;
+        newReceiver->deviation = 0;
+        newReceiver->nominalDuration = 0;
+        OregonReceiverResetRun(newReceiver, 0);
+
+        newReceiver->previousCode = 0;
+        newReceiver->previousCodeTimestamp = 0;
+        newReceiver->hasPreviousCode = false;
+
+        atomic_init(&newReceiver->polarityErrorCount, 0);
+        ReceiverCountersReset(&newReceiver->counters);
+    }
+    return newReceiver;
+}
+
+void OregonReceiverRelease(OregonReceiverRef receiver)
+{
+    free(receiver);
+}
+
+// counts and traces a frame that was rejected, and waits for the next one
+void OregonReceiverReject(OregonReceiverRef receiver, ReceiverRejectReason reason, uint32_t timestamp)
+{
+    ReceiverCountersIncrement(receiver->counters.frameCount);
+    ReceiverCountersCountReject(&receiver->counters, reason, receiver->dataBitCount);
+    LPD433Trace3(oregon_frame_reject, receiver, reason, receiver->dataBitCount);
+    OregonReceiverResetRun(receiver, timestamp);
+}
+
+// the last nibble of a message arrived: checks it, and passes it on
+void OregonReceiverFinishFrame(OregonReceiverRef receiver, uint32_t timestamp)
+{
+    const OregonSensorDescription * description = &OregonSensorDescriptions[receiver->sensor];
+    const uint8_t * nibbles = receiver->nibbles;
+    ReceiverCountersIncrement(receiver->counters.endSyncCount);
+
+    uint32_t checksumIndex = description->nibbleCount - 2;
+    uint32_t sum = 0;
+    for (uint32_t index = 0; index < checksumIndex; index++) { sum += nibbles[index]; }
+    bool isValid = ((sum & 0xFF) == (uint32_t) (nibbles[checksumIndex] | (nibbles[checksumIndex + 1] << 4)));
+
+    // the readings are decimal digits, the last one first
+    for (uint32_t index = 8; index < 11; index++) { isValid = isValid && nibbles[index] <= 9; }
+    if (description->hasHumidity) { isValid = isValid && nibbles[12] <= 9 && nibbles[13] <= 9; }
+
+    // version 2.1 sends the channel as one bit: 1, 2 or 4
+    uint8_t channel = nibbles[4];
+    if (2 == description->version)
+    {
+        isValid = isValid && (1 == channel || 2 == channel || 4 == channel);
+        if (4 == channel) { channel = 3; }
+    }
+    if (!isValid)
+    {
+        OregonReceiverReject(receiver, ReceiverRejectReasonChecksum, timestamp);
+        return;
+    }
+
+    uint32_t startTimestamp = receiver->runStartTimestamp;
+    uint32_t averageDeviation = receiver->deviation * 200 / receiver->nominalDuration;
+    uint8_t quality = (uint8_t) (averageDeviation >= 100 ? 0 : 100 - averageDeviation);
+
+    // FNV-1a
+    uint32_t code = 2166136261u;
+    for (uint32_t index = 0; index < description->nibbleCount; index++) { code = (code ^ nibbles[index]) * 16777619u; }
+
+    ReceiverCountersIncrement(receiver->counters.frameCount);
+    ReceiverCountersIncrement(receiver->counters.acceptedCount);
+    LPD433Trace3(oregon_frame_accept, receiver, code, quality);
+    OregonReceiverResetRun(receiver, timestamp);
+
+    bool isRepeat = receiver->hasPreviousCode && code == receiver->previousCode &&
+                    timestamp - receiver->previousCodeTimestamp < OregonRepeatPeriod;
+    receiver->previousCode = code;
+    receiver->previousCodeTimestamp = timestamp;
+    receiver->hasPreviousCode = true;
+    if (isRepeat)
+    {
+        ReceiverCountersIncrement(receiver->counters.repeatCount);
+        return;
+    }
+    if (NULL == receiver->callback) { return; }
+
+    OregonMessageRef message = malloc(sizeof(struct OregonMessage));
+    if (NULL == message) { return; }
+    message->sensor = (OregonSensor) receiver->sensor;
+    message->channel = channel;
+    message->rollingCode = (uint8_t) ((nibbles[5] << 4) | nibbles[6]);
+    message->batteryLow = (0 != (nibbles[7] & 0x4));
+    message->temperature = (int16_t) (nibbles[10] * 100 + nibbles[9] * 10 + nibbles[8]);
+    if (0 != nibbles[11]) { message->temperature = -message->temperature; }
+    message->humidity = description->hasHumidity ? (uint8_t) (nibbles[13] * 10 + nibbles[12]) : 0;
+    message->code = code;
+    message->quality = quality;
+    message->startTimestamp = startTimestamp;
+    message->endTimestamp = timestamp;
+
+    // the callback owns the message
+    ReceiverCountersIncrement(receiver->counters.callbackCount);
+    receiver->callback(receiver, message);
+}
+
+// a bit of the message, after the sync
+void OregonReceiverAddDataBit(OregonReceiverRef receiver, uint32_t bit, uint32_t timestamp)
+{
+    uint32_t nibbleIndex = receiver->dataBitCount / 4;
+    uint32_t bitIndex = receiver->dataBitCount % 4;
+    if (0 == bitIndex) { receiver->nibbles[nibbleIndex] = 0; }
+    receiver->nibbles[nibbleIndex] |= (uint8_t) (bit << bitIndex);
+    receiver->dataBitCount += 1;
+    if (3 != bitIndex) { return; }
+
+    if (3 == nibbleIndex)
+    {
+        const uint8_t * nibbles = receiver->nibbles;
+        uint16_t identifier = (uint16_t) ((nibbles[0] << 12) | (nibbles[1] << 8) | (nibbles[2] << 4) | nibbles[3]);
+        for (int32_t sensor = 0; sensor < OregonSensorCount; sensor++)
+        {
+            if (OregonSensorDescriptions[sensor].identifier == identifier &&
+                OregonSensorDescriptions[sensor].version == receiver->version)
+            { receiver->sensor = sensor; }
+        }
+        // a sensor of another type: its checksum can not be found
+        if (receiver->sensor < 0) { OregonReceiverReject(receiver, ReceiverRejectReasonChecksum, timestamp); }
+    }
+    else if (receiver->sensor >= 0 && nibbleIndex + 1 == OregonSensorDescriptions[receiver->sensor].nibbleCount)
+    { OregonReceiverFinishFrame(receiver, timestamp); }
+}
+
+// a bit that was decoded from a transition in the middle of a bit period
+void OregonReceiverAddBit(OregonReceiverRef receiver, uint32_t bit, uint32_t timestamp)
+{
+    if (OregonStateSearching == receiver->state)
+    {
+        receiver->recentBits = (receiver->recentBits << 1) | bit;
+        receiver->runBitCount += 1;
+
+        uint32_t v3Bits = receiver->recentBits & ((1u << OregonV3SyncBitCount) - 1);
+        uint32_t v21Bits = receiver->recentBits & ((1u << OregonV21SyncBitCount) - 1);
+        uint32_t v3Inverted = ~OregonV3Sync & ((1u << OregonV3SyncBitCount) - 1);
+        uint32_t v21Inverted = ~OregonV21Sync & ((1u << OregonV21SyncBitCount) - 1);
+        if (receiver->runBitCount >= OregonV3SyncBitCount && (OregonV3Sync == v3Bits || v3Inverted == v3Bits))
+        {
+            receiver->version = 3;
+            receiver->invertedBits = (v3Inverted == v3Bits);
+        }
+        else if (receiver->runBitCount >= OregonV21SyncBitCount && (OregonV21Sync == v21Bits || v21Inverted == v21Bits))
+        {
+            receiver->version = 2;
+            receiver->invertedBits = (v21Inverted == v21Bits);
+        }
+        else { return; }
+
+        receiver->state = OregonStateData;
+        receiver->dataBitCount = 0;
+        receiver->hasPairFirstBit = false;
+        receiver->sensor = -1;
+        receiver->deviation = 0;
+        receiver->nominalDuration = 0;
+        ReceiverCountersIncrement(receiver->counters.startSyncCount);
+        LPD433Trace3(oregon_sync, receiver, timestamp, receiver->version);
+        return;
+    }
+
+    // version 2.1: the inverted copy first
+    if (2 == receiver->version && !receiver->hasPairFirstBit)
+    {
+        receiver->pairFirstBit = (0 != bit);
+        receiver->hasPairFirstBit = true;
+        return;
+    }
+    if (2 == receiver->version)
+    {
+        receiver->hasPairFirstBit = false;
+        if (receiver->pairFirstBit == (0 != bit))
+        {
+            OregonReceiverReject(receiver, ReceiverRejectReasonBitEncoding, timestamp);
+            return;
+        }
+    }
+    OregonReceiverAddDataBit(receiver, bit ^ (receiver->invertedBits ? 1 : 0), timestamp);
+}
+
+void OregonReceiverFeedGPIOLevelChange(OregonReceiverRef receiver, uint32_t timestamp, uint32_t level)
+{
+    assert(NULL != receiver);
+    ReceiverCountersIncrement(receiver->counters.edgeCount);
+
+    int32_t newLevel = ((0 != level) != receiver->inverted) ? 1 : 0;
+    uint32_t duration = timestamp - receiver->lastTimestamp;
+    int32_t lastLevel = receiver->lastLevel;
+    receiver->lastLevel = newLevel;
+    receiver->lastTimestamp = timestamp;
+    if (lastLevel < 0)
+    {
+        OregonReceiverResetRun(receiver, timestamp);
+        return;
+    }
+    if (newLevel == lastLevel)
+    {
+        // an edge in between was missed
+        if (OregonStateData == receiver->state)
+        {
+            ReceiverCountersIncrement(receiver->polarityErrorCount);
+            OregonReceiverReject(receiver, ReceiverRejectReasonPolarity, timestamp);
+        }
+        OregonReceiverResetRun(receiver, timestamp);
+        return;
+    }
+
+    uint32_t clock = receiver->clock;
+    uint32_t nominalDuration;
+    uint32_t measuredClock;
+    bool isMidBit;
+    if (duration >= clock / 2 && duration < clock * 3 / 2)
+    {
+        // half a bit: from the middle to a boundary, or the other way around
+        nominalDuration = clock;
+        measuredClock = duration;
+        isMidBit = !receiver->atMidBit;
+    }
+    else if (duration >= clock * 3 / 2 && duration < clock * 5 / 2)
+    {
+        // a whole bit: from the middle of one to the middle of the next
+        nominalDuration = 2 * clock;
+        measuredClock = duration / 2;
+        isMidBit = true;
+        if (!receiver->atMidBit)
+        {
+            if (OregonStateData == receiver->state)
+            {
+                OregonReceiverReject(receiver, ReceiverRejectReasonBitEncoding, timestamp);
+                return;
+            }
+            // the bits of the preamble were taken from the boundaries: they
+            // were all inverted
+            receiver->recentBits = ~receiver->recentBits;
+        }
+    }
+    else
+    {
+        // the end of a frame, or noise
+        if (OregonStateData == receiver->state)
+        { OregonReceiverReject(receiver, ReceiverRejectReasonBitEncoding, timestamp); }
+        OregonReceiverResetRun(receiver, timestamp);
+        return;
+    }
+
+    // clock recovery: follow the measured durations, an eighth at a time
+    int32_t newClock = (int32_t) clock + ((int32_t) measuredClock - (int32_t) clock) / 8;
+    if (newClock < (int32_t) receiver->minimumClock) { newClock = (int32_t) receiver->minimumClock; }
+    if (newClock > (int32_t) receiver->maximumClock) { newClock = (int32_t) receiver->maximumClock; }
+    receiver->clock = (uint32_t) newClock;
+    receiver->deviation += (duration > nominalDuration) ? duration - nominalDuration : nominalDuration - duration;
+    receiver->nominalDuration += nominalDuration;
+
+    receiver->atMidBit = isMidBit;
+    if (isMidBit) { OregonReceiverAddBit(receiver, (0 == newLevel) ? 1 : 0, timestamp); }
+}
+
+void OregonReceiverFeedTimeout(OregonReceiverRef receiver, uint32_t timestamp)
+{
+    assert(NULL != receiver);
+    if (OregonStateData == receiver->state)
+    { OregonReceiverReject(receiver, ReceiverRejectReasonBitEncoding, timestamp); }
+}
+
+void OregonReceiverSetCallback(OregonReceiverRef receiver, OregonMessageDetected callback)
+{
+    assert(NULL != receiver);
+    receiver->callback = callback;
+}
+
+void OregonReceiverSetContext(OregonReceiverRef receiver, void * context)
+{
+    assert(NULL != receiver);
+    receiver->context = context;
+}
+
+void * OregonReceiverGetContext(OregonReceiverRef receiver)
+{
+    assert(NULL != receiver);
+    return receiver->context;
+}
+
+void OregonReceiverSetHalfBitDuration(OregonReceiverRef receiver, uint32_t duration)
+{
+    assert(NULL != receiver);
+    receiver->halfBitDuration = duration;
+    OregonReceiverUpdateDurations(receiver);
+}
+
+uint32_t OregonReceiverGetHalfBitDuration(OregonReceiverRef receiver)
+{
+    assert(NULL != receiver);
+    return receiver->halfBitDuration;
+}
+
+void OregonReceiverSetInverted(OregonReceiverRef receiver, bool inverted)
+{
+    assert(NULL != receiver);
+    receiver->inverted = inverted;
+    receiver->lastLevel = -1;
+}
+
+bool OregonReceiverGetInverted(OregonReceiverRef receiver)
+{
+    assert(NULL != receiver);
+    return receiver->inverted;
+}
+
+uint32_t OregonReceiverGetPolarityErrorCount(OregonReceiverRef receiver)
+{
+    assert(NULL != receiver);
+    return atomic_load_explicit(&receiver->polarityErrorCount, memory_order_relaxed);
+}
+
+void OregonReceiverGetStatistics(OregonReceiverRef receiver, ReceiverStatistics * statistics)
+{
+    assert(NULL != receiver);
+    ReceiverCountersGetStatistics(&receiver->counters, statistics);
+}
@@ -0,0 +1,157 @@
+#ifndef OregonReceiver_h
+#define OregonReceiver_h
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include "ReceiverStatistics.h"
+
+/*
+An OregonReceiver decodes the temperature and humidity sensors of Oregon
+Scientific, protocol versions 2.1 and 3. Unlike COCO and KFS, these are
+Manchester coded: every bit is a transition of the carrier in the middle of a
+bit period of 1/1024 s, so the pulses and gaps are either a half or a whole
+period long. The receiver recovers the clock from the edges as they are fed,
+one edge at a time, at about the cost of a COCOReceiver: there is no buffer
+of durations to analyse afterwards.
+
+A frame is a preamble, the sync nibble 0xA and the nibbles of the message,
+least significant bit first; version 2.1 sends every bit twice, inverted
+first. The message is the sensor type (4 nibbles), the channel, the rolling
+code that the sensor picks when its batteries are inserted (2 nibbles), the
+flags (the battery), the readings, and a checksum: the sum of all nibbles
+before it. Only the sensor types this receiver knows are reported, once
+their checksum matched, as soon as their last nibble arrived.
+*/
+
+// An opaque type on which to operate
+typedef struct OregonReceiver  *OregonReceiverRef;
+typedef struct OregonMessage   *OregonMessageRef;
+
+// You are responsible for releasing the OregonMessageRef using
+// OregonMessageRelease().
+typedef void (*OregonMessageDetected)(OregonReceiverRef, OregonMessageRef);
+
+// the sensor types that are decoded
+typedef enum OregonSensor
+{
+    OregonSensorTHGR122N = 0, // temperature and humidity, version 2.1
+    OregonSensorTHGR228N = 1, // temperature and humidity, version 2.1
+    OregonSensorTHN132N = 2,  // temperature, version 2.1
+    OregonSensorTHGR810 = 3,  // temperature and humidity, version 3
+    OregonSensorTHN802 = 4,   // temperature, version 3
+    OregonSensorCount = 5
+} OregonSensor;
+
+// querying an OregonMessageRef
+OregonSensor OregonMessageGetSensor(OregonMessageRef message);
+const char * OregonMessageGetSensorName(OregonMessageRef message);
+uint8_t OregonMessageGetChannel(OregonMessageRef message);   // 1 - 15
+uint8_t OregonMessageGetRollingCode(OregonMessageRef message);
+bool OregonMessageGetBatteryLow(OregonMessageRef message);
+
+// in tenths of a degree Celsius, e.g. -51 is -5.1 °C
+int16_t OregonMessageGetTemperature(OregonMessageRef message);
+
+// in percent; only if OregonMessageHasHumidity()
+bool OregonMessageHasHumidity(OregonMessageRef message);
+uint8_t OregonMessageGetHumidity(OregonMessageRef message);
+
+/*
+A hash of all nibbles of the message. Two messages with the same code are the
+same message, e.g. the copies received on several PINs.
+*/
+uint32_t OregonMessageGetCode(OregonMessageRef message);
+
+/*
+An estimate of how well the received pulses matched the recovered clock, from
+0 (at the edge of the tolerances) to 100 (perfect timing).
+*/
+uint8_t OregonMessageGetQuality(OregonMessageRef message);
+
+/*
+The timestamps (in the time base of the timestamps fed to the receiver) of the
+first edge of the preamble and of the last edge of the message.
+*/
+uint32_t OregonMessageGetStartTimestamp(OregonMessageRef message);
+uint32_t OregonMessageGetEndTimestamp(OregonMessageRef message);
+
+/*
+Writes the message as text, e.g. `Oregon THGR122N [channel 1, rolling code
+187, temperature 21.4, humidity 45, battery ok]`. Returns what snprintf()
+returns.
+*/
+int OregonMessageFormat(OregonMessageRef message, char * buffer, size_t size);
+
+/*
+Releases an OregonMessageRef. This function is safe to call when `message` is
+NULL.
+*/
+void OregonMessageRelease(OregonMessageRef message);
+
+/*
+Creates a new OregonReceiver, or NULL if a receiver could not be created. You
+are responsible for releasing this object using OregonReceiverRelease().
+*/
+OregonReceiverRef OregonReceiverCreate();
+
+/*
+Releases an OregonReceiverRef. This function is safe to call when `receiver`
+is NULL.
+*/
+void OregonReceiverRelease(OregonReceiverRef receiver);
+
+void OregonReceiverSetCallback(OregonReceiverRef receiver, OregonMessageDetected callback);
+
+/*
+Defaults to NULL. A pointer that is not used by the receiver, so that your
+callback can tell receivers apart (e.g. when listening on several GPIOs).
+*/
+void OregonReceiverSetContext(OregonReceiverRef receiver, void * context);
+void * OregonReceiverGetContext(OregonReceiverRef receiver);
+
+/*
+Every time the GPIO that you are monitoring changes state, call this function
+with the timestamp of the change (µs) and the `level` (0 or 1) after it, e.g.
+from the alert function of PIGPIO.
+*/
+void OregonReceiverFeedGPIOLevelChange(OregonReceiverRef receiver, uint32_t timestamp, uint32_t level);
+
+/*
+Call this when the GPIO did not change state since the last edge until
+`timestamp`, e.g. from the timeout of a PIGPIO ISR or watchdog: a frame that
+stopped before its last nibble is dropped (and counted) right away, instead
+of when the next edge arrives.
+*/
+void OregonReceiverFeedTimeout(OregonReceiverRef receiver, uint32_t timestamp);
+
+/*
+Defaults to 488, half a bit period at 1024 bits per second, in µs. The clock
+that is recovered from the edges starts at this duration for every frame, and
+may drift 30% from it.
+*/
+void OregonReceiverSetHalfBitDuration(OregonReceiverRef receiver, uint32_t duration);
+uint32_t OregonReceiverGetHalfBitDuration(OregonReceiverRef receiver);
+
+/*
+Defaults to false. Set this to true for a receiver module whose output is low
+while it receives a carrier, and high otherwise.
+*/
+void OregonReceiverSetInverted(OregonReceiverRef receiver, bool inverted);
+bool OregonReceiverGetInverted(OregonReceiverRef receiver);
+
+/*
+The number of times a frame that was being received was dropped, because an
+edge was missed. Safe to call from any thread.
+*/
+uint32_t OregonReceiverGetPolarityErrorCount(OregonReceiverRef receiver);
+
+/*
+Copies the counters of what this receiver did with the edges it was fed (see
+ReceiverStatistics.h) into `statistics`. Messages that equal the previous one
+within a second (version 2.1 sends each message twice) are counted as repeats,
+and not passed on. Safe to call from any thread, at any time.
+*/
+void OregonReceiverGetStatistics(OregonReceiverRef receiver, ReceiverStatistics * statistics);
+
+#endif
@@ -0,0 +1,97 @@
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h> // usleep()
+#include "PIGPIOBackend.h"
+
+#if LPD433PIGPIO
+
+#include <pigpio.h> // install this library by running: `sudo apt-get install pigpio`
+
+int PIGPIOBackendInitialise(GPIOBackendRef backend)
+{
+    return (gpioInitialise() == PI_INIT_FAILED) ? -1 : 0;
+}
+
+void PIGPIOBackendTerminate(GPIOBackendRef backend)
+{
+    gpioTerminate();
+}
+
+int PIGPIOBackendSetOutput(GPIOBackendRef backend, uint32_t gpio)
+{
+    return gpioSetMode(gpio, PI_OUTPUT);
+}
+
+int PIGPIOBackendWrite(GPIOBackendRef backend, uint32_t gpio, uint32_t level)
+{
+    return gpioWrite(gpio, level);
+}
+
+int PIGPIOBackendSetEdgeFunction(GPIOBackendRef backend, uint32_t gpio, GPIOBackendEdgeFunction function, void * userdata)
+{
+    if (NULL != function)
+    {
+        int result = gpioSetMode(gpio, PI_INPUT);
+        if (result < 0) { return result; }
+    }
+    return gpioSetAlertFuncEx(gpio, function, userdata);
+}
+
+int PIGPIOBackendSetTimerFunction(GPIOBackendRef backend, uint32_t timer, uint32_t millis, GPIOBackendTimerFunction function, void * userdata)
+{
+    return gpioSetTimerFuncEx(timer, millis, function, userdata);
+}
+
+uint32_t PIGPIOBackendTick(GPIOBackendRef backend)
+{
+    return gpioTick();
+}
+
+uint64_t PIGPIOBackendTime(GPIOBackendRef backend)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000 + (uint64_t) now.tv_nsec / 1000;
+}
+
+void PIGPIOBackendWaitUntil(GPIOBackendRef backend, uint64_t time)
+{
+    // busywait is more accurate than some form of sleep()
+    while (PIGPIOBackendTime(backend) < time) { ; }
+}
+
+void PIGPIOBackendSleep(GPIOBackendRef backend, uint32_t duration)
+{
+    usleep(duration);
+}
+
+struct GPIOBackend PIGPIOBackend =
+{
+    .name = "pigpio",
+    .state = NULL,
+    .initialise = PIGPIOBackendInitialise,
+    .terminate = PIGPIOBackendTerminate,
+    .release = NULL, // static, nothing to release
+    .setOutput = PIGPIOBackendSetOutput,
+    .write = PIGPIOBackendWrite,
+    .setEdgeFunction = PIGPIOBackendSetEdgeFunction,
+    .setTimerFunction = PIGPIOBackendSetTimerFunction,
+    .tick = PIGPIOBackendTick,
+    .time = PIGPIOBackendTime,
+    .waitUntil = PIGPIOBackendWaitUntil,
+    .sleep = PIGPIOBackendSleep
+};
+
+GPIOBackendRef PIGPIOBackendGet()
+{
+    return &PIGPIOBackend;
+}
+
+#else
+
+GPIOBackendRef PIGPIOBackendGet()
+{
+    return NULL;
+}
+
+#endif
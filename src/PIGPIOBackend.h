@@ -0,0 +1,13 @@
+#ifndef PIGPIOBackend_h
+#define PIGPIOBackend_h
+
+#include "GPIOBackend.h"
+
+/*
+The GPIOBackend that uses the PIGPIO library, i.e. the real GPIO pins of the
+Raspberry Pi. There is only one, do not release it. Returns NULL when built
+with LPD433PIGPIO set to 0.
+*/
+GPIOBackendRef PIGPIOBackendGet();
+
+#endif
@@ -0,0 +1,295 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include "ProtocolDescriptor.h"
+
+// see the diagram in COCOReceiver.c
+const ProtocolDescriptor ProtocolDescriptorCOCO =
+{
+    .name = "COCO",
+    .singlePulseDuration = 260,
+    .positiveTolerance = 40,
+    .negativeTolerance = 40,
+    .repeatCount = 1,
+    .refractoryPeriod = 0,
+    .transmitRepeatCount = 15,
+
+    .startSyncHigh = 1,
+    .startSyncLow = 10,
+    .endHigh = 1,
+    .endSyncLow = 40,
+
+    .minBitCount = 32,
+    .maxBitCount = 32,
+    .flags = 0,
+
+    .symbolCount = 2,
+    .symbols =
+    {
+        { .pulseCount = 4, .pulses = { 1, 1, 1, 4 }, .bitCount = 1, .value = 0 },
+        { .pulseCount = 4, .pulses = { 1, 4, 1, 1 }, .bitCount = 1, .value = 1 }
+    },
+
+    // 26-bit address | 1-bit group | 1-bit on/off | 4-bit channel
+    .fieldCount = 4,
+    .fields =
+    {
+        { .name = "address", .shift = 6, .width = 26 },
+        { .name = "onOff", .shift = 4, .width = 1 },
+        { .name = "group", .shift = 5, .width = 1 },
+        { .name = "channel", .shift = 0, .width = 4 }
+    }
+};
+
+// see the diagram in KeyFobSwitchReceiver.c
+const ProtocolDescriptor ProtocolDescriptorKFS =
+{
+    .name = "KFS",
+    .singlePulseDuration = 350,
+    .positiveTolerance = 20,
+    .negativeTolerance = 20,
+    .repeatCount = 2,
+    .refractoryPeriod = 0,
+    .transmitRepeatCount = 6,
+
+    .startSyncHigh = 1,
+    .startSyncLow = 31,
+    .endHigh = 1,
+    .endSyncLow = 0,
+
+    .minBitCount = 5,
+    .maxBitCount = 24,
+    .flags = ProtocolFlagRejectZeroCode,
+
+    .symbolCount = 2,
+    .symbols =
+    {
+        { .pulseCount = 2, .pulses = { 1, 3 }, .bitCount = 1, .value = 0 },
+        { .pulseCount = 2, .pulses = { 3, 1 }, .bitCount = 1, .value = 1 }
+    },
+
+    .fieldCount = 1,
+    .fields =
+    {
+        { .name = "identifier", .shift = 0, .width = 24 }
+    }
+};
+
+// rc-switch's protocol 1 timing, which most of these chips are set up for
+const ProtocolDescriptor ProtocolDescriptorEV1527 =
+{
+    .name = "EV1527",
+    .singlePulseDuration = 350,
+    .positiveTolerance = 30,
+    .negativeTolerance = 30,
+    .repeatCount = 1,
+    .refractoryPeriod = 0,
+    .transmitRepeatCount = 8,
+
+    .startSyncHigh = 1,
+    .startSyncLow = 31,
+    .endHigh = 1,
+    .endSyncLow = 0,
+
+    .minBitCount = 24,
+    .maxBitCount = 24,
+    .flags = ProtocolFlagRejectZeroCode,
+
+    .symbolCount = 2,
+    .symbols =
+    {
+        { .pulseCount = 2, .pulses = { 1, 3 }, .bitCount = 1, .value = 0 },
+        { .pulseCount = 2, .pulses = { 3, 1 }, .bitCount = 1, .value = 1 }
+    },
+
+    // 20-bit id | 4 data bits (the buttons, or the sensor's state)
+    .fieldCount = 2,
+    .fields =
+    {
+        { .name = "id", .shift = 4, .width = 20 },
+        { .name = "data", .shift = 0, .width = 4 }
+    }
+};
+
+const ProtocolDescriptor ProtocolDescriptorPT2262 =
+{
+    .name = "PT2262",
+    .singlePulseDuration = 350,
+    .positiveTolerance = 30,
+    .negativeTolerance = 30,
+    .repeatCount = 1,
+    .refractoryPeriod = 0,
+    .transmitRepeatCount = 8,
+
+    .startSyncHigh = 1,
+    .startSyncLow = 31,
+    .endHigh = 1,
+    .endSyncLow = 0,
+
+    .minBitCount = 24,
+    .maxBitCount = 24,
+    .flags = 0,
+
+    // a trit is two bits, 10 does not exist
+    .symbolCount = 3,
+    .symbols =
+    {
+        { .pulseCount = 4, .pulses = { 1, 3, 1, 3 }, .bitCount = 2, .value = 0 },
+        { .pulseCount = 4, .pulses = { 3, 1, 3, 1 }, .bitCount = 2, .value = 3 },
+        { .pulseCount = 4, .pulses = { 1, 3, 3, 1 }, .bitCount = 2, .value = 1 }
+    },
+
+    // 8 address pins | 4 data pins
+    .fieldCount = 2,
+    .fields =
+    {
+        { .name = "address", .shift = 8, .width = 16, .format = ProtocolFieldFormatTriState },
+        { .name = "data", .shift = 0, .width = 8, .format = ProtocolFieldFormatTriState }
+    }
+};
+
+const ProtocolDescriptor * ProtocolDescriptorFind(const char * name)
+{
+    assert(NULL != name);
+
+    static const ProtocolDescriptor * const descriptors[] =
+    {
+        &ProtocolDescriptorCOCO,
+        &ProtocolDescriptorKFS,
+        &ProtocolDescriptorEV1527,
+        &ProtocolDescriptorPT2262
+    };
+    for (uint32_t index = 0; index < sizeof(descriptors) / sizeof(descriptors[0]); index++)
+    {
+        if (!strcmp(descriptors[index]->name, name)) { return descriptors[index]; }
+    }
+    return NULL;
+}
+
+uint64_t ProtocolFieldGetValue(const ProtocolField * field, uint64_t code)
+{
+    uint64_t mask = (field->width >= 64) ? UINT64_MAX : (((uint64_t) 1 << field->width) - 1);
+    return (code >> field->shift) & mask;
+}
+
+bool ProtocolFrameGetField(const ProtocolFrame * frame, const char * name, uint64_t * value)
+{
+    assert(NULL != frame);
+    assert(NULL != name);
+    assert(NULL != value);
+
+    const ProtocolDescriptor * descriptor = frame->descriptor;
+    for (uint32_t index = 0; index < descriptor->fieldCount; index++)
+    {
+        if (!strcmp(descriptor->fields[index].name, name))
+        {
+            *value = ProtocolFieldGetValue(&descriptor->fields[index], frame->code);
+            return true;
+        }
+    }
+    return false;
+}
+
+const ProtocolField * ProtocolDescriptorGetField(const ProtocolDescriptor * descriptor, const char * name)
+{
+    for (uint32_t index = 0; index < descriptor->fieldCount; index++)
+    {
+        if (!strcmp(descriptor->fields[index].name, name)) { return &descriptor->fields[index]; }
+    }
+    return NULL;
+}
+
+bool ProtocolCodeSetField(const ProtocolDescriptor * descriptor, uint64_t * code, const char * name, uint64_t value)
+{
+    assert(NULL != descriptor);
+    assert(NULL != code);
+    assert(NULL != name);
+
+    const ProtocolField * field = ProtocolDescriptorGetField(descriptor, name);
+    if (NULL == field) { return false; }
+
+    uint64_t mask = (field->width >= 64) ? UINT64_MAX : (((uint64_t) 1 << field->width) - 1);
+    *code = (*code & ~(mask << field->shift)) | ((value & mask) << field->shift);
+    return true;
+}
+
+bool ProtocolCodeParseField(const ProtocolDescriptor * descriptor, uint64_t * code, const char * name, const char * text)
+{
+    assert(NULL != descriptor);
+    assert(NULL != code);
+    assert(NULL != name);
+    assert(NULL != text);
+
+    const ProtocolField * field = ProtocolDescriptorGetField(descriptor, name);
+    if (NULL == field || '\0' == text[0]) { return false; }
+
+    uint64_t value = 0;
+    if (ProtocolFieldFormatTriState == field->format)
+    {
+        if (strlen(text) != field->width / 2) { return false; }
+        for (const char * trit = text; '\0' != *trit; trit++)
+        {
+            value <<= 2;
+            if ('1' == *trit) { value |= 3; }
+            else if ('F' == *trit || 'f' == *trit) { value |= 1; }
+            else if ('0' != *trit) { return false; }
+        }
+    }
+    else
+    {
+        char * end = NULL;
+        value = strtoull(text, &end, 10);
+        if ('\0' != *end) { return false; }
+    }
+    return ProtocolCodeSetField(descriptor, code, name, value);
+}
+
+int ProtocolFieldFormatValue(const ProtocolField * field, uint64_t code, char * buffer, size_t size)
+{
+    uint64_t value = ProtocolFieldGetValue(field, code);
+    if (ProtocolFieldFormatTriState != field->format)
+    { return snprintf(buffer, size, "%llu", (unsigned long long) value); }
+
+    static const char trits[4] = { '0', 'F', '?', '1' };
+    char text[33];
+    uint32_t length = field->width / 2;
+    for (uint32_t index = 0; index < length; index++)
+    {
+        text[index] = trits[(value >> (2 * (length - 1 - index))) & 3];
+    }
+    text[length] = '\0';
+    return snprintf(buffer, size, "%s", text);
+}
+
+int ProtocolFrameFormat(const ProtocolFrame * frame, char * buffer, size_t size)
+{
+    assert(NULL != frame);
+    assert(NULL != buffer);
+
+    const ProtocolDescriptor * descriptor = frame->descriptor;
+    if (0 == descriptor->fieldCount)
+    {
+        return snprintf(buffer, size, "%s [code 0x%llx, bits %u]", descriptor->name,
+                        (unsigned long long) frame->code, frame->bitCount);
+    }
+
+    int length = snprintf(buffer, size, "%s [", descriptor->name);
+    for (uint32_t index = 0; index < descriptor->fieldCount && length >= 0; index++)
+    {
+        const ProtocolField * field = &descriptor->fields[index];
+        size_t used = ((size_t) length < size) ? (size_t) length : size;
+        int printed = snprintf(buffer + used, size - used, "%s%s ", (0 == index) ? "" : ", ", field->name);
+        length = (printed < 0) ? printed : length + printed;
+        if (length < 0) { break; }
+        used = ((size_t) length < size) ? (size_t) length : size;
+        printed = ProtocolFieldFormatValue(field, frame->code, buffer + used, size - used);
+        length = (printed < 0) ? printed : length + printed;
+    }
+    if (length >= 0)
+    {
+        size_t used = ((size_t) length < size) ? (size_t) length : size;
+        int printed = snprintf(buffer + used, size - used, "]");
+        length = (printed < 0) ? printed : length + printed;
+    }
+    return length;
+}
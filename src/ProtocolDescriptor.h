@@ -0,0 +1,157 @@
+#ifndef ProtocolDescriptor_h
+#define ProtocolDescriptor_h
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+
+/*
+A ProtocolDescriptor describes a pulse-width coded OOK protocol as data, like
+the diagrams at the top of COCOReceiver.c and KeyFobSwitchReceiver.c do, so
+that one ProtocolEngine (see ProtocolEngine.h) decodes any number of
+protocols, instead of one hand-written receiver per protocol.
+
+All durations are multiples of the single pulse duration T. A frame is:
+- the start-sync: a high pulse of `startSyncHigh` T, then a low pulse of
+  `startSyncLow` T. Only the low pulse is matched: it is what tells the
+  protocols apart, and wakes the decoder of the protocol.
+- symbols, each a fixed sequence of pulses of alternately high and low, that
+  starts high, and appends `bitCount` bits (`value`) to the code of the frame,
+  until there are `maxBitCount` bits.
+- a high pulse of `endHigh` T, then either the end-sync: a low pulse of
+  `endSyncLow` T, or, when `endSyncLow` is 0, the start-sync of the next frame
+  (or a silence at least as long as one).
+For example, COCO:
+    start-sync  T 10t
+    '0'         T t T 4t
+    '1'         T 4t T t
+    end-sync    T 40t
+*/
+
+#define ProtocolMaxSymbolCount 4
+#define ProtocolMaxSymbolPulseCount 4
+#define ProtocolMaxFieldCount 8
+#define ProtocolMaxBitCount 64
+
+typedef struct ProtocolSymbol
+{
+    uint8_t pulseCount; // 2 or 4
+    uint8_t pulses[ProtocolMaxSymbolPulseCount]; // T, starting with a high pulse
+    uint8_t bitCount;   // the number of bits it appends to the code
+    uint8_t value;
+} ProtocolSymbol;
+
+// how the value of a field is written and parsed
+typedef enum ProtocolFieldFormat
+{
+    ProtocolFieldFormatDecimal = 0,
+    // a trit per 2 bits, first the highest: 00 is `0`, 11 is `1`, 01 is `F`
+    // (floating), as the address and data pins of a PT2262 are set
+    ProtocolFieldFormatTriState = 1
+} ProtocolFieldFormat;
+
+// a part of the code: `width` bits, of which the lowest is `shift` bits from
+// the last bit received
+typedef struct ProtocolField
+{
+    const char * name;
+    uint8_t shift;
+    uint8_t width;
+    uint8_t format; // ProtocolFieldFormat
+} ProtocolField;
+
+// frames with an all-zero code are not valid
+#define ProtocolFlagRejectZeroCode 1
+
+typedef struct ProtocolDescriptor
+{
+    const char * name;
+
+    // the defaults, which can be changed per decoder
+    uint32_t singlePulseDuration; // µs
+    uint32_t positiveTolerance;   // percentage
+    uint32_t negativeTolerance;   // percentage
+    uint32_t repeatCount;
+    uint32_t refractoryPeriod;    // seconds
+    uint32_t transmitRepeatCount; // the number of times a sender repeats a frame
+
+    uint8_t startSyncHigh;
+    uint16_t startSyncLow;
+    uint8_t endHigh;
+    uint16_t endSyncLow; // 0: the next start-sync ends the frame
+
+    uint8_t minBitCount;
+    uint8_t maxBitCount;
+    uint32_t flags;
+
+    uint8_t symbolCount;
+    ProtocolSymbol symbols[ProtocolMaxSymbolCount];
+    uint8_t fieldCount;
+    ProtocolField fields[ProtocolMaxFieldCount]; // in the order they are printed
+} ProtocolDescriptor;
+
+// the protocols of COCOReceiver and KFSReceiver
+extern const ProtocolDescriptor ProtocolDescriptorCOCO;
+extern const ProtocolDescriptor ProtocolDescriptorKFS;
+
+// The EV1527 and PT2262 encoders of most cheap sensors (PIR, door contacts)
+// and remotes: like KFS, a 31T start-sync and 1:3 / 3:1 pulses. EV1527 sends
+// a 20-bit id and 4 data bits, PT2262 12 tri-state address and data pins.
+// Their frames look alike: only enable the ones that are around, or a frame
+// is reported by each.
+extern const ProtocolDescriptor ProtocolDescriptorEV1527;
+extern const ProtocolDescriptor ProtocolDescriptorPT2262;
+
+/*
+Returns the built-in descriptor called `name` (e.g. `EV1527`), or NULL.
+*/
+const ProtocolDescriptor * ProtocolDescriptorFind(const char * name);
+
+/*
+A frame that a ProtocolEngine decoded. It is only valid during the callback:
+copy what you need.
+*/
+typedef struct ProtocolFrame
+{
+    const ProtocolDescriptor * descriptor;
+    uint32_t protocolIndex;  // of the descriptor in the engine
+    uint64_t code;           // the bits in the order they were received, the last one lowest
+    uint32_t bitCount;
+    uint8_t quality;         // 0 - 100, as COCOMessageGetQuality()
+    uint32_t startTimestamp; // the end of the start-sync
+    uint32_t endTimestamp;   // the end of the frame
+} ProtocolFrame;
+
+/*
+Returns false if the protocol of `frame` has no field `name`.
+*/
+bool ProtocolFrameGetField(const ProtocolFrame * frame, const char * name, uint64_t * value);
+
+/*
+Sets field `name` of `code` to `value`, so that a sender can build a code from
+its fields; bits of `value` that do not fit the field are ignored. Returns
+false if `descriptor` has no field `name`.
+*/
+bool ProtocolCodeSetField(const ProtocolDescriptor * descriptor, uint64_t * code, const char * name, uint64_t value);
+
+/*
+Like ProtocolCodeSetField(), with the value as text in the format of the
+field, e.g. `235498` or `0F1F0000`. Returns false if `descriptor` has no
+field `name`, or if `text` is not a value of that field.
+*/
+bool ProtocolCodeParseField(const ProtocolDescriptor * descriptor, uint64_t * code, const char * name, const char * text);
+
+/*
+Writes the value of `field` in `code` in the format of the field, e.g.
+`654321` or `0F1F0000`. Returns what snprintf() returns.
+*/
+int ProtocolFieldFormatValue(const ProtocolField * field, uint64_t code, char * buffer, size_t size);
+
+/*
+Writes `frame` the way messages are given to `LPD433 -s` and `-b`, e.g.
+`COCO [address 235498, onOff 1, group 0, channel 3]`, or with the code and its
+length for a protocol without fields. Returns what snprintf() returns.
+*/
+int ProtocolFrameFormat(const ProtocolFrame * frame, char * buffer, size_t size);
+
+#endif
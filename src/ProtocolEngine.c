@@ -0,0 +1,583 @@
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include "ProtocolEngine.h"
+#include "Tracepoints.h"
+
+// the durations of low pulses are looked up in buckets of 64µs, up to 65ms:
+// a longer start-sync can not be looked up
+#define ProtocolEngineSyncBucketShift 6
+#define ProtocolEngineSyncBucketCount 1024
+
+// a protocol without an end-sync is ended by the next start-sync: the pulses
+// between its last bit and that start-sync are ignored, up to this many
+#define ProtocolEngineMaxTrailingPulseCount 16
+
+struct ProtocolDecoder
+{
+    const ProtocolDescriptor * descriptor;
+
+    // publicly queryable properties
+    uint32_t singlePulseDuration; // µs
+    uint32_t positiveTolerance;   // percentage
+    uint32_t negativeTolerance;   // percentage
+    uint32_t repeatCount;
+    uint32_t refractoryPeriod;    // seconds
+
+    // the durations (µs) a pulse must be longer than (min) and shorter than (max)
+    uint32_t startSyncMinDuration;
+    uint32_t startSyncMaxDuration;
+    uint32_t endHighMinDuration;
+    uint32_t endHighMaxDuration;
+    uint32_t endSyncMinDuration;
+    uint32_t endSyncMaxDuration;
+    uint32_t symbolMinDurations[ProtocolMaxSymbolCount][ProtocolMaxSymbolPulseCount];
+    uint32_t symbolMaxDurations[ProtocolMaxSymbolCount][ProtocolMaxSymbolPulseCount];
+
+    // the frame that is being received
+    uint64_t code;
+    uint32_t bitCount;
+    uint32_t startTimestamp;
+    uint32_t pulses[ProtocolMaxSymbolPulseCount]; // of the current symbol
+    uint32_t pulseIndex;       // in the current symbol
+    uint32_t candidates;       // bit per symbol that the pulses of the current symbol still match
+    uint32_t deviation;        // sum of the deviations of the pulses of all symbols, in percent
+    uint32_t symbolPulseCount; // the number of pulses in `deviation`
+    uint32_t trailingPulseCount;
+
+    uint64_t previousCode;
+    uint32_t previousBitCount; // 0: no previous frame
+    uint32_t repeats;
+    uint32_t timestampPreviousHit;
+
+    struct ReceiverCounters counters;
+};
+
+struct ProtocolEngine
+{
+    ProtocolFrameDetected callback;
+    void * context;
+    bool inverted;
+
+    uint32_t protocolCount;
+    struct ProtocolDecoder decoders[ProtocolEngineMaxProtocolCount];
+
+    // bit per decoder that is receiving a frame
+    uint32_t awakeDecoders;
+
+    // per bucket of durations, a bit per decoder whose start-sync may be that long
+    uint32_t syncDecoders[ProtocolEngineSyncBucketCount];
+
+    uint32_t lastTimestamp;
+    int32_t lastLevel; // -1 before the first edge
+    _Atomic uint64_t edgeCount;
+    _Atomic uint32_t polarityErrorCount;
+};
+
+// the deviation of `duration` from `nominalDuration`, in percent
+uint32_t ProtocolPulseDeviation(uint32_t duration, uint32_t nominalDuration)
+{
+    uint32_t difference = duration > nominalDuration ? duration - nominalDuration : nominalDuration - duration;
+    return difference * 100 / nominalDuration;
+}
+
+void ProtocolDecoderUpdateDurations(struct ProtocolDecoder * decoder)
+{
+    const ProtocolDescriptor * descriptor = decoder->descriptor;
+    uint32_t minimum = decoder->singlePulseDuration * (100 - decoder->negativeTolerance);
+    uint32_t maximum = decoder->singlePulseDuration * (100 + decoder->positiveTolerance);
+
+    decoder->startSyncMinDuration = descriptor->startSyncLow * minimum / 100;
+    decoder->startSyncMaxDuration = descriptor->startSyncLow * maximum / 100;
+    decoder->endHighMinDuration = descriptor->endHigh * minimum / 100;
+    decoder->endHighMaxDuration = descriptor->endHigh * maximum / 100;
+    decoder->endSyncMinDuration = descriptor->endSyncLow * minimum / 100;
+    decoder->endSyncMaxDuration = descriptor->endSyncLow * maximum / 100;
+    for (uint32_t symbol = 0; symbol < descriptor->symbolCount; symbol++)
+    {
+        for (uint32_t pulse = 0; pulse < descriptor->symbols[symbol].pulseCount; pulse++)
+        {
+            decoder->symbolMinDurations[symbol][pulse] = descriptor->symbols[symbol].pulses[pulse] * minimum / 100;
+            decoder->symbolMaxDurations[symbol][pulse] = descriptor->symbols[symbol].pulses[pulse] * maximum / 100;
+        }
+    }
+}
+
+void ProtocolEngineUpdateSyncLookup(ProtocolEngineRef engine)
+{
+    memset(engine->syncDecoders, 0, sizeof(engine->syncDecoders));
+    for (uint32_t index = 0; index < engine->protocolCount; index++)
+    {
+        struct ProtocolDecoder * decoder = &engine->decoders[index];
+        uint32_t first = decoder->startSyncMinDuration >> ProtocolEngineSyncBucketShift;
+        uint32_t last = decoder->startSyncMaxDuration >> ProtocolEngineSyncBucketShift;
+        if (last >= ProtocolEngineSyncBucketCount) { last = ProtocolEngineSyncBucketCount - 1; }
+        for (uint32_t bucket = first; bucket <= last; bucket++)
+        {
+            engine->syncDecoders[bucket] |= 1u << index;
+        }
+    }
+}
+
+ProtocolEngineRef ProtocolEngineCreate()
+{
+    ProtocolEngineRef newEngine = malloc(sizeof(struct ProtocolEngine));
+    if (NULL != newEngine)
+    {
+        newEngine->callback = NULL;
+        newEngine->context = NULL;
+        newEngine->inverted = false;
+        newEngine->protocolCount = 0;
+        newEngine->awakeDecoders = 0;
+        memset(newEngine->syncDecoders, 0, sizeof(newEngine->syncDecoders));
+        newEngine->lastTimestamp = 0;
+        newEngine->lastLevel = -1;
+        atomic_init(&newEngine->edgeCount, 0);
+        atomic_init(&newEngine->polarityErrorCount, 0);
+    }
+    return newEngine;
+}
+
+void ProtocolEngineRelease(ProtocolEngineRef engine)
+{
+    free(engine);
+}
+
+bool ProtocolDescriptorIsValid(const ProtocolDescriptor * descriptor)
+{
+    if (0 == descriptor->startSyncLow || 0 == descriptor->singlePulseDuration ||
+        0 == descriptor->symbolCount || descriptor->symbolCount > ProtocolMaxSymbolCount ||
+        descriptor->fieldCount > ProtocolMaxFieldCount ||
+        descriptor->minBitCount > descriptor->maxBitCount || descriptor->maxBitCount > ProtocolMaxBitCount)
+    { return false; }
+
+    // every symbol starts high and ends low, so that the next one starts high again
+    for (uint32_t symbol = 0; symbol < descriptor->symbolCount; symbol++)
+    {
+        uint32_t pulseCount = descriptor->symbols[symbol].pulseCount;
+        if (0 == pulseCount || 0 != pulseCount % 2 || pulseCount > ProtocolMaxSymbolPulseCount ||
+            0 == descriptor->symbols[symbol].bitCount)
+        { return false; }
+    }
+    return true;
+}
+
+int32_t ProtocolEngineAddProtocol(ProtocolEngineRef engine, const ProtocolDescriptor * descriptor)
+{
+    assert(NULL != engine);
+    assert(NULL != descriptor);
+
+    if (engine->protocolCount == ProtocolEngineMaxProtocolCount || !ProtocolDescriptorIsValid(descriptor))
+    {
+        printf("ProtocolEngineAddProtocol(): can not add %s.\n", (NULL == descriptor->name) ? "(unnamed)" : descriptor->name);
+        return -1;
+    }
+
+    uint32_t index = engine->protocolCount;
+    struct ProtocolDecoder * decoder = &engine->decoders[index];
+    decoder->descriptor = descriptor;
+    decoder->singlePulseDuration = descriptor->singlePulseDuration;
+    decoder->positiveTolerance = descriptor->positiveTolerance;
+    decoder->negativeTolerance = descriptor->negativeTolerance;
+    decoder->repeatCount = descriptor->repeatCount;
+    decoder->refractoryPeriod = descriptor->refractoryPeriod;
+    decoder->code = 0;
+    decoder->bitCount = 0;
+    decoder->startTimestamp = 0;
+    decoder->pulseIndex = 0;
+    decoder->candidates = 0;
+    decoder->deviation = 0;
+    decoder->symbolPulseCount = 0;
+    decoder->trailingPulseCount = 0;
+    decoder->previousCode = 0;
+    decoder->previousBitCount = 0;
+    decoder->repeats = 0;
+    decoder->timestampPreviousHit = 0;
+    ReceiverCountersReset(&decoder->counters);
+    ProtocolDecoderUpdateDurations(decoder);
+
+    engine->protocolCount += 1;
+    ProtocolEngineUpdateSyncLookup(engine);
+    return (int32_t) index;
+}
+
+// drops the frame that the decoder at `index` was receiving
+void ProtocolEngineReject(ProtocolEngineRef engine, uint32_t index, ReceiverRejectReason reason)
+{
+    struct ProtocolDecoder * decoder = &engine->decoders[index];
+    engine->awakeDecoders &= ~(1u << index);
+    ReceiverCountersCountReject(&decoder->counters, reason, decoder->bitCount);
+    LPD433Trace4(engine_frame_reject, engine, index, reason, decoder->bitCount);
+}
+
+// a start-sync of the decoder at `index` ended at `timestamp`
+void ProtocolEngineStart(ProtocolEngineRef engine, uint32_t index, uint32_t timestamp, uint32_t duration)
+{
+    struct ProtocolDecoder * decoder = &engine->decoders[index];
+    decoder->code = 0;
+    decoder->bitCount = 0;
+    decoder->startTimestamp = timestamp;
+    decoder->pulseIndex = 0;
+    decoder->candidates = (1u << decoder->descriptor->symbolCount) - 1;
+    decoder->deviation = 0;
+    decoder->symbolPulseCount = 0;
+    decoder->trailingPulseCount = 0;
+    engine->awakeDecoders |= 1u << index;
+    ReceiverCountersIncrement(decoder->counters.startSyncCount);
+    LPD433Trace4(engine_start_sync, engine, index, timestamp, duration);
+}
+
+// the end of the frame of the decoder at `index` was received
+void ProtocolEngineFinish(ProtocolEngineRef engine, uint32_t index, uint32_t timestamp)
+{
+    struct ProtocolDecoder * decoder = &engine->decoders[index];
+    const ProtocolDescriptor * descriptor = decoder->descriptor;
+    ReceiverCountersIncrement(decoder->counters.endSyncCount);
+
+    // the frame ends with the high pulse before the end-sync, which started a
+    // symbol, unless the protocol has none. Without an end-sync, a complete
+    // code may be followed by anything.
+    bool endHighReceived = (1 == decoder->pulseIndex &&
+                            decoder->pulses[0] > decoder->endHighMinDuration &&
+                            decoder->pulses[0] < decoder->endHighMaxDuration);
+    bool endMatches = (0 == descriptor->endHigh) ? (0 == decoder->pulseIndex) :
+                      (endHighReceived || (0 == descriptor->endSyncLow && 0 == decoder->pulseIndex));
+    if (0 == descriptor->endSyncLow && decoder->bitCount == descriptor->maxBitCount) { endMatches = true; }
+    if (!endMatches)
+    {
+        ProtocolEngineReject(engine, index, ReceiverRejectReasonPulseCount);
+        decoder->previousBitCount = 0;
+        return;
+    }
+    ReceiverCountersIncrement(decoder->counters.frameCount);
+    if (decoder->bitCount < descriptor->minBitCount ||
+        (0 != (descriptor->flags & ProtocolFlagRejectZeroCode) && 0 == decoder->code))
+    {
+        ProtocolEngineReject(engine, index, ReceiverRejectReasonCodeLength);
+        decoder->previousBitCount = 0;
+        return;
+    }
+    engine->awakeDecoders &= ~(1u << index);
+
+    ProtocolFrame frame;
+    frame.descriptor = descriptor;
+    frame.protocolIndex = index;
+    frame.code = decoder->code;
+    frame.bitCount = decoder->bitCount;
+    uint32_t averageDeviation = (0 == decoder->symbolPulseCount) ? 100 : decoder->deviation / decoder->symbolPulseCount;
+    frame.quality = (uint8_t) (averageDeviation >= 100 ? 0 : 100 - averageDeviation);
+    frame.startTimestamp = decoder->startTimestamp;
+    frame.endTimestamp = timestamp;
+    ReceiverCountersIncrement(decoder->counters.acceptedCount);
+    LPD433Trace4(engine_frame_accept, engine, index, frame.code, frame.quality);
+
+    if (frame.code == decoder->previousCode && frame.bitCount == decoder->previousBitCount)
+    {
+        decoder->repeats += 1;
+        ReceiverCountersIncrement(decoder->counters.repeatCount);
+        if (decoder->repeats >= decoder->repeatCount)
+        {
+            if (frame.startTimestamp - decoder->timestampPreviousHit > (decoder->refractoryPeriod * 1000000))
+            {
+                decoder->timestampPreviousHit = frame.startTimestamp;
+                decoder->repeats = 0;
+                // like KFSReceiver: the next frame starts a new count
+                decoder->previousCode = 0;
+                decoder->previousBitCount = 0;
+                if (NULL != engine->callback)
+                {
+                    ReceiverCountersIncrement(decoder->counters.callbackCount);
+                    engine->callback(engine, &frame);
+                }
+            }
+            else
+            {
+                ReceiverCountersIncrement(decoder->counters.suppressedCount);
+            }
+        }
+    }
+    else
+    {
+        decoder->repeats = 0;
+        decoder->previousCode = frame.code;
+        decoder->previousBitCount = frame.bitCount;
+    }
+}
+
+// the pulse of `duration` µs that ended at `timestamp`, for the awake decoder at `index`
+void ProtocolEngineDecode(ProtocolEngineRef engine, uint32_t index, uint32_t timestamp, uint32_t duration, bool high)
+{
+    struct ProtocolDecoder * decoder = &engine->decoders[index];
+    const ProtocolDescriptor * descriptor = decoder->descriptor;
+
+    // the syncs are low and longer than any pulse of a symbol
+    if (!high)
+    {
+        if (0 != descriptor->endSyncLow)
+        {
+            if (duration > decoder->endSyncMinDuration && duration < decoder->endSyncMaxDuration)
+            {
+                ProtocolEngineFinish(engine, index, timestamp);
+                return;
+            }
+        }
+        else if (duration > decoder->startSyncMinDuration)
+        {
+            // the next start-sync, or a silence as long as one
+            ProtocolEngineFinish(engine, index, timestamp);
+            return;
+        }
+    }
+
+    if (0 == descriptor->endSyncLow && decoder->bitCount == descriptor->maxBitCount)
+    {
+        decoder->trailingPulseCount += 1;
+        if (decoder->trailingPulseCount > ProtocolEngineMaxTrailingPulseCount)
+        { ProtocolEngineReject(engine, index, ReceiverRejectReasonPulseCount); }
+        return;
+    }
+
+    // the symbols that the pulses so far still match: the pulses of all
+    // symbols alternate between high and low, starting high, as the edges do
+    uint32_t pulseIndex = decoder->pulseIndex;
+    uint32_t candidates = 0;
+    for (uint32_t remaining = decoder->candidates; 0 != remaining; remaining &= remaining - 1)
+    {
+        uint32_t symbol = (uint32_t) __builtin_ctz(remaining);
+        if (duration > decoder->symbolMinDurations[symbol][pulseIndex] &&
+            duration < decoder->symbolMaxDurations[symbol][pulseIndex])
+        { candidates |= 1u << symbol; }
+    }
+    if (0 == candidates)
+    {
+        ProtocolEngineReject(engine, index, ReceiverRejectReasonBitEncoding);
+        return;
+    }
+    decoder->pulses[pulseIndex] = duration;
+    pulseIndex += 1;
+
+    for (uint32_t remaining = candidates; 0 != remaining; remaining &= remaining - 1)
+    {
+        uint32_t symbolIndex = (uint32_t) __builtin_ctz(remaining);
+        const ProtocolSymbol * symbol = &descriptor->symbols[symbolIndex];
+        if (symbol->pulseCount != pulseIndex) { continue; }
+
+        // a complete symbol
+        if (decoder->bitCount + symbol->bitCount > descriptor->maxBitCount)
+        {
+            ProtocolEngineReject(engine, index, ReceiverRejectReasonPulseCount);
+            return;
+        }
+        decoder->code = (decoder->code << symbol->bitCount) | symbol->value;
+        decoder->bitCount += symbol->bitCount;
+        for (uint32_t pulse = 0; pulse < symbol->pulseCount; pulse++)
+        {
+            decoder->deviation += ProtocolPulseDeviation(decoder->pulses[pulse], symbol->pulses[pulse] * decoder->singlePulseDuration);
+        }
+        decoder->symbolPulseCount += symbol->pulseCount;
+        decoder->pulseIndex = 0;
+        decoder->candidates = (1u << descriptor->symbolCount) - 1;
+        return;
+    }
+    decoder->pulseIndex = pulseIndex;
+    decoder->candidates = candidates;
+}
+
+void ProtocolEngineFeedPulse(ProtocolEngineRef engine, uint32_t timestamp, uint32_t duration, bool high)
+{
+    for (uint32_t awake = engine->awakeDecoders; 0 != awake; awake &= awake - 1)
+    {
+        ProtocolEngineDecode(engine, (uint32_t) __builtin_ctz(awake), timestamp, duration, high);
+    }
+
+    // the start-syncs are low: one lookup finds the decoders it may wake
+    if (high) { return; }
+    uint32_t bucket = duration >> ProtocolEngineSyncBucketShift;
+    if (bucket >= ProtocolEngineSyncBucketCount) { return; }
+    for (uint32_t candidates = engine->syncDecoders[bucket]; 0 != candidates; candidates &= candidates - 1)
+    {
+        uint32_t index = (uint32_t) __builtin_ctz(candidates);
+        struct ProtocolDecoder * decoder = &engine->decoders[index];
+        if (duration > decoder->startSyncMinDuration && duration < decoder->startSyncMaxDuration)
+        { ProtocolEngineStart(engine, index, timestamp, duration); }
+    }
+}
+
+void ProtocolEngineFeedGPIOLevelChange(ProtocolEngineRef engine, uint32_t timestamp, uint32_t level)
+{
+    assert(NULL != engine);
+    atomic_fetch_add_explicit(&engine->edgeCount, 1, memory_order_relaxed);
+
+    int32_t newLevel = ((0 != level) != engine->inverted) ? 1 : 0;
+    if (newLevel == engine->lastLevel)
+    {
+        // no change: an edge in between was missed, so the level (and
+        // length) of the pulse that ended is unknown
+        engine->lastTimestamp = timestamp;
+        if (0 != engine->awakeDecoders) { ReceiverCountersIncrement(engine->polarityErrorCount); }
+        for (uint32_t awake = engine->awakeDecoders; 0 != awake; awake &= awake - 1)
+        {
+            ProtocolEngineReject(engine, (uint32_t) __builtin_ctz(awake), ReceiverRejectReasonPolarity);
+        }
+        return;
+    }
+
+    // the pulse that ended had the other level; before the first edge it is
+    // unknown
+    int32_t pulseLevel = engine->lastLevel;
+    uint32_t duration = timestamp - engine->lastTimestamp;
+    engine->lastLevel = newLevel;
+    engine->lastTimestamp = timestamp;
+    if (pulseLevel < 0) { return; }
+    ProtocolEngineFeedPulse(engine, timestamp, duration, 1 == pulseLevel);
+}
+
+void ProtocolEngineFeedTimeout(ProtocolEngineRef engine, uint32_t timestamp)
+{
+    assert(NULL != engine);
+
+    // the syncs are low: a silence without carrier
+    if (0 != engine->lastLevel) { return; }
+    uint32_t silence = timestamp - engine->lastTimestamp;
+    for (uint32_t awake = engine->awakeDecoders; 0 != awake; awake &= awake - 1)
+    {
+        uint32_t index = (uint32_t) __builtin_ctz(awake);
+        struct ProtocolDecoder * decoder = &engine->decoders[index];
+        const ProtocolDescriptor * descriptor = decoder->descriptor;
+
+        // end the frame at the nominal length of what ends it, as if the edge was there
+        uint32_t endDuration = decoder->singlePulseDuration *
+                               ((0 != descriptor->endSyncLow) ? descriptor->endSyncLow : descriptor->startSyncLow);
+        if (silence >= endDuration) { ProtocolEngineFinish(engine, index, engine->lastTimestamp + endDuration); }
+    }
+}
+
+const ProtocolDescriptor * ProtocolEngineGetDescriptor(ProtocolEngineRef engine, uint32_t protocolIndex)
+{
+    assert(NULL != engine);
+    assert(protocolIndex < engine->protocolCount);
+    return engine->decoders[protocolIndex].descriptor;
+}
+
+uint32_t ProtocolEngineGetProtocolCount(ProtocolEngineRef engine)
+{
+    assert(NULL != engine);
+    return engine->protocolCount;
+}
+
+void ProtocolEngineSetCallback(ProtocolEngineRef engine, ProtocolFrameDetected callback)
+{
+    assert(NULL != engine);
+    engine->callback = callback;
+}
+
+void ProtocolEngineSetContext(ProtocolEngineRef engine, void * context)
+{
+    assert(NULL != engine);
+    engine->context = context;
+}
+
+void * ProtocolEngineGetContext(ProtocolEngineRef engine)
+{
+    assert(NULL != engine);
+    return engine->context;
+}
+
+void ProtocolEngineSetInverted(ProtocolEngineRef engine, bool inverted)
+{
+    assert(NULL != engine);
+    engine->inverted = inverted;
+    engine->lastLevel = -1;
+    engine->awakeDecoders = 0;
+}
+
+void ProtocolEngineSetSinglePulseDuration(ProtocolEngineRef engine, uint32_t protocolIndex, uint32_t pulseDuration)
+{
+    assert(NULL != engine);
+    assert(protocolIndex < engine->protocolCount);
+    assert(pulseDuration > 0);
+    engine->decoders[protocolIndex].singlePulseDuration = pulseDuration;
+    ProtocolDecoderUpdateDurations(&engine->decoders[protocolIndex]);
+    ProtocolEngineUpdateSyncLookup(engine);
+}
+
+void ProtocolEngineSetPositiveTolerance(ProtocolEngineRef engine, uint32_t protocolIndex, uint32_t tolerance)
+{
+    assert(NULL != engine);
+    assert(protocolIndex < engine->protocolCount);
+    engine->decoders[protocolIndex].positiveTolerance = tolerance > 100 ? 100 : tolerance;
+    ProtocolDecoderUpdateDurations(&engine->decoders[protocolIndex]);
+    ProtocolEngineUpdateSyncLookup(engine);
+}
+
+void ProtocolEngineSetNegativeTolerance(ProtocolEngineRef engine, uint32_t protocolIndex, uint32_t tolerance)
+{
+    assert(NULL != engine);
+    assert(protocolIndex < engine->protocolCount);
+    engine->decoders[protocolIndex].negativeTolerance = tolerance > 100 ? 100 : tolerance;
+    ProtocolDecoderUpdateDurations(&engine->decoders[protocolIndex]);
+    ProtocolEngineUpdateSyncLookup(engine);
+}
+
+void ProtocolEngineSetRepeatCount(ProtocolEngineRef engine, uint32_t protocolIndex, uint32_t repeatCount)
+{
+    assert(NULL != engine);
+    assert(protocolIndex < engine->protocolCount);
+    engine->decoders[protocolIndex].repeatCount = repeatCount;
+}
+
+void ProtocolEngineSetRefractoryPeriod(ProtocolEngineRef engine, uint32_t protocolIndex, uint32_t refractoryPeriod)
+{
+    assert(NULL != engine);
+    assert(protocolIndex < engine->protocolCount);
+    engine->decoders[protocolIndex].refractoryPeriod = refractoryPeriod;
+}
+
+uint32_t ProtocolEngineGetSinglePulseDuration(ProtocolEngineRef engine, uint32_t protocolIndex)
+{
+    assert(NULL != engine);
+    assert(protocolIndex < engine->protocolCount);
+    return engine->decoders[protocolIndex].singlePulseDuration;
+}
+
+uint32_t ProtocolEngineGetPositiveTolerance(ProtocolEngineRef engine, uint32_t protocolIndex)
+{
+    assert(NULL != engine);
+    assert(protocolIndex < engine->protocolCount);
+    return engine->decoders[protocolIndex].positiveTolerance;
+}
+
+uint32_t ProtocolEngineGetNegativeTolerance(ProtocolEngineRef engine, uint32_t protocolIndex)
+{
+    assert(NULL != engine);
+    assert(protocolIndex < engine->protocolCount);
+    return engine->decoders[protocolIndex].negativeTolerance;
+}
+
+uint32_t ProtocolEngineGetRepeatCount(ProtocolEngineRef engine, uint32_t protocolIndex)
+{
+    assert(NULL != engine);
+    assert(protocolIndex < engine->protocolCount);
+    return engine->decoders[protocolIndex].repeatCount;
+}
+
+uint32_t ProtocolEngineGetRefractoryPeriod(ProtocolEngineRef engine, uint32_t protocolIndex)
+{
+    assert(NULL != engine);
+    assert(protocolIndex < engine->protocolCount);
+    return engine->decoders[protocolIndex].refractoryPeriod;
+}
+
+void ProtocolEngineGetStatistics(ProtocolEngineRef engine, uint32_t protocolIndex, ReceiverStatistics * statistics)
+{
+    assert(NULL != engine);
+    assert(protocolIndex < engine->protocolCount);
+    ReceiverCountersGetStatistics(&engine->decoders[protocolIndex].counters, statistics);
+    statistics->edgeCount = atomic_load_explicit(&engine->edgeCount, memory_order_relaxed);
+}
+
+uint32_t ProtocolEngineGetPolarityErrorCount(ProtocolEngineRef engine)
+{
+    assert(NULL != engine);
+    return atomic_load_explicit(&engine->polarityErrorCount, memory_order_relaxed);
+}
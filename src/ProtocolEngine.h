@@ -0,0 +1,119 @@
+#ifndef ProtocolEngine_h
+#define ProtocolEngine_h
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include "ProtocolDescriptor.h"
+#include "ReceiverStatistics.h"
+
+/*
+A ProtocolEngine decodes the frames of all protocols that were added to it as
+a ProtocolDescriptor, from the edges of one GPIO.
+A hand-written receiver per protocol looks at every edge, so the cost per edge
+grows with every protocol. The engine looks up the duration of each low pulse
+in one table, that holds per duration the protocols whose start-sync is that
+long: only those decoders are woken, and only awake decoders (those receiving
+a frame) see the pulses that follow. A decoder goes back to sleep as soon as a
+pulse fits none of its symbols, so with 20 protocols an edge costs about as
+much as with 2: one lookup, and the few decoders that are awake.
+The decoders match the pulses as they arrive, symbol by symbol, without
+storing the durations or allocating memory per frame.
+
+The repeat count and refractory period work as in KFSReceiver: a frame is
+passed to the callback once it was received `repeatCount` more times in a row,
+unless a frame was passed less than `refractoryPeriod` seconds before. After a
+frame was passed, the count starts over: the next `repeatCount` + 1 identical
+frames make the next hit. (COCOReceiver keeps counting instead, so that every
+further repeat is a hit, unless the refractory period suppresses it.)
+*/
+
+// the maximum number of protocols in one engine
+#define ProtocolEngineMaxProtocolCount 32
+
+typedef struct ProtocolEngine *ProtocolEngineRef;
+
+// `frame` is only valid during the call
+typedef void (*ProtocolFrameDetected)(ProtocolEngineRef engine, const ProtocolFrame * frame);
+
+/*
+Creates a new ProtocolEngine without protocols, or NULL if an engine could not
+be created. You are responsible for releasing this object using
+ProtocolEngineRelease().
+*/
+ProtocolEngineRef ProtocolEngineCreate();
+
+/*
+Releases a ProtocolEngineRef. This function is safe to call when `engine` is
+NULL.
+*/
+void ProtocolEngineRelease(ProtocolEngineRef engine);
+
+/*
+Adds the protocol `descriptor`, with its default timing and repeat settings.
+The descriptor is not copied, it must outlive the engine. Returns the index of
+the protocol in the engine, or -1 if the engine is full or the descriptor is
+not valid.
+*/
+int32_t ProtocolEngineAddProtocol(ProtocolEngineRef engine, const ProtocolDescriptor * descriptor);
+uint32_t ProtocolEngineGetProtocolCount(ProtocolEngineRef engine);
+const ProtocolDescriptor * ProtocolEngineGetDescriptor(ProtocolEngineRef engine, uint32_t protocolIndex);
+
+void ProtocolEngineSetCallback(ProtocolEngineRef engine, ProtocolFrameDetected callback);
+
+/*
+Defaults to NULL. A pointer that is not used by the engine, so that your
+callback can tell engines apart (e.g. when listening on several GPIOs).
+*/
+void ProtocolEngineSetContext(ProtocolEngineRef engine, void * context);
+void * ProtocolEngineGetContext(ProtocolEngineRef engine);
+
+/*
+Defaults to false. Set this to true for a receiver module whose output is low
+while it receives a carrier, and high otherwise.
+*/
+void ProtocolEngineSetInverted(ProtocolEngineRef engine, bool inverted);
+
+/*
+Every time the GPIO changes state, call this function with the timestamp of
+the change (µs, e.g. the PIGPIO tick) and the `level` (0 or 1) after it. The
+engine needs the levels: syncs are low, and a pulse of the wrong level means
+an edge was missed, which drops the frames that are being received.
+*/
+void ProtocolEngineFeedGPIOLevelChange(ProtocolEngineRef engine, uint32_t timestamp, uint32_t level);
+
+/*
+Call this when the GPIO did not change state since the last edge until
+`timestamp`, e.g. from the timeout of a PIGPIO ISR or watchdog: a frame that
+only waits for its end-sync, or for the next start-sync, is finished as soon
+as the silence is that long, instead of when the next edge arrives.
+Calling this function more than once during the same silence is harmless.
+*/
+void ProtocolEngineFeedTimeout(ProtocolEngineRef engine, uint32_t timestamp);
+
+// The settings per protocol, see COCOReceiverSetSinglePulseDuration() and friends.
+void ProtocolEngineSetSinglePulseDuration(ProtocolEngineRef engine, uint32_t protocolIndex, uint32_t pulseDuration);
+void ProtocolEngineSetPositiveTolerance(ProtocolEngineRef engine, uint32_t protocolIndex, uint32_t tolerance);
+void ProtocolEngineSetNegativeTolerance(ProtocolEngineRef engine, uint32_t protocolIndex, uint32_t tolerance);
+void ProtocolEngineSetRepeatCount(ProtocolEngineRef engine, uint32_t protocolIndex, uint32_t repeatCount);
+void ProtocolEngineSetRefractoryPeriod(ProtocolEngineRef engine, uint32_t protocolIndex, uint32_t refractoryPeriod);
+uint32_t ProtocolEngineGetSinglePulseDuration(ProtocolEngineRef engine, uint32_t protocolIndex);
+uint32_t ProtocolEngineGetPositiveTolerance(ProtocolEngineRef engine, uint32_t protocolIndex);
+uint32_t ProtocolEngineGetNegativeTolerance(ProtocolEngineRef engine, uint32_t protocolIndex);
+uint32_t ProtocolEngineGetRepeatCount(ProtocolEngineRef engine, uint32_t protocolIndex);
+uint32_t ProtocolEngineGetRefractoryPeriod(ProtocolEngineRef engine, uint32_t protocolIndex);
+
+/*
+Copies the counters of the decoder of one protocol (see ReceiverStatistics.h)
+into `statistics`; the edges are those of the engine. Safe to call from any
+thread, at any time.
+*/
+void ProtocolEngineGetStatistics(ProtocolEngineRef engine, uint32_t protocolIndex, ReceiverStatistics * statistics);
+
+/*
+The number of times an edge was missed (two edges to the same level) while a
+frame was being received. Safe to call from any thread.
+*/
+uint32_t ProtocolEngineGetPolarityErrorCount(ProtocolEngineRef engine);
+
+#endif
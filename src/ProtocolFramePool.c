@@ -0,0 +1,76 @@
+#include <stdio.h>
+#include <assert.h>
+#include <stdatomic.h>
+#include "ProtocolFramePool.h"
+#include "BoundedQueue.h"
+
+struct ProtocolFramePool
+{
+    ProtocolFrame * frames;
+    BoundedQueueRef freeFrames; // of ProtocolFrame *
+    _Atomic uint64_t droppedCount;
+};
+
+ProtocolFramePoolRef ProtocolFramePoolCreate(uint32_t capacity)
+{
+    assert(capacity > 0);
+
+    ProtocolFramePoolRef newPool = malloc(sizeof(struct ProtocolFramePool));
+    if (NULL != newPool)
+    {
+        newPool->frames = malloc(capacity * sizeof(ProtocolFrame));
+        newPool->freeFrames = BoundedQueueCreate(capacity, sizeof(ProtocolFrame *));
+        atomic_init(&newPool->droppedCount, 0);
+        if (NULL == newPool->frames || NULL == newPool->freeFrames)
+        {
+            free(newPool->frames);
+            BoundedQueueRelease(newPool->freeFrames);
+            free(newPool);
+            return NULL;
+        }
+        for (uint32_t index = 0; index < capacity; index++)
+        {
+            ProtocolFrame * frame = &newPool->frames[index];
+            BoundedQueueTryPush(newPool->freeFrames, &frame);
+        }
+    }
+    return newPool;
+}
+
+void ProtocolFramePoolRelease(ProtocolFramePoolRef pool)
+{
+    if (NULL == pool) { return; }
+    BoundedQueueRelease(pool->freeFrames);
+    free(pool->frames);
+    free(pool);
+}
+
+ProtocolFrame * ProtocolFramePoolTake(ProtocolFramePoolRef pool, const ProtocolFrame * frame)
+{
+    assert(NULL != pool);
+    assert(NULL != frame);
+
+    ProtocolFrame * pooledFrame = NULL;
+    if (!BoundedQueueTryPop(pool->freeFrames, &pooledFrame))
+    {
+        atomic_fetch_add_explicit(&pool->droppedCount, 1, memory_order_relaxed);
+        return NULL;
+    }
+    *pooledFrame = *frame;
+    return pooledFrame;
+}
+
+void ProtocolFramePoolReturn(ProtocolFramePoolRef pool, ProtocolFrame * frame)
+{
+    assert(NULL != pool);
+    assert(NULL != frame);
+
+    // the queue has room for every frame of the pool
+    BoundedQueueTryPush(pool->freeFrames, &frame);
+}
+
+uint64_t ProtocolFramePoolGetDroppedCount(ProtocolFramePoolRef pool)
+{
+    assert(NULL != pool);
+    return atomic_load_explicit(&pool->droppedCount, memory_order_relaxed);
+}
@@ -0,0 +1,48 @@
+#ifndef ProtocolFramePool_h
+#define ProtocolFramePool_h
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include "ProtocolDescriptor.h"
+
+/*
+A ProtocolFramePool holds a fixed number of ProtocolFrames, allocated once,
+so that frames decoded by a ProtocolEngine can be passed on (e.g. through a
+DiversityCombiner and a MessageDispatcher) without allocating memory per
+frame. The free frames are kept in a BoundedQueue: taking and returning a
+frame never blocks, and is safe from any number of threads at the same time.
+*/
+
+typedef struct ProtocolFramePool *ProtocolFramePoolRef;
+
+/*
+Creates a new pool of `capacity` frames, or NULL if a pool could not be
+created. You are responsible for releasing this object using
+ProtocolFramePoolRelease(), once all frames were returned.
+*/
+ProtocolFramePoolRef ProtocolFramePoolCreate(uint32_t capacity);
+
+/*
+Releases a ProtocolFramePoolRef. This function is safe to call when `pool` is
+NULL.
+*/
+void ProtocolFramePoolRelease(ProtocolFramePoolRef pool);
+
+/*
+Returns a copy of `frame` from the pool, or NULL if all frames of the pool are
+in use, in which case it is counted as dropped.
+*/
+ProtocolFrame * ProtocolFramePoolTake(ProtocolFramePoolRef pool, const ProtocolFrame * frame);
+
+/*
+Gives a frame that ProtocolFramePoolTake() returned back to the pool.
+*/
+void ProtocolFramePoolReturn(ProtocolFramePoolRef pool, ProtocolFrame * frame);
+
+/*
+The number of frames that could not be taken because the pool was empty.
+*/
+uint64_t ProtocolFramePoolGetDroppedCount(ProtocolFramePoolRef pool);
+
+#endif
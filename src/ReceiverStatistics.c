@@ -0,0 +1,90 @@
+#include <assert.h>
+#include "ReceiverStatistics.h"
+
+void ReceiverCountersReset(struct ReceiverCounters * counters)
+{
+    assert(NULL != counters);
+    atomic_init(&counters->edgeCount, 0);
+    atomic_init(&counters->startSyncCount, 0);
+    atomic_init(&counters->endSyncCount, 0);
+    atomic_init(&counters->frameCount, 0);
+    atomic_init(&counters->acceptedCount, 0);
+    for (uint32_t index = 0; index < ReceiverRejectReasonCount; index++)
+    {
+        atomic_init(&counters->rejectCounts[index], 0);
+    }
+    for (uint32_t index = 0; index < ReceiverStatisticsBitCount; index++)
+    {
+        atomic_init(&counters->rejectBitCounts[index], 0);
+    }
+    atomic_init(&counters->repeatCount, 0);
+    atomic_init(&counters->suppressedCount, 0);
+    atomic_init(&counters->callbackCount, 0);
+}
+
+void ReceiverCountersCountReject(struct ReceiverCounters * counters, ReceiverRejectReason reason, uint32_t bitIndex)
+{
+    assert(NULL != counters);
+    assert(reason < ReceiverRejectReasonCount);
+    ReceiverCountersIncrement(counters->rejectCounts[reason]);
+    if (bitIndex >= ReceiverStatisticsBitCount) { bitIndex = ReceiverStatisticsBitCount - 1; }
+    ReceiverCountersIncrement(counters->rejectBitCounts[bitIndex]);
+}
+
+void ReceiverCountersGetStatistics(struct ReceiverCounters * counters, ReceiverStatistics * statistics)
+{
+    assert(NULL != counters);
+    assert(NULL != statistics);
+    statistics->edgeCount = atomic_load_explicit(&counters->edgeCount, memory_order_relaxed);
+    statistics->startSyncCount = atomic_load_explicit(&counters->startSyncCount, memory_order_relaxed);
+    statistics->endSyncCount = atomic_load_explicit(&counters->endSyncCount, memory_order_relaxed);
+    statistics->frameCount = atomic_load_explicit(&counters->frameCount, memory_order_relaxed);
+    statistics->acceptedCount = atomic_load_explicit(&counters->acceptedCount, memory_order_relaxed);
+    for (uint32_t index = 0; index < ReceiverRejectReasonCount; index++)
+    {
+        statistics->rejectCounts[index] = atomic_load_explicit(&counters->rejectCounts[index], memory_order_relaxed);
+    }
+    for (uint32_t index = 0; index < ReceiverStatisticsBitCount; index++)
+    {
+        statistics->rejectBitCounts[index] = atomic_load_explicit(&counters->rejectBitCounts[index], memory_order_relaxed);
+    }
+    statistics->repeatCount = atomic_load_explicit(&counters->repeatCount, memory_order_relaxed);
+    statistics->suppressedCount = atomic_load_explicit(&counters->suppressedCount, memory_order_relaxed);
+    statistics->callbackCount = atomic_load_explicit(&counters->callbackCount, memory_order_relaxed);
+}
+
+void ReceiverStatisticsPrint(FILE * output, const char * name, const ReceiverStatistics * statistics)
+{
+    assert(NULL != output);
+    assert(NULL != statistics);
+    fprintf(output, "%s edges %llu, syncs %llu/%llu, frames %llu, accepted %llu, rejected: pulses %llu bits %llu length %llu polarity %llu checksum %llu, repeats %llu, suppressed %llu, callbacks %llu\n",
+            name,
+            (unsigned long long) statistics->edgeCount,
+            (unsigned long long) statistics->startSyncCount,
+            (unsigned long long) statistics->endSyncCount,
+            (unsigned long long) statistics->frameCount,
+            (unsigned long long) statistics->acceptedCount,
+            (unsigned long long) statistics->rejectCounts[ReceiverRejectReasonPulseCount],
+            (unsigned long long) statistics->rejectCounts[ReceiverRejectReasonBitEncoding],
+            (unsigned long long) statistics->rejectCounts[ReceiverRejectReasonCodeLength],
+            (unsigned long long) statistics->rejectCounts[ReceiverRejectReasonPolarity],
+            (unsigned long long) statistics->rejectCounts[ReceiverRejectReasonChecksum],
+            (unsigned long long) statistics->repeatCount,
+            (unsigned long long) statistics->suppressedCount,
+            (unsigned long long) statistics->callbackCount);
+
+    bool hasBitRejects = false;
+    for (uint32_t index = 0; index < ReceiverStatisticsBitCount; index++)
+    {
+        if (0 != statistics->rejectBitCounts[index]) { hasBitRejects = true; }
+    }
+    if (!hasBitRejects) { return; }
+
+    fprintf(output, "%s rejected at bit:", name);
+    for (uint32_t index = 0; index < ReceiverStatisticsBitCount; index++)
+    {
+        if (0 != statistics->rejectBitCounts[index])
+        { fprintf(output, " %u:%llu", index, (unsigned long long) statistics->rejectBitCounts[index]); }
+    }
+    fprintf(output, "\n");
+}
@@ -0,0 +1,79 @@
+#ifndef ReceiverStatistics_h
+#define ReceiverStatistics_h
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdatomic.h>
+
+/*
+Counters of what a protocol receiver (COCOReceiver, KFSReceiver,
+OregonReceiver) did with the edges it was fed, so that it can be told why a
+device "does not work": did any edges arrive, did a start-sync match, at which
+bit was a frame rejected, was a message suppressed by the repeat count or the
+refractory period?
+The receiver updates its ReceiverCounters on the thread that feeds it, with
+relaxed atomic increments: cheap enough to always stay enabled, and safe to
+read from any other thread at any time, without locks. Read them through the
+...GetStatistics() function of the receiver, which copies them into a
+ReceiverStatistics snapshot. The counters of a snapshot are read one by one,
+so they may be a few edges apart.
+*/
+
+// why a frame was rejected
+typedef enum ReceiverRejectReason
+{
+    ReceiverRejectReasonPulseCount = 0,  // the end-sync came after too few (or too many) pulses
+    ReceiverRejectReasonBitEncoding = 1, // the pulses of a bit encode neither a zero nor a one
+    ReceiverRejectReasonCodeLength = 2,  // too few bits were received
+    ReceiverRejectReasonPolarity = 3,    // an edge was missed: a pulse had the wrong level
+    ReceiverRejectReasonChecksum = 4,    // the bits were received, but their checksum did not match
+    ReceiverRejectReasonCount = 5
+} ReceiverRejectReason;
+
+// rejects at bit indexes beyond this are counted at the last index
+#define ReceiverStatisticsBitCount 32
+
+typedef struct ReceiverStatistics
+{
+    uint64_t edgeCount;
+    uint64_t startSyncCount;
+    uint64_t endSyncCount;
+    uint64_t frameCount;       // frames analysed: accepted + rejected
+    uint64_t acceptedCount;    // frames that held a valid message
+    uint64_t rejectCounts[ReceiverRejectReasonCount];
+    uint64_t rejectBitCounts[ReceiverStatisticsBitCount]; // the bit at which frames were rejected
+    uint64_t repeatCount;      // accepted messages that equalled the previous one
+    uint64_t suppressedCount;  // messages not passed on because of the refractory period
+    uint64_t callbackCount;
+} ReceiverStatistics;
+
+// for use by the receivers
+struct ReceiverCounters
+{
+    _Atomic uint64_t edgeCount;
+    _Atomic uint64_t startSyncCount;
+    _Atomic uint64_t endSyncCount;
+    _Atomic uint64_t frameCount;
+    _Atomic uint64_t acceptedCount;
+    _Atomic uint64_t rejectCounts[ReceiverRejectReasonCount];
+    _Atomic uint64_t rejectBitCounts[ReceiverStatisticsBitCount];
+    _Atomic uint64_t repeatCount;
+    _Atomic uint64_t suppressedCount;
+    _Atomic uint64_t callbackCount;
+};
+
+#define ReceiverCountersIncrement(counter) atomic_fetch_add_explicit(&(counter), 1, memory_order_relaxed)
+
+void ReceiverCountersReset(struct ReceiverCounters * counters);
+void ReceiverCountersCountReject(struct ReceiverCounters * counters, ReceiverRejectReason reason, uint32_t bitIndex);
+void ReceiverCountersGetStatistics(struct ReceiverCounters * counters, ReceiverStatistics * statistics);
+
+/*
+Prints `statistics` on one line, prefixed with `name`, followed by a line with
+the rejects per bit, if there were any.
+*/
+void ReceiverStatisticsPrint(FILE * output, const char * name, const ReceiverStatistics * statistics);
+
+#endif
@@ -0,0 +1,171 @@
+#include <stdio.h>
+#include <assert.h>
+#include <stdatomic.h>
+#include "SampleEdgeExtractor.h"
+
+#define SampleEdgeExtractorGPIOCount 32
+
+// the number of samples that are checked for changes at once. At PIGPIO's
+// default sample rate of 5µs, a 433MHz pulse (> 150µs) spans 30 samples or
+// more, so most blocks hold no edges at all.
+#define SampleEdgeExtractorBlockLength 8
+
+struct SampleEdgeExtractor
+{
+    SampleEdgeExtractorEdgeDetected callback;
+    uint32_t monitoredMask;
+    void * contexts[SampleEdgeExtractorGPIOCount];
+
+    // for internal use
+    //
+    bool hasLevel;
+    uint32_t level; // the levels of the last sample fed
+    uint64_t sampleCount;
+    uint64_t edgeCount;
+    uint32_t maxSampleInterval; // µs, 0 when gaps are not detected
+    uint32_t lastTick; // the tick of the last sample fed
+    _Atomic uint64_t gapCount;
+};
+
+SampleEdgeExtractorRef SampleEdgeExtractorCreate(uint32_t monitoredMask)
+{
+    SampleEdgeExtractorRef newExtractor = malloc(sizeof(struct SampleEdgeExtractor));
+    if (NULL != newExtractor)
+    {
+        newExtractor->callback = NULL;
+        newExtractor->monitoredMask = monitoredMask;
+        for (uint32_t index = 0; index < SampleEdgeExtractorGPIOCount; index++)
+        {
+            newExtractor->contexts[index] = NULL;
+        }
+        newExtractor->hasLevel = false;
+        newExtractor->level = 0;
+        newExtractor->sampleCount = 0;
+        newExtractor->edgeCount = 0;
+        newExtractor->maxSampleInterval = 0;
+        newExtractor->lastTick = 0;
+        atomic_init(&newExtractor->gapCount, 0);
+    }
+    return newExtractor;
+}
+
+void SampleEdgeExtractorRelease(SampleEdgeExtractorRef extractor)
+{
+    free(extractor);
+}
+
+void SampleEdgeExtractorSetCallback(SampleEdgeExtractorRef extractor, SampleEdgeExtractorEdgeDetected callback)
+{
+    assert(NULL != extractor);
+    extractor->callback = callback;
+}
+
+void SampleEdgeExtractorSetGPIOContext(SampleEdgeExtractorRef extractor, uint32_t gpio, void * context)
+{
+    assert(NULL != extractor);
+    assert(gpio < SampleEdgeExtractorGPIOCount);
+    extractor->contexts[gpio] = context;
+}
+
+// reports every monitored GPIO that differs between `previousLevel` and `sample`
+void SampleEdgeExtractorReportEdges(SampleEdgeExtractorRef extractor, uint32_t previousLevel, const SampleEdgeExtractorSample * sample)
+{
+    uint32_t changed = (previousLevel ^ sample->level) & extractor->monitoredMask;
+    while (0 != changed)
+    {
+        uint32_t gpio = (uint32_t) __builtin_ctz(changed);
+        changed &= changed - 1; // clear the lowest bit
+
+        extractor->edgeCount += 1;
+        if (NULL != extractor->callback)
+        {
+            extractor->callback(extractor, gpio, (sample->level >> gpio) & 1, sample->tick, extractor->contexts[gpio]);
+        }
+    }
+}
+
+void SampleEdgeExtractorFeedSamples(SampleEdgeExtractorRef extractor, const SampleEdgeExtractorSample * samples, uint32_t count)
+{
+    assert(NULL != extractor);
+    if (0 == count) { return; }
+
+    extractor->sampleCount += count;
+
+    // a batch holds consecutive samples, but samples can get lost in between
+    if (extractor->hasLevel && 0 != extractor->maxSampleInterval &&
+        samples[0].tick - extractor->lastTick > extractor->maxSampleInterval)
+    {
+        atomic_fetch_add_explicit(&extractor->gapCount, 1, memory_order_relaxed);
+    }
+    extractor->lastTick = samples[count - 1].tick;
+
+    uint32_t index = 0;
+    if (!extractor->hasLevel)
+    {
+        extractor->level = samples[0].level;
+        extractor->hasLevel = true;
+        index = 1;
+    }
+
+    uint32_t previousLevel = extractor->level;
+    uint32_t monitoredMask = extractor->monitoredMask;
+    while (index < count)
+    {
+        // Check a whole block for changes without branching per sample: all
+        // samples equal to the level before the block means no edges. The
+        // compiler vectorises this loop where the target has SIMD.
+        if (index + SampleEdgeExtractorBlockLength <= count)
+        {
+            uint32_t changed = 0;
+            for (uint32_t offset = 0; offset < SampleEdgeExtractorBlockLength; offset++)
+            {
+                changed |= samples[index + offset].level ^ previousLevel;
+            }
+            if (0 == (changed & monitoredMask))
+            {
+                // the unmonitored GPIOs may differ, but only the monitored
+                // bits of `previousLevel` are ever compared
+                index += SampleEdgeExtractorBlockLength;
+                continue;
+            }
+        }
+
+        // there is at least one edge in this block (or in the tail): walk it
+        // sample by sample
+        uint32_t blockEnd = index + SampleEdgeExtractorBlockLength;
+        if (blockEnd > count) { blockEnd = count; }
+        for (; index < blockEnd; index++)
+        {
+            if (0 != ((samples[index].level ^ previousLevel) & monitoredMask))
+            {
+                SampleEdgeExtractorReportEdges(extractor, previousLevel, &samples[index]);
+            }
+            previousLevel = samples[index].level;
+        }
+    }
+    extractor->level = previousLevel;
+}
+
+uint64_t SampleEdgeExtractorGetSampleCount(SampleEdgeExtractorRef extractor)
+{
+    assert(NULL != extractor);
+    return extractor->sampleCount;
+}
+
+uint64_t SampleEdgeExtractorGetEdgeCount(SampleEdgeExtractorRef extractor)
+{
+    assert(NULL != extractor);
+    return extractor->edgeCount;
+}
+
+void SampleEdgeExtractorSetMaxSampleInterval(SampleEdgeExtractorRef extractor, uint32_t microseconds)
+{
+    assert(NULL != extractor);
+    extractor->maxSampleInterval = microseconds;
+}
+
+uint64_t SampleEdgeExtractorGetGapCount(SampleEdgeExtractorRef extractor)
+{
+    assert(NULL != extractor);
+    return atomic_load_explicit(&extractor->gapCount, memory_order_relaxed);
+}
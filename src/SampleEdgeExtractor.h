@@ -0,0 +1,93 @@
+#ifndef SampleEdgeExtractor_h
+#define SampleEdgeExtractor_h
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+
+/*
+A SampleEdgeExtractor finds the level changes of many GPIOs at once in a
+stream of level samples, such as the ones PIGPIO delivers through
+gpioSetGetSamplesFunc(). Each sample holds the levels of all 32 GPIOs of bank 1
+as a bitmask, so instead of one alert callback per edge per GPIO, a whole batch
+of samples is processed in one go: the levels of consecutive samples are
+XOR-ed, and runs of samples in which none of the monitored GPIOs changed are
+skipped without looking at the individual bits.
+For every edge that is found your callback is called with the GPIO, its new
+level and the tick of the sample, which is exactly what an alert function
+would have been given. The time between two edges of a GPIO is the duration
+of a pulse, which the protocol receivers compute from these ticks.
+This object is not thread-safe: feed it from one thread (the PIGPIO sample
+thread).
+*/
+
+typedef struct SampleEdgeExtractor *SampleEdgeExtractorRef;
+
+/*
+One sample: the tick (in microseconds) at which all GPIO levels were read, and
+the levels as a bitmask (bit n is GPIO n). The layout equals PIGPIO's
+`gpioSample_t`, so the samples given to a gpioGetSamplesFunc_t can be passed
+on as is.
+*/
+typedef struct SampleEdgeExtractorSample
+{
+    uint32_t tick;
+    uint32_t level;
+} SampleEdgeExtractorSample;
+
+/*
+Called for every level change of a monitored GPIO. `context` is the context
+that was set for `gpio` using SampleEdgeExtractorSetGPIOContext().
+*/
+typedef void (*SampleEdgeExtractorEdgeDetected)(SampleEdgeExtractorRef, uint32_t gpio, uint32_t level, uint32_t timestamp, void * context);
+
+/*
+Creates a new SampleEdgeExtractor for the GPIOs in `monitoredMask` (bit n is
+GPIO n), or NULL if an extractor could not be created. You are responsible for
+releasing this object using SampleEdgeExtractorRelease().
+*/
+SampleEdgeExtractorRef SampleEdgeExtractorCreate(uint32_t monitoredMask);
+
+/*
+Releases a SampleEdgeExtractorRef. This function is safe to call when
+`extractor` is NULL.
+*/
+void SampleEdgeExtractorRelease(SampleEdgeExtractorRef extractor);
+
+void SampleEdgeExtractorSetCallback(SampleEdgeExtractorRef extractor, SampleEdgeExtractorEdgeDetected callback);
+
+/*
+Defaults to NULL. Passed to the callback for edges of `gpio` (0 - 31).
+*/
+void SampleEdgeExtractorSetGPIOContext(SampleEdgeExtractorRef extractor, uint32_t gpio, void * context);
+
+/*
+Processes `count` consecutive samples. The first sample ever fed only sets the
+initial levels. Edges are reported in time order, and for samples with more
+than one edge, in order of GPIO number.
+*/
+void SampleEdgeExtractorFeedSamples(SampleEdgeExtractorRef extractor, const SampleEdgeExtractorSample * samples, uint32_t count);
+
+/*
+The number of samples fed, and the number of edges reported.
+*/
+uint64_t SampleEdgeExtractorGetSampleCount(SampleEdgeExtractorRef extractor);
+uint64_t SampleEdgeExtractorGetEdgeCount(SampleEdgeExtractorRef extractor);
+
+/*
+Defaults to 0: off. When the first sample of a batch was taken more than
+`microseconds` after the last sample of the previous batch, samples were lost
+(e.g. PIGPIO's sample buffer overflowed because its thread did not get the
+CPU in time), and with them possibly edges. Such gaps are counted. Only set
+this for continuous samples: level change reports (see
+NotificationPipeReader.h) have gaps as long as the pulses.
+*/
+void SampleEdgeExtractorSetMaxSampleInterval(SampleEdgeExtractorRef extractor, uint32_t microseconds);
+
+/*
+The number of gaps detected, see SampleEdgeExtractorSetMaxSampleInterval().
+Safe to call from any thread.
+*/
+uint64_t SampleEdgeExtractorGetGapCount(SampleEdgeExtractorRef extractor);
+
+#endif
@@ -0,0 +1,248 @@
+#include <stdio.h>
+#include <assert.h>
+#include "SimulatedGPIOBackend.h"
+
+#define SimulatedGPIOBackendGPIOCount 64
+#define SimulatedGPIOBackendTimerCount 10
+
+struct SimulatedGPIO
+{
+    uint32_t level;
+    uint64_t connectedInputs; // bit n is GPIO n
+
+    // inputs only
+    GPIOBackendEdgeFunction edgeFunction;
+    void * userdata;
+    uint64_t lastEdgeTime; // with jitter, edges must stay in order
+};
+
+struct SimulatedTimer
+{
+    GPIOBackendTimerFunction function; // NULL when not in use
+    void * userdata;
+    uint64_t period; // µicro seconds
+    uint64_t nextTime;
+};
+
+struct SimulatedGPIOBackend
+{
+    struct GPIOBackend backend; // must be first: the GPIOBackendRef points here
+
+    uint64_t time; // µicro seconds
+    struct SimulatedGPIO GPIOs[SimulatedGPIOBackendGPIOCount];
+    struct SimulatedTimer timers[SimulatedGPIOBackendTimerCount];
+    uint32_t maxJitter;
+    uint32_t randomState;
+    uint64_t edgeCount;
+};
+
+struct SimulatedGPIOBackend * SimulatedGPIOBackendGetState(GPIOBackendRef backend)
+{
+    assert(NULL != backend);
+    return backend->state;
+}
+
+// xorshift: deterministic, and independent of rand()
+uint32_t SimulatedGPIOBackendRandom(struct SimulatedGPIOBackend * simulated)
+{
+    uint32_t value = simulated->randomState;
+    value ^= value << 13;
+    value ^= value >> 17;
+    value ^= value << 5;
+    simulated->randomState = value;
+    return value;
+}
+
+// moves the clock to `time`, firing the timers that are due on the way in order
+void SimulatedGPIOBackendAdvanceTo(struct SimulatedGPIOBackend * simulated, uint64_t time)
+{
+    while (true)
+    {
+        struct SimulatedTimer * dueTimer = NULL;
+        for (uint32_t index = 0; index < SimulatedGPIOBackendTimerCount; index++)
+        {
+            struct SimulatedTimer * timer = &simulated->timers[index];
+            if (NULL != timer->function && timer->nextTime <= time &&
+                (NULL == dueTimer || timer->nextTime < dueTimer->nextTime))
+            { dueTimer = timer; }
+        }
+        if (NULL == dueTimer) { break; }
+
+        if (dueTimer->nextTime > simulated->time) { simulated->time = dueTimer->nextTime; }
+        dueTimer->nextTime += dueTimer->period;
+        dueTimer->function(dueTimer->userdata);
+    }
+    if (time > simulated->time) { simulated->time = time; }
+}
+
+int SimulatedGPIOBackendInitialise(GPIOBackendRef backend)
+{
+    return 0;
+}
+
+void SimulatedGPIOBackendTerminate(GPIOBackendRef backend)
+{
+    struct SimulatedGPIOBackend * simulated = SimulatedGPIOBackendGetState(backend);
+    for (uint32_t index = 0; index < SimulatedGPIOBackendGPIOCount; index++)
+    {
+        simulated->GPIOs[index].edgeFunction = NULL;
+    }
+    for (uint32_t index = 0; index < SimulatedGPIOBackendTimerCount; index++)
+    {
+        simulated->timers[index].function = NULL;
+    }
+}
+
+void SimulatedGPIOBackendRelease(GPIOBackendRef backend)
+{
+    free(SimulatedGPIOBackendGetState(backend));
+}
+
+int SimulatedGPIOBackendSetOutput(GPIOBackendRef backend, uint32_t gpio)
+{
+    if (gpio >= SimulatedGPIOBackendGPIOCount) { return -1; }
+    return 0;
+}
+
+int SimulatedGPIOBackendWrite(GPIOBackendRef backend, uint32_t gpio, uint32_t level)
+{
+    struct SimulatedGPIOBackend * simulated = SimulatedGPIOBackendGetState(backend);
+    if (gpio >= SimulatedGPIOBackendGPIOCount) { return -1; }
+
+    level = (0 != level) ? 1 : 0;
+    struct SimulatedGPIO * output = &simulated->GPIOs[gpio];
+    if (output->level == level) { return 0; }
+    output->level = level;
+
+    uint64_t inputs = output->connectedInputs;
+    while (0 != inputs)
+    {
+        uint32_t inputGPIO = (uint32_t) __builtin_ctzll(inputs);
+        inputs &= inputs - 1;
+
+        struct SimulatedGPIO * input = &simulated->GPIOs[inputGPIO];
+        input->level = level;
+
+        uint64_t edgeTime = simulated->time;
+        if (simulated->maxJitter > 0)
+        { edgeTime += SimulatedGPIOBackendRandom(simulated) % (simulated->maxJitter + 1); }
+        if (edgeTime < input->lastEdgeTime) { edgeTime = input->lastEdgeTime; }
+        input->lastEdgeTime = edgeTime;
+
+        if (NULL != input->edgeFunction)
+        {
+            simulated->edgeCount += 1;
+            input->edgeFunction((int) inputGPIO, (int) level, (uint32_t) edgeTime, input->userdata);
+        }
+    }
+    return 0;
+}
+
+int SimulatedGPIOBackendSetEdgeFunction(GPIOBackendRef backend, uint32_t gpio, GPIOBackendEdgeFunction function, void * userdata)
+{
+    struct SimulatedGPIOBackend * simulated = SimulatedGPIOBackendGetState(backend);
+    if (gpio >= SimulatedGPIOBackendGPIOCount) { return -1; }
+
+    simulated->GPIOs[gpio].edgeFunction = function;
+    simulated->GPIOs[gpio].userdata = userdata;
+    return 0;
+}
+
+int SimulatedGPIOBackendSetTimerFunction(GPIOBackendRef backend, uint32_t timer, uint32_t millis, GPIOBackendTimerFunction function, void * userdata)
+{
+    struct SimulatedGPIOBackend * simulated = SimulatedGPIOBackendGetState(backend);
+    if (timer >= SimulatedGPIOBackendTimerCount || (NULL != function && 0 == millis)) { return -1; }
+
+    struct SimulatedTimer * simulatedTimer = &simulated->timers[timer];
+    simulatedTimer->function = function;
+    simulatedTimer->userdata = userdata;
+    simulatedTimer->period = (uint64_t) millis * 1000;
+    simulatedTimer->nextTime = simulated->time + simulatedTimer->period;
+    return 0;
+}
+
+uint32_t SimulatedGPIOBackendTick(GPIOBackendRef backend)
+{
+    return (uint32_t) SimulatedGPIOBackendGetState(backend)->time;
+}
+
+uint64_t SimulatedGPIOBackendTime(GPIOBackendRef backend)
+{
+    return SimulatedGPIOBackendGetState(backend)->time;
+}
+
+void SimulatedGPIOBackendWaitUntil(GPIOBackendRef backend, uint64_t time)
+{
+    SimulatedGPIOBackendAdvanceTo(SimulatedGPIOBackendGetState(backend), time);
+}
+
+void SimulatedGPIOBackendSleep(GPIOBackendRef backend, uint32_t duration)
+{
+    struct SimulatedGPIOBackend * simulated = SimulatedGPIOBackendGetState(backend);
+    SimulatedGPIOBackendAdvanceTo(simulated, simulated->time + duration);
+}
+
+GPIOBackendRef SimulatedGPIOBackendCreate()
+{
+    struct SimulatedGPIOBackend * simulated = malloc(sizeof(struct SimulatedGPIOBackend));
+    if (NULL == simulated) { return NULL; }
+
+    simulated->backend.name = "simulated";
+    simulated->backend.state = simulated;
+    simulated->backend.initialise = SimulatedGPIOBackendInitialise;
+    simulated->backend.terminate = SimulatedGPIOBackendTerminate;
+    simulated->backend.release = SimulatedGPIOBackendRelease;
+    simulated->backend.setOutput = SimulatedGPIOBackendSetOutput;
+    simulated->backend.write = SimulatedGPIOBackendWrite;
+    simulated->backend.setEdgeFunction = SimulatedGPIOBackendSetEdgeFunction;
+    simulated->backend.setTimerFunction = SimulatedGPIOBackendSetTimerFunction;
+    simulated->backend.tick = SimulatedGPIOBackendTick;
+    simulated->backend.time = SimulatedGPIOBackendTime;
+    simulated->backend.waitUntil = SimulatedGPIOBackendWaitUntil;
+    simulated->backend.sleep = SimulatedGPIOBackendSleep;
+
+    simulated->time = 1000000;
+    for (uint32_t index = 0; index < SimulatedGPIOBackendGPIOCount; index++)
+    {
+        simulated->GPIOs[index].level = 0;
+        simulated->GPIOs[index].connectedInputs = 0;
+        simulated->GPIOs[index].edgeFunction = NULL;
+        simulated->GPIOs[index].userdata = NULL;
+        simulated->GPIOs[index].lastEdgeTime = 0;
+    }
+    for (uint32_t index = 0; index < SimulatedGPIOBackendTimerCount; index++)
+    {
+        simulated->timers[index].function = NULL;
+    }
+    simulated->maxJitter = 0;
+    simulated->randomState = 1;
+    simulated->edgeCount = 0;
+
+    return &simulated->backend;
+}
+
+void SimulatedGPIOBackendConnect(GPIOBackendRef backend, uint32_t outputGPIO, uint32_t inputGPIO)
+{
+    struct SimulatedGPIOBackend * simulated = SimulatedGPIOBackendGetState(backend);
+    assert(outputGPIO < SimulatedGPIOBackendGPIOCount);
+    assert(inputGPIO < SimulatedGPIOBackendGPIOCount);
+    simulated->GPIOs[outputGPIO].connectedInputs |= ((uint64_t) 1 << inputGPIO);
+}
+
+void SimulatedGPIOBackendSetJitter(GPIOBackendRef backend, uint32_t maxJitter, uint32_t seed)
+{
+    struct SimulatedGPIOBackend * simulated = SimulatedGPIOBackendGetState(backend);
+    simulated->maxJitter = maxJitter;
+    simulated->randomState = (0 == seed) ? 1 : seed; // xorshift never leaves 0
+}
+
+void SimulatedGPIOBackendAdvance(GPIOBackendRef backend, uint64_t duration)
+{
+    struct SimulatedGPIOBackend * simulated = SimulatedGPIOBackendGetState(backend);
+    SimulatedGPIOBackendAdvanceTo(simulated, simulated->time + duration);
+}
+
+uint64_t SimulatedGPIOBackendGetEdgeCount(GPIOBackendRef backend)
+{
+    return SimulatedGPIOBackendGetState(backend)->edgeCount;
+}
@@ -0,0 +1,50 @@
+#ifndef SimulatedGPIOBackend_h
+#define SimulatedGPIOBackend_h
+
+#include "GPIOBackend.h"
+
+/*
+A GPIOBackend without hardware, driven by a virtual clock. The clock starts
+at 1 second and only moves when the backend is asked to wait or sleep, so a
+sender that transmits 72ms worth of pulses returns as soon as the pulses are
+computed, and everything that runs on it is deterministic.
+Output pins can be connected to input pins: every level change written to the
+output is delivered as an edge on the connected inputs, on the thread that
+called GPIOBackendWrite(). This way an OOKSender on one pin can be received
+by the receivers on another pin, like a transmitter next to a receiver.
+Timers fire while the clock is moved past their deadline.
+This backend is not thread-safe: use it from one thread.
+*/
+
+/*
+Creates a new simulated backend, or NULL if it could not be created. You are
+responsible for releasing it using GPIOBackendRelease().
+*/
+GPIOBackendRef SimulatedGPIOBackendCreate();
+
+/*
+Delivers every level change of output `outputGPIO` as an edge on
+`inputGPIO` (0 - 63). An output can be connected to several inputs.
+*/
+void SimulatedGPIOBackendConnect(GPIOBackendRef backend, uint32_t outputGPIO, uint32_t inputGPIO);
+
+/*
+Defaults to 0.
+Delays each delivered edge by a pseudo-random 0 - `maxJitter` microseconds,
+to mimic the timing noise of real hardware. Edges on an input never arrive
+out of order. `seed` makes the noise reproducible.
+*/
+void SimulatedGPIOBackendSetJitter(GPIOBackendRef backend, uint32_t maxJitter, uint32_t seed);
+
+/*
+Moves the virtual clock forward by `duration` microseconds, firing the timers
+that are due on the way.
+*/
+void SimulatedGPIOBackendAdvance(GPIOBackendRef backend, uint64_t duration);
+
+/*
+The number of edges delivered to inputs.
+*/
+uint64_t SimulatedGPIOBackendGetEdgeCount(GPIOBackendRef backend);
+
+#endif
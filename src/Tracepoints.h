@@ -0,0 +1,69 @@
+#ifndef Tracepoints_h
+#define Tracepoints_h
+
+/*
+Static tracepoints (USDT probes) on the hot paths of receiving and sending, to
+trace a running LPD433 with e.g. `perf` or bpftrace, without rebuilding it
+with COCODebugLogging or KFSDebugLogging, whose printf() calls change the
+timing completely. A probe that is not traced is a single `nop` instruction,
+so the probes stay in production builds.
+
+The probes are built in when <sys/sdt.h> is available (on Debian and Raspberry
+Pi OS: `apt install systemtap-sdt-dev`), or can be switched off by building
+with -DLPD433Tracepoints=0. Without them, they compile to nothing.
+
+List them with `perf list sdt_LPD433:*` (after `perf buildid-cache --add
+LPD433`) or `bpftrace -l 'usdt:./LPD433:*'`, e.g.:
+    bpftrace -e 'usdt:./LPD433:LPD433:coco_frame_reject { @[arg1, arg2] = count(); }'
+
+Provider `LPD433`, probes and their arguments:
+  coco_start_sync      receiver, timestamp, duration (µs)
+  coco_frame_reject    receiver, reason (ReceiverRejectReason), bit index
+  coco_frame_accept    receiver, code, quality
+  coco_repeat          receiver, code, repeats: the same code was received again
+  coco_refractory      receiver, code, µs since the previous hit: suppressed
+  coco_callback_entry  receiver, code
+  coco_callback_exit   receiver, code
+  kfs_...              the same probes with the same arguments for the
+                       KFSReceiver, where `code` is the identifier
+  ook_transmit_start   sender, pulse count, repeats
+  ook_pulse            sender, repeat index, pulse index, level, duration (µs):
+                       the start of every pulse, right after the GPIO was written
+  ook_transmit_end     sender
+  engine_start_sync    engine, protocol index, timestamp, duration (µs)
+  engine_frame_reject  engine, protocol index, reason (ReceiverRejectReason), bit index
+  engine_frame_accept  engine, protocol index, code, quality
+  oregon_sync          receiver, timestamp, protocol version (2 for 2.1, or 3)
+  oregon_frame_reject  receiver, reason (ReceiverRejectReason), bit index
+  oregon_frame_accept  receiver, code, quality
+*/
+
+#ifndef LPD433Tracepoints
+    #if defined(__has_include)
+        #if __has_include(<sys/sdt.h>)
+            #define LPD433Tracepoints 1
+        #endif
+    #endif
+#endif
+#ifndef LPD433Tracepoints
+    #define LPD433Tracepoints 0
+#endif
+
+#if LPD433Tracepoints
+    #include <sys/sdt.h>
+    #define LPD433Trace1(name, a) DTRACE_PROBE1(LPD433, name, a)
+    #define LPD433Trace2(name, a, b) DTRACE_PROBE2(LPD433, name, a, b)
+    #define LPD433Trace3(name, a, b, c) DTRACE_PROBE3(LPD433, name, a, b, c)
+    #define LPD433Trace4(name, a, b, c, d) DTRACE_PROBE4(LPD433, name, a, b, c, d)
+    #define LPD433Trace5(name, a, b, c, d, e) DTRACE_PROBE5(LPD433, name, a, b, c, d, e)
+#else
+    // the arguments are still evaluated, so that a variable that only exists
+    // to be traced is not reported as unused
+    #define LPD433Trace1(name, a) do { (void) (a); } while (0)
+    #define LPD433Trace2(name, a, b) do { (void) (a); (void) (b); } while (0)
+    #define LPD433Trace3(name, a, b, c) do { (void) (a); (void) (b); (void) (c); } while (0)
+    #define LPD433Trace4(name, a, b, c, d) do { (void) (a); (void) (b); (void) (c); (void) (d); } while (0)
+    #define LPD433Trace5(name, a, b, c, d, e) do { (void) (a); (void) (b); (void) (c); (void) (d); (void) (e); } while (0)
+#endif
+
+#endif